@@ -0,0 +1,203 @@
+/************************************************************************/
+/**
+
+   \file       cache2pdb.c
+
+   \version    V1.1
+   \date       15.10.26
+   \brief      Convert binary cache files to PDB files
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Converts a binary cache file written by pdb2cache back to PDB
+   format. Any PDB file may also be given and is simply rewritten.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/macros.h"
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/pdb.h"
+#include "bioplib/general.h"
+#include "common/mappdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF 160
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+int  main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+void Usage(void);
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program for converting binary cache files to PDB format
+
+-  15.10.26 Original    By: ACRM
+*/
+int main(int argc, char **argv)
+{
+   FILE     *in  = stdin,
+            *out = stdout;
+   WHOLEPDB *wpdb;
+   char     infile[MAXBUFF],
+            outfile[MAXBUFF];
+
+   if(ParseCmdLine(argc, argv, infile, outfile))
+   {
+      if(blOpenStdFiles(infile, outfile, &in, &out))
+      {
+         if((wpdb = ReadMappedWholePDB(in))==NULL)
+         {
+            fprintf(stderr,"No atoms read from input file\n");
+            return(1);
+         }
+         blWriteWholePDB(out, wpdb);
+         blFreeWholePDB(wpdb);
+      }
+      else
+      {
+         Usage();
+         return(1);
+      }
+   }
+   else
+   {
+      Usage();
+      return(1);
+   }
+
+   return(0);
+}
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]      argc        Argument count
+   \param[in]      **argv      Argument array
+   \param[out]     *infile     Input filename (or blank string)
+   \param[out]     *outfile    Output filename (or blank string)
+   \return                     Success
+
+   Parse the command line
+
+-  15.10.26 Original    By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+{
+   argc--;
+   argv++;
+
+   infile[0] = outfile[0] = '\0';
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         switch(argv[0][1])
+         {
+         case 'h':
+         default:
+            return(FALSE);
+            break;
+         }
+      }
+      else
+      {
+         /* Check that there are only 1 or 2 arguments left             */
+         if(argc > 2)
+            return(FALSE);
+
+         /* Copy the first to infile                                    */
+         strcpy(infile, argv[0]);
+
+         /* If there's another, copy it to outfile                      */
+         argc--;
+         argv++;
+         if(argc)
+            strcpy(outfile, argv[0]);
+
+         return(TRUE);
+      }
+      argc--;
+      argv++;
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+   Print a usage message
+
+-  15.10.26 Original    By: ACRM
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\ncache2pdb V1.0 (c) 2026 Dr. Andrew C.R. Martin, \
+UCL\n");
+   fprintf(stderr,"\nUsage: cache2pdb [in.cache [out.pdb]]\n\n");
+   fprintf(stderr,"If files are not specified, stdin and stdout are \
+used. The cache file must\n");
+   fprintf(stderr,"be a file (or redirected from a file) rather than \
+a pipe.\n");
+   fprintf(stderr,"Converts a binary cache file written by pdb2cache \
+back to PDB format.\n\n");
+}
@@ -0,0 +1,535 @@
+/************************************************************************/
+/**
+
+   \file       batch.c
+
+   \version    V1.2
+   \date       15.10.26
+   \brief      Running a program over a list of input files
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Lets a program process many input files in one run so that process
+   startup and the reading of any data files are paid for once rather
+   than once per structure.
+
+   The input files are listed one per line in a list file (or on
+   standard input if the list file is given as '-'). Blank lines and
+   lines starting with a # are skipped. Each file is opened and handed
+   to a function supplied by the program, along with a pointer to the
+   program's own data (options, data files already read, etc.).
+
+   Lines longer than MAXBATCHBUFF-1 characters are reported and 
+   skipped.
+
+   If an output directory is given, the output for each input file is
+   written to a file of the same name in that directory (or with its
+   extension replaced, see RunBatchExt()). Two input files with the
+   same name in different directories would write the same output file,
+   so the second is reported and skipped. An input file which is itself
+   the output file (the output directory is the input directory) is
+   also reported and skipped, since opening the output would empty it
+   before it was read. Otherwise all
+   output goes to a single stream and the output for each file is
+   framed by lines of the form
+
+      #BEGIN filename
+      ...
+      #END filename OK
+
+   where OK is replaced by FAILED if the file could not be processed.
+
+**************************************************************************
+
+   Usage:
+   ======
+   BOOL ProcessFile(FILE *in, FILE *out, char *infile, void *data)
+   {
+      ...
+   }
+
+   nfail = RunBatch(listfile, outdir, out, ProcessFile, &data);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Rejects over-long lines in the list file and input
+                  files which would overwrite each other's output
+-  V1.2  15.10.26 Refuses to overwrite an input file with its own
+                  output. Added RunBatchExt()
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
+#include "batch.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NAMESETSIZE 256             /* Initial size of a NAMESET        */
+
+/* Hash set of the output filenames already written                     */
+typedef struct
+{
+   char **names;                    /* Open-addressed table of names    */
+   int  size,
+        nnames;
+}  NAMESET;
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL BuildOutFileName(char *outfile, char *outdir, char *infile,
+                             char *ext);
+static BOOL SameFile(FILE *in, char *outfile);
+static BOOL SkipLongLine(FILE *fp, char *buffer);
+static int  AddToNameSet(NAMESET *set, char *name);
+static BOOL GrowNameSet(NAMESET *set);
+static int  FindInNameSet(char **names, int size, char *name);
+static void FreeNameSet(NAMESET *set);
+
+/************************************************************************/
+/*>int RunBatch(char *listfile, char *outdir, FILE *out,
+                BATCHFUNC ProcessFile, void *data)
+   ------------------------------------------------------
+*//**
+
+   \param[in]      *listfile     File listing the input files ('-' for
+                                 stdin)
+   \param[in]      *outdir       Directory for output files (or blank
+                                 string to write all output to out)
+   \param[in]      *out          Output stream used if outdir is blank
+   \param[in]      ProcessFile   Function to process each file
+   \param[in]      *data         Data passed through to ProcessFile()
+   \return                       Number of files which could not be
+                                 processed (-1 if the list could not be
+                                 read)
+
+   Runs ProcessFile() on each file named in the list file. A file which
+   cannot be opened or processed is reported and skipped, as is a line
+   which is too long or a file whose output would overwrite the output
+   for an earlier file or the file itself.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Checks for long lines and output filename clashes
+-  15.10.26 Now calls RunBatchExt()
+*/
+int RunBatch(char *listfile, char *outdir, FILE *out,
+             BATCHFUNC ProcessFile, void *data)
+{
+   return(RunBatchExt(listfile, outdir, NULL, out, ProcessFile, data));
+}
+
+/************************************************************************/
+/*>int RunBatchExt(char *listfile, char *outdir, char *ext, FILE *out,
+                   BATCHFUNC ProcessFile, void *data)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]      *listfile     File listing the input files ('-' for
+                                 stdin)
+   \param[in]      *outdir       Directory for output files (or blank
+                                 string to write all output to out)
+   \param[in]      *ext          Extension (e.g. ".cache") replacing any
+                                 extension of the input filename in the
+                                 output filename (NULL to keep the name)
+   \param[in]      *out          Output stream used if outdir is blank
+   \param[in]      ProcessFile   Function to process each file
+   \param[in]      *data         Data passed through to ProcessFile()
+   eturn                       Number of files which could not be
+                                 processed (-1 if the list could not be
+                                 read)
+
+   As RunBatch(), but the output files may be given a different
+   extension from the input files
+
+-  15.10.26 Original (split from RunBatch())   By: ACRM
+*/
+int RunBatchExt(char *listfile, char *outdir, char *ext, FILE *out,
+                BATCHFUNC ProcessFile, void *data)
+{
+   FILE    *fpList,
+           *in,
+           *fpOut;
+   char    buffer[MAXBATCHBUFF],
+           outfile[MAXBATCHBUFF],
+           *infile;
+   NAMESET outnames;
+   int     nfail = 0,
+           added;
+   BOOL    ok;
+
+   if(!strcmp(listfile, "-"))
+   {
+      fpList = stdin;
+   }
+   else if((fpList = fopen(listfile, "r"))==NULL)
+   {
+      return(-1);
+   }
+
+   outnames.names  = NULL;
+   outnames.size   = 0;
+   outnames.nnames = 0;
+
+   while(fgets(buffer, MAXBATCHBUFF, fpList))
+   {
+      if(SkipLongLine(fpList, buffer))
+      {
+         fprintf(stderr, "Warning: Line in list file longer than %d \
+characters skipped\n", MAXBATCHBUFF-1);
+         nfail++;
+         continue;
+      }
+
+      TERMINATE(buffer);
+      KILLTRAILSPACES(buffer);
+      KILLLEADSPACES(infile, buffer);
+      if((*infile == '\0') || (*infile == '#'))
+         continue;
+
+      if((in = fopen(infile, "r"))==NULL)
+      {
+         fprintf(stderr, "Warning: Unable to open input file, %s\n",
+                 infile);
+         nfail++;
+         continue;
+      }
+
+      if(outdir[0])
+      {
+         if(!BuildOutFileName(outfile, outdir, infile, ext) ||
+            ((added = AddToNameSet(&outnames, outfile)) < 0))
+         {
+            fprintf(stderr, "Warning: Unable to create output file name \
+for %s\n", infile);
+            fclose(in);
+            nfail++;
+            continue;
+         }
+         if(added == 0)
+         {
+            fprintf(stderr, "Warning: Output file %s for %s would \
+overwrite the output for an earlier file with the same name\n", 
+                    outfile, infile);
+            fclose(in);
+            nfail++;
+            continue;
+         }
+         if(SameFile(in, outfile))
+         {
+            fprintf(stderr, "Warning: Output file %s is the input file \
+%s and would overwrite it\n", outfile, infile);
+            fclose(in);
+            nfail++;
+            continue;
+         }
+         if((fpOut = fopen(outfile, "w"))==NULL)
+         {
+            fprintf(stderr, "Warning: Unable to open output file for \
+%s\n", infile);
+            fclose(in);
+            nfail++;
+            continue;
+         }
+      }
+      else
+      {
+         fpOut = out;
+         fprintf(out, "%s%s\n", BATCH_BEGIN, infile);
+      }
+
+      ok = (*ProcessFile)(in, fpOut, infile, data);
+      fclose(in);
+
+      if(outdir[0])
+      {
+         fclose(fpOut);
+      }
+      else
+      {
+         fprintf(out, "%s%s %s\n", BATCH_END, infile,
+                 (ok ? "OK" : "FAILED"));
+         fflush(out);
+      }
+
+      if(!ok)
+         nfail++;
+   }
+
+   if(fpList != stdin)
+      fclose(fpList);
+   FreeNameSet(&outnames);
+
+   return(nfail);
+}
+
+/************************************************************************/
+/*>static BOOL BuildOutFileName(char *outfile, char *outdir, char *infile,
+                                char *ext)
+   -----------------------------------------------------------------------
+*//**
+
+   \param[out]     *outfile   Output filename
+   \param[in]      *outdir    Output directory
+   \param[in]      *infile    Input filename
+   \param[in]      *ext       Extension to replace that of the input
+                              filename (or NULL)
+   \return                    Did the name fit in MAXBATCHBUFF?
+
+   Builds the output filename from the output directory and the input
+   filename with any path removed and, if ext is given, the extension
+   replaced
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Added ext
+*/
+static BOOL BuildOutFileName(char *outfile, char *outdir, char *infile,
+                             char *ext)
+{
+   char *basename,
+        *dot;
+   int  len;
+
+   if((basename = strrchr(infile, '/'))!=NULL)
+      basename++;
+   else
+      basename = infile;
+
+   len = strlen(basename);
+   if((ext != NULL) && ((dot = strrchr(basename, '.'))!=NULL) &&
+      (dot != basename))
+      len = (int)(dot - basename);
+
+   if((strlen(outdir) + len + ((ext != NULL) ? strlen(ext) : 0) + 2) >
+      MAXBATCHBUFF)
+      return(FALSE);
+
+   sprintf(outfile, "%s/%.*s%s", outdir, len, basename,
+           ((ext != NULL) ? ext : ""));
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static BOOL SameFile(FILE *in, char *outfile)
+   ---------------------------------------------
+*//**
+
+   \param[in]      *in        Open input file
+   \param[in]      *outfile   Output filename
+   \return                    Is the output file the input file?
+
+   Compares the device and inode numbers, so links and different paths
+   to the same file are found. An output file that does not exist yet
+   cannot be the input file.
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL SameFile(FILE *in, char *outfile)
+{
+   struct stat inStat,
+               outStat;
+
+   if(stat(outfile, &outStat) || fstat(fileno(in), &inStat))
+      return(FALSE);
+
+   return((BOOL)((inStat.st_dev == outStat.st_dev) &&
+                 (inStat.st_ino == outStat.st_ino)));
+}
+
+/************************************************************************/
+/*>static BOOL SkipLongLine(FILE *fp, char *buffer)
+   ------------------------------------------------
+*//**
+
+   \param[in]      *fp       File being read
+   \param[in]      *buffer   Line just read with fgets()
+   \return                   Was the line too long for the buffer?
+
+   Checks whether fgets() stopped before the end of a line. If so, the
+   rest of the line is read and discarded. The last line of a file need
+   not end with a newline.
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL SkipLongLine(FILE *fp, char *buffer)
+{
+   int ch;
+
+   if(strchr(buffer, '\n') != NULL)
+      return(FALSE);
+
+   if((ch = getc(fp)) == EOF)
+      return(FALSE);
+
+   while((ch != '\n') && (ch != EOF))
+      ch = getc(fp);
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static int AddToNameSet(NAMESET *set, char *name)
+   -------------------------------------------------
+*//**
+
+   \param[in,out]  *set      Set of names
+   \param[in]      *name     Name to add (copied)
+   \return                   1 if added, 0 if already in the set, -1 if
+                             out of memory
+
+   Adds a name to the set if it is not already there
+
+-  15.10.26 Original   By: ACRM
+*/
+static int AddToNameSet(NAMESET *set, char *name)
+{
+   int slot;
+
+   if((2 * (set->nnames + 1) > set->size) && !GrowNameSet(set))
+      return(-1);
+
+   slot = FindInNameSet(set->names, set->size, name);
+   if(set->names[slot] != NULL)
+      return(0);
+
+   if((set->names[slot] = (char *)malloc(strlen(name) + 1))==NULL)
+      return(-1);
+   strcpy(set->names[slot], name);
+   set->nnames++;
+
+   return(1);
+}
+
+/************************************************************************/
+/*>static BOOL GrowNameSet(NAMESET *set)
+   -------------------------------------
+*//**
+
+   \param[in,out]  *set      Set of names
+   \return                   Success in allocations
+
+   Doubles the size of the table (or creates it) and re-inserts the 
+   names
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL GrowNameSet(NAMESET *set)
+{
+   char **names;
+   int  size = (set->size ? 2 * set->size : NAMESETSIZE),
+        i;
+
+   if((names = (char **)calloc(size, sizeof(char *)))==NULL)
+      return(FALSE);
+
+   for(i=0; i<set->size; i++)
+   {
+      if(set->names[i] != NULL)
+         names[FindInNameSet(names, size, set->names[i])] = set->names[i];
+   }
+
+   if(set->names != NULL)
+      free(set->names);
+   set->names = names;
+   set->size  = size;
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static int FindInNameSet(char **names, int size, char *name)
+   ------------------------------------------------------------
+*//**
+
+   \param[in]      **names   Table of names
+   \param[in]      size      Size of the table (a power of 2)
+   \param[in]      *name     Name to find
+   \return                   Slot holding the name, or the empty slot
+                             where it would go
+
+   Looks up a name in the table with linear probing
+
+-  15.10.26 Original   By: ACRM
+*/
+static int FindInNameSet(char **names, int size, char *name)
+{
+   unsigned long hash = 5381;
+   char          *chp;
+   int           slot;
+
+   for(chp=name; *chp; chp++)
+      hash = (hash * 33) ^ (unsigned char)*chp;
+
+   for(slot = (int)(hash & (size - 1));
+       (names[slot] != NULL) && strcmp(names[slot], name);
+       slot = (slot + 1) & (size - 1));
+
+   return(slot);
+}
+
+/************************************************************************/
+/*>static void FreeNameSet(NAMESET *set)
+   -------------------------------------
+*//**
+
+   \param[in,out]  *set      Set of names
+
+   Frees the names and the table
+
+-  15.10.26 Original   By: ACRM
+*/
+static void FreeNameSet(NAMESET *set)
+{
+   int i;
+
+   if(set->names != NULL)
+   {
+      for(i=0; i<set->size; i++)
+      {
+         if(set->names[i] != NULL)
+            free(set->names[i]);
+      }
+      free(set->names);
+      set->names = NULL;
+   }
+   set->size   = 0;
+   set->nnames = 0;
+}
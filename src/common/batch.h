@@ -0,0 +1,69 @@
+/************************************************************************/
+/**
+
+   \file       batch.h
+
+   \version    V1.1
+   \date       15.10.26
+   \brief      Running a program over a list of input files
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Added RunBatchExt()
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_BATCH_H
+#define _BIOPTOOLS_BATCH_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBATCHBUFF 512               /* Max length of a filename      */
+#define BATCH_BEGIN  "#BEGIN "         /* Frame lines when all output   */
+#define BATCH_END    "#END "           /* goes to a single stream       */
+
+/* Processes one file. Returns FALSE if the file could not be processed */
+typedef BOOL (*BATCHFUNC)(FILE *in, FILE *out, char *infile, void *data);
+
+/************************************************************************/
+/* Prototypes
+*/
+int RunBatch(char *listfile, char *outdir, FILE *out,
+             BATCHFUNC ProcessFile, void *data);
+int RunBatchExt(char *listfile, char *outdir, char *ext, FILE *out,
+                BATCHFUNC ProcessFile, void *data);
+
+#endif
@@ -0,0 +1,254 @@
+/************************************************************************/
+/**
+
+   \file       cellgrid.c
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Cell-list grids and residue tables for neighbour searches
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A cell-list grid divides space into cubic cells and sorts a set of
+   items (atoms or residue centres) by cell. With cells at least as large
+   as a search radius, the neighbours of an item are found by looking
+   only in its own cell and the 26 cells around it.
+
+   The residue table gives the atom range, atom count and bounding sphere
+   of each residue so that residue pairs which cannot be in contact can
+   be skipped without looking at their atoms.
+
+**************************************************************************
+
+   Usage:
+   ======
+   grid = BuildCellGrid(coords, n, radius);
+   ... search grid->cellItems[] for the cells around each item ...
+   FreeCellGrid(grid);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original (moved from pdbatomcount.c, pdbhbond.c,
+                  pdbsphere.c and pdbmakepatch.c)
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "cellgrid.h"
+
+/************************************************************************/
+/*>CELLGRID *BuildCellGrid(VEC3F *coords, int nitems, REAL cellSize)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *coords    Coordinates of the items
+   \param[in]      nitems     Number of items
+   \param[in]      cellSize   Minimum edge length of a grid cell
+   \return                    Malloc'd grid (NULL if no memory)
+
+   Builds a cell-list grid over a set of coordinates. Any two items 
+   closer than cellSize are in the same or adjacent cells. The cell
+   size is increased if the grid would otherwise contain more than
+   MAXCELLSPERITEM cells per item (e.g. for a very small radius in a
+   sparse structure).
+
+-  15.10.26 Original   By: ACRM
+*/
+CELLGRID *BuildCellGrid(VEC3F *coords, int nitems, REAL cellSize)
+{
+   CELLGRID *grid;
+   REAL     xmax, ymax, zmax;
+   int      i,
+            ncells;
+
+   if((grid = (CELLGRID *)malloc(sizeof(CELLGRID)))==NULL)
+      return(NULL);
+   grid->itemCell  = NULL;
+   grid->cellStart = NULL;
+   grid->cellItems = NULL;
+   grid->nitems    = nitems;
+
+   /* Find the bounding box                                             */
+   grid->xmin = xmax = coords[0].x;
+   grid->ymin = ymax = coords[0].y;
+   grid->zmin = zmax = coords[0].z;
+   for(i=1; i<nitems; i++)
+   {
+      grid->xmin = MIN(grid->xmin, coords[i].x);
+      grid->ymin = MIN(grid->ymin, coords[i].y);
+      grid->zmin = MIN(grid->zmin, coords[i].z);
+      xmax       = MAX(xmax, coords[i].x);
+      ymax       = MAX(ymax, coords[i].y);
+      zmax       = MAX(zmax, coords[i].z);
+   }
+
+   /* Choose the cell size and grid dimensions                          */
+   if(cellSize <= (REAL)0.0)
+      cellSize = (REAL)1.0;
+   for(;;)
+   {
+      grid->nx = 1 + (int)((xmax - grid->xmin) / cellSize);
+      grid->ny = 1 + (int)((ymax - grid->ymin) / cellSize);
+      grid->nz = 1 + (int)((zmax - grid->zmin) / cellSize);
+      if(((double)grid->nx * (double)grid->ny * (double)grid->nz) <=
+         (double)MAXCELLSPERITEM * (double)nitems)
+         break;
+      cellSize *= (REAL)2.0;
+   }
+   grid->cellSize = cellSize;
+   ncells = grid->nx * grid->ny * grid->nz;
+
+   if(((grid->itemCell  = (int *)malloc(nitems * sizeof(int)))==NULL) ||
+      ((grid->cellItems = (int *)malloc(nitems * sizeof(int)))==NULL) ||
+      ((grid->cellStart = (int *)calloc(ncells+1, sizeof(int)))==NULL))
+   {
+      FreeCellGrid(grid);
+      return(NULL);
+   }
+
+   /* Find the cell for each item and count the items in each cell      */
+   for(i=0; i<nitems; i++)
+   {
+      int cx, cy, cz;
+      
+      cx = (int)((coords[i].x - grid->xmin) / cellSize);
+      cy = (int)((coords[i].y - grid->ymin) / cellSize);
+      cz = (int)((coords[i].z - grid->zmin) / cellSize);
+      grid->itemCell[i] = cx + grid->nx * (cy + grid->ny * cz);
+      grid->cellStart[grid->itemCell[i]+1]++;
+   }
+
+   /* Convert the counts to offsets and sort the items into cells. The
+      items in each cell stay in their original order
+   */
+   for(i=0; i<ncells; i++)
+      grid->cellStart[i+1] += grid->cellStart[i];
+   for(i=0; i<nitems; i++)
+      grid->cellItems[grid->cellStart[grid->itemCell[i]]++] = i;
+   for(i=ncells; i>0; i--)
+      grid->cellStart[i] = grid->cellStart[i-1];
+   grid->cellStart[0] = 0;
+
+   return(grid);
+}
+
+/************************************************************************/
+/*>void FreeCellGrid(CELLGRID *grid)
+   ---------------------------------
+*//**
+
+   \param[in]      *grid      Cell-list grid
+
+   Frees a grid created by BuildCellGrid()
+
+-  15.10.26 Original   By: ACRM
+*/
+void FreeCellGrid(CELLGRID *grid)
+{
+   if(grid != NULL)
+   {
+      if(grid->itemCell  != NULL) free(grid->itemCell);
+      if(grid->cellStart != NULL) free(grid->cellStart);
+      if(grid->cellItems != NULL) free(grid->cellItems);
+      free(grid);
+   }
+}
+
+/************************************************************************/
+/*>RESIDUE *BuildResidueTable(PDB *pdb, int *nres)
+   -----------------------------------------------
+*//**
+
+   \param[in]      *pdb       PDB linked list
+   \param[out]     *nres      Number of residues
+   \return                    Malloc'd residue table (NULL if no memory)
+
+   Builds a table of the residues in linked list order with the atom 
+   range, atom count and bounding sphere for each.
+
+-  15.10.26 Original   By: ACRM
+*/
+RESIDUE *BuildResidueTable(PDB *pdb, int *nres)
+{
+   RESIDUE *residues;
+   PDB     *p,
+           *start;
+   int     i;
+
+   *nres = 0;
+   for(start=pdb; start!=NULL; start=blFindNextResidue(start))
+      (*nres)++;
+
+   if((residues = (RESIDUE *)malloc(MAX(*nres, 1) * sizeof(RESIDUE)))
+      ==NULL)
+      return(NULL);
+
+   for(start=pdb, i=0; start!=NULL; start=residues[i++].stop)
+   {
+      RESIDUE *r = residues+i;
+      
+      r->start    = start;
+      r->stop     = blFindNextResidue(start);
+      r->resnum   = start->resnum;
+      r->natoms   = 0;
+      r->radius   = (REAL)0.0;
+      r->centre.x = r->centre.y = r->centre.z = (REAL)0.0;
+      
+      for(p=r->start; p!=r->stop; NEXT(p))
+      {
+         r->natoms++;
+         r->centre.x += p->x;
+         r->centre.y += p->y;
+         r->centre.z += p->z;
+      }
+      r->centre.x /= (REAL)r->natoms;
+      r->centre.y /= (REAL)r->natoms;
+      r->centre.z /= (REAL)r->natoms;
+
+      for(p=r->start; p!=r->stop; NEXT(p))
+      {
+         REAL distsq = DISTSQ(p, &(r->centre));
+         if(distsq > r->radius)
+            r->radius = distsq;
+      }
+      r->radius = (REAL)sqrt(r->radius);
+   }
+   
+   return(residues);
+}
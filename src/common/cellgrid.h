@@ -0,0 +1,90 @@
+/************************************************************************/
+/**
+
+   \file       cellgrid.h
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Cell-list grids and residue tables for neighbour searches
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original (moved from pdbatomcount.c, pdbhbond.c, pdbsphere.c
+                  and pdbmakepatch.c)
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_CELLGRID_H
+#define _BIOPTOOLS_CELLGRID_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXCELLSPERITEM 8  /* Grid is coarsened if it would have more
+                              cells than this per item                 */
+
+/* Cell-list grid used for neighbour searches. Items (atoms or residue
+   centres) are sorted by cell such that the items in cell c are
+   cellItems[cellStart[c]] ... cellItems[cellStart[c+1]-1]             */
+typedef struct
+{
+   int  *itemCell,      /* Cell number of each item                     */
+        *cellStart,     /* Offset into cellItems[] for each cell        */
+        *cellItems;     /* Item indexes sorted by cell                  */
+   REAL xmin, ymin, zmin,
+        cellSize;
+   int  nitems,
+        nx, ny, nz;
+}  CELLGRID;
+
+/* Residue table. Residues are indexed in linked list order             */
+typedef struct
+{
+   PDB   *start,        /* First atom in the residue                    */
+         *stop;         /* First atom of the next residue               */
+   VEC3F centre;        /* Centroid of the atoms                        */
+   REAL  radius;        /* Bounding sphere radius about the centroid    */
+   int   resnum,
+         natoms;
+}  RESIDUE;
+
+/************************************************************************/
+/* Prototypes
+*/
+CELLGRID *BuildCellGrid(VEC3F *coords, int nitems, REAL cellSize);
+void FreeCellGrid(CELLGRID *grid);
+RESIDUE *BuildResidueTable(PDB *pdb, int *nres);
+
+#endif
@@ -0,0 +1,177 @@
+/************************************************************************/
+/**
+
+   \file       chainsel.c
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Selecting chains from a PDB linked list
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Removes all but the selected chains from a PDB linked list. Used by
+   pdbgetchain and by the pdbgetchain stage of the bioptools pipeline.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original (moved from pdbgetchain.c)
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "chainsel.h"
+
+/************************************************************************/
+/*>void SelectPDBChains(WHOLEPDB *wpdb, char **chains, BOOL numeric)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in,out]  *wpdb      Whole PDB structure
+   \param[in]      **chains   Chain labels (or numbers) to keep
+   \param[in]      numeric    Chains are given as numbers (1 is the
+                              first chain)
+
+   Unlinks and frees all chains that are not listed
+
+-  04.03.15 Original   By: ACRM
+-  15.10.26 Moved from pdbgetchain.c and now passes the chain number
+            to ValidChain()
+*/
+void SelectPDBChains(WHOLEPDB *wpdb, char **chains, BOOL numeric)
+{
+   PDB  *chainStart    = NULL,
+        *endOfChain    = NULL,
+        *nextChain     = NULL,
+        *keptChainsEnd = NULL;
+   int  chainNum       = 0;
+   
+   for(chainStart=wpdb->pdb; chainStart!=NULL; chainStart=nextChain)
+   {
+      endOfChain       = FindEndOfChain(chainStart);
+      nextChain        = endOfChain->next;
+      endOfChain->next = NULL;
+
+      if(ValidChain(chainStart, chains, numeric, ++chainNum))
+      {
+         if(keptChainsEnd!=NULL)
+            keptChainsEnd->next = chainStart;
+         keptChainsEnd = endOfChain;
+      }
+      else
+      {
+         if(chainStart == wpdb->pdb)
+            wpdb->pdb = nextChain;
+
+         FREELIST(chainStart, PDB);
+      }
+   }
+}
+
+/************************************************************************/
+/*>BOOL ValidChain(PDB *pdb, char **chains, BOOL numeric, int chainNum)
+   --------------------------------------------------------------------
+*//**
+
+   \param[in]      *pdb       Start of a chain
+   \param[in]      **chains   Chain labels (or numbers) to keep
+   \param[in]      numeric    Chains are given as numbers
+   \param[in]      chainNum   Number of this chain (from 1)
+   \return                    Is this chain one of those listed?
+
+-  04.03.15 Original   By: ACRM
+-  15.10.26 Takes the chain number rather than counting the calls in a
+            static
+*/
+BOOL ValidChain(PDB *pdb, char **chains, BOOL numeric, int chainNum)
+{
+   int i;
+
+   if(numeric)
+   {
+      for(i=0; ((chains[i] != NULL) && (chains[i][0] != '\0')); i++)
+      {
+         int numericChain;
+         
+         if(sscanf(chains[i], "%d", &numericChain))
+         {
+            if(chainNum == numericChain)
+               return(TRUE);
+         }
+      }
+   }
+   else
+   {
+      for(i=0; ((chains[i] != NULL) && (chains[i][0] != '\0')); i++)
+      {
+         if(CHAINMATCH(pdb->chain, chains[i]))
+            return(TRUE);
+      }
+   }
+   
+   return(FALSE);
+}
+
+/************************************************************************/
+/*>PDB *FindEndOfChain(PDB *chain)
+   -------------------------------
+*//**
+
+   \param[in]      *chain     Start of a chain
+   \return                    Last atom in the chain
+
+-  04.03.15 Original   By: ACRM
+*/
+PDB *FindEndOfChain(PDB *chain)
+{
+   PDB *p;
+   if(chain==NULL)
+      return(NULL);
+   
+   for(p=chain; 
+       ((p->next !=NULL) && CHAINMATCH(p->chain, p->next->chain));
+       NEXT(p))
+   {
+      continue;
+   }
+   return(p);
+}
@@ -0,0 +1,112 @@
+/************************************************************************/
+/**
+
+   \file       hetstrip.c
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Removing HETATM records from a PDB linked list
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Removes the HETATM records from a PDB linked list. Used by
+   pdbhetstrip and by the pdbhetstrip stage of the bioptools pipeline.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original (moved from multicall/stages.c)
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "hetstrip.h"
+
+/************************************************************************/
+/*>void StripHetAtoms(WHOLEPDB *wpdb)
+   ----------------------------------
+*//**
+
+   \param[in,out]  *wpdb      Whole PDB structure
+
+   Unlinks and frees all HETATM records and updates the atom count.
+   CONECT entries from the remaining atoms to the HETATMs are removed
+   first so no pointers are left to freed atoms.
+
+-  15.10.26 Original   By: ACRM
+*/
+void StripHetAtoms(WHOLEPDB *wpdb)
+{
+   PDB *p,
+       *prev = NULL,
+       *next;
+   int i, j;
+
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      for(i=0, j=0; i<p->nConect; i++)
+      {
+         if(strncmp(p->conect[i]->record_type, "HETATM", 6))
+            p->conect[j++] = p->conect[i];
+      }
+      p->nConect = j;
+   }
+
+   wpdb->natoms = 0;
+   for(p=wpdb->pdb; p!=NULL; p=next)
+   {
+      next = p->next;
+      if(!strncmp(p->record_type, "HETATM", 6))
+      {
+         if(prev == NULL)
+            wpdb->pdb = next;
+         else
+            prev->next = next;
+         free(p);
+      }
+      else
+      {
+         prev = p;
+         wpdb->natoms++;
+      }
+   }
+}
@@ -0,0 +1,55 @@
+/************************************************************************/
+/**
+
+   \file       hetstrip.h
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Removing HETATM records from a PDB linked list
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original (moved from multicall/stages.c)
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_HETSTRIP_H
+#define _BIOPTOOLS_HETSTRIP_H
+
+/************************************************************************/
+/* Includes
+*/
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Prototypes
+*/
+void StripHetAtoms(WHOLEPDB *wpdb);
+
+#endif
@@ -0,0 +1,114 @@
+/************************************************************************/
+/**
+
+   \file       hybrid36.c
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Reading decimal and hybrid-36 atom numbers
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Files with more than 99999 atoms number them in hybrid-36, where
+   'A0000' to 'ZZZZZ' follow 99999 and are followed by 'a0000' to
+   'zzzzz'. Used by the streaming filters (pdbfilter.c) and the mapped
+   PDB reader (mappdb.c).
+
+**************************************************************************
+
+   Usage:
+   ======
+   serial = ReadAtomSerial(field);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original (moved from pdbfilter.c)
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdlib.h>
+#include <ctype.h>
+
+#include "bioplib/SysDefs.h"
+#include "hybrid36.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXSERIAL      99999       /* Largest decimal atom number       */
+#define HY36BASE       1679616     /* 36^4: hybrid-36 'A0000' is 10 *
+                                      this and means MAXSERIAL+1        */
+
+/************************************************************************/
+/*>int ReadAtomSerial(char *field)
+   -------------------------------
+*//**
+
+   \param[in]      *field   Atom number field (columns 7-11 of an ATOM
+                            record) as a string, which may be cut short
+   \return                  The atom number (0 if blank or not valid)
+
+   Reads a decimal or hybrid-36 atom number. A hybrid-36 number must
+   fill all 5 columns with digits and letters of the same case.
+
+-  15.10.26 Original (was ReadSerial() in pdbfilter.c)   By: ACRM
+*/
+int ReadAtomSerial(char *field)
+{
+   int  i,
+        digit,
+        serial = 0;
+   BOOL upper;
+
+   if(!isalpha((int)field[0]))
+      return(atoi(field));
+
+   upper = (BOOL)(isupper((int)field[0]) != 0);
+   for(i=0; i<5; i++)
+   {
+      if(isdigit((int)field[i]))
+         digit = field[i] - '0';
+      else if(upper && isupper((int)field[i]))
+         digit = field[i] - 'A' + 10;
+      else if(!upper && islower((int)field[i]))
+         digit = field[i] - 'a' + 10;
+      else
+         return(0);
+      serial = 36 * serial + digit;
+   }
+
+   serial += MAXSERIAL + 1 - 10 * HY36BASE;
+   if(!upper)
+      serial += 26 * HY36BASE;
+
+   return(serial);
+}
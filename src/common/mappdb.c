@@ -0,0 +1,865 @@
+/************************************************************************/
+/**
+
+   \file       mappdb.c
+
+   \version    V1.6
+   \date       15.10.26
+   \brief      Memory-mapped reading of PDB coordinates
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A replacement for blReadPDB() for programs which only read the
+   coordinates. When the input is a regular file, it is memory-mapped
+   and the fixed columns of the ATOM and HETATM records are parsed
+   straight from the mapped file into a single array of atoms, linked
+   as a normal PDB linked list.
+
+   The mapped reader only handles simple coordinate files. Input which
+   is not a regular file (such as a pipe) or which contains MODEL
+   records, alternate atom positions or PDBML is read with blReadPDB()
+   instead. CONECT records are not read by the mapped reader, so the
+   conect[] arrays are left empty.
+
+   Since the atoms may be held in one array, the list must be freed
+   with FreeMappedPDB() and atoms must not be freed or unlinked
+   individually.
+
+   ReadMappedWholePDB() parses the atoms in the same way but allocates
+   them separately, so it returns a normal WHOLEPDB which is freed with
+   blFreeWholePDB(). The header (the records before the first atom) and
+   the trailer (from the first CONECT, MASTER or END record) are split
+   from the same mapped file and the CONECT records are read into the
+   conect[] arrays. As with blReadWholePDB(), other records among the
+   atoms (such as TER) are not kept.
+
+   Both ReadMappedPDB() and ReadMappedWholePDB() also recognise the
+   binary cache files written by pdb2cache (see pdbcache.c) and unpack
+   them without parsing any text. A file which starts like a cache but
+   was written on a different kind of machine or by a different version,
+   or is corrupt, is reported and not read.
+
+**************************************************************************
+
+   Usage:
+   ======
+   MAPPEDPDB *mpdb;
+   if((mpdb = ReadMappedPDB(fp))!=NULL)
+   {
+      ... use mpdb->pdb and mpdb->natoms ...
+      FreeMappedPDB(mpdb);
+   }
+
+   WHOLEPDB *wpdb;
+   if((wpdb = ReadMappedWholePDB(fp))!=NULL)
+   {
+      ... use wpdb as from blReadWholePDB() ...
+      blFreeWholePDB(wpdb);
+   }
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Added ReadMappedWholePDB() and reading of binary
+                  cache files
+-  V1.2  15.10.26 Fields are blank-padded and the element is set from
+                  the atom name if it is blank, as in blReadPDB()
+-  V1.3  15.10.26 A cache which is empty or cannot be unpacked is not
+                  read as a PDB file
+-  V1.4  15.10.26 Reads hybrid-36 atom numbers
+-  V1.5  15.10.26 ReadMappedWholePDB() parses text files from the
+                  mapping rather than calling blReadWholePDB()
+-  V1.6  15.10.26 A cache which cannot be unpacked is reported rather
+                  than read as text. Restores the number of models
+
+*************************************************************************/
+/* Includes
+*/
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "mappdb.h"
+#include "pdbcache.h"
+#include "hybrid36.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define FIELDBUFF 16
+
+/************************************************************************/
+/* Prototypes
+*/
+static char *MapFile(FILE *fp, size_t *size);
+static BOOL ScanMappedPDB(char *buffer, size_t size, int *natoms);
+static char *NextLine(char *line, char *end, int *len);
+static BOOL IsAtomRecord(char *line, int len);
+static void CopyField(char *dest, char *line, int len, int start,
+                      int width);
+static void ParseAtom(PDB *p, char *line, int len);
+static WHOLEPDB *AllocWholePDB(int natoms, PDB ***atoms);
+static WHOLEPDB *ParseWholePDB(char *buffer, size_t size, int natoms);
+static BOOL IsTrailerRecord(char *line, int len);
+static BOOL StoreLine(STRINGLIST **strings, char *line, int len);
+static void ReadConects(PDB **atoms, int natoms, STRINGLIST *trailer);
+static int CompareAtnum(const void *a, const void *b);
+static void ReportBadCache(void);
+
+/************************************************************************/
+/*>MAPPEDPDB *ReadMappedPDB(FILE *fp)
+   ----------------------------------
+*//**
+
+   \param[in]      *fp     PDB file pointer
+   \return                 The atoms read (NULL if none or out of
+                           memory)
+
+   Reads the atoms from a PDB file. If fp is a regular file at its
+   start, it is memory-mapped and parsed directly, or unpacked if it is
+   a binary cache. Otherwise, or if the file contains anything the
+   mapped reader does not handle, it is read with blReadPDB(). A cache
+   with no atoms, or which cannot be unpacked, gives NULL rather than
+   being read as text.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Reads binary cache files
+-  15.10.26 Does not read a cache as text if it cannot be unpacked
+-  15.10.26 Reports a cache which cannot be unpacked
+*/
+MAPPEDPDB *ReadMappedPDB(FILE *fp)
+{
+   MAPPEDPDB   *mpdb;
+   size_t      size;
+   char        *buffer,
+               *line,
+               *end;
+   int         natoms = 0,
+               len,
+               i;
+   BOOL        cached = FALSE;
+
+   if((mpdb = (MAPPEDPDB *)malloc(sizeof(MAPPEDPDB)))==NULL)
+      return(NULL);
+   mpdb->pdb    = NULL;
+   mpdb->atoms  = NULL;
+   mpdb->natoms = 0;
+
+   if((buffer = MapFile(fp, &size))!=NULL)
+   {
+      end = buffer + size;
+
+      if(HasCacheMagic(buffer, size))
+      {
+         /* A binary cache - unpack it into the array. It must not be
+            read as text if it is empty, cannot be unpacked or we run
+            out of memory
+         */
+         PDB **atoms;
+
+         cached = TRUE;
+         if((natoms = CachedAtomCount(buffer, size)) < 0)
+            ReportBadCache();
+         else if((natoms > 0) &&
+                 ((mpdb->atoms = (PDB *)malloc(natoms * sizeof(PDB)))
+                  !=NULL))
+         {
+            if((atoms = (PDB **)malloc(natoms * sizeof(PDB *)))!=NULL)
+            {
+               for(i=0; i<natoms; i++)
+                  atoms[i] = mpdb->atoms + i;
+               UnpackPDBCache(buffer, atoms);
+               free(atoms);
+
+               mpdb->pdb    = mpdb->atoms;
+               mpdb->natoms = natoms;
+            }
+            else
+            {
+               free(mpdb->atoms);
+               mpdb->atoms = NULL;
+            }
+         }
+      }
+      /* Count the atoms and check the file is one we can handle        */
+      else if(ScanMappedPDB(buffer, size, &natoms) &&
+              (natoms > 0) &&
+              ((mpdb->atoms = (PDB *)malloc(natoms * sizeof(PDB)))!=NULL))
+      {
+         for(line=buffer, i=0; line<end; )
+         {
+            char *thisLine = line;
+            line = NextLine(line, end, &len);
+            if(IsAtomRecord(thisLine, len))
+            {
+               ParseAtom(mpdb->atoms + i, thisLine, len);
+               mpdb->atoms[i].next = (i < natoms-1) ?
+                                     mpdb->atoms + i + 1 : NULL;
+               i++;
+            }
+         }
+
+         mpdb->pdb    = mpdb->atoms;
+         mpdb->natoms = natoms;
+      }
+      munmap(buffer, size);
+   }
+
+   /* Fall back to BiopLib                                              */
+   if((mpdb->pdb == NULL) && !cached)
+      mpdb->pdb = blReadPDB(fp, &(mpdb->natoms));
+
+   if(mpdb->pdb == NULL)
+   {
+      free(mpdb);
+      return(NULL);
+   }
+
+   return(mpdb);
+}
+
+/************************************************************************/
+/*>WHOLEPDB *ReadMappedWholePDB(FILE *fp)
+   --------------------------------------
+*//**
+
+   \param[in]      *fp     PDB file pointer
+   \return                 Whole PDB structure (NULL if none or out of
+                           memory)
+
+   A replacement for blReadWholePDB(). If fp is a regular file at its
+   start, it is memory-mapped and parsed directly, or unpacked if it is
+   a binary cache, into a normal WHOLEPDB structure. Otherwise, or if
+   the file contains anything the mapped reader does not handle, it is
+   read with blReadWholePDB(). A cache with no atoms, or which cannot
+   be unpacked, gives NULL.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Returns NULL for a cache with no atoms
+-  15.10.26 Parses text files from the mapping
+-  15.10.26 Reports a cache which cannot be unpacked. Restores the
+            number of models
+*/
+WHOLEPDB *ReadMappedWholePDB(FILE *fp)
+{
+   WHOLEPDB *wpdb = NULL;
+   PDB      **atoms;
+   size_t   size;
+   char     *buffer;
+   int      natoms;
+
+   if((buffer = MapFile(fp, &size))==NULL)
+      return(blReadWholePDB(fp));
+
+   if(HasCacheMagic(buffer, size))
+   {
+      /* A binary cache. It must not be read as text if it is empty,
+         cannot be unpacked or we run out of memory
+      */
+      if((natoms = CachedAtomCount(buffer, size)) < 0)
+      {
+         ReportBadCache();
+      }
+      else if((natoms > 0) &&
+              ((wpdb = AllocWholePDB(natoms, &atoms))!=NULL))
+      {
+         UnpackPDBCache(buffer, atoms);
+         free(atoms);
+
+         wpdb->numModels = CachedModelCount(buffer);
+         wpdb->header    = UnpackCachedText(buffer, FALSE);
+         wpdb->trailer   = UnpackCachedText(buffer, TRUE);
+      }
+      munmap(buffer, size);
+      return(wpdb);
+   }
+
+   /* Count the atoms and check the file is one we can handle           */
+   if(ScanMappedPDB(buffer, size, &natoms) && (natoms > 0))
+      wpdb = ParseWholePDB(buffer, size, natoms);
+   munmap(buffer, size);
+
+   /* Fall back to BiopLib                                              */
+   if(wpdb == NULL)
+      wpdb = blReadWholePDB(fp);
+
+   return(wpdb);
+}
+
+/************************************************************************/
+/*>void FreeMappedPDB(MAPPEDPDB *mpdb)
+   -----------------------------------
+*//**
+
+   \param[in]      *mpdb   Atoms from ReadMappedPDB()
+
+   Frees the atoms read by ReadMappedPDB()
+
+-  15.10.26 Original   By: ACRM
+*/
+void FreeMappedPDB(MAPPEDPDB *mpdb)
+{
+   if(mpdb != NULL)
+   {
+      if(mpdb->atoms != NULL)
+      {
+         free(mpdb->atoms);
+      }
+      else if(mpdb->pdb != NULL)
+      {
+         FREELIST(mpdb->pdb, PDB);
+      }
+      free(mpdb);
+   }
+}
+
+/************************************************************************/
+/*>static char *MapFile(FILE *fp, size_t *size)
+   --------------------------------------------
+*//**
+
+   \param[in]      *fp      File pointer
+   \param[out]     *size    Size of the file
+   \return                  Mapped file (NULL if fp is not a regular
+                            file at its start or cannot be mapped)
+
+   Memory-maps a file. The file position is not changed so the file
+   can still be read normally if the mapping is not used.
+
+-  15.10.26 Original   By: ACRM
+*/
+static char *MapFile(FILE *fp, size_t *size)
+{
+   struct stat st;
+   char        *buffer;
+   int         fd;
+
+   fd = fileno(fp);
+   if((ftell(fp) != 0L) || fstat(fd, &st) || !S_ISREG(st.st_mode) ||
+      (st.st_size <= 0))
+      return(NULL);
+
+   *size  = (size_t)st.st_size;
+   buffer = (char *)mmap(NULL, *size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+   return((buffer == (char *)MAP_FAILED) ? NULL : buffer);
+}
+
+/************************************************************************/
+/*>static BOOL ScanMappedPDB(char *buffer, size_t size, int *natoms)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *buffer  Mapped file
+   \param[in]      size     Size of the file
+   \param[out]     *natoms  Number of ATOM and HETATM records
+   \return                  Can the file be read by the mapped reader?
+
+   Counts the coordinate records and checks that there are no MODEL
+   records or alternate atom positions and that the file is not PDBML.
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL ScanMappedPDB(char *buffer, size_t size, int *natoms)
+{
+   char *line,
+        *end = buffer + size;
+   int  len;
+
+   *natoms = 0;
+
+   /* PDBML starts with an XML tag                                      */
+   for(line=buffer; (line<end) && ((*line==' ') || (*line=='\n') ||
+                                   (*line=='\r') || (*line=='\t'));
+       line++);
+   if((line<end) && (*line == '<'))
+      return(FALSE);
+
+   for(line=buffer; line<end; )
+   {
+      char *thisLine = line;
+      line = NextLine(line, end, &len);
+
+      if(IsAtomRecord(thisLine, len))
+      {
+         /* Alternate position in column 17                             */
+         if((len > 16) && (thisLine[16] != ' '))
+            return(FALSE);
+         (*natoms)++;
+      }
+      else if((len >= 5) && !strncmp(thisLine, "MODEL", 5))
+      {
+         return(FALSE);
+      }
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static char *NextLine(char *line, char *end, int *len)
+   ------------------------------------------------------
+*//**
+
+   \param[in]      *line    Start of a line in the mapped file
+   \param[in]      *end     End of the mapped file
+   \param[out]     *len     Length of the line without the line end
+   \return                  Start of the next line
+
+   Finds the length of a line and the start of the next
+
+-  15.10.26 Original   By: ACRM
+*/
+static char *NextLine(char *line, char *end, int *len)
+{
+   char *eol;
+
+   if((eol = (char *)memchr(line, '\n', end - line))==NULL)
+      eol = end;
+
+   *len = (int)(eol - line);
+   if((*len > 0) && (line[*len - 1] == '\r'))
+      (*len)--;
+
+   return((eol < end) ? eol + 1 : end);
+}
+
+/************************************************************************/
+/*>static BOOL IsAtomRecord(char *line, int len)
+   ---------------------------------------------
+*//**
+
+   \param[in]      *line    Line in the mapped file
+   \param[in]      len      Length of the line
+   \return                  Is it an ATOM or HETATM record?
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL IsAtomRecord(char *line, int len)
+{
+   return((len >= 6) && (!strncmp(line, "ATOM  ", 6) ||
+                         !strncmp(line, "HETATM", 6)));
+}
+
+/************************************************************************/
+/*>static void CopyField(char *dest, char *line, int len, int start,
+                         int width)
+   -----------------------------------------------------------------
+*//**
+
+   \param[out]     *dest    The field as a string
+   \param[in]      *line    Line in the mapped file
+   \param[in]      len      Length of the line
+   \param[in]      start    Offset of the field in the line
+   \param[in]      width    Width of the field
+
+   Copies a fixed-width field. If the line ends within the field, the
+   rest of the field is padded with spaces as if the line had been
+   padded to full length.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Pads with spaces rather than truncating
+*/
+static void CopyField(char *dest, char *line, int len, int start,
+                      int width)
+{
+   int n = MIN(width, len - start);
+
+   if(n < 0)
+      n = 0;
+   memcpy(dest, line + start, n);
+   for(; n<width; n++)
+      dest[n] = ' ';
+   dest[width] = '\0';
+}
+
+/************************************************************************/
+/*>static void ParseAtom(PDB *p, char *line, int len)
+   --------------------------------------------------
+*//**
+
+   \param[out]     *p       PDB record
+   \param[in]      *line    ATOM or HETATM record in the mapped file
+   \param[in]      len      Length of the line
+
+   Fills in a PDB record from the fixed columns of an ATOM or HETATM
+   record in the same way as blReadPDB(). Short lines are treated as
+   blank-padded, so a missing insert code or chain is " ". If the 
+   element columns are blank, the element is set from the atom name.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Blank-pads short lines and sets a blank element from the
+            atom name
+-  15.10.26 Reads hybrid-36 atom numbers
+*/
+static void ParseAtom(PDB *p, char *line, int len)
+{
+   char field[FIELDBUFF],
+        atnambuff[8],
+        *atnam,
+        *chp;
+
+   CLEAR_PDB(p);
+
+   CopyField(p->record_type, line, len,  0, 6);
+   CopyField(field,          line, len,  6, 5);
+   p->atnum  = ReadAtomSerial(field);
+   CopyField(atnambuff,      line, len, 12, 5);
+   CopyField(p->resnam,      line, len, 17, 4);
+   CopyField(p->chain,       line, len, 21, 1);
+   CopyField(field,          line, len, 22, 4);
+   p->resnum = atoi(field);
+   CopyField(p->insert,      line, len, 26, 1);
+   CopyField(field,          line, len, 30, 8);
+   p->x      = (REAL)atof(field);
+   CopyField(field,          line, len, 38, 8);
+   p->y      = (REAL)atof(field);
+   CopyField(field,          line, len, 46, 8);
+   p->z      = (REAL)atof(field);
+   CopyField(field,          line, len, 54, 6);
+   p->occ    = (REAL)atof(field);
+   CopyField(field,          line, len, 60, 6);
+   p->bval   = (REAL)atof(field);
+   CopyField(p->segid,       line, len, 72, 4);
+
+   /* Element, skipping leading spaces. Set from the atom name if it is
+      blank
+   */
+   CopyField(field,          line, len, 76, 2);
+   for(chp=field; *chp==' '; chp++);
+   strcpy(p->element, chp);
+   if(p->element[0] == '\0')
+      blSetElementSymbolFromAtomName(p->element, atnambuff);
+
+   /* Formal charge is given as 2+, 1- etc.                             */
+   CopyField(field,          line, len, 78, 2);
+   p->formal_charge = atoi(field);
+   if(strchr(field, '-') != NULL)
+      p->formal_charge = -p->formal_charge;
+
+   /* Atom name as it appears in the file and fixed so that it starts
+      in column 13
+   */
+   strncpy(p->atnam_raw, atnambuff, 4);
+   p->atnam_raw[4] = '\0';
+   p->altpos       = ' ';     /* Files with altpos are not mapped       */
+   atnam    = blFixAtomName(atnambuff, p->occ);
+   atnam[4] = '\0';
+   strcpy(p->atnam, atnam);
+}
+
+/************************************************************************/
+/*>static WHOLEPDB *AllocWholePDB(int natoms, PDB ***atoms)
+   --------------------------------------------------------
+*//**
+
+   \param[in]      natoms   Number of atoms
+   \param[out]     *atoms   Array of pointers to the atoms, to be freed
+                            by the caller
+   \return                  Empty WHOLEPDB structure (NULL if out of
+                            memory)
+
+   Allocates a WHOLEPDB structure and its atoms. The atoms are
+   allocated separately so that the list can be freed and edited as
+   normal. The atoms are linked in order by whoever fills them in.
+
+-  15.10.26 Original (split from ReadMappedWholePDB())   By: ACRM
+*/
+static WHOLEPDB *AllocWholePDB(int natoms, PDB ***atoms)
+{
+   WHOLEPDB *wpdb;
+   int      i;
+
+   if((wpdb = (WHOLEPDB *)malloc(sizeof(WHOLEPDB)))==NULL)
+      return(NULL);
+   memset(wpdb, 0, sizeof(WHOLEPDB));
+
+   if((*atoms = (PDB **)malloc(natoms * sizeof(PDB *)))==NULL)
+   {
+      free(wpdb);
+      return(NULL);
+   }
+
+   for(i=0; i<natoms; i++)
+   {
+      if(((*atoms)[i] = (PDB *)malloc(sizeof(PDB)))==NULL)
+      {
+         while(i--)
+            free((*atoms)[i]);
+         free(*atoms);
+         free(wpdb);
+         return(NULL);
+      }
+   }
+
+   wpdb->pdb    = (*atoms)[0];
+   wpdb->natoms = natoms;
+   return(wpdb);
+}
+
+/************************************************************************/
+/*>static WHOLEPDB *ParseWholePDB(char *buffer, size_t size, int natoms)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]      *buffer  Mapped file (checked with ScanMappedPDB())
+   \param[in]      size     Size of the file
+   \param[in]      natoms   Number of ATOM and HETATM records
+   \return                  Whole PDB structure (NULL if out of memory)
+
+   Parses the atoms, header and trailer from a mapped PDB file
+
+-  15.10.26 Original   By: ACRM
+*/
+static WHOLEPDB *ParseWholePDB(char *buffer, size_t size, int natoms)
+{
+   WHOLEPDB *wpdb;
+   PDB      **atoms;
+   char     *line,
+            *end = buffer + size;
+   int      len,
+            i;
+   BOOL     ok        = TRUE,
+            inTrailer = FALSE;
+
+   if((wpdb = AllocWholePDB(natoms, &atoms))==NULL)
+      return(NULL);
+   wpdb->numModels = 1;
+
+   for(line=buffer, i=0; ok && (line<end); )
+   {
+      char *thisLine = line;
+      line = NextLine(line, end, &len);
+
+      if(IsAtomRecord(thisLine, len))
+      {
+         ParseAtom(atoms[i], thisLine, len);
+         atoms[i]->next = (i < natoms-1) ? atoms[i+1] : NULL;
+         i++;
+      }
+      else if(i == 0)
+      {
+         ok = StoreLine(&(wpdb->header), thisLine,
+                        (int)(line - thisLine));
+      }
+      else if(inTrailer || IsTrailerRecord(thisLine, len))
+      {
+         inTrailer = TRUE;
+         ok = StoreLine(&(wpdb->trailer), thisLine,
+                        (int)(line - thisLine));
+      }
+   }
+
+   if(!ok)
+   {
+      /* Link whatever atoms were parsed so the structure can be freed */
+      while(i < natoms)
+      {
+         CLEAR_PDB(atoms[i]);
+         atoms[i]->next = (i < natoms-1) ? atoms[i+1] : NULL;
+         i++;
+      }
+      free(atoms);
+      blFreeWholePDB(wpdb);
+      return(NULL);
+   }
+
+   ReadConects(atoms, natoms, wpdb->trailer);
+   free(atoms);
+
+   return(wpdb);
+}
+
+/************************************************************************/
+/*>static BOOL IsTrailerRecord(char *line, int len)
+   ------------------------------------------------
+*//**
+
+   \param[in]      *line    Line in the mapped file
+   \param[in]      len      Length of the line
+   \return                  Does the line start the trailer?
+
+   The trailer starts at the first CONECT, MASTER or END record after
+   the atoms, as in blReadWholePDB()
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL IsTrailerRecord(char *line, int len)
+{
+   return((BOOL)(((len >= 6) && (!strncmp(line, "CONECT", 6) ||
+                                 !strncmp(line, "MASTER", 6))) ||
+                 ((len >= 3) && !strncmp(line, "END", 3) &&
+                  ((len == 3) || (line[3] == ' ')))));
+}
+
+/************************************************************************/
+/*>static BOOL StoreLine(STRINGLIST **strings, char *line, int len)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in,out]  **strings  Header or trailer records
+   \param[in]      *line      Line in the mapped file
+   \param[in]      len        Length of the line including its newline
+   \return                    Success
+
+   Adds a line to the header or trailer. The line keeps its newline as
+   in blReadWholePDB().
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL StoreLine(STRINGLIST **strings, char *line, int len)
+{
+   STRINGLIST *stored;
+   char       *copy;
+
+   if((copy = (char *)malloc(len + 1))==NULL)
+      return(FALSE);
+   strncpy(copy, line, len);
+   copy[len] = '\0';
+   stored = blStoreString(*strings, copy);
+   free(copy);
+
+   if(stored == NULL)
+      return(FALSE);
+   *strings = stored;
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static void ReadConects(PDB **atoms, int natoms, STRINGLIST *trailer)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in,out]  **atoms   Array of pointers to the atoms. Sorted by
+                             atom number on return
+   \param[in]      natoms    Number of atoms
+   \param[in]      *trailer  Trailer records
+
+   Fills in the conect[] arrays from the CONECT records. Each record
+   adds bonds from its first atom only, since a file lists each bond
+   from both ends. Atoms which are not found and bonds beyond
+   MAXCONECT are ignored.
+
+-  15.10.26 Original   By: ACRM
+*/
+static void ReadConects(PDB **atoms, int natoms, STRINGLIST *trailer)
+{
+   STRINGLIST *s;
+   PDB        key,
+              *pKey = &key,
+              **found,
+              *p;
+   char       field[FIELDBUFF];
+   int        len,
+              i,
+              j;
+
+   qsort(atoms, natoms, sizeof(PDB *), CompareAtnum);
+
+   for(s=trailer; s!=NULL; s=s->next)
+   {
+      if(strncmp(s->string, "CONECT", 6))
+         continue;
+      len = strlen(s->string);
+
+      CopyField(field, s->string, len, 6, 5);
+      key.atnum = ReadAtomSerial(field);
+      if((found = (PDB **)bsearch(&pKey, atoms, natoms, sizeof(PDB *),
+                                  CompareAtnum))==NULL)
+         continue;
+      p = *found;
+
+      for(i=11; i<=26; i+=5)
+      {
+         CopyField(field, s->string, len, i, 5);
+         if((key.atnum = ReadAtomSerial(field)) == 0)
+            continue;
+         if((found = (PDB **)bsearch(&pKey, atoms, natoms,
+                                     sizeof(PDB *), CompareAtnum))==NULL)
+            continue;
+
+         for(j=0; j<p->nConect; j++)
+         {
+            if(p->conect[j] == *found)
+               break;
+         }
+         if((j == p->nConect) && (p->nConect < MAXCONECT))
+            p->conect[p->nConect++] = *found;
+      }
+   }
+}
+
+/************************************************************************/
+/*>static int CompareAtnum(const void *a, const void *b)
+   ----------------------------------------------------
+*//**
+
+   \param[in]      *a       Pointer to an atom pointer
+   \param[in]      *b       Pointer to an atom pointer
+   \return                  Comparison of the atom numbers for qsort()
+                            and bsearch()
+
+-  15.10.26 Original   By: ACRM
+*/
+static int CompareAtnum(const void *a, const void *b)
+{
+   int atnumA = (*(PDB **)a)->atnum,
+       atnumB = (*(PDB **)b)->atnum;
+
+   return((atnumA < atnumB) ? -1 : ((atnumA > atnumB) ? 1 : 0));
+}
+
+/************************************************************************/
+/*>static void ReportBadCache(void)
+   --------------------------------
+*//**
+
+   Reports a file which starts like a binary cache but cannot be
+   unpacked
+
+-  15.10.26 Original   By: ACRM
+*/
+static void ReportBadCache(void)
+{
+   fprintf(stderr,"Error: Binary cache file is corrupt or was written \
+on a different kind of\n");
+   fprintf(stderr,"       machine or by a different version. Rewrite \
+it with pdb2cache\n");
+}
@@ -0,0 +1,70 @@
+/************************************************************************/
+/**
+
+   \file       mappdb.h
+
+   \version    V1.1
+   \date       15.10.26
+   \brief      Memory-mapped reading of PDB coordinates
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Added ReadMappedWholePDB()
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_MAPPDB_H
+#define _BIOPTOOLS_MAPPDB_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+typedef struct
+{
+   PDB  *pdb,        /* Linked list of atoms                            */
+        *atoms;      /* Array holding the atoms or NULL if the list was
+                        read by blReadPDB()                             */
+   int  natoms;      /* Number of atoms                                 */
+}  MAPPEDPDB;
+
+/************************************************************************/
+/* Prototypes
+*/
+MAPPEDPDB *ReadMappedPDB(FILE *fp);
+WHOLEPDB *ReadMappedWholePDB(FILE *fp);
+void FreeMappedPDB(MAPPEDPDB *mpdb);
+
+#endif
@@ -0,0 +1,896 @@
+/************************************************************************/
+/**
+
+   \file       pdbcache.c
+
+   \version    V1.2
+   \date       15.10.26
+   \brief      Binary cache format for PDB structures
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Writes and unpacks a binary image of a WHOLEPDB structure so that
+   structures which are read many times need only be parsed once.
+   Coordinates, occupancies and B-values are stored as separate arrays,
+   residue and chain tables index the atoms, atom, residue and chain
+   names are stored once in a name table and the header and trailer
+   records are stored as raw text. The layout is described in
+   pdbcache.h.
+
+   The file is in native byte order and REAL size. Cache files are
+   written by pdb2cache and read transparently by ReadMappedPDB() and
+   ReadMappedWholePDB(). Every count and index in a cache is checked
+   against the header before it is used. A cache written on a different
+   kind of machine or by a different version, or which is truncated or
+   corrupt, is not unpacked. Since it still starts with the cache magic
+   number (HasCacheMagic()) it is rejected rather than read as a PDB
+   file.
+
+   Programs which read PDB files with BiopLib call IsPDBCache() first so
+   that they report a cache file as an error rather than trying to read
+   it as text.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Checks all indices in a cache before it is used.
+                  The name table grows rather than being limited to
+                  2048 names
+-  V1.2  15.10.26 Stores the number of models. Added IsPDBCache(),
+                  HasCacheMagic() and CachedModelCount()
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "bioplib/general.h"
+#include "pdbcache.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define NAMEHASHSIZE 4096     /* Initial size; must be a power of 2     */
+
+/* Names interned while writing a cache                                 */
+typedef struct
+{
+   char (*names)[CACHE_NAMELEN];
+   int  *hash,
+        hashSize,
+        nnames,
+        maxnames;
+}  NAMETABLE;
+
+/* Pointers to the sections of a cache                                  */
+typedef struct
+{
+   CACHEHEADER *header;
+   REAL        *x, *y, *z, *occ, *bval;
+   CACHEATOM   *atoms;
+   CACHERES    *residues;
+   CACHECHAIN  *chains;
+   char        (*names)[CACHE_NAMELEN];
+   int         *conect;
+   char        *headerText,
+               *trailerText;
+}  CACHESECTIONS;
+
+/* Used to find the index of an atom from a CONECT pointer              */
+typedef struct
+{
+   PDB *atom;
+   int index;
+}  ATOMINDEX;
+
+/* Copies a name from the name table into a PDB field                   */
+#define COPYNAME(field, names, i)                                        \
+   do {                                                                  \
+      strncpy((field), (names)[(i)], sizeof(field) - 1);                 \
+      (field)[sizeof(field) - 1] = '\0';                                 \
+   }  while(0)
+
+/* Is an index from a cache in the range 0..n-1?                        */
+#define INRANGE(i, n) (((i) >= 0) && ((i) < (n)))
+
+/************************************************************************/
+/* Prototypes
+*/
+static int InternName(NAMETABLE *table, char *name);
+static BOOL GrowNameHash(NAMETABLE *table);
+static unsigned long HashName(char *name, int hashSize);
+static size_t CacheSize(CACHEHEADER *header);
+static BOOL CheckCacheIndices(char *buffer);
+static void FindSections(char *buffer, CACHESECTIONS *sec);
+static int CompareAtomIndex(const void *a, const void *b);
+static int TextLength(STRINGLIST *strings);
+static BOOL WriteText(FILE *fp, STRINGLIST *strings);
+
+/************************************************************************/
+/*>BOOL WritePDBCache(FILE *fp, WHOLEPDB *wpdb)
+   --------------------------------------------
+*//**
+
+   \param[in]      *fp      Output file
+   \param[in]      *wpdb    Whole PDB structure
+   \return                  Success (FALSE if out of memory or the
+                            write failed)
+
+   Writes a whole PDB structure as a binary cache
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Stores the number of models
+*/
+BOOL WritePDBCache(FILE *fp, WHOLEPDB *wpdb)
+{
+   CACHEHEADER header;
+   NAMETABLE   table;
+   PDB         *p,
+               **atoms    = NULL;
+   REAL        *coords    = NULL;
+   CACHEATOM   *catoms    = NULL;
+   CACHERES    *residues  = NULL;
+   CACHECHAIN  *chains    = NULL;
+   ATOMINDEX   *index     = NULL;
+   int         *conect    = NULL,
+               natoms     = 0,
+               nres       = 0,
+               nchains    = 0,
+               nconect    = 0,
+               i, j;
+   BOOL        ok         = FALSE;
+
+   for(p=wpdb->pdb; p!=NULL; NEXT(p))
+   {
+      natoms++;
+      nconect += p->nConect;
+   }
+
+   table.nnames   = 0;
+   table.maxnames = 0;
+   table.hashSize = NAMEHASHSIZE;
+   table.names    = NULL;
+   table.hash     = NULL;
+
+   /* Allocate everything we need. conect always has room for one pair
+      so that malloc(0) is never called
+   */
+   if(((atoms    = (PDB **)malloc(natoms * sizeof(PDB *)))==NULL) ||
+      ((coords   = (REAL *)malloc(5 * natoms * sizeof(REAL)))==NULL) ||
+      ((catoms   = (CACHEATOM *)malloc(natoms * sizeof(CACHEATOM)))
+       ==NULL) ||
+      ((residues = (CACHERES *)malloc(natoms * sizeof(CACHERES)))
+       ==NULL) ||
+      ((chains   = (CACHECHAIN *)malloc(natoms * sizeof(CACHECHAIN)))
+       ==NULL) ||
+      ((index    = (ATOMINDEX *)malloc(natoms * sizeof(ATOMINDEX)))
+       ==NULL) ||
+      ((conect   = (int *)malloc((2 * nconect + 2) * sizeof(int)))
+       ==NULL) ||
+      ((table.hash = (int *)malloc(NAMEHASHSIZE * sizeof(int)))==NULL))
+      goto cleanup;
+
+   for(i=0; i<NAMEHASHSIZE; i++)
+      table.hash[i] = (-1);
+
+   /* Build the arrays of atom data and the residue and chain tables    */
+   for(p=wpdb->pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      atoms[i]              = p;
+      index[i].atom         = p;
+      index[i].index        = i;
+      coords[i]             = p->x;
+      coords[natoms+i]      = p->y;
+      coords[2*natoms+i]    = p->z;
+      coords[3*natoms+i]    = p->occ;
+      coords[4*natoms+i]    = p->bval;
+
+      if(((catoms[i].recordType = InternName(&table, p->record_type))<0)||
+         ((catoms[i].atnam      = InternName(&table, p->atnam))<0)      ||
+         ((catoms[i].atnamRaw   = InternName(&table, p->atnam_raw))<0)  ||
+         ((catoms[i].element    = InternName(&table, p->element))<0)    ||
+         ((catoms[i].segid      = InternName(&table, p->segid))<0))
+         goto cleanup;
+      catoms[i].atnum        = p->atnum;
+      catoms[i].formalCharge = p->formal_charge;
+      catoms[i].altpos       = p->altpos;
+      catoms[i].pad[0] = catoms[i].pad[1] = catoms[i].pad[2] = '\0';
+
+      if((i == 0) || !CHAINMATCH(p->chain, atoms[i-1]->chain))
+      {
+         chains[nchains].firstRes = nres;
+         if((chains[nchains].chain = InternName(&table, p->chain)) < 0)
+            goto cleanup;
+         nchains++;
+      }
+
+      if((i == 0) || (chains[nchains-1].firstRes == nres) ||
+         (p->resnum != atoms[i-1]->resnum) ||
+         strcmp(p->insert, atoms[i-1]->insert) ||
+         strcmp(p->resnam, atoms[i-1]->resnam))
+      {
+         residues[nres].firstAtom = i;
+         residues[nres].resnum    = p->resnum;
+         if(((residues[nres].resnam = InternName(&table, p->resnam))<0) ||
+            ((residues[nres].insert = InternName(&table, p->insert))<0))
+            goto cleanup;
+         nres++;
+      }
+   }
+
+   /* Convert CONECT pointers to pairs of atom indices                  */
+   qsort(index, natoms, sizeof(ATOMINDEX), CompareAtomIndex);
+   for(i=0, nconect=0; i<natoms; i++)
+   {
+      for(j=0; j<atoms[i]->nConect; j++)
+      {
+         ATOMINDEX key,
+                   *found;
+         key.atom = atoms[i]->conect[j];
+         if((found = (ATOMINDEX *)bsearch(&key, index, natoms,
+                                          sizeof(ATOMINDEX),
+                                          CompareAtomIndex))!=NULL)
+         {
+            conect[2*nconect]   = i;
+            conect[2*nconect+1] = found->index;
+            nconect++;
+         }
+      }
+   }
+
+   memset(&header, 0, sizeof(CACHEHEADER));
+   memcpy(header.magic, CACHE_MAGIC, 8);
+   header.order      = CACHE_ORDER;
+   header.version    = CACHE_VERSION;
+   header.realSize   = (int)sizeof(REAL);
+   header.natoms     = natoms;
+   header.nres       = nres;
+   header.nchains    = nchains;
+   header.nnames     = table.nnames;
+   header.nconect    = nconect;
+   header.headerLen  = TextLength(wpdb->header);
+   header.trailerLen = TextLength(wpdb->trailer);
+   header.numModels  = wpdb->numModels;
+
+   ok = (BOOL)
+      ((fwrite(&header, sizeof(CACHEHEADER), 1, fp) == 1) &&
+       (fwrite(coords, sizeof(REAL), 5*natoms, fp) == (size_t)(5*natoms))&&
+       (fwrite(catoms, sizeof(CACHEATOM), natoms, fp) == (size_t)natoms) &&
+       (fwrite(residues, sizeof(CACHERES), nres, fp) == (size_t)nres)    &&
+       (fwrite(chains, sizeof(CACHECHAIN), nchains, fp) ==
+        (size_t)nchains) &&
+       (fwrite(table.names, CACHE_NAMELEN, table.nnames, fp) ==
+        (size_t)table.nnames) &&
+       (fwrite(conect, 2*sizeof(int), nconect, fp) == (size_t)nconect) &&
+       WriteText(fp, wpdb->header) &&
+       WriteText(fp, wpdb->trailer));
+
+cleanup:
+   free(atoms);
+   free(coords);
+   free(catoms);
+   free(residues);
+   free(chains);
+   free(index);
+   free(conect);
+   free(table.hash);
+   free(table.names);
+
+   return(ok);
+}
+
+/************************************************************************/
+/*>int CachedAtomCount(char *buffer, size_t size)
+   ----------------------------------------------
+*//**
+
+   \param[in]      *buffer  Contents of a file
+   \param[in]      size     Size of the file
+   \return                  Number of atoms if this is a valid binary
+                            cache that can be read on this machine, -1
+                            otherwise
+
+   Checks whether a file is a binary cache. The sizes of the sections
+   and every index into them are checked, so a truncated or corrupt
+   cache gives -1.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Checks the indices with CheckCacheIndices()
+-  15.10.26 Checks the number of models
+*/
+int CachedAtomCount(char *buffer, size_t size)
+{
+   CACHEHEADER header;
+
+   if(size < sizeof(CACHEHEADER))
+      return(-1);
+
+   /* The buffer may not be aligned if it is not from mmap()            */
+   memcpy(&header, buffer, sizeof(CACHEHEADER));
+   if(!HasCacheMagic(buffer, size)           ||
+      (header.order    != CACHE_ORDER)      ||
+      (header.version  != CACHE_VERSION)    ||
+      (header.realSize != (int)sizeof(REAL)) ||
+      (header.numModels < 0)                 ||
+      (CacheSize(&header) > size) ||
+      !CheckCacheIndices(buffer))
+      return(-1);
+
+   return(header.natoms);
+}
+
+/************************************************************************/
+/*>int CachedModelCount(char *buffer)
+   ----------------------------------
+*//**
+
+   \param[in]      *buffer  Mapped binary cache (checked with
+                            CachedAtomCount())
+   \return                  Number of models in the WHOLEPDB structure
+                            which was cached
+
+-  15.10.26 Original   By: ACRM
+*/
+int CachedModelCount(char *buffer)
+{
+   CACHEHEADER header;
+
+   memcpy(&header, buffer, sizeof(CACHEHEADER));
+   return(header.numModels);
+}
+
+/************************************************************************/
+/*>BOOL HasCacheMagic(char *buffer, size_t size)
+   ---------------------------------------------
+*//**
+
+   \param[in]      *buffer  Start of a file
+   \param[in]      size     Number of bytes in buffer
+   \return                  Does the file start like a binary cache?
+
+   Checks only the magic number, so this is also TRUE for a cache
+   which cannot be unpacked by CachedAtomCount() and UnpackPDBCache().
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL HasCacheMagic(char *buffer, size_t size)
+{
+   return((BOOL)((size >= 8) && !strncmp(buffer, CACHE_MAGIC, 8)));
+}
+
+/************************************************************************/
+/*>BOOL IsPDBCache(FILE *fp, char *progname)
+   -----------------------------------------
+*//**
+
+   \param[in]      *fp        File about to be read as a PDB file
+   \param[in]      *progname  Program name for the error message
+   \return                    Is the file a binary cache?
+
+   Checks whether a file is a binary cache before it is read with
+   BiopLib and, if so, reports that it must be converted with
+   cache2pdb. The file must be at its start and able to seek back there
+   (as a file or stdin redirected from a file is) to be checked, so a
+   cache sent through a pipe is not found. The file position is not
+   changed.
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL IsPDBCache(FILE *fp, char *progname)
+{
+   char   magic[8];
+   size_t nread;
+
+   if(ftell(fp) != 0L)
+      return(FALSE);
+
+   nread = fread(magic, 1, 8, fp);
+   if(fseek(fp, 0L, SEEK_SET))
+      return(FALSE);
+
+   if(!HasCacheMagic(magic, nread))
+      return(FALSE);
+
+   fprintf(stderr,"Error (%s): Input is a binary cache file. Use \
+cache2pdb to convert it to PDB format\n", progname);
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>void UnpackPDBCache(char *buffer, PDB **atoms)
+   ----------------------------------------------
+*//**
+
+   \param[in]      *buffer  Mapped binary cache (checked with
+                            CachedAtomCount())
+   \param[in,out]  **atoms  Array of pointers to space for each atom
+
+   Fills in the atoms from a binary cache and links them in order. The
+   caller decides where the atoms live (a single array or separately
+   allocated) by the pointers it supplies.
+
+-  15.10.26 Original   By: ACRM
+*/
+void UnpackPDBCache(char *buffer, PDB **atoms)
+{
+   CACHESECTIONS sec;
+   CACHEHEADER   *header;
+   PDB           *p;
+   int           c, r, i,
+                 lastRes,
+                 lastAtom;
+
+   FindSections(buffer, &sec);
+   header = sec.header;
+
+   for(c=0; c<header->nchains; c++)
+   {
+      lastRes = (c < header->nchains-1) ?
+                sec.chains[c+1].firstRes : header->nres;
+
+      for(r=sec.chains[c].firstRes; r<lastRes; r++)
+      {
+         lastAtom = (r < header->nres-1) ?
+                    sec.residues[r+1].firstAtom : header->natoms;
+
+         for(i=sec.residues[r].firstAtom; i<lastAtom; i++)
+         {
+            CACHEATOM *a = sec.atoms + i;
+
+            p = atoms[i];
+            CLEAR_PDB(p);
+
+            p->x             = sec.x[i];
+            p->y             = sec.y[i];
+            p->z             = sec.z[i];
+            p->occ           = sec.occ[i];
+            p->bval          = sec.bval[i];
+            p->atnum         = a->atnum;
+            p->formal_charge = a->formalCharge;
+            p->altpos        = a->altpos;
+            p->resnum        = sec.residues[r].resnum;
+            COPYNAME(p->record_type, sec.names, a->recordType);
+            COPYNAME(p->atnam,       sec.names, a->atnam);
+            COPYNAME(p->atnam_raw,   sec.names, a->atnamRaw);
+            COPYNAME(p->element,     sec.names, a->element);
+            COPYNAME(p->segid,       sec.names, a->segid);
+            COPYNAME(p->resnam,      sec.names, sec.residues[r].resnam);
+            COPYNAME(p->insert,      sec.names, sec.residues[r].insert);
+            COPYNAME(p->chain,       sec.names, sec.chains[c].chain);
+
+            p->next = (i < header->natoms-1) ? atoms[i+1] : NULL;
+         }
+      }
+   }
+
+   for(i=0; i<header->nconect; i++)
+   {
+      p = atoms[sec.conect[2*i]];
+      if(p->nConect < MAXCONECT)
+         p->conect[p->nConect++] = atoms[sec.conect[2*i+1]];
+   }
+}
+
+/************************************************************************/
+/*>STRINGLIST *UnpackCachedText(char *buffer, BOOL trailer)
+   --------------------------------------------------------
+*//**
+
+   \param[in]      *buffer  Mapped binary cache (checked with
+                            CachedAtomCount())
+   \param[in]      trailer  Get the trailer rather than the header
+   \return                  The header or trailer records (NULL if
+                            there are none or out of memory)
+
+   Rebuilds the header or trailer records of the WHOLEPDB structure.
+   Each line keeps its newline as in blReadWholePDB().
+
+-  15.10.26 Original   By: ACRM
+*/
+STRINGLIST *UnpackCachedText(char *buffer, BOOL trailer)
+{
+   CACHESECTIONS sec;
+   STRINGLIST    *strings = NULL;
+   char          *text,
+                 *line,
+                 *eol,
+                 *copy;
+   int           len,
+                 lineLen;
+
+   FindSections(buffer, &sec);
+   if(trailer)
+   {
+      text = sec.trailerText;
+      len  = sec.header->trailerLen;
+   }
+   else
+   {
+      text = sec.headerText;
+      len  = sec.header->headerLen;
+   }
+
+   for(line=text; line<text+len; line=eol)
+   {
+      if((eol = (char *)memchr(line, '\n', text+len-line))!=NULL)
+         eol++;
+      else
+         eol = text+len;
+      lineLen = (int)(eol - line);
+
+      if((copy = (char *)malloc(lineLen + 1))==NULL)
+         break;
+      strncpy(copy, line, lineLen);
+      copy[lineLen] = '\0';
+      strings = blStoreString(strings, copy);
+      free(copy);
+   }
+
+   return(strings);
+}
+
+/************************************************************************/
+/*>static int InternName(NAMETABLE *table, char *name)
+   ---------------------------------------------------
+*//**
+
+   \param[in,out]  *table   Name table
+   \param[in]      *name    Name to store
+   \return                  Index of the name in the table (-1 if out
+                            of memory)
+
+   Finds a name in the name table, adding it if it is not already
+   there. Names are truncated to CACHE_NAMELEN-1 characters.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Grows the hash table rather than failing when it is half
+            full
+*/
+static int InternName(NAMETABLE *table, char *name)
+{
+   char          buffer[CACHE_NAMELEN];
+   unsigned long h;
+
+   strncpy(buffer, name, CACHE_NAMELEN-1);
+   buffer[CACHE_NAMELEN-1] = '\0';
+
+   /* Keep the hash table at most half full                             */
+   if((table->nnames >= table->hashSize/2) && !GrowNameHash(table))
+      return(-1);
+
+   for(h=HashName(buffer, table->hashSize); table->hash[h] >= 0;
+       h=(h+1) & (table->hashSize-1))
+   {
+      if(!strcmp(table->names[table->hash[h]], buffer))
+         return(table->hash[h]);
+   }
+
+   /* Not found so add it                                               */
+   if(table->nnames == table->maxnames)
+   {
+      char (*names)[CACHE_NAMELEN];
+      int  maxnames = table->maxnames ? 2 * table->maxnames : 64;
+
+      if((names = realloc(table->names, maxnames * CACHE_NAMELEN))==NULL)
+         return(-1);
+      table->names    = names;
+      table->maxnames = maxnames;
+   }
+
+   memset(table->names[table->nnames], 0, CACHE_NAMELEN);
+   strcpy(table->names[table->nnames], buffer);
+   table->hash[h] = table->nnames;
+
+   return(table->nnames++);
+}
+
+/************************************************************************/
+/*>static BOOL GrowNameHash(NAMETABLE *table)
+   ------------------------------------------
+*//**
+
+   \param[in,out]  *table   Name table
+   \return                  Success (FALSE if out of memory)
+
+   Doubles the size of the hash table and re-inserts the names
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL GrowNameHash(NAMETABLE *table)
+{
+   unsigned long h;
+   int           *hash,
+                 hashSize = 2 * table->hashSize,
+                 i;
+
+   if((hash = (int *)malloc(hashSize * sizeof(int)))==NULL)
+      return(FALSE);
+
+   for(i=0; i<hashSize; i++)
+      hash[i] = (-1);
+
+   for(i=0; i<table->nnames; i++)
+   {
+      for(h=HashName(table->names[i], hashSize); hash[h] >= 0;
+          h=(h+1) & (hashSize-1));
+      hash[h] = i;
+   }
+
+   free(table->hash);
+   table->hash     = hash;
+   table->hashSize = hashSize;
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static unsigned long HashName(char *name, int hashSize)
+   -------------------------------------------------------
+*//**
+
+   \param[in]      *name     Name
+   \param[in]      hashSize  Size of the hash table (a power of 2)
+   \return                   Hash table slot
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Added hashSize
+*/
+static unsigned long HashName(char *name, int hashSize)
+{
+   unsigned long h = 5381;
+
+   for(; *name; name++)
+      h = (h * 33) ^ (unsigned char)(*name);
+
+   return(h & (unsigned long)(hashSize-1));
+}
+
+/************************************************************************/
+/*>static size_t CacheSize(CACHEHEADER *header)
+   --------------------------------------------
+*//**
+
+   \param[in]      *header  Cache header
+   \return                  Size of the cache in bytes
+
+-  15.10.26 Original   By: ACRM
+*/
+static size_t CacheSize(CACHEHEADER *header)
+{
+   if((header->natoms < 0) || (header->nres < 0) ||
+      (header->nchains < 0) || (header->nnames < 0) ||
+      (header->nconect < 0) || (header->headerLen < 0) ||
+      (header->trailerLen < 0))
+      return((size_t)(-1));
+
+   return(sizeof(CACHEHEADER) +
+          5 * (size_t)header->natoms * sizeof(REAL) +
+          (size_t)header->natoms     * sizeof(CACHEATOM) +
+          (size_t)header->nres       * sizeof(CACHERES) +
+          (size_t)header->nchains    * sizeof(CACHECHAIN) +
+          (size_t)header->nnames     * CACHE_NAMELEN +
+          (size_t)header->nconect    * 2 * sizeof(int) +
+          (size_t)header->headerLen  +
+          (size_t)header->trailerLen);
+}
+
+/************************************************************************/
+/*>static BOOL CheckCacheIndices(char *buffer)
+   -------------------------------------------
+*//**
+
+   \param[in]      *buffer  Binary cache whose section sizes have been
+                            checked against the file size
+   \return                  Are all the indices valid?
+
+   Checks that the chains and residues start at 0 and are in order with
+   no empty entries, so that every atom belongs to one residue and
+   chain, that every name index is in the name table, that every name
+   is terminated and that every CONECT refers to two atoms.
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL CheckCacheIndices(char *buffer)
+{
+   CACHESECTIONS sec;
+   CACHEHEADER   *header;
+   CACHEATOM     *a;
+   int           natoms,
+                 nres,
+                 nchains,
+                 nnames,
+                 i;
+
+   FindSections(buffer, &sec);
+   header  = sec.header;
+   natoms  = header->natoms;
+   nres    = header->nres;
+   nchains = header->nchains;
+   nnames  = header->nnames;
+
+   if(natoms == 0)
+      return((BOOL)((nres == 0) && (nchains == 0) &&
+                    (header->nconect == 0)));
+
+   if(!INRANGE(nres-1, natoms) || !INRANGE(nchains-1, nres))
+      return(FALSE);
+
+   for(i=0; i<nnames; i++)
+   {
+      if(sec.names[i][CACHE_NAMELEN-1] != '\0')
+         return(FALSE);
+   }
+
+   for(i=0; i<nchains; i++)
+   {
+      if(((i == 0) && (sec.chains[i].firstRes != 0)) ||
+         ((i > 0) &&
+          (sec.chains[i].firstRes <= sec.chains[i-1].firstRes)) ||
+         !INRANGE(sec.chains[i].firstRes, nres) ||
+         !INRANGE(sec.chains[i].chain, nnames))
+         return(FALSE);
+   }
+
+   for(i=0; i<nres; i++)
+   {
+      if(((i == 0) && (sec.residues[i].firstAtom != 0)) ||
+         ((i > 0) &&
+          (sec.residues[i].firstAtom <= sec.residues[i-1].firstAtom)) ||
+         !INRANGE(sec.residues[i].firstAtom, natoms) ||
+         !INRANGE(sec.residues[i].resnam, nnames)    ||
+         !INRANGE(sec.residues[i].insert, nnames))
+         return(FALSE);
+   }
+
+   for(i=0, a=sec.atoms; i<natoms; i++, a++)
+   {
+      if(!INRANGE(a->recordType, nnames) ||
+         !INRANGE(a->atnam,      nnames) ||
+         !INRANGE(a->atnamRaw,   nnames) ||
+         !INRANGE(a->element,    nnames) ||
+         !INRANGE(a->segid,      nnames))
+         return(FALSE);
+   }
+
+   for(i=0; i<2*header->nconect; i++)
+   {
+      if(!INRANGE(sec.conect[i], natoms))
+         return(FALSE);
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static void FindSections(char *buffer, CACHESECTIONS *sec)
+   ----------------------------------------------------------
+*//**
+
+   \param[in]      *buffer  Mapped binary cache
+   \param[out]     *sec     Pointers to the sections of the cache
+
+-  15.10.26 Original   By: ACRM
+*/
+static void FindSections(char *buffer, CACHESECTIONS *sec)
+{
+   CACHEHEADER *header = (CACHEHEADER *)buffer;
+   int         natoms  = header->natoms;
+
+   sec->header      = header;
+   sec->x           = (REAL *)(buffer + sizeof(CACHEHEADER));
+   sec->y           = sec->x + natoms;
+   sec->z           = sec->y + natoms;
+   sec->occ         = sec->z + natoms;
+   sec->bval        = sec->occ + natoms;
+   sec->atoms       = (CACHEATOM *)(sec->bval + natoms);
+   sec->residues    = (CACHERES *)(sec->atoms + natoms);
+   sec->chains      = (CACHECHAIN *)(sec->residues + header->nres);
+   sec->names       = (char (*)[CACHE_NAMELEN])
+                      (sec->chains + header->nchains);
+   sec->conect      = (int *)(sec->names + header->nnames);
+   sec->headerText  = (char *)(sec->conect + 2 * header->nconect);
+   sec->trailerText = sec->headerText + header->headerLen;
+}
+
+/************************************************************************/
+/*>static int CompareAtomIndex(const void *a, const void *b)
+   ---------------------------------------------------------
+*//**
+
+   qsort()/bsearch() comparison of ATOMINDEX items by atom pointer
+
+-  15.10.26 Original   By: ACRM
+*/
+static int CompareAtomIndex(const void *a, const void *b)
+{
+   PDB *pa = ((ATOMINDEX *)a)->atom,
+       *pb = ((ATOMINDEX *)b)->atom;
+
+   if(pa < pb) return(-1);
+   if(pa > pb) return(1);
+   return(0);
+}
+
+/************************************************************************/
+/*>static int TextLength(STRINGLIST *strings)
+   ------------------------------------------
+*//**
+
+   \param[in]      *strings  Header or trailer records
+   \return                   Total length of the records
+
+-  15.10.26 Original   By: ACRM
+*/
+static int TextLength(STRINGLIST *strings)
+{
+   STRINGLIST *s;
+   int        len = 0;
+
+   for(s=strings; s!=NULL; NEXT(s))
+      len += strlen(s->string);
+
+   return(len);
+}
+
+/************************************************************************/
+/*>static BOOL WriteText(FILE *fp, STRINGLIST *strings)
+   ----------------------------------------------------
+*//**
+
+   \param[in]      *fp       Output file
+   \param[in]      *strings  Header or trailer records
+   \return                   Success
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL WriteText(FILE *fp, STRINGLIST *strings)
+{
+   STRINGLIST *s;
+
+   for(s=strings; s!=NULL; NEXT(s))
+   {
+      if(fputs(s->string, fp) == EOF)
+         return(FALSE);
+   }
+
+   return(TRUE);
+}
@@ -0,0 +1,130 @@
+/************************************************************************/
+/**
+
+   \file       pdbcache.h
+
+   \version    V1.1
+   \date       15.10.26
+   \brief      Binary cache format for PDB structures
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Stores the number of models. Added IsPDBCache() and
+                  CachedModelCount()
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_PDBCACHE_H
+#define _BIOPTOOLS_PDBCACHE_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stddef.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define CACHE_MAGIC    "BPTCACHE"  /* First 8 bytes of a cache file     */
+#define CACHE_VERSION  2
+#define CACHE_ORDER    0x01020304  /* Checks the byte order matches     */
+#define CACHE_NAMELEN  16          /* Size of a name table entry        */
+
+/* The file starts with this header. It is followed by the sections
+   below. The header and each section are sized so that the following
+   section is correctly aligned when the file is memory-mapped:
+      REAL       x[natoms], y[natoms], z[natoms], occ[natoms],
+                 bval[natoms]
+      CACHEATOM  atoms[natoms]
+      CACHERES   residues[nres]
+      CACHECHAIN chains[nchains]
+      char       names[nnames][CACHE_NAMELEN]
+      int        conect[nconect][2]
+      char       header[headerLen], trailer[trailerLen]
+   Names are stored once in the name table and referred to by index.
+*/
+typedef struct
+{
+   char magic[8];
+   int  order,
+        version,
+        realSize,
+        natoms,
+        nres,
+        nchains,
+        nnames,
+        nconect,
+        headerLen,
+        trailerLen,
+        numModels,
+        spare;           /* 56 bytes in all                             */
+}  CACHEHEADER;
+
+typedef struct
+{
+   int  recordType,      /* Name indices                                */
+        atnam,
+        atnamRaw,
+        element,
+        segid,
+        atnum,
+        formalCharge;
+   char altpos,
+        pad[3];
+}  CACHEATOM;
+
+typedef struct
+{
+   int  firstAtom,       /* Index of the first atom in the residue      */
+        resnum,
+        resnam,          /* Name indices                                */
+        insert;
+}  CACHERES;
+
+typedef struct
+{
+   int  firstRes,        /* Index of the first residue in the chain     */
+        chain;           /* Name index                                  */
+}  CACHECHAIN;
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL WritePDBCache(FILE *fp, WHOLEPDB *wpdb);
+int  CachedAtomCount(char *buffer, size_t size);
+int  CachedModelCount(char *buffer);
+BOOL HasCacheMagic(char *buffer, size_t size);
+BOOL IsPDBCache(FILE *fp, char *progname);
+void UnpackPDBCache(char *buffer, PDB **atoms);
+STRINGLIST *UnpackCachedText(char *buffer, BOOL trailer);
+
+#endif
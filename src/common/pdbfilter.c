@@ -0,0 +1,504 @@
+/************************************************************************/
+/**
+
+   \file       pdbfilter.c
+
+   \version    V1.2
+   \date       15.10.26
+   \brief      Streaming record filters for PDB files
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Filters a PDB file one record at a time rather than reading the
+   whole structure into memory, so that memory use does not depend on
+   the size of the file. The records are copied unchanged except where
+   the removal of atoms has to be reflected elsewhere:
+
+   - ANISOU, SIGATM and SIGUIJ records are dropped with their atom.
+   - A TER record is dropped if all the atoms before it were dropped.
+   - Dropped atoms are removed from CONECT records and a CONECT record
+     is dropped if its own atom, or all of its bonded atoms, were
+     dropped. Atom serial numbers may be decimal or hybrid-36 (as used
+     for more than 99999 atoms) and are recorded in a bit map which
+     grows as needed. The map is cleared at each MODEL record, so
+     CONECT records are checked against the atoms dropped from the
+     most recent model.
+   - The coordinate, TER and CONECT counts in the MASTER record are
+     replaced by the number of records written.
+
+   A program supplies a function which decides whether each ATOM and
+   HETATM record is kept. PDBML files cannot be filtered in this way.
+
+**************************************************************************
+
+   Usage:
+   ======
+   BOOL KeepAtom(char *record, void *data)
+   {
+      ...
+   }
+
+   ok = StreamFilterPDB(in, out, KeepAtom, &data, 0);
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Reads hybrid-36 atom numbers. The bit map of dropped
+                  atoms grows as needed and is cleared for each model
+-  V1.2  15.10.26 Atom numbers are decoded by ReadAtomSerial()
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/macros.h"
+#include "pdbfilter.h"
+#include "hybrid36.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXFILTERLINE  1024        /* Longer lines are copied in pieces */
+#define FILTERBUFFSIZE (1<<20)     /* stdio buffer size for in and out  */
+#define MAXSERIAL      99999       /* Largest decimal atom number. The
+                                      bit map starts this size          */
+
+#define SETSERIAL(map, n)   ((map)[(n)>>3] |= (unsigned char)(1<<((n)&7)))
+#define GOTSERIAL(map, n)   ((map)[(n)>>3] &  (unsigned char)(1<<((n)&7)))
+
+/* Removed atoms and the counts needed for the MASTER record            */
+typedef struct
+{
+   unsigned char *removed;
+   int           mapSize,        /* Size of removed[] in bytes          */
+                 maxRemoved,     /* Largest serial set in removed[]     */
+                 nRemoved,
+                 nCoord,
+                 nTer,
+                 nConect;
+}  FILTERSTATE;
+
+/************************************************************************/
+/* Prototypes
+*/
+static BOOL RecordIs(char *line, char *type);
+static int  ReadSerial(char *line, int offset);
+static BOOL SetRemoved(FILTERSTATE *state, int serial);
+static void ClearRemoved(FILTERSTATE *state);
+static BOOL IsRemoved(FILTERSTATE *state, int serial);
+static BOOL FilterConect(char *line, FILTERSTATE *state);
+static void FixMaster(char *line, FILTERSTATE *state);
+
+/************************************************************************/
+/*>BOOL StreamFilterPDB(FILE *in, FILE *out, ATOMFILTER KeepAtom,
+                        void *data, int flags)
+   --------------------------------------------------------------
+*//**
+
+   \param[in]      *in        Input PDB file
+   \param[in]      *out       Output PDB file
+   \param[in]      KeepAtom   Function deciding whether an ATOM or HETATM
+                              record is kept (NULL to keep them all)
+   \param[in]      *data      Data passed through to KeepAtom()
+   \param[in]      flags      FILTER_COORDSONLY to drop all but the
+                              coordinate records
+   \return                    Success (FALSE for PDBML, out of memory
+                              or a write error)
+
+   Copies a PDB file a record at a time, keeping the ATOM and HETATM
+   records accepted by KeepAtom(). Large stdio buffers are used, so
+   this must be called before anything else is read from or written
+   to the files.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 The bit map is allocated separately, grown by SetRemoved()
+            and cleared at each MODEL record
+*/
+BOOL StreamFilterPDB(FILE *in, FILE *out, ATOMFILTER KeepAtom,
+                     void *data, int flags)
+{
+   FILTERSTATE *state;
+   char        line[MAXFILTERLINE],
+               *chp;
+   BOOL        keep         = TRUE,
+               keepAtom     = TRUE,
+               continuation = FALSE,
+               coordsOnly   = (BOOL)((flags & FILTER_COORDSONLY) != 0),
+               firstLine    = TRUE,
+               ok           = TRUE;
+   int         nKeptSinceTer = 0;
+
+   if((state = (FILTERSTATE *)malloc(sizeof(FILTERSTATE)))==NULL)
+      return(FALSE);
+   memset(state, 0, sizeof(FILTERSTATE));
+   state->mapSize = MAXSERIAL/8 + 1;
+   if((state->removed = (unsigned char *)calloc(state->mapSize, 1))
+      ==NULL)
+   {
+      free(state);
+      return(FALSE);
+   }
+
+   setvbuf(in,  NULL, _IOFBF, FILTERBUFFSIZE);
+   setvbuf(out, NULL, _IOFBF, FILTERBUFFSIZE);
+
+   while(fgets(line, MAXFILTERLINE, in))
+   {
+      /* The rest of a long line goes the same way as its start         */
+      if(continuation)
+      {
+         if(keep)
+            fputs(line, out);
+         continuation = (BOOL)(strchr(line, '\n') == NULL);
+         continue;
+      }
+      continuation = (BOOL)(strchr(line, '\n') == NULL);
+
+      if(firstLine)
+      {
+         for(chp=line; (*chp == ' ') || (*chp == '\t'); chp++);
+         if(*chp == '<')
+         {
+            fprintf(stderr, "Error: PDBML files cannot be filtered as a \
+stream\n");
+            ok = FALSE;
+            break;
+         }
+         firstLine = FALSE;
+      }
+
+      if(RecordIs(line, "ATOM  ") || RecordIs(line, "HETATM"))
+      {
+         keep = keepAtom = (BOOL)((KeepAtom == NULL) ||
+                                  (*KeepAtom)(line, data));
+         if(keep)
+         {
+            state->nCoord++;
+            nKeptSinceTer++;
+         }
+         else
+         {
+            if(!SetRemoved(state, ReadSerial(line, 6)))
+            {
+               ok = FALSE;
+               break;
+            }
+            state->nRemoved++;
+         }
+      }
+      else if(RecordIs(line, "ANISOU") || RecordIs(line, "SIGATM") ||
+              RecordIs(line, "SIGUIJ"))
+      {
+         keep = (BOOL)(!coordsOnly && keepAtom);
+      }
+      else if(RecordIs(line, "TER"))
+      {
+         if((keep = (BOOL)(nKeptSinceTer > 0))==TRUE)
+            state->nTer++;
+         nKeptSinceTer = 0;
+      }
+      else if(RecordIs(line, "MODEL") || RecordIs(line, "ENDMDL"))
+      {
+         /* Atom numbers start again in each model                      */
+         if(RecordIs(line, "MODEL"))
+            ClearRemoved(state);
+         keep = TRUE;
+         nKeptSinceTer = 0;
+      }
+      else if(coordsOnly)
+      {
+         keep = FALSE;
+      }
+      else if(RecordIs(line, "CONECT"))
+      {
+         if((keep = FilterConect(line, state))==TRUE)
+            state->nConect++;
+      }
+      else if(RecordIs(line, "MASTER"))
+      {
+         FixMaster(line, state);
+         keep = TRUE;
+      }
+      else
+      {
+         keep = TRUE;
+      }
+
+      if(keep)
+         fputs(line, out);
+   }
+
+   if(ferror(out) || (fflush(out) == EOF))
+      ok = FALSE;
+
+   free(state->removed);
+   free(state);
+   return(ok);
+}
+
+/************************************************************************/
+/*>static BOOL RecordIs(char *line, char *type)
+   --------------------------------------------
+*//**
+
+   \param[in]      *line    PDB record
+   \param[in]      *type    Record type
+   \return                  Is the record of this type?
+
+   Record types shorter than 6 characters may be followed by a space
+   or the end of the line.
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL RecordIs(char *line, char *type)
+{
+   int len = strlen(type);
+
+   if(strncmp(line, type, len))
+      return(FALSE);
+   return((BOOL)((len == 6) || (line[len] == ' ') ||
+                 (line[len] == '\n') || (line[len] == '\r') ||
+                 (line[len] == '\0')));
+}
+
+/************************************************************************/
+/*>static int ReadSerial(char *line, int offset)
+   ---------------------------------------------
+*//**
+
+   \param[in]      *line    PDB record
+   \param[in]      offset   Offset of a 5 character atom number
+   \return                  The atom number (0 if blank, past the end
+                            of the line or not valid)
+
+   Reads a decimal or hybrid-36 atom number from a record
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Reads hybrid-36 atom numbers
+-  15.10.26 Decoding moved to ReadAtomSerial()
+*/
+static int ReadSerial(char *line, int offset)
+{
+   char field[6];
+   int  i;
+
+   for(i=0; i<5; i++)
+   {
+      if((line[offset+i] == '\0') || (line[offset+i] == '\n') ||
+         (line[offset+i] == '\r'))
+         break;
+      field[i] = line[offset+i];
+   }
+   field[i] = '\0';
+
+   return(ReadAtomSerial(field));
+}
+
+/************************************************************************/
+/*>static BOOL SetRemoved(FILTERSTATE *state, int serial)
+   ------------------------------------------------------
+*//**
+
+   \param[in,out]  *state   Filter state
+   \param[in]      serial   Atom number (ignored if not positive)
+   \return                  Success (FALSE if out of memory)
+
+   Records that an atom was dropped, growing the bit map if needed
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL SetRemoved(FILTERSTATE *state, int serial)
+{
+   if(serial <= 0)
+      return(TRUE);
+
+   if((serial >> 3) >= state->mapSize)
+   {
+      unsigned char *removed;
+      int           mapSize = MAX(2 * state->mapSize, (serial >> 3) + 1);
+
+      if((removed = (unsigned char *)realloc(state->removed, mapSize))
+         ==NULL)
+         return(FALSE);
+      memset(removed + state->mapSize, 0, mapSize - state->mapSize);
+      state->removed = removed;
+      state->mapSize = mapSize;
+   }
+
+   SETSERIAL(state->removed, serial);
+   state->maxRemoved = MAX(state->maxRemoved, serial);
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static void ClearRemoved(FILTERSTATE *state)
+   --------------------------------------------
+*//**
+
+   \param[in,out]  *state   Filter state
+
+   Clears the bit map of dropped atoms at the start of a model. Only the
+   part that has been used is cleared.
+
+-  15.10.26 Original   By: ACRM
+*/
+static void ClearRemoved(FILTERSTATE *state)
+{
+   if(state->maxRemoved)
+   {
+      memset(state->removed, 0, (state->maxRemoved >> 3) + 1);
+      state->maxRemoved = 0;
+   }
+}
+
+/************************************************************************/
+/*>static BOOL IsRemoved(FILTERSTATE *state, int serial)
+   -----------------------------------------------------
+*//**
+
+   \param[in]      *state   Filter state
+   \param[in]      serial   Atom number
+   \return                  Was the atom dropped?
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Checks against the highest atom number recorded
+*/
+static BOOL IsRemoved(FILTERSTATE *state, int serial)
+{
+   return((BOOL)((serial > 0) && (serial <= state->maxRemoved) &&
+                 GOTSERIAL(state->removed, serial)));
+}
+
+/************************************************************************/
+/*>static BOOL FilterConect(char *line, FILTERSTATE *state)
+   --------------------------------------------------------
+*//**
+
+   \param[in,out]  *line    CONECT record
+   \param[in]      *state   Filter state
+   \return                  Should the record be kept?
+
+   Removes dropped atoms from a CONECT record. The four bonded atoms in
+   columns 12-31 are closed up; any of the old hydrogen bond and salt
+   bridge fields after these which refer to a dropped atom are blanked.
+   The record keeps its length.
+
+-  15.10.26 Original   By: ACRM
+*/
+static BOOL FilterConect(char *line, FILTERSTATE *state)
+{
+   char newLine[MAXFILTERLINE];
+   int  len,
+        offset,
+        width,
+        pos,
+        serial,
+        nBonded = 0,
+        nKept   = 0;
+
+   if(!state->nRemoved)
+      return(TRUE);
+   if(IsRemoved(state, ReadSerial(line, 6)))
+      return(FALSE);
+
+   len = strcspn(line, "\r\n");
+   pos = MIN(len, 11);
+   memcpy(newLine, line, pos);
+
+   /* Bonded atoms, closed up and padded with blanks                    */
+   for(offset=11; (offset<31) && (offset<len); offset+=5)
+   {
+      width = MIN(5, len-offset);
+      if((serial = ReadSerial(line, offset)) > 0)
+      {
+         nBonded++;
+         if(!IsRemoved(state, serial))
+         {
+            memcpy(newLine+pos, line+offset, width);
+            pos += width;
+            nKept++;
+         }
+      }
+   }
+   if(nBonded && !nKept)
+      return(FALSE);
+   width = MIN(len, 31);
+   memset(newLine+pos, ' ', width-pos);
+   pos = width;
+
+   /* Further fields keep their columns                                 */
+   if(len > 31)
+   {
+      for(offset=31; offset<len; offset+=5)
+      {
+         width = MIN(5, len-offset);
+         if(IsRemoved(state, ReadSerial(line, offset)))
+            memset(newLine+pos, ' ', width);
+         else
+            memcpy(newLine+pos, line+offset, width);
+         pos += width;
+      }
+   }
+
+   /* Line end                                                          */
+   strcpy(newLine+pos, line+len);
+   strcpy(line, newLine);
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>static void FixMaster(char *line, FILTERSTATE *state)
+   -----------------------------------------------------
+*//**
+
+   \param[in,out]  *line    MASTER record
+   \param[in]      *state   Filter state
+
+   Replaces the numCoord, numTer and numConect fields (columns 51-65)
+   of a MASTER record with the numbers of records written
+
+-  15.10.26 Original   By: ACRM
+*/
+static void FixMaster(char *line, FILTERSTATE *state)
+{
+   char counts[24];
+
+   if(!state->nRemoved || (strcspn(line, "\r\n") < 65))
+      return;
+
+   sprintf(counts, "%5d%5d%5d", state->nCoord % 100000,
+           state->nTer % 100000, state->nConect % 100000);
+   memcpy(line+50, counts, 15);
+}
@@ -0,0 +1,65 @@
+/************************************************************************/
+/**
+
+   \file       pdbfilter.h
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Streaming record filters for PDB files
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_PDBFILTER_H
+#define _BIOPTOOLS_PDBFILTER_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define FILTER_COORDSONLY 0x0001   /* Keep only the ATOM, HETATM, TER,
+                                      MODEL and ENDMDL records          */
+
+/* Decides whether an ATOM or HETATM record is kept                     */
+typedef BOOL (*ATOMFILTER)(char *record, void *data);
+
+/************************************************************************/
+/* Prototypes
+*/
+BOOL StreamFilterPDB(FILE *in, FILE *out, ATOMFILTER KeepAtom,
+                     void *data, int flags);
+
+#endif
@@ -0,0 +1,200 @@
+/************************************************************************/
+/**
+
+   \file       solvcalc.c
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Solvent accessibility of a whole PDB structure
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   The accessibility calculation done by pdbsolv. Used by pdbsolv and
+   by the pdbsolv stage of the bioptools pipeline.
+
+**************************************************************************
+
+   Usage:
+   ======
+   FILE   *fpRad;
+   RESRAD *resrad;
+   if((fpRad = OpenRadiusFile(radfile))!=NULL)
+   {
+      if(CalcWholePDBAccess(wpdb, fpRad, integrationAccuracy,
+                            probeRadius, doAccessibility, &resrad))
+      {
+         PopulateBValWithAccess(wpdb->pdb);
+         ...
+         FREELIST(resrad, RESRAD);
+      }
+      fclose(fpRad);
+   }
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original (moved from pdbsolv.c and
+                  multicall/stages.c)
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "bioplib/access.h"
+#include "bioplib/general.h"
+#include "solvcalc.h"
+
+/************************************************************************/
+/*>FILE *OpenRadiusFile(char *radfile)
+   -----------------------------------
+*//**
+
+   \param[in]      *radfile   Radius file name
+   \return                    Open radius file (NULL on error)
+
+   Opens the radius file, looking in the DATA_ENV directory if it is
+   not found. Reports an error if it cannot be opened.
+
+-  15.10.26 Original (split from pdbsolv main())   By: ACRM
+*/
+FILE *OpenRadiusFile(char *radfile)
+{
+   FILE *fpRad;
+   BOOL noenv = FALSE;
+
+   if((fpRad=blOpenFile(radfile, DATA_ENV, "r", &noenv))==NULL)
+   {
+      fprintf(stderr, "Error (pdbsolv): Unable to open radius file, \
+%s\n", radfile);
+      if(noenv)
+      {
+         fprintf(stderr, "              Environment variable %s \
+not set\n", DATA_ENV);
+      }
+   }
+
+   return(fpRad);
+}
+
+/************************************************************************/
+/*>BOOL CalcWholePDBAccess(WHOLEPDB *wpdb, FILE *fpRad, 
+                           REAL integrationAccuracy, REAL probeRadius,
+                           BOOL doAccessibility, RESRAD **resrad)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in,out]  *wpdb                Whole PDB structure
+   \param[in]      *fpRad               Open radius file
+   \param[in]      integrationAccuracy  Integration accuracy
+   \param[in]      probeRadius          Probe radius
+   \param[in]      doAccessibility      Calculate accessibility rather
+                                        than contact area
+   \param[out]     **resrad             Residue radii and standard
+                                        accessibilities, to be freed by
+                                        the caller (may be NULL if not
+                                        wanted)
+   \return                              Success
+
+   Removes the waters from the structure and calculates the
+   accessibility of each atom. The radius file is rewound first so it
+   can be used again for the next structure.
+
+-  15.10.26 Original (split from pdbsolv SolvFile())   By: ACRM
+*/
+BOOL CalcWholePDBAccess(WHOLEPDB *wpdb, FILE *fpRad, 
+                        REAL integrationAccuracy, REAL probeRadius,
+                        BOOL doAccessibility, RESRAD **resrad)
+{
+   RESRAD *radii;
+   PDB    *pdb;
+   int    natoms;
+
+   if(resrad != NULL)
+      *resrad = NULL;
+
+   /* Strip waters                                                      */
+   if((pdb = blStripWatersPDBAsCopy(wpdb->pdb, &natoms))==NULL)
+   {
+      fprintf(stderr, "Error (pdbsolv): No memory to strip waters\n");
+      return(FALSE);
+   }
+
+   /* Free the original linked list of atoms and patch in the new one   */
+   FREELIST(wpdb->pdb, PDB);
+   wpdb->pdb    = pdb;
+   wpdb->natoms = natoms;
+
+   /* Set the atom radii in the linked list                             */
+   rewind(fpRad);
+   radii = blSetAtomRadii(pdb, fpRad);
+
+   /* Do the actual accessibility calculations                          */
+   if(!blCalcAccess(pdb, natoms, integrationAccuracy, probeRadius,
+                    doAccessibility))
+   {
+      fprintf(stderr,"Error: (pdbsolv) No memory for accessibility \
+arrays\n");
+      FREELIST(radii, RESRAD);
+      return(FALSE);
+   }
+
+   if(resrad != NULL)
+      *resrad = radii;
+   else
+      FREELIST(radii, RESRAD);
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>void PopulateBValWithAccess(PDB *pdb)
+   -------------------------------------
+*//**
+   \param   PDB  *pdb    PDB linked list
+
+   Copies the accessibility inforation into the B-Value column for output
+
+-  17.07.14  Original   By: ACRM   
+-  15.10.26  Moved from pdbsolv.c
+*/
+void PopulateBValWithAccess(PDB *pdb)
+{
+   PDB *p;
+   for(p=pdb; p!=NULL; NEXT(p))
+   {
+      p->bval = p->access;
+   }
+}
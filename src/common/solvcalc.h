@@ -0,0 +1,69 @@
+/************************************************************************/
+/**
+
+   \file       solvcalc.h
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      Solvent accessibility of a whole PDB structure
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_SOLVCALC_H
+#define _BIOPTOOLS_SOLVCALC_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/pdb.h"
+#include "bioplib/access.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define DEF_PROBERADIUS 1.4
+#define DEF_RADFILE     "radii.dat"
+#define DATA_ENV        "DATADIR"
+
+/************************************************************************/
+/* Prototypes
+*/
+FILE *OpenRadiusFile(char *radfile);
+BOOL CalcWholePDBAccess(WHOLEPDB *wpdb, FILE *fpRad, 
+                        REAL integrationAccuracy, REAL probeRadius,
+                        BOOL doAccessibility, RESRAD **resrad);
+void PopulateBValWithAccess(PDB *pdb);
+
+#endif
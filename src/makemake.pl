@@ -4,11 +4,11 @@
 #   Program:    makemake
 #   File:       makemake.pl
 #   
-#   Version:    V1.6.2
-#   Date:       11.08.16
+#   Version:    V1.10
+#   Date:       15.10.26
 #   Function:   Build the Makefile for BiopTools
 #   
-#   Copyright:  (c) Dr. Andrew C. R. Martin, UCL, 2014-2016
+#   Copyright:  (c) Dr. Andrew C. R. Martin, UCL, 2014-2026
 #   Author:     Dr. Andrew C. R. Martin
 #   Address:    Institute of Structural and Molecular Biology
 #               Division of Biosciences
@@ -60,12 +60,23 @@
 #                     V3.4.1
 #   V1.6.1  17.02.16  Bumped to require BiopLib V3.4.2
 #   V1.6.2  11.08.16  Bumped to require BiopLib V3.5
+#   V1.7    15.10.26  Links with -lpthread for multi-threaded programs
+#   V1.8    15.10.26  Builds the code shared by the programs in common/
+#                     as a library and links all programs with it
+#   V1.9    15.10.26  Builds the bioptools multi-call program from the
+#                     programs and the code in multicall/
+#   V1.10   15.10.26  The multi-call program is no longer part of 'all'
+#                     since it needs GNU objcopy. Build it with
+#                     'make bioptools'
 #
 #*************************************************************************
 $::biopversion = "3.5.0";
 #*************************************************************************
 $::biopgit     = "https://github.com/ACRMGroup/bioplib/archive/V";
 $::biopext     = ".tar.gz";
+$::commondir   = "common";
+$::multidir    = "multicall";
+$::multiexe    = "bioptools";
 #*************************************************************************
 # Deal with the command line
 UsageDie() if(defined($::h) || defined($::help));
@@ -89,16 +100,23 @@ else
 GetBiopLib()        if($::bioplib);
 my @cFiles = GetCFileList('.');
 my @exeFiles = StripExtension(@cFiles);
+my @libFiles = map { "$::commondir/$_" } GetCFileList($::commondir);
+my @multiFiles = map { "$::multidir/$_" } GetCFileList($::multidir);
 open(my $makefp, ">Makefile") || die "Can't open Makefile for writing";
 WriteFlags($makefp, $::libdir, $::incdir, $::bindir, $::datadir);
 WriteTargets($makefp, @exeFiles);
+WriteCommonTargets($makefp, @libFiles);
+WriteMultiTargets($makefp, @exeFiles);
 WriteDummyRule($makefp, $::bioplib);
 WriteInstallRule($makefp, @exeFiles);
 WriteCleanRules($makefp, $::bioplib, @exeFiles);
 WriteLinksRule($makefp);
+WriteCommonRules($makefp, @libFiles);
+WriteMultiRules($makefp, @multiFiles);
 foreach my $cFile (@cFiles)
 {
     WriteRule($makefp, $cFile);
+    WriteMultiObjRule($makefp, $cFile);
 }
 
 close $makefp;
@@ -132,6 +150,8 @@ sub GetBiopLib
 # Writes the rule for installing code in $BINDIR
 #
 # 06.11.14 Original   By: ACRM
+# 15.10.26 Installs the multi-call program
+# 15.10.26 Only installs the multi-call program if it has been built
 sub WriteInstallRule
 {
     my($makefp, @exeFiles) = @_;
@@ -140,6 +160,7 @@ sub WriteInstallRule
 install : 
 \tmkdir -p \$(BINDIR)
 \tcp \$(TARGETS) \$(BINDIR)
+\tif [ -f \$(MULTICALL) ] ; then cp \$(MULTICALL) \$(BINDIR) ; fi
 \tmkdir -p \$(DATADIR)
 \tif [ ! -f \$(DATADIR)/radii.dat ] ; then cp ../data/radii.dat \$(DATADIR) ; fi
 \t\@echo " "
@@ -200,6 +221,7 @@ __EOF
 #
 # 06.11.14 Original   By: ACRM
 # 13.02.15 Added distclean
+# 15.10.26 Removes the common library and the multi-call program
 sub WriteCleanRules
 {
     my($makefp, $bioplib, @exeFiles) = @_;
@@ -213,7 +235,8 @@ distclean : clean
 clean : 
 \t\\rm -rf bioplib
 \t(cd libsrc/bioplib/src; make clean)
-\t\\rm -f \$(TARGETS)
+\t\\rm -f \$(TARGETS) \$(COMMONLIB) \$(COMMONOBJS)
+\t\\rm -f \$(MULTICALL) \$(MULTIOBJS) $::multidir/tools.h
 
 __EOF
     }
@@ -225,7 +248,8 @@ distclean : clean
 \t\\rm Makefile
 
 clean : 
-\t\\rm -f \$(TARGETS)
+\t\\rm -f \$(TARGETS) \$(COMMONLIB) \$(COMMONOBJS)
+\t\\rm -f \$(MULTICALL) \$(MULTIOBJS) $::multidir/tools.h
 
 __EOF
     }
@@ -235,6 +259,7 @@ __EOF
 # Writes a rule to build an executable from a C file
 #
 # 06.11.14 Original   By: ACRM
+# 15.10.26 Links with the common library
 sub WriteRule
 {
     my($makefp, $cFile) = @_;
@@ -242,16 +267,87 @@ sub WriteRule
     $exeFile =~ s/\.c$//;
     print $makefp <<__EOF;
 
-$exeFile : $cFile
-\t\$(CC) \$(CFLAGS) -o \$@ \$< \$(LFLAGS)
+$exeFile : $cFile \$(COMMONLIB)
+\t\$(CC) \$(CFLAGS) -o \$@ \$< \$(COMMONLIB) \$(LFLAGS)
 __EOF
 
 }
 
+#*************************************************************************
+# Writes the rules to build the library of common code from the C files
+# in the common directory
+#
+# 15.10.26 Original   By: ACRM
+sub WriteCommonRules
+{
+    my($makefp, @libFiles) = @_;
+    print $makefp <<__EOF;
+
+\$(COMMONLIB) : \$(COMMONOBJS)
+\tar rcs \$@ \$(COMMONOBJS)
+__EOF
+
+    foreach my $cFile (@libFiles)
+    {
+        my $oFile = $cFile;
+        $oFile =~ s/\.c$/.o/;
+        print $makefp <<__EOF;
+
+$oFile : $cFile \$(COMMONHDRS)
+\t\$(CC) \$(CFLAGS) -c -o \$@ \$<
+__EOF
+    }
+}
+
+#*************************************************************************
+# Writes the rules to build the multi-call program from the C files in
+# the multicall directory and a version of each program with main()
+# renamed. tools.h lists the programs for the multi-call program. It is
+# not built by 'all' since renaming needs GNU objcopy, so it is built
+# with 'make bioptools'.
+#
+# 15.10.26 Original   By: ACRM
+sub WriteMultiRules
+{
+    my($makefp, @multiFiles) = @_;
+    my $srcs = join(' ', @multiFiles);
+    print $makefp <<__EOF;
+
+\$(MULTICALL) : $srcs $::multidir/tools.h \$(MULTIOBJS) \$(COMMONLIB)
+\t\$(CC) \$(CFLAGS) -I. -o \$@ $srcs \$(MULTIOBJS) \$(COMMONLIB) \$(LFLAGS)
+
+$::multidir/tools.h : Makefile
+\tfor t in \$(TARGETS) ; do echo "TOOL(\$\$t)" ; done > \$@
+__EOF
+}
+
+#*************************************************************************
+# Writes a rule to compile a program for the multi-call program. main()
+# is renamed to <program>_main() and all other global symbols are made
+# local so that functions with the same name in different programs
+# (Usage(), ParseCmdLine(), etc.) do not clash.
+#
+# 15.10.26 Original   By: ACRM
+sub WriteMultiObjRule
+{
+    my($makefp, $cFile) = @_;
+    my $exeFile = $cFile;
+    $exeFile =~ s/\.c$//;
+    print $makefp <<__EOF;
+
+$::multidir/$exeFile.o : $cFile \$(COMMONHDRS)
+\t\$(CC) \$(CFLAGS) -Dmain=${exeFile}_main -c -o \$@.tmp \$<
+\tobjcopy --keep-global-symbol=${exeFile}_main \$@.tmp \$@
+\t\\rm -f \$@.tmp
+__EOF
+}
+
 #*************************************************************************
 # Writes the dummy rule for building everything
 #
 # 06.11.14 Original   By: ACRM
+# 15.10.26 Builds the multi-call program
+# 15.10.26 No longer builds the multi-call program
 sub WriteDummyRule
 {
     my($makefp, $bioplib) = @_;
@@ -293,6 +389,7 @@ __EOF
 # Write the flags for the compiler and directories
 #
 # 06.11.14 Original   By: ACRM
+# 15.10.26 Added -lpthread
 sub WriteFlags
 {
     my($makefp, $libdir, $incdir, $bindir, $datadir) = @_;
@@ -301,7 +398,7 @@ CC      = gcc
 BINDIR  = $bindir
 DATADIR = $datadir
 CFLAGS  = -O3 -ansi -Wall -pedantic -I$incdir -L$libdir
-LFLAGS  = -lbiop -lgen -lm -lxml2
+LFLAGS  = -lbiop -lgen -lm -lxml2 -lpthread
 __EOF
 }
 
@@ -320,6 +417,42 @@ sub WriteTargets
     print $makefp "\n";
 }
 
+#*************************************************************************
+# Write the list of objects and headers for the common library
+#
+# 15.10.26 Original   By: ACRM
+sub WriteCommonTargets
+{
+    my ($makefp, @libFiles) = @_;
+    print $makefp "COMMONLIB  = $::commondir/libbioptools.a\n";
+    print $makefp "COMMONOBJS = ";
+    foreach my $cFile (@libFiles)
+    {
+        my $oFile = $cFile;
+        $oFile =~ s/\.c$/.o/;
+        print $makefp "$oFile ";
+    }
+    print $makefp "\n";
+    print $makefp "COMMONHDRS = $::commondir/*.h\n";
+}
+
+#*************************************************************************
+# Write the name of the multi-call program and the list of programs
+# compiled for it
+#
+# 15.10.26 Original   By: ACRM
+sub WriteMultiTargets
+{
+    my ($makefp, @exeFiles) = @_;
+    print $makefp "MULTICALL  = $::multiexe\n";
+    print $makefp "MULTIOBJS  = ";
+    foreach my $exe (@exeFiles)
+    {
+        print $makefp "$::multidir/$exe.o ";
+    }
+    print $makefp "\n";
+}
+
 #*************************************************************************
 # Build a list of target excutables by remove the extensions from the
 # C source files
@@ -0,0 +1,398 @@
+/************************************************************************/
+/**
+
+   \file       bioptools.c
+
+   \version    V1.1
+   \date       15.10.26
+   \brief      Multi-call program running any of the BiopTools programs
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   A single executable containing all the BiopTools programs. The
+   program to run is taken from the name bioptools is called by (so it
+   may be linked to pdbhstrip, etc.) or from the first argument.
+
+   bioptools pipe runs a pipeline of programs in one process. The PDB
+   file is read once, each stage works on the structure in memory, and
+   the result is written once at the end, rather than each program in
+   a shell pipeline writing and re-reading PDB format text.
+
+   Each program is compiled with main() renamed to <program>_main()
+   and all its other symbols made local (see makemake.pl). tools.h is
+   written by the Makefile and lists the programs as TOOL(name). Since
+   this needs GNU objcopy, the program is only built by
+   'make bioptools'.
+
+**************************************************************************
+
+   Usage:
+   ======
+   bioptools program [args...]
+   bioptools pipe [-i in.pdb] [-o out.pdb] program [args] 
+                  [-- program [args]]...
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 pipe reads the PDB file with ReadMappedWholePDB() so
+                  binary cache files may be used
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/pdb.h"
+#include "bioplib/general.h"
+#include "common/mappdb.h"
+#include "stages.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF   160
+#define STAGESEP  "--"
+
+typedef struct
+{
+   char *name;
+   int  (*func)(int argc, char **argv);
+}  TOOLMAIN;
+
+/************************************************************************/
+/* Prototypes
+*/
+#define TOOL(x) int x##_main(int argc, char **argv);
+#include "tools.h"
+#undef TOOL
+
+int  main(int argc, char **argv);
+TOOLMAIN *FindTool(char *name);
+int  RunPipeline(int argc, char **argv);
+BOOL CheckPipeline(int argc, char **argv);
+BOOL ParsePipeFiles(int *argc, char ***argv, char *infile, char *outfile);
+void Usage(void);
+
+/************************************************************************/
+/* Globals
+*/
+static TOOLMAIN sTools[] =
+{
+#define TOOL(x) {#x, x##_main},
+#include "tools.h"
+#undef TOOL
+   {NULL, NULL}
+};
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program. Runs the program named by argv[0] or argv[1], or a
+   pipeline
+
+-  15.10.26 Original   By: ACRM
+*/
+int main(int argc, char **argv)
+{
+   TOOLMAIN *tool;
+   char     *progname;
+
+   /* Called through a link with the name of a program                  */
+   if((progname = strrchr(argv[0], '/'))!=NULL)
+      progname++;
+   else
+      progname = argv[0];
+
+   if((tool = FindTool(progname))!=NULL)
+      return((*tool->func)(argc, argv));
+
+   /* Otherwise the first argument says what to do                      */
+   if(argc < 2)
+   {
+      Usage();
+      return(1);
+   }
+
+   if(!strcmp(argv[1], "pipe"))
+      return(RunPipeline(argc-1, argv+1));
+
+   if(!strcmp(argv[1], "-h"))
+   {
+      Usage();
+      return(0);
+   }
+
+   if((tool = FindTool(argv[1]))!=NULL)
+      return((*tool->func)(argc-1, argv+1));
+
+   fprintf(stderr,"bioptools: (error) Unknown program, %s\n", argv[1]);
+   return(1);
+}
+
+/************************************************************************/
+/*>TOOLMAIN *FindTool(char *name)
+   ------------------------------
+*//**
+
+   \param[in]      *name    Program name
+   \return                  The program (NULL if not found)
+
+-  15.10.26 Original   By: ACRM
+*/
+TOOLMAIN *FindTool(char *name)
+{
+   int i;
+
+   for(i=0; sTools[i].name != NULL; i++)
+   {
+      if(!strcmp(sTools[i].name, name))
+         return(&(sTools[i]));
+   }
+   return(NULL);
+}
+
+/************************************************************************/
+/*>int RunPipeline(int argc, char **argv)
+   --------------------------------------
+*//**
+
+   \param[in]      argc     Argument count (argv[0] is "pipe")
+   \param[in]      **argv   Arguments
+   \return                  Exit status
+
+   Reads a PDB file, runs each stage on it in turn and writes the
+   result. Stages are separated by STAGESEP. All the stages are checked
+   before the input is read.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Uses ReadMappedWholePDB()
+*/
+int RunPipeline(int argc, char **argv)
+{
+   FILE     *in  = stdin,
+            *out = stdout;
+   WHOLEPDB *wpdb;
+   STAGE    *stage;
+   char     infile[MAXBUFF],
+            outfile[MAXBUFF];
+   int      nargs;
+
+   argc--;
+   argv++;
+
+   if(!ParsePipeFiles(&argc, &argv, infile, outfile) ||
+      !CheckPipeline(argc, argv))
+   {
+      Usage();
+      return(1);
+   }
+
+   if(!blOpenStdFiles(infile, outfile, &in, &out))
+   {
+      fprintf(stderr,"bioptools: (error) Unable to open input or output \
+file\n");
+      return(1);
+   }
+
+   if(((wpdb = ReadMappedWholePDB(in))==NULL) || (wpdb->pdb == NULL))
+   {
+      fprintf(stderr,"bioptools: (error) No atoms read from PDB file\n");
+      return(1);
+   }
+
+   while(argc)
+   {
+      /* Find the arguments for this stage                              */
+      for(nargs=0; (nargs<argc) && strcmp(argv[nargs], STAGESEP); nargs++);
+
+      stage = FindStage(argv[0]);
+      if(!(*stage->func)(wpdb, nargs, argv))
+      {
+         fprintf(stderr,"bioptools: (error) Pipeline stage %s failed\n",
+                 argv[0]);
+         return(1);
+      }
+
+      /* Skip the arguments and the separator                           */
+      argc -= nargs;
+      argv += nargs;
+      if(argc)
+      {
+         argc--;
+         argv++;
+      }
+   }
+
+   blWriteWholePDB(out, wpdb);
+   return(0);
+}
+
+/************************************************************************/
+/*>BOOL CheckPipeline(int argc, char **argv)
+   -----------------------------------------
+*//**
+
+   \param[in]      argc     Argument count
+   \param[in]      **argv   Stages and their arguments
+   \return                  Are all the stages known?
+
+   Checks that there is at least one stage and that each is one that
+   can be run in a pipeline
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL CheckPipeline(int argc, char **argv)
+{
+   BOOL stageStart = TRUE;
+
+   if(argc == 0)
+      return(FALSE);
+
+   for(; argc; argc--, argv++)
+   {
+      if(!strcmp(argv[0], STAGESEP))
+      {
+         if(stageStart)
+            return(FALSE);
+         stageStart = TRUE;
+      }
+      else if(stageStart)
+      {
+         if(FindStage(argv[0]) == NULL)
+         {
+            fprintf(stderr,"bioptools: (error) %s cannot be used in a \
+pipeline\n", argv[0]);
+            return(FALSE);
+         }
+         stageStart = FALSE;
+      }
+   }
+
+   return((BOOL)!stageStart);
+}
+
+/************************************************************************/
+/*>BOOL ParsePipeFiles(int *argc, char ***argv, char *infile, 
+                       char *outfile)
+   ----------------------------------------------------------
+*//**
+
+   \param[in,out]  *argc     Argument count
+   \param[in,out]  ***argv   Arguments
+   \param[out]     *infile   Input filename (or blank string)
+   \param[out]     *outfile  Output filename (or blank string)
+   \return                   Success
+
+   Reads the -i and -o options that come before the first stage
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL ParsePipeFiles(int *argc, char ***argv, char *infile, char *outfile)
+{
+   infile[0] = outfile[0] = '\0';
+
+   while(*argc && ((*argv)[0][0] == '-'))
+   {
+      switch((*argv)[0][1])
+      {
+      case 'i':
+         if(!(--(*argc)))
+            return(FALSE);
+         (*argv)++;
+         strncpy(infile, (*argv)[0], MAXBUFF);
+         infile[MAXBUFF-1] = '\0';
+         break;
+      case 'o':
+         if(!(--(*argc)))
+            return(FALSE);
+         (*argv)++;
+         strncpy(outfile, (*argv)[0], MAXBUFF);
+         outfile[MAXBUFF-1] = '\0';
+         break;
+      default:
+         return(FALSE);
+      }
+      (*argc)--;
+      (*argv)++;
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+   Prints a usage message
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 V1.1
+*/
+void Usage(void)
+{
+   int i;
+
+   fprintf(stderr,"\nbioptools V1.1 (c) 2026 UCL, Dr. Andrew C.R. \
+Martin\n");
+   fprintf(stderr,"\nUsage: bioptools program [args...]\n");
+   fprintf(stderr,"       bioptools pipe [-i in.pdb] [-o out.pdb] \
+program [args]\n");
+   fprintf(stderr,"                      [%s program [args]]...\n",
+           STAGESEP);
+
+   fprintf(stderr,"\nRuns any of the BiopTools programs. bioptools may \
+also be linked to\n");
+   fprintf(stderr,"the name of a program and run by that name.\n");
+
+   fprintf(stderr,"\nWith pipe, the programs are run one after another on \
+the same structure\n");
+   fprintf(stderr,"in memory: the PDB file is read once and the result \
+written once. This\n");
+   fprintf(stderr,"is the same as a shell pipeline of the programs. \
+Input and output are\n");
+   fprintf(stderr,"through standard input/output if -i and -o are not \
+given. The programs\n");
+   fprintf(stderr,"which may be used in a pipeline are:\n");
+   ListStages(stderr);
+
+   fprintf(stderr,"\nPrograms:");
+   for(i=0; sTools[i].name != NULL; i++)
+      fprintf(stderr,"%s%s", (i%5 ? " " : "\n   "), sTools[i].name);
+   fprintf(stderr,"\n\n");
+}
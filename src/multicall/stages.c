@@ -0,0 +1,371 @@
+/************************************************************************/
+/**
+
+   \file       stages.c
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      In-process pipeline stages for the bioptools multi-call program
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Each stage does the work of one of the programs on a WHOLEPDB
+   structure that has already been read, so that a pipeline such as
+
+      pdbhstrip | pdbgetchain A | pdbsolv
+
+   can be run by bioptools as a single process with the PDB file read
+   once at the start and written once at the end.
+
+   The stages take the same options as the equivalent programs, but
+   not the input and output filenames.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 The pdbhetstrip and pdbsolv stages call the same code
+                  as the programs in common/
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/macros.h"
+#include "bioplib/pdb.h"
+#include "bioplib/access.h"
+#include "bioplib/general.h"
+#include "bioplib/array.h"
+#include "common/chainsel.h"
+#include "common/hetstrip.h"
+#include "common/solvcalc.h"
+#include "stages.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF          160
+#define MAXCHAINLABEL      8
+
+/************************************************************************/
+/* Globals
+*/
+static STAGE sStages[] =
+{
+   {"pdbhstrip",   "",                              StageHStrip},
+   {"pdbhetstrip", "",                              StageHetStrip},
+   {"pdbgetchain", "[-n] chain[,chain[...]]",       StageGetChain},
+   {"pdborigin",   "",                              StageOrigin},
+   {"pdbsolv",     "[-i val] [-p val] [-f radfile] [-c]",
+                                                    StageSolv},
+   {NULL,          NULL,                            NULL}
+};
+
+/************************************************************************/
+/* Prototypes
+*/
+static int CountAtoms(PDB *pdb);
+
+/************************************************************************/
+/*>STAGE *FindStage(char *name)
+   ----------------------------
+*//**
+
+   \param[in]      *name    Program name
+   \return                  The stage (NULL if there isn't one)
+
+   Finds the pipeline stage for a program
+
+-  15.10.26 Original   By: ACRM
+*/
+STAGE *FindStage(char *name)
+{
+   int i;
+
+   for(i=0; sStages[i].name != NULL; i++)
+   {
+      if(!strcmp(sStages[i].name, name))
+         return(&(sStages[i]));
+   }
+   return(NULL);
+}
+
+/************************************************************************/
+/*>void ListStages(FILE *fp)
+   -------------------------
+*//**
+
+   \param[in]      *fp      Output file
+
+   Lists the available pipeline stages and their arguments
+
+-  15.10.26 Original   By: ACRM
+*/
+void ListStages(FILE *fp)
+{
+   int i;
+
+   for(i=0; sStages[i].name != NULL; i++)
+      fprintf(fp, "   %-12s %s\n", sStages[i].name, sStages[i].args);
+}
+
+/************************************************************************/
+/*>BOOL StageHStrip(WHOLEPDB *wpdb, int argc, char **argv)
+   -------------------------------------------------------
+*//**
+
+   \param[in,out]  *wpdb    Whole PDB structure
+   \param[in]      argc     Argument count
+   \param[in]      **argv   Arguments
+   \return                  Success
+
+   Removes hydrogens as done by pdbhstrip
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL StageHStrip(WHOLEPDB *wpdb, int argc, char **argv)
+{
+   PDB *pdbout;
+   int natoms;
+
+   if(argc > 1)
+      return(FALSE);
+
+   if((pdbout = blStripHPDBAsCopy(wpdb->pdb, &natoms))==NULL)
+   {
+      fprintf(stderr,"pdbhstrip: (error) No memory to strip \
+hydrogens\n");
+      return(FALSE);
+   }
+
+   FREELIST(wpdb->pdb, PDB);
+   wpdb->pdb    = pdbout;
+   wpdb->natoms = natoms;
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>BOOL StageHetStrip(WHOLEPDB *wpdb, int argc, char **argv)
+   ---------------------------------------------------------
+*//**
+
+   \param[in,out]  *wpdb    Whole PDB structure
+   \param[in]      argc     Argument count
+   \param[in]      **argv   Arguments
+   \return                  Success
+
+   Removes HETATM records as done by pdbhetstrip
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Uses StripHetAtoms()
+*/
+BOOL StageHetStrip(WHOLEPDB *wpdb, int argc, char **argv)
+{
+   if(argc > 1)
+      return(FALSE);
+
+   StripHetAtoms(wpdb);
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>BOOL StageGetChain(WHOLEPDB *wpdb, int argc, char **argv)
+   ---------------------------------------------------------
+*//**
+
+   \param[in,out]  *wpdb    Whole PDB structure
+   \param[in]      argc     Argument count
+   \param[in]      **argv   Arguments
+   \return                  Success
+
+   Keeps only the specified chains as done by pdbgetchain
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL StageGetChain(WHOLEPDB *wpdb, int argc, char **argv)
+{
+   char **chains;
+   BOOL numeric = FALSE;
+
+   argc--;
+   argv++;
+
+   if(argc && !strcmp(argv[0], "-n"))
+   {
+      numeric = TRUE;
+      argc--;
+      argv++;
+   }
+   if(argc != 1)
+      return(FALSE);
+
+   if((chains = blSplitStringOnCommas(argv[0], MAXCHAINLABEL))==NULL)
+   {
+      fprintf(stderr,"pdbgetchain: (error) No memory for storing chain \
+labels: %s\n", argv[0]);
+      return(FALSE);
+   }
+
+   SelectPDBChains(wpdb, chains, numeric);
+   wpdb->natoms = CountAtoms(wpdb->pdb);
+
+   if(wpdb->pdb == NULL)
+   {
+      fprintf(stderr,"pdbgetchain: (error) No atoms left after selecting \
+chains\n");
+      return(FALSE);
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>BOOL StageOrigin(WHOLEPDB *wpdb, int argc, char **argv)
+   -------------------------------------------------------
+*//**
+
+   \param[in,out]  *wpdb    Whole PDB structure
+   \param[in]      argc     Argument count
+   \param[in]      **argv   Arguments
+   \return                  Success
+
+   Moves the structure to the origin as done by pdborigin
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL StageOrigin(WHOLEPDB *wpdb, int argc, char **argv)
+{
+   if(argc > 1)
+      return(FALSE);
+
+   blOriginPDB(wpdb->pdb);
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>BOOL StageSolv(WHOLEPDB *wpdb, int argc, char **argv)
+   -----------------------------------------------------
+*//**
+
+   \param[in,out]  *wpdb    Whole PDB structure
+   \param[in]      argc     Argument count
+   \param[in]      **argv   Arguments
+   \return                  Success
+
+   Calculates accessibility and stores it in the B-value column as done
+   by pdbsolv. Waters are removed.
+
+-  15.10.26 Original   By: ACRM
+-  15.10.26 Uses OpenRadiusFile() and CalcWholePDBAccess()
+*/
+BOOL StageSolv(WHOLEPDB *wpdb, int argc, char **argv)
+{
+   FILE   *fpRad;
+   REAL   integrationAccuracy = ACCESS_DEF_INTACC,
+          probeRadius         = DEF_PROBERADIUS;
+   BOOL   doAccessibility     = TRUE,
+          ok;
+   char   radfile[MAXBUFF];
+
+   strcpy(radfile, DEF_RADFILE);
+
+   for(argc--, argv++; argc; argc--, argv++)
+   {
+      if(argv[0][0] != '-')
+         return(FALSE);
+
+      switch(argv[0][1])
+      {
+      case 'i':
+         if(!(--argc) || !sscanf((++argv)[0],"%lf",&integrationAccuracy))
+            return(FALSE);
+         break;
+      case 'p':
+         if(!(--argc) || !sscanf((++argv)[0],"%lf",&probeRadius))
+            return(FALSE);
+         break;
+      case 'f':
+         if(!(--argc))
+            return(FALSE);
+         strncpy(radfile,(++argv)[0],MAXBUFF);
+         radfile[MAXBUFF-1] = '\0';
+         break;
+      case 'c':
+         doAccessibility = FALSE;
+         break;
+      default:
+         return(FALSE);
+      }
+   }
+
+   if((fpRad=OpenRadiusFile(radfile))==NULL)
+      return(FALSE);
+
+   ok = CalcWholePDBAccess(wpdb, fpRad, integrationAccuracy, probeRadius,
+                           doAccessibility, NULL);
+   fclose(fpRad);
+
+   if(ok)
+      PopulateBValWithAccess(wpdb->pdb);
+
+   return(ok);
+}
+
+/************************************************************************/
+/*>static int CountAtoms(PDB *pdb)
+   -------------------------------
+*//**
+
+   \param[in]      *pdb     PDB linked list
+   \return                  Number of atoms
+
+-  15.10.26 Original   By: ACRM
+*/
+static int CountAtoms(PDB *pdb)
+{
+   PDB *p;
+   int natoms = 0;
+
+   for(p=pdb; p!=NULL; NEXT(p))
+      natoms++;
+
+   return(natoms);
+}
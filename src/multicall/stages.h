@@ -0,0 +1,75 @@
+/************************************************************************/
+/**
+
+   \file       stages.h
+
+   \version    V1.0
+   \date       15.10.26
+   \brief      In-process pipeline stages for the bioptools multi-call program
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+
+*************************************************************************/
+#ifndef _BIOPTOOLS_STAGES_H
+#define _BIOPTOOLS_STAGES_H
+
+/************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include "bioplib/SysDefs.h"
+#include "bioplib/pdb.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+/* A stage modifies the structure in place. argv[0] is the stage name  */
+typedef BOOL (*STAGEFUNC)(WHOLEPDB *wpdb, int argc, char **argv);
+
+typedef struct
+{
+   char      *name,         /* Name of the equivalent program           */
+             *args;         /* Summary of the arguments taken           */
+   STAGEFUNC func;
+}  STAGE;
+
+/************************************************************************/
+/* Prototypes
+*/
+STAGE *FindStage(char *name);
+void ListStages(FILE *fp);
+BOOL StageHStrip(WHOLEPDB *wpdb, int argc, char **argv);
+BOOL StageHetStrip(WHOLEPDB *wpdb, int argc, char **argv);
+BOOL StageGetChain(WHOLEPDB *wpdb, int argc, char **argv);
+BOOL StageOrigin(WHOLEPDB *wpdb, int argc, char **argv);
+BOOL StageSolv(WHOLEPDB *wpdb, int argc, char **argv);
+
+#endif
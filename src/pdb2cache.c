@@ -0,0 +1,308 @@
+/************************************************************************/
+/**
+
+   \file       pdb2cache.c
+
+   \version    V1.3
+   \date       15.10.26
+   \brief      Convert PDB files to binary cache files
+
+   \copyright  (c) Dr. Andrew C. R. Martin 2026
+   \author     Dr. Andrew C. R. Martin
+   \par
+               Institute of Structural and Molecular Biology,
+               University College,
+               Gower Street,
+               London.
+               WC1E 6BT.
+   \par
+               andrew@bioinf.org.uk
+               andrew.martin@ucl.ac.uk
+
+**************************************************************************
+
+   This code is NOT IN THE PUBLIC DOMAIN, but it may be copied
+   according to the conditions laid out in the accompanying file
+   COPYING.DOC.
+
+   The code may be modified as required, but any modifications must be
+   documented so that the person responsible can be identified.
+
+   The code may not be sold commercially or included as part of a
+   commercial product except as described in the file COPYING.DOC.
+
+**************************************************************************
+
+   Description:
+   ============
+   Writes a PDB file as a binary cache file (see common/pdbcache.c).
+   Programs which read PDB files with ReadMappedPDB() or
+   ReadMappedWholePDB() read cache files directly, without parsing any
+   text, so structures which are used many times need only be parsed
+   once. Other programs report an error if they are given a cache
+   file. Cache files are in native byte order and so are not portable
+   between different kinds of machine.
+
+**************************************************************************
+
+   Usage:
+   ======
+
+**************************************************************************
+
+   Revision History:
+   =================
+-  V1.0  15.10.26 Original
+-  V1.1  15.10.26 Usage message lists the programs which read cache
+                  files
+-  V1.2  15.10.26 Cache files written with -d are named .cache
+-  V1.3  15.10.26 Usage message says that other programs reject cache
+                  files
+
+*************************************************************************/
+/* Includes
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "bioplib/macros.h"
+#include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
+#include "bioplib/pdb.h"
+#include "bioplib/general.h"
+#include "common/mappdb.h"
+#include "common/pdbcache.h"
+#include "common/batch.h"
+
+/************************************************************************/
+/* Defines and macros
+*/
+#define MAXBUFF 160
+
+/************************************************************************/
+/* Globals
+*/
+
+/************************************************************************/
+/* Prototypes
+*/
+int  main(int argc, char **argv);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  char *listfile, char *outdir);
+void Usage(void);
+BOOL CacheFile(FILE *in, FILE *out, char *infile, void *data);
+
+/************************************************************************/
+/*>int main(int argc, char **argv)
+   -------------------------------
+*//**
+
+   Main program for writing binary cache files
+
+-  15.10.26 Original    By: ACRM
+*/
+int main(int argc, char **argv)
+{
+   FILE *in  = stdin,
+        *out = stdout;
+   char infile[MAXBUFF],
+        outfile[MAXBUFF],
+        listfile[MAXBUFF],
+        outdir[MAXBUFF];
+   int  nfail;
+
+   if(ParseCmdLine(argc, argv, infile, outfile, listfile, outdir))
+   {
+      if(listfile[0])
+      {
+         if((nfail = RunBatchExt(listfile, outdir, ".cache", NULL,
+                                 CacheFile, NULL)) < 0)
+         {
+            fprintf(stderr,"Unable to read list file, %s\n", listfile);
+            return(1);
+         }
+         if(nfail)
+         {
+            fprintf(stderr,"%d files could not be cached\n", nfail);
+            return(1);
+         }
+      }
+      else if(blOpenStdFiles(infile, outfile, &in, &out))
+      {
+         if(!CacheFile(in, out, infile, NULL))
+            return(1);
+      }
+      else
+      {
+         Usage();
+         return(1);
+      }
+   }
+   else
+   {
+      Usage();
+      return(1);
+   }
+
+   return(0);
+}
+
+/************************************************************************/
+/*>BOOL CacheFile(FILE *in, FILE *out, char *infile, void *data)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]      *in         Input PDB file
+   \param[in]      *out        Output cache file
+   \param[in]      *infile     Input filename
+   \param[in]      *data       Unused
+   \return                     Success
+
+   Reads a PDB file and writes it as a binary cache. Called directly or
+   for each file by RunBatchExt()
+
+-  15.10.26 Original   By: ACRM
+*/
+BOOL CacheFile(FILE *in, FILE *out, char *infile, void *data)
+{
+   WHOLEPDB *wpdb;
+   BOOL     ok;
+
+   if(((wpdb = ReadMappedWholePDB(in))==NULL) || (wpdb->pdb == NULL))
+   {
+      fprintf(stderr,"No atoms read from input file %s\n", infile);
+      if(wpdb != NULL)
+         blFreeWholePDB(wpdb);
+      return(FALSE);
+   }
+
+   if(!(ok = WritePDBCache(out, wpdb)))
+      fprintf(stderr,"Unable to write cache for %s\n", infile);
+
+   blFreeWholePDB(wpdb);
+   return(ok);
+}
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     char *listfile, char *outdir)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]      argc        Argument count
+   \param[in]      **argv      Argument array
+   \param[out]     *infile     Input filename (or blank string)
+   \param[out]     *outfile    Output filename (or blank string)
+   \param[out]     *listfile   File listing input files (or blank
+                               string)
+   \param[out]     *outdir     Output directory (or blank string)
+   \return                     Success
+
+   Parse the command line. A list of files needs an output directory
+   since the cache files cannot be written to a single stream.
+
+-  15.10.26 Original    By: ACRM
+*/
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  char *listfile, char *outdir)
+{
+   argc--;
+   argv++;
+
+   infile[0] = outfile[0] = listfile[0] = outdir[0] = '\0';
+
+   while(argc)
+   {
+      if(argv[0][0] == '-')
+      {
+         switch(argv[0][1])
+         {
+         case 'h':
+            return(FALSE);
+            break;
+         case 'l':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(listfile, argv[0], MAXBUFF);
+            listfile[MAXBUFF-1] = '\0';
+            break;
+         case 'd':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(outdir, argv[0], MAXBUFF);
+            outdir[MAXBUFF-1] = '\0';
+            break;
+         default:
+            return(FALSE);
+            break;
+         }
+      }
+      else
+      {
+         /* With a list of files, no other filenames may be given       */
+         if(listfile[0])
+            return(FALSE);
+
+         /* Check that there are only 1 or 2 arguments left             */
+         if(argc > 2)
+            return(FALSE);
+
+         /* Copy the first to infile                                    */
+         strcpy(infile, argv[0]);
+
+         /* If there's another, copy it to outfile                      */
+         argc--;
+         argv++;
+         if(argc)
+            strcpy(outfile, argv[0]);
+
+         return(TRUE);
+      }
+      argc--;
+      argv++;
+   }
+
+   /* -l and -d must be used together                                   */
+   return((BOOL)((listfile[0] == '\0') == (outdir[0] == '\0')));
+}
+
+/************************************************************************/
+/*>void Usage(void)
+   ----------------
+*//**
+
+   Print a usage message
+
+-  15.10.26 Original    By: ACRM
+-  15.10.26 V1.1 Lists the programs which read cache files
+-  15.10.26 V1.2
+-  15.10.26 V1.3
+*/
+void Usage(void)
+{
+   fprintf(stderr,"\npdb2cache V1.3 (c) 2026 Dr. Andrew C.R. Martin, \
+UCL\n");
+   fprintf(stderr,"\nUsage: pdb2cache [in.pdb [out.cache]]\n");
+   fprintf(stderr,"       pdb2cache -l listfile -d outdir\n");
+   fprintf(stderr,"       -l  Convert each of the PDB files listed in \
+listfile ('-' for stdin)\n");
+   fprintf(stderr,"       -d  Write each cache file to outdir, named \
+as the PDB file but with\n");
+   fprintf(stderr,"           a .cache extension\n\n");
+   fprintf(stderr,"If files are not specified, stdin and stdout are \
+used.\n");
+   fprintf(stderr,"Converts a PDB file to a binary cache file. \
+Cache files are read directly by\n");
+   fprintf(stderr,"cache2pdb, pdb2xyz, pdbatoms, pdbcount, pdbgetchain \
+(except with -a),\n");
+   fprintf(stderr,"pdbhbond, pdbhstrip, pdbrenum, pdbsolv and \
+'bioptools pipe' when they are\n");
+   fprintf(stderr,"given as files rather than through a pipe. Other \
+programs report an error if\n");
+   fprintf(stderr,"they are given a cache file.\n");
+   fprintf(stderr,"Cache files are specific to the type of machine on \
+which they are written.\n");
+   fprintf(stderr,"Use cache2pdb to convert back to PDB format.\n\n");
+}
@@ -3,11 +3,11 @@
 
    \file       pdb2ms.c
    
-   \version    V1.3
-   \date       22.07.14
+   \version    V1.4
+   \date       15.10.26
    \brief      Create input file for Connoly MS program
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1996-2014
+   \copyright  (c) Dr. Andrew C. R. Martin 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -62,6 +62,7 @@
                   Can take atom types or radii from the PDB file
 -  V1.3  22.07.14 Renamed deprecated functions with bl prefix.
                   Added doxygen annotation. By: CTP
+-  V1.4  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -73,6 +74,7 @@
 #include "bioplib/SysDefs.h"
 #include "bioplib/MathType.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -135,6 +137,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(InFile, OutFile, &in, &out))
       {
+         if(IsPDBCache(in, "pdb2ms"))
+            return(1);
          if((pdb = blReadPDB(in, &natoms))==NULL)
          {
             fprintf(stderr,"No atoms read from PDB file\n");
@@ -257,10 +261,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  29.01.95 V1.1
 -  01.02.96 V1.2
 -  22.07.14 V1.3 By: CTP
+-  15.10.26 V1.4
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2ms V1.3 (c)1996-2014, Dr. Andrew C.R. Martin, UCL\n");
+   fprintf(stderr,"\npdb2ms V1.4 (c)1996-2026, Dr. Andrew C.R. Martin, UCL\n");
    fprintf(stderr,"\nUsage: pdb2ms [-s] [-a] [-q] [in.pdb [out.ms]]\n");
    fprintf(stderr,"       -s Write standard data files as well\n");
    fprintf(stderr,"       -a Use alternate atom type radii (as used by \
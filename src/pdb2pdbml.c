@@ -3,11 +3,11 @@
 
    \file       pdb2pdbml.c
    
-   \version    V1.0
-   \date       26.02.15
+   \version    V1.1
+   \date       15.10.26
    \brief      Convert PDB format to PDBML
    
-   \copyright  (c) Dr. Andrew C. R. Martin 2015
+   \copyright  (c) Dr. Andrew C. R. Martin 2015-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -47,6 +47,7 @@
    Revision History:
    =================
 -  V1.0  26.02.15 Original
+-  V1.1  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -55,6 +56,7 @@
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -93,6 +95,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdb2pdbml"))
+            return(1);
          if((wpdb=blReadWholePDB(in))!=NULL)
          {
             FORCEXML;
@@ -121,10 +125,11 @@ int main(int argc, char **argv)
    Prints a usage message
 
 -  26.02.15 Original    By: ACRM
+-  15.10.26 V1.1
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2pdbml V1.0  (c) 2015 UCL, Andrew C.R. \
+   fprintf(stderr,"\npdb2pdbml V1.1  (c) 2015-2026 UCL, Andrew C.R. \
 Martin\n");
    fprintf(stderr,"Usage: pdb2pdbml [<input.pdb> [<output.pdb>]]\n");
    fprintf(stderr,"I/O is to stdin/stdout if not specified\n\n");
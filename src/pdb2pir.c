@@ -3,11 +3,11 @@
 
    \file       pdb2pir.c
    
-   \version    V2.13
-   \date       10.03.15
+   \version    V2.15
+   \date       15.10.26
    \brief      Convert PDB to PIR sequence file
    
-   \copyright  (c) Dr. Andrew C. R. Martin, UCL 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin, UCL 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure and Modelling,
@@ -74,6 +74,7 @@
 -  V2.12 25.11.14 Initialized a variable  By: ACRM
 -  V2.13 10.03.15 Improved multi-character chain support
 -  V2.14 11.06.15 Moved generally useful code into Bioplib
+-  V2.15 15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -89,6 +90,7 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbcache.h"
 
 
 /************************************************************************/
@@ -283,6 +285,9 @@ int main(int argc, char **argv)
       argv++;
    }
 
+   if(IsPDBCache(in, "pdb2pir"))
+      return(1);
+
    /* Read PDB file                                                     */
    if(((wpdb = blReadWholePDBAtoms(in)) == NULL)||(wpdb->pdb==NULL))
    {
@@ -412,10 +417,11 @@ int main(int argc, char **argv)
 -  25.11.14 V2.12
 -  10.03.15 V2.13
 -  11.06.15 V2.14
+-  15.10.26 V2.15
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2pir V2.14 (c) 1994-2015 Dr. Andrew C.R. Martin, \
+   fprintf(stderr,"\npdb2pir V2.15 (c) 1994-2026 Dr. Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"\nUsage: pdb2pir [-h][-l label][-t title][-s][-c][-x]\
 [-u][-p][-q]\n");
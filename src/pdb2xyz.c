@@ -3,7 +3,7 @@
 
    \file       pdb2xyz.c
    
-   \version    V1.1
+   \version    V1.2
    \date       22.07.14
    \brief      Convert PDB to Gromos XYZ
    
@@ -49,6 +49,7 @@
 -  V1.0  23.08.94 Original   By: ACRM
 -  V1.1  22.07.14 Renamed deprecated functions with bl prefix.
                   Added doxygen annotation. By: CTP
+-  V1.2  15.10.26 Reads the PDB file with ReadMappedPDB()  By: ACRM
 
 *************************************************************************/
 /* Includes
@@ -61,6 +62,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/mappdb.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -90,6 +92,7 @@ void WriteXYZ(FILE *out, PDB *pdb, int natoms, char *title);
 -  23.08.94 Original    By: ACRM
 -  24.08.94 Changed to call OpenStdFiles()
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  15.10.26 Uses ReadMappedPDB()   By: ACRM
 */
 int main(int argc, char **argv)
 {
@@ -98,16 +101,16 @@ int main(int argc, char **argv)
    char infile[MAXBUFF],
         outfile[MAXBUFF],
         title[MAXBUFF];
-   PDB  *pdb;
-   int  natoms;
+   MAPPEDPDB *mpdb;
    
    if(ParseCmdLine(argc, argv, infile, outfile, title))
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb = blReadPDB(in,&natoms)) != NULL)
+         if((mpdb = ReadMappedPDB(in)) != NULL)
          {
-            WriteXYZ(out, pdb, natoms, title);
+            WriteXYZ(out, mpdb->pdb, mpdb->natoms, title);
+            FreeMappedPDB(mpdb);
          }
          else
          {
@@ -199,10 +202,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 
 -  23.08.94 Original    By: ACRM
 -  22.07.14 V1.1 By: CTP
+-  15.10.26 V1.2 By: ACRM
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdb2xyz V1.1 (c) 1994-2014, Andrew C.R. Martin, UCL\n");
+   fprintf(stderr,"\npdb2xyz V1.2 (c) 1994-2026, Andrew C.R. Martin, UCL\n");
    fprintf(stderr,"Usage: pdb2xyz [-t title] [<in.pdb>] [<out.pdb>]\n\n");
    fprintf(stderr,"Convert PDB format to GROMOS XYZ. N.B. Does NOT \
 correct atom order.\n\n");
@@ -3,11 +3,11 @@
 
    \file       pdbaddhet.c
    
-   \version    V2.4
-   \date       12.02.15
+   \version    V2.5
+   \date       15.10.26
    \brief      Add HETATMs back into a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 2002-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 2002-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -52,6 +52,7 @@
 -  V2.2  06.11.14    Changed name from addhet to pdbaddhet
 -  V2.3  25.11.14    Initialized a variable  By: ACRM
 -  V2.4  12.02.15    Updated usage message
+-  V2.5  15.10.26    Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes */
@@ -60,6 +61,7 @@
 #include <stdlib.h>
 #include "bioplib/macros.h"
 #include "bioplib/pdb.h"
+#include "common/pdbcache.h"
 
 /***********************************************************************/
 /* Prototypes */
@@ -96,7 +98,7 @@ int main (int argc, char *argv[])
    /* check correct number of files are specified on command line */
    if(argc !=4)
    {
-      fprintf(stderr, "\npdbaddhet V2.4 (c) 2002-2015, UCL, \
+      fprintf(stderr, "\npdbaddhet V2.5 (c) 2002-2026, UCL, \
 Dr. Andrew C.R. Martin\n\n");
       fprintf(stderr, "Usage: pdbaddhet whole.pdb part.pdb \
 out.pdb\n");
@@ -134,6 +136,9 @@ SCOP\n\n");
    }
    
    
+   if(IsPDBCache(fp1, "pdbaddhet") || IsPDBCache(fp2, "pdbaddhet"))
+      exit(1);
+
    if((pdbDomain =  blReadPDB(fp2, &natoms))!=NULL)
    {
       DetermineBoundingBox(pdbDomain, &xmin, &xmax, &ymin, &ymax,  
@@ -3,12 +3,12 @@
 
    \file       pdbatomcount.c
    
-   \version    V1.8
-   \date       12.03.15
+   \version    V1.14
+   \date       15.10.26
    \brief      Count atoms neighbouring each atom in a PDB file
                Results output in B-val column
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -58,6 +58,18 @@
 -  V1.6  06.11.14 Renamed from atomcount
 -  V1.7  12.02.15 Uses WholePDB
 -  V1.8  12.03.15 Changed to use CHAINMATCH()
+-  V1.9  15.10.26 Atom neighbour counting uses a cell-list grid rather
+                  than comparing every pair of atoms
+-  V1.10 15.10.26 Residue contacts use a residue table with bounding
+                  spheres and a grid of residue centres rather than
+                  walking the linked list for each residue pair
+-  V1.11 15.10.26 -r takes a comma-separated list of radii. With more
+                  than one radius, the counts for all radii are found in
+                  a single pass and written as a table
+-  V1.12 15.10.26 Added -j to split the counting across threads
+-  V1.13 15.10.26 Cell-list grid and residue table moved to
+                  common/cellgrid.c
+-  V1.14 15.10.26 Reports an error for a binary cache file
 
 
 *************************************************************************/
@@ -65,13 +77,17 @@
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/MathType.h"
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/cellgrid.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -80,12 +96,39 @@
 #define MAXCONTACT 160
 #define DEFRAD  ((REAL)5.0)
 #define DEFCRAD ((REAL)3.5)
+#define MAXRADII 32        /* Max number of radii given with -r         */
+#define MAXTHREADS 1024    /* Max number of threads given with -j       */
 #define TYP_ALL         0  /* Atom counting schemes                     */
 #define TYP_DIFFRES     1
 #define TYP_NONBOND     2
 #define TYP_CONTACT     3
 #define TYP_NORMCONTACT 4
 
+/* Block of atoms to be counted by one thread                           */
+typedef struct
+{
+   PDB      **atoms;    /* All atoms in linked list order               */
+   CELLGRID *grid;      /* Grid of atoms                                */
+   REAL     *RadSq,     /* Squared radii in ascending order             */
+            *counts;    /* Counts for all atoms                         */
+   int      nrad,
+            CountType,
+            first,      /* First atom in the block                      */
+            last;       /* Atom after the last atom in the block        */
+}  ATOMJOB;
+
+/* Block of residues to be tested for contacts by one thread            */
+typedef struct
+{
+   RESIDUE  *residues;  /* Residue table                                */
+   CELLGRID *grid;      /* Grid of residue centres                      */
+   REAL     *RadSq;     /* Squared cutoffs in ascending order           */
+   int      *contacts,  /* Contact counts for all residues for this job */
+            nrad,
+            first,      /* First residue in the block                   */
+            last;       /* Residue after the last in the block          */
+}  RESIDUEJOB;
+
 /************************************************************************/
 /* Globals
 */
@@ -95,11 +138,23 @@
 */
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  REAL *radius, int *CountType, BOOL *StripWater);
-void CountNeighbours(PDB *pdb, REAL radius, int CountType);
+                  REAL *radii, int *nrad, int *CountType, 
+                  BOOL *StripWater, int *nthreads);
+BOOL ParseRadii(char *list, REAL *radii, int *nrad);
+REAL *CountNeighbours(PDB *pdb, REAL *RadSq, int nrad, int CountType,
+                      int nthreads);
+void *CountAtomNeighbours(void *arg);
+void RunJobs(void *(*func)(void *), void *jobs, size_t jobSize, 
+             int njobs);
+void WriteCountTable(FILE *out, PDB *pdb, REAL *radii, int nrad, 
+                     REAL *counts);
 void Usage(void);
-void doResidueContacts(PDB *pdb, REAL RadSq, int CountType);
-BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr);
+REAL *doResidueContacts(PDB *pdb, REAL *RadSq, int nrad, 
+                        int CountType, int nthreads);
+void *CountResidueContacts(void *arg);
+BOOL ResSep(RESIDUE *residues, int i, int j);
+REAL ResContactDistSq(RESIDUE *res1, RESIDUE *res2, REAL MinRadSq, 
+                      REAL MaxRadSq);
 
 
 /************************************************************************/
@@ -115,6 +170,9 @@ BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr);
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  19.08.14 Fixed call to renamed function blStripWatersPDBAsCopy() 
             By: CTP
+-  15.10.26 Checks return from CountNeighbours()
+-  15.10.26 Handles multiple radii
+-  15.10.26 Added nthreads
 */
 int main(int argc, char **argv)
 {
@@ -122,20 +180,29 @@ int main(int argc, char **argv)
         *out = stdout;
    char infile[MAXBUFF],
         outfile[MAXBUFF];
-   REAL radius = DEFRAD;
-   PDB  *pdb;
-   int  CountType;
+   REAL radii[MAXRADII],
+        RadSq[MAXRADII],
+        *counts = NULL;
+   PDB  *pdb,
+        *p;
+   int  CountType,
+        nrad,
+        nthreads,
+        i;
    BOOL StripWater = TRUE;
    
-   if(ParseCmdLine(argc, argv, infile, outfile, &radius, &CountType,
-                   &StripWater))
+   if(ParseCmdLine(argc, argv, infile, outfile, radii, &nrad, &CountType,
+                   &StripWater, &nthreads))
    {
-      /* Square the radius to save on distance sqrt()s                  */
-      radius *= radius;
+      /* Square the radii to save on distance sqrt()s                   */
+      for(i=0; i<nrad; i++)
+         RadSq[i] = radii[i] * radii[i];
       
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
          WHOLEPDB *wpdb;
+         if(IsPDBCache(in, "pdbatomcount"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb = wpdb->pdb;
@@ -148,8 +215,33 @@ int main(int argc, char **argv)
                FREELIST(pdb, PDB);
                wpdb->pdb = pdb = pdb2;
             }
-            CountNeighbours(pdb, radius, CountType);
-            blWriteWholePDB(out, wpdb);
+            if(pdb != NULL)
+            {
+               if((counts = CountNeighbours(pdb, RadSq, nrad, CountType,
+                                            nthreads))==NULL)
+               {
+                  fprintf(stderr,"pdbatomcount: (error) No memory for \
+neighbour grid\n");
+                  return(1);
+               }
+            }
+
+            /* With multiple radii, write a table of counts. Otherwise
+               write the PDB file with the counts in the B-value column
+            */
+            if(nrad > 1)
+            {
+               WriteCountTable(out, pdb, radii, nrad, counts);
+            }
+            else
+            {
+               for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+                  p->bval = counts[i];
+               blWriteWholePDB(out, wpdb);
+            }
+
+            if(counts != NULL)
+               free(counts);
          }
          else
          {
@@ -167,7 +259,8 @@ int main(int argc, char **argv)
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                     REAL *radius, int *CountType, BOOL *StripWater)
+                     REAL *radii, int *nrad, int *CountType, 
+                     BOOL *StripWater, int *nthreads)
    ---------------------------------------------------------------------
 *//**
 
@@ -175,9 +268,11 @@ int main(int argc, char **argv)
    \param[in]      **argv       Argument array
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
-   \param[out]     *radius      Neighbour radius
+   \param[out]     *radii       Neighbour radii (sorted)
+   \param[out]     *nrad        Number of radii
    \param[out]     *CountType   Counting scheme
    \param[out]     *StripWater  Strip waters?
+   \param[out]     *nthreads    Number of threads
    \return                     Success?
 
    Parse the command line
@@ -185,9 +280,12 @@ int main(int argc, char **argv)
 -  05.07.94 Original    By: ACRM
 -  29.04.08 Added -c and -n handling
 -  30.04.08 Added -w handling
+-  15.10.26 -r takes a list of radii
+-  15.10.26 Added -j handling
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  REAL *radius, int *CountType, BOOL *StripWater)
+                  REAL *radii, int *nrad, int *CountType, 
+                  BOOL *StripWater, int *nthreads)
 {
    BOOL GotRad;
 
@@ -195,7 +293,10 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    argv++;
 
    GotRad = FALSE;
+   radii[0] = DEFRAD;
+   *nrad = 1;
    *StripWater = TRUE;
+   *nthreads = 1;
    *CountType = TYP_ALL;
    infile[0] = outfile[0] = '\0';
    
@@ -208,7 +309,8 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          case 'r':
             argc--;
             argv++;
-            sscanf(argv[0],"%lf",radius);
+            if(!argc || !ParseRadii(argv[0], radii, nrad))
+               return(FALSE);
             GotRad = TRUE;
             break;
          case 'd':
@@ -221,19 +323,26 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
             *CountType = TYP_CONTACT;
             if(!GotRad)
             {
-               *radius = DEFCRAD;
+               radii[0] = DEFCRAD;
             }
             break;
          case 'n':
             *CountType = TYP_NORMCONTACT;
             if(!GotRad)
             {
-               *radius = DEFCRAD;
+               radii[0] = DEFCRAD;
             }
             break;
          case 'w':
             *StripWater = FALSE;
             break;
+         case 'j':
+            argc--;
+            argv++;
+            if(!argc || !sscanf(argv[0],"%d",nthreads) || 
+               (*nthreads < 1) || (*nthreads > MAXTHREADS))
+               return(FALSE);
+            break;
          default:
             return(FALSE);
             break;
@@ -264,13 +373,59 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 }
 
 /************************************************************************/
-/*>void CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
-   ---------------------------------------------------------
+/*>BOOL ParseRadii(char *list, REAL *radii, int *nrad)
+   ---------------------------------------------------
 *//**
 
-   \param[in,out]  *pdb       PDB linked list
-   \param[in]      RadSq      Radius squared for neighbour search
+   \param[in]      *list      Comma-separated list of radii
+   \param[out]     *radii     Radii sorted into ascending order
+   \param[out]     *nrad      Number of radii
+   \return                    Success?
+
+   Parses a comma-separated list of up to MAXRADII radii
+
+-  15.10.26 Original
+*/
+BOOL ParseRadii(char *list, REAL *radii, int *nrad)
+{
+   char *chp;
+   int  i;
+   REAL r;
+   
+   *nrad = 0;
+   for(chp=list; chp!=NULL; chp=strchr(chp, ','))
+   {
+      if(*chp == ',')
+         chp++;
+      if((*nrad >= MAXRADII) || (sscanf(chp, "%lf", &r) != 1) ||
+         (r < (REAL)0.0))
+         return(FALSE);
+
+      /* Insert into the sorted list                                    */
+      for(i=*nrad; (i>0) && (radii[i-1] > r); i--)
+         radii[i] = radii[i-1];
+      radii[i] = r;
+      (*nrad)++;
+   }
+   
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>REAL *CountNeighbours(PDB *pdb, REAL *RadSq, int nrad, int CountType,
+                         int nthreads)
+   ---------------------------------------------------------------------
+*//**
+
+   \param[in]      *pdb       PDB linked list
+   \param[in]      *RadSq     Radii squared for neighbour search in
+                              ascending order
+   \param[in]      nrad       Number of radii
    \param[in]      CountType  Counting scheme
+   \param[in]      nthreads   Number of threads to use
+   \return                    Malloc'd array of counts (NULL if no 
+                              memory). The counts for atom i are in
+                              elements i*nrad ... i*nrad+nrad-1
 
    Does the actual work of counting the neighbours. 5 schemes are allowed:
    TYP_ALL         All atoms counted
@@ -280,62 +435,291 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    TYP_NORMCONTACT Counts number of residues which contact each residue
                    and normalize by number of atoms in this residue
 
+   Atom neighbours are found using a cell-list grid with cells at least
+   the size of the largest radius, so each atom need only be compared 
+   with the atoms in its own and the 26 surrounding cells. The atoms are
+   split into blocks which are counted by separate threads.
+
 -  05.07.94 Original    By: ACRM
 -  29.04.08 Added TYP_CONTACT / TYP_NORMCONTACT
 -  12.03.15 Changed to use CHAINMATCH()
+-  15.10.26 Uses a cell-list grid
+-  15.10.26 Takes multiple radii and returns the counts (NULL on
+            failure) rather than setting the B-values
+-  15.10.26 Added nthreads. Counting moved to CountAtomNeighbours()
 */
-void CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
+REAL *CountNeighbours(PDB *pdb, REAL *RadSq, int nrad, int CountType,
+                      int nthreads)
 {
-   PDB *p,
-       *q;
-   int count;
+   PDB      **atoms;
+   VEC3F    *coords;
+   CELLGRID *grid = NULL;
+   ATOMJOB  *jobs;
+   REAL     *counts;
+   int      natoms,
+            i;
 
    if((CountType == TYP_CONTACT) || (CountType == TYP_NORMCONTACT))
+      return(doResidueContacts(pdb, RadSq, nrad, CountType, nthreads));
+
+   if((atoms = blIndexPDB(pdb, &natoms))==NULL)
+      return(NULL);
+   nthreads = MIN(nthreads, natoms);
+
+   if((counts = (REAL *)calloc(natoms * nrad, sizeof(REAL)))==NULL)
    {
-      doResidueContacts(pdb, RadSq, CountType);
+      free(atoms);
+      return(NULL);
    }
-   else
+   if((jobs = (ATOMJOB *)malloc(nthreads * sizeof(ATOMJOB)))==NULL)
    {
-      for(p=pdb; p!=NULL; NEXT(p))
+      free(counts);
+      free(atoms);
+      return(NULL);
+   }
+   if((coords = (VEC3F *)malloc(natoms * sizeof(VEC3F)))!=NULL)
+   {
+      for(i=0; i<natoms; i++)
       {
-         count = 0;
-         for(q=pdb; q!=NULL; NEXT(q))
+         coords[i].x = atoms[i]->x;
+         coords[i].y = atoms[i]->y;
+         coords[i].z = atoms[i]->z;
+      }
+      grid = BuildCellGrid(coords, natoms, (REAL)sqrt(RadSq[nrad-1]));
+      free(coords);
+   }
+   if(grid == NULL)
+   {
+      free(jobs);
+      free(counts);
+      free(atoms);
+      return(NULL);
+   }
+
+   /* Split the atoms into a block for each thread                      */
+   for(i=0; i<nthreads; i++)
+   {
+      jobs[i].atoms     = atoms;
+      jobs[i].grid      = grid;
+      jobs[i].RadSq     = RadSq;
+      jobs[i].counts    = counts;
+      jobs[i].nrad      = nrad;
+      jobs[i].CountType = CountType;
+      jobs[i].first     = (int)(((double)natoms * i) / nthreads);
+      jobs[i].last      = (int)(((double)natoms * (i+1)) / nthreads);
+   }
+   RunJobs(CountAtomNeighbours, jobs, sizeof(ATOMJOB), nthreads);
+
+   FreeCellGrid(grid);
+   free(jobs);
+   free(atoms);
+   return(counts);
+}
+
+/************************************************************************/
+/*>void *CountAtomNeighbours(void *arg)
+   ------------------------------------
+*//**
+
+   \param[in,out]  *arg       ATOMJOB describing the atoms to count
+   \return                    NULL
+
+   Counts the neighbours of atoms job->first ... job->last-1 filling in
+   their elements of job->counts. Each neighbour is binned into the shell
+   between successive radii and the shells are then summed to give the 
+   count within each radius.
+
+-  15.10.26 Original (split from CountNeighbours())
+*/
+void *CountAtomNeighbours(void *arg)
+{
+   ATOMJOB  *job   = (ATOMJOB *)arg;
+   CELLGRID *grid  = job->grid;
+   REAL     *RadSq = job->RadSq,
+            MaxRadSq = RadSq[job->nrad-1],
+            distsq;
+   PDB      *p,
+            *q;
+   int      i, j, k, shell,
+            cx, cy, cz,
+            ix, iy, iz,
+            cell;
+
+   for(i=job->first; i<job->last; i++)
+   {
+      REAL *shells = job->counts + i*job->nrad;
+      
+      p     = job->atoms[i];
+      cell  = grid->itemCell[i];
+      cx    = cell % grid->nx;
+      cy    = (cell / grid->nx) % grid->ny;
+      cz    = cell / (grid->nx * grid->ny);
+
+      /* Step through this cell and the 26 cells around it              */
+      for(iz=MAX(cz-1, 0); iz<=MIN(cz+1, grid->nz-1); iz++)
+      {
+         for(iy=MAX(cy-1, 0); iy<=MIN(cy+1, grid->ny-1); iy++)
          {
-            /* Skip this comparison if the appropriate conditions apply */
-            switch(CountType)
+            for(ix=MAX(cx-1, 0); ix<=MIN(cx+1, grid->nx-1); ix++)
             {
-            case TYP_ALL:
-               if(p==q) continue;
-               break;
-            case TYP_DIFFRES:
-               if(p->resnum    == q->resnum    &&
-                  p->insert[0] == q->insert[0] &&
-                  CHAINMATCH(p->chain, q->chain))
-                  continue;
-               break;
-            case TYP_NONBOND:
-               /* 29.04.08 Corrected to <4.0 rather than >4.0 !!!       */
-               if((p==q) || (DISTSQ(p,q) < (REAL)4.0))
-                  continue;
-               break;
+               cell = ix + grid->nx * (iy + grid->ny * iz);
+               for(j=grid->cellStart[cell]; j<grid->cellStart[cell+1]; j++)
+               {
+                  k = grid->cellItems[j];
+                  q = job->atoms[k];
+                  distsq = DISTSQ(p,q);
+
+                  /* Skip this comparison if the appropriate conditions 
+                     apply
+                  */
+                  switch(job->CountType)
+                  {
+                  case TYP_ALL:
+                     if(k==i) continue;
+                     break;
+                  case TYP_DIFFRES:
+                     if(p->resnum    == q->resnum    &&
+                        p->insert[0] == q->insert[0] &&
+                        CHAINMATCH(p->chain, q->chain))
+                        continue;
+                     break;
+                  case TYP_NONBOND:
+                     /* 29.04.08 Corrected to <4.0 rather than >4.0 !!! */
+                     if((k==i) || (distsq < (REAL)4.0))
+                        continue;
+                     break;
+                  }
+
+                  /* Bin into the innermost shell containing the atom   */
+                  if(distsq < MaxRadSq)
+                  {
+                     for(shell=0; distsq >= RadSq[shell]; shell++);
+                     shells[shell] += (REAL)1.0;
+                  }
+               }
             }
-            
-            if(DISTSQ(p,q) < RadSq)
-               count++;
          }
-         p->bval = (REAL)count;
       }
+
+      /* Sum the shells to give the count within each radius            */
+      for(shell=1; shell<job->nrad; shell++)
+         shells[shell] += shells[shell-1];
+   }
+
+   return(NULL);
+}
+
+/************************************************************************/
+/*>void RunJobs(void *(*func)(void *), void *jobs, size_t jobSize, 
+                int njobs)
+   ---------------------------------------------------------------
+*//**
+
+   \param[in]      *func      Function to run for each job
+   \param[in,out]  *jobs      Array of job structures
+   \param[in]      jobSize    Size of each job structure
+   \param[in]      njobs      Number of jobs
+
+   Runs each job in its own thread, with the first job run by the 
+   calling thread, and waits for them all to complete. If a thread 
+   cannot be created, its job is run by the calling thread instead so
+   the results are always complete.
+
+-  15.10.26 Original
+*/
+void RunJobs(void *(*func)(void *), void *jobs, size_t jobSize, 
+             int njobs)
+{
+   pthread_t *threads = NULL;
+   BOOL      *started = NULL;
+   int       i;
+
+   if(njobs > 1)
+   {
+      threads = (pthread_t *)malloc(njobs * sizeof(pthread_t));
+      started = (BOOL *)calloc(njobs, sizeof(BOOL));
+   }
+
+   for(i=1; i<njobs; i++)
+   {
+      if((threads != NULL) && (started != NULL) &&
+         !pthread_create(&(threads[i]), NULL, func, 
+                         (void *)((char *)jobs + i*jobSize)))
+         started[i] = TRUE;
+   }
+
+   if(njobs > 0)
+      (*func)(jobs);
+
+   for(i=1; i<njobs; i++)
+   {
+      if((started != NULL) && started[i])
+      {
+         pthread_join(threads[i], NULL);
+      }
+      else
+      {
+         (*func)((void *)((char *)jobs + i*jobSize));
+      }
+   }
+
+   if(threads != NULL) free(threads);
+   if(started != NULL) free(started);
+}
+
+/************************************************************************/
+/*>void WriteCountTable(FILE *out, PDB *pdb, REAL *radii, int nrad, 
+                        REAL *counts)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]      *out       Output file pointer
+   \param[in]      *pdb       PDB linked list
+   \param[in]      *radii     Radii
+   \param[in]      nrad       Number of radii
+   \param[in]      *counts    Counts from CountNeighbours()
+
+   Writes a table of the counts within each radius for each atom
+
+-  15.10.26 Original
+*/
+void WriteCountTable(FILE *out, PDB *pdb, REAL *radii, int nrad, 
+                     REAL *counts)
+{
+   PDB *p;
+   int i, j;
+
+   fprintf(out, "# ATNUM ATOM RES  CHAIN RESNUM");
+   for(j=0; j<nrad; j++)
+      fprintf(out, " %7.2f", radii[j]);
+   fprintf(out, "\n");
+   
+   for(p=pdb, i=0; p!=NULL; NEXT(p), i++)
+   {
+      fprintf(out, "%7d %-4s %-4s %-5s %5d%-1s",
+              p->atnum, p->atnam, p->resnam, p->chain, p->resnum,
+              p->insert);
+      for(j=0; j<nrad; j++)
+         fprintf(out, " %7.2f", counts[i*nrad + j]);
+      fprintf(out, "\n");
    }
 }
 
 /************************************************************************/
-/*>void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
-   -----------------------------------------------------------
+/*>REAL *doResidueContacts(PDB *pdb, REAL *RadSq, int nrad, 
+                           int CountType, int nthreads)
+   ----------------------------------------------------------
 *//**
 
    \param[in]      *pdb        PDB linked list
-   \param[in]      RadSq       Squared cutoff distance
+   \param[in]      *RadSq      Squared cutoff distances in ascending 
+                               order
+   \param[in]      nrad        Number of cutoff distances
    \param[in]      CountType   Counting scheme
+   \param[in]      nthreads    Number of threads to use
+   \return                     Malloc'd array of counts for each atom
+                               as for CountNeighbours() (NULL if no
+                               memory)
 
    Does residue-by-residue contacts rather than atom-atom contacts
    Allowed counting schemes are
@@ -345,163 +729,268 @@ void CountNeighbours(PDB *pdb, REAL RadSq, int CountType)
    (though no check is made for invalid types which are treated as
    TYP_CONTACT)
 
+   Residue centres are placed on a grid with cells large enough that
+   any two residues whose bounding spheres are within the largest cutoff
+   lie in the same or adjacent cells. The residues are split into blocks
+   which are handled by separate threads, each keeping its own contact
+   counts which are summed at the end.
+
 -  29.04.08  Original   By: ACRM
+-  15.10.26  Rewritten to use a residue table and grid. Contacts are
+             symmetrical so each residue pair is only tested once.
+-  15.10.26  Takes multiple radii and returns the counts (NULL on
+             failure) rather than setting the B-values
+-  15.10.26  Added nthreads. Contact search moved to 
+             CountResidueContacts()
 */
-
-void doResidueContacts(PDB *pdb, REAL RadSq, int CountType)
+REAL *doResidueContacts(PDB *pdb, REAL *RadSq, int nrad, int CountType,
+                        int nthreads)
 {
-   PDB *p, *q,
-       *res_p, *res_q,
-       *next_res_p = NULL,
-       *next_res_q = NULL;
-   
-   int atomcount = 0,
-       contacts = 0;
+   PDB        *p;
+   RESIDUE    *residues;
+   VEC3F      *centres = NULL;
+   CELLGRID   *grid    = NULL;
+   RESIDUEJOB *jobs    = NULL;
+   REAL       *counts  = NULL,
+              maxResRad = (REAL)0.0;
+   int        *contacts = NULL,
+              nres,
+              natoms,
+              i, j, k, shell;
+
+   if((residues = BuildResidueTable(pdb, &nres))==NULL)
+      return(NULL);
+
+   nthreads = MIN(nthreads, nres);
+   natoms   = 0;
+   for(i=0; i<nres; i++)
+   {
+      maxResRad = MAX(maxResRad, residues[i].radius);
+      natoms   += residues[i].natoms;
+   }
 
-   /* Step through each residue                                         */
-   for(res_p=pdb; res_p!=NULL; res_p = next_res_p)
+   if(((contacts = (int *)calloc(nthreads * nres * nrad, sizeof(int)))
+       !=NULL) &&
+      ((counts   = (REAL *)malloc(natoms * nrad * sizeof(REAL)))!=NULL) &&
+      ((jobs     = (RESIDUEJOB *)malloc(nthreads * sizeof(RESIDUEJOB)))
+       !=NULL) &&
+      ((centres  = (VEC3F *)malloc(nres * sizeof(VEC3F)))!=NULL))
    {
-      next_res_p=blFindNextResidue(res_p);
-      /* Using the occupancy as a flag, clear the contact list          */
-      for(p=pdb; p!=NULL; NEXT(p))
+      for(i=0; i<nres; i++)
+         centres[i] = residues[i].centre;
+      grid = BuildCellGrid(centres, nres, 
+                           (REAL)sqrt(RadSq[nrad-1]) + 
+                           (REAL)2.0 * maxResRad);
+   }
+   if(centres != NULL)
+      free(centres);
+   if(grid == NULL)
+   {
+      if(jobs != NULL)
+         free(jobs);
+      if(counts != NULL)
+         free(counts);
+      if(contacts != NULL)
+         free(contacts);
+      free(residues);
+      return(NULL);
+   }
+
+   /* Split the residues into a block for each thread                   */
+   for(i=0; i<nthreads; i++)
+   {
+      jobs[i].residues = residues;
+      jobs[i].grid     = grid;
+      jobs[i].RadSq    = RadSq;
+      jobs[i].contacts = contacts + i*nres*nrad;
+      jobs[i].nrad     = nrad;
+      jobs[i].first    = (int)(((double)nres * i) / nthreads);
+      jobs[i].last     = (int)(((double)nres * (i+1)) / nthreads);
+   }
+   RunJobs(CountResidueContacts, jobs, sizeof(RESIDUEJOB), nthreads);
+
+   /* Sum the contact counts from each thread                           */
+   for(i=1; i<nthreads; i++)
+   {
+      for(j=0; j<nres*nrad; j++)
+         contacts[j] += jobs[i].contacts[j];
+   }
+
+   /* Step through the residues and set the counts for each atom        */
+   for(i=0, k=0; i<nres; i++)
+   {
+      for(p=residues[i].start; p!=residues[i].stop; NEXT(p), k++)
       {
-         p->occ = 0.0;
+         for(shell=0; shell<nrad; shell++)
+         {
+            if(CountType == TYP_NORMCONTACT)
+            {
+               counts[k*nrad + shell] = (REAL)contacts[i*nrad + shell] /
+                                        (REAL)residues[i].natoms;
+            }
+            else
+            {
+               counts[k*nrad + shell] = (REAL)contacts[i*nrad + shell];
+            }
+         }
+
+         /* The occupancy used to be a flag and is still reset to 1.0   */
+         p->occ = 1.0;
       }
-      /* Count of atoms in this residue                                 */
-      atomcount = 0;
-      contacts = 0;
-         
-      
-      /* Step through atoms in this residue                             */
-      for(p=res_p; p!=next_res_p; NEXT(p))
-      {
-         atomcount++;   /* Increment atoms in this residue              */
+   }
 
-         /* Step through the other residues                             */
-         for(res_q=pdb; res_q!=NULL; res_q = next_res_q)
-         {
-            next_res_q=blFindNextResidue(res_q);
+   FreeCellGrid(grid);
+   free(jobs);
+   free(contacts);
+   free(residues);
+   return(counts);
+}
+
+/************************************************************************/
+/*>void *CountResidueContacts(void *arg)
+   -------------------------------------
+*//**
+
+   \param[in,out]  *arg       RESIDUEJOB describing the residues
+   \return                    NULL
 
-            /* Check it's a different and not-bonded residue            */
-            if(ResSep(pdb, res_p, res_q))
+   Tests residues job->first ... job->last-1 against each later residue 
+   in the same or surrounding grid cells. Atom-level checks are only made
+   for pairs of residues whose bounding spheres are within the largest
+   cutoff and the closest contact is compared with each cutoff. Contacts
+   are added to job->contacts for both residues.
+
+-  15.10.26 Original (split from doResidueContacts())
+*/
+void *CountResidueContacts(void *arg)
+{
+   RESIDUEJOB *job      = (RESIDUEJOB *)arg;
+   CELLGRID   *grid     = job->grid;
+   RESIDUE    *residues = job->residues;
+   REAL       *RadSq    = job->RadSq,
+              MaxRadSq  = RadSq[job->nrad-1],
+              radius    = (REAL)sqrt(MaxRadSq);
+   int        nrad      = job->nrad,
+              i, j, k, shell,
+              cx, cy, cz,
+              ix, iy, iz,
+              cell;
+
+   for(i=job->first; i<job->last; i++)
+   {
+      cell = grid->itemCell[i];
+      cx   = cell % grid->nx;
+      cy   = (cell / grid->nx) % grid->ny;
+      cz   = cell / (grid->nx * grid->ny);
+
+      for(iz=MAX(cz-1, 0); iz<=MIN(cz+1, grid->nz-1); iz++)
+      {
+         for(iy=MAX(cy-1, 0); iy<=MIN(cy+1, grid->ny-1); iy++)
+         {
+            for(ix=MAX(cx-1, 0); ix<=MIN(cx+1, grid->nx-1); ix++)
             {
-               /* Run through the atoms in this residue                 */
-               for(q=res_q; q!=next_res_q; NEXT(q))
+               cell = ix + grid->nx * (iy + grid->ny * iz);
+               for(j=grid->cellStart[cell]; j<grid->cellStart[cell+1]; j++)
                {
-                  REAL distsq;
-                  distsq = DISTSQ(p,q);
-                  if((distsq < RadSq) && (distsq > (REAL)4.0))
+                  REAL maxDist,
+                       distsq;
+                  
+                  k = grid->cellItems[j];
+                  if((k <= i) || !ResSep(residues, i, k))
+                     continue;
+
+                  /* Skip if the bounding spheres are too far apart     */
+                  maxDist = residues[i].radius + residues[k].radius +
+                            radius;
+                  if(DISTSQ(&(residues[i].centre), &(residues[k].centre))
+                     > maxDist * maxDist)
+                     continue;
+
+                  distsq = ResContactDistSq(residues+i, residues+k,
+                                            RadSq[0], MaxRadSq);
+                  for(shell=0; shell<nrad; shell++)
                   {
-                     q->occ = 1.0;
+                     if(distsq < RadSq[shell])
+                     {
+                        job->contacts[i*nrad + shell]++;
+                        job->contacts[k*nrad + shell]++;
+                     }
                   }
                }
             }
          }
-      }  /* Atoms in res_p                                              */
+      }
+   }
 
-      /* Step through the other residues again and count how many
-         residues make contact
-      */
-      for(res_q=pdb; res_q!=NULL; res_q = next_res_q)
-      {
-         next_res_q=blFindNextResidue(res_q);
+   return(NULL);
+}
 
-         /* Run through the atoms in this residue                       */
-         for(q=res_q; q!=next_res_q; NEXT(q))
-         {
-            /* As soon as we find one atom flagged in this residue,
-               bump the counter and jump out of the loop
-            */
-            if(q->occ > (REAL)0.5)
-            {
-               contacts++;
-               break;
-            }
-         }  /* Atoms in res_q                                           */
-      }  /* res_q                                                       */
+/************************************************************************/
+/*>REAL ResContactDistSq(RESIDUE *res1, RESIDUE *res2, REAL MinRadSq, 
+                         REAL MaxRadSq)
+   -------------------------------------------------------------------
+*//**
+
+   \param[in]      *res1      First residue
+   \param[in]      *res2      Second residue
+   \param[in]      MinRadSq   Smallest squared cutoff distance
+   \param[in]      MaxRadSq   Largest squared cutoff distance
+   \return                    Squared distance of closest contact
 
-      /* Step through atoms in this residue and update the b-value      */
-      for(p=res_p; p!=next_res_p; NEXT(p))
+   Finds the closest pair of atoms which are > 2.0A apart. Returns
+   MaxRadSq if there are none within MaxRadSq. Returns as soon as a 
+   contact within MinRadSq is found since this is within every cutoff.
+
+-  15.10.26  Original
+*/
+REAL ResContactDistSq(RESIDUE *res1, RESIDUE *res2, REAL MinRadSq, 
+                      REAL MaxRadSq)
+{
+   PDB  *p, *q;
+   REAL best = MaxRadSq;
+   
+   for(p=res1->start; p!=res1->stop; NEXT(p))
+   {
+      for(q=res2->start; q!=res2->stop; NEXT(q))
       {
-         if(CountType == TYP_NORMCONTACT)
-         {
-            p->bval = (REAL)contacts / (REAL)atomcount;
-         }
-         else
+         REAL distsq;
+         distsq = DISTSQ(p,q);
+         if((distsq < best) && (distsq > (REAL)4.0))
          {
-            p->bval = (REAL)contacts;
+            best = distsq;
+            if(best < MinRadSq)
+               return(best);
          }
-      }  /* Atoms in res_p                                              */
-   }  /* res_p                                                          */
-
-   /* Reset the occupancy                                               */
-   for(p=pdb; p!=NULL; NEXT(p))
-   {
-      p->occ = 1.0;
+      }
    }
+   return(best);
 }
 
-
 /************************************************************************/
-/*>BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr)
-   ---------------------------------------
+/*>BOOL ResSep(RESIDUE *residues, int i, int j)
+   --------------------------------------------
 *//**
 
-   \param[in]      *pdb       PDB linked list
-   \param[in]      *pr        Pointer to first residue of interest
-   \param[in]      *qr        Pointer to second residue of interest
-   \return                     Are the residues separated?
+   \param[in]      *residues  Residue table
+   \param[in]      i          Index of first residue of interest
+   \param[in]      j          Index of second residue of interest
+   \return                    Are the residues separated?
+
+   Residues are separated if they are more than 1 apart in residue 
+   number or in their position in the linked list
 
 -  29.04.08  Original   By: ACRM
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  15.10.26 Uses the residue table rather than walking the linked list
 */
-BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr)
+BOOL ResSep(RESIDUE *residues, int i, int j)
 {
-   int sep;
-   PDB *p, *q;
-   BOOL GotPR = FALSE,
-        GotQR = FALSE;
-   
    /* If they are more than 1 resnum apart immediately return TRUE      */
-   if(pr->resnum < (qr->resnum - 1))
-      return(TRUE);
-   if(pr->resnum > (qr->resnum + 1))
+   if(ABS(residues[i].resnum - residues[j].resnum) > 1)
       return(TRUE);
 
-   /* Otherwise count through the PDB linked list and see how far 
-      apart they are
-   */
-   sep = 0;
-   for(p=pdb; p!=NULL; p = q)
-   {
-      q = blFindNextResidue(p);
-      if(p == pr)
-      {
-         if(!GotQR)
-         {
-            sep = 0;
-         }
-         GotPR = TRUE;
-         if(sep > 1)
-         {
-            return(TRUE);
-         }
-      }
-      if(p == qr)
-      {
-         if(!GotPR)
-         {
-            sep = 0;
-         }
-         GotQR = TRUE;
-         if(sep > 1)
-         {
-            return(TRUE);
-         }
-      }
-      sep++;
-   }
-   return(FALSE);
+   /* Otherwise see how far apart they are in the linked list           */
+   return((BOOL)(ABS(i - j) > 1));
 }
 
 /************************************************************************/
@@ -518,21 +1007,32 @@ BOOL ResSep(PDB *pdb, PDB *pr, PDB *qr)
 -  06.11.14 V1.5 By: ACRM
 -  12.02.15 V1.7
 -  12.03.15 V1.8
+-  15.10.26 V1.9
+-  15.10.26 V1.10
+-  15.10.26 V1.11
+-  15.10.26 V1.12
+-  15.10.26 V1.13
+-  15.10.26 V1.14
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbatomcount V1.8 (c) 1994-2015, Andrew C.R. \
+   fprintf(stderr,"\npdbatomcount V1.14 (c) 1994-2026, Andrew C.R. \
 Martin, UCL\n");
-   fprintf(stderr,"Usage: pdbatomcount [-r <rad>] [-d|-b|-c|-n] [-w] \
-[<in.pdb> [<out.pdb>]]\n");
+   fprintf(stderr,"Usage: pdbatomcount [-r <rad>[,<rad>...]] \
+[-d|-b|-c|-n] [-w] [-j <n>]\n");
+   fprintf(stderr,"                    [<in.pdb> [<out.pdb>]]\n");
    fprintf(stderr,"       -r Specify radius (Default: %.2f or \
 %.2f with -c/-n)\n", DEFRAD, DEFCRAD);
+   fprintf(stderr,"          A comma-separated list gives a table of \
+counts for each\n");
+   fprintf(stderr,"          radius (max %d)\n", MAXRADII);
    fprintf(stderr,"       -d Ignore atoms in current \
 residue\n");
    fprintf(stderr,"       -b Ignore bonded atoms (<2.0A)\n");
    fprintf(stderr,"       -c Count residue contacts\n");
    fprintf(stderr,"       -n Normalized residue contacts\n");
-   fprintf(stderr,"       -w Keep waters\n\n");
+   fprintf(stderr,"       -w Keep waters\n");
+   fprintf(stderr,"       -j Number of threads (Default: 1)\n\n");
 
    fprintf(stderr,"Counts the number of atoms within the specified \
 radius of each atom in\n");
@@ -547,5 +1047,13 @@ normalized, the\n");
    fprintf(stderr,"residue contact counts are divided by the number of \
 atoms in the \n");
    fprintf(stderr,"current residue.\n\n");
+
+   fprintf(stderr,"If more than one radius is given, all the counts are \
+found in a single\n");
+   fprintf(stderr,"pass and a table is written instead of a PDB file. \
+This contains the\n");
+   fprintf(stderr,"atom number, atom name, residue name, chain, \
+residue number and the\n");
+   fprintf(stderr,"count within each radius (in ascending order).\n\n");
 }
 
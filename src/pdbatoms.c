@@ -3,11 +3,11 @@
 
    \file       pdbatoms.c
    
-   \version    V1.0
-   \date       26.02.15
+   \version    V1.3
+   \date       15.10.26
    \brief      Discard header and footer records from PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 2015
+   \copyright  (c) Dr. Andrew C. R. Martin 2015-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -47,14 +47,22 @@
    Revision History:
    =================
 -  V1.0  26.02.15 Original
+-  V1.1  15.10.26 Added -s to filter the file as a stream
+-  V1.2  15.10.26 Reads the PDB file with ReadMappedPDB() so binary
+                  cache files may be used
+-  V1.3  15.10.26 -s reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <string.h>
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
+#include "common/pdbfilter.h"
+#include "common/mappdb.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -70,7 +78,8 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -80,23 +89,32 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
    Main program
 
 -  26.02.15 Original    By: ACRM
+-  15.10.26 Added -s
+-  15.10.26 Uses ReadMappedPDB()
 */
 int main(int argc, char **argv)
 {
-   FILE     *in      = stdin,
-            *out     = stdout;
-   PDB      *pdb;
-   int      natoms;
-   char     infile[MAXBUFF],
-            outfile[MAXBUFF];
-
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   FILE      *in      = stdin,
+             *out     = stdout;
+   MAPPEDPDB *mpdb;
+   char      infile[MAXBUFF],
+             outfile[MAXBUFF];
+   BOOL      stream = FALSE;
+
+   if(ParseCmdLine(argc, argv, infile, outfile, &stream))
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natoms))!=NULL)
+         if(stream)
          {
-            blWritePDB(out, pdb);
+            if(IsPDBCache(in, "pdbatoms") ||
+               !StreamFilterPDB(in, out, NULL, NULL, FILTER_COORDSONLY))
+               return(1);
+         }
+         else if((mpdb=ReadMappedPDB(in))!=NULL)
+         {
+            blWritePDB(out, mpdb->pdb);
+            FreeMappedPDB(mpdb);
          }
          else
          {
@@ -120,12 +138,21 @@ int main(int argc, char **argv)
 *//**
 
 -  26.02.15 Original    By: ACRM
+-  15.10.26 V1.1
+-  15.10.26 V1.2
+-  15.10.26 V1.3
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbatoms V1.0  (c) 2015 UCL, Andrew C.R. \
+   fprintf(stderr,"\npdbatoms V1.3  (c) 2015-2026 UCL, Andrew C.R. \
 Martin\n");
-   fprintf(stderr,"Usage: pdbatoms [<input.pdb> [<output.pdb>]]\n");
+   fprintf(stderr,"Usage: pdbatoms [-s] [<input.pdb> [<output.pdb>]]\n");
+   fprintf(stderr,"       -s  Filter the file as a stream using constant \
+memory. Records are\n");
+   fprintf(stderr,"           copied unchanged and all models (with \
+MODEL/ENDMDL) and\n");
+   fprintf(stderr,"           alternate positions are kept. Not \
+available for PDBML.\n");
 
    fprintf(stderr,"\nExtracts only the coordinate records from a PDB \
 or PDBML file (i.e. the\n");
@@ -144,18 +171,22 @@ and footer information.\n");
    \param[in]      **argv       Argument array
    \param[out]     *infile      Input file (or blank string)
    \param[out]     *outfile     Output file (or blank string)
+   \param[out]     *stream      Filter as a stream?
    \return                      Success?
 
    Parse the command line
    
 -  26.02.15 Original    By: ACRM
+-  15.10.26 Added -s
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream)
 {
    argc--;
    argv++;
 
    infile[0] = outfile[0] = '\0';
+   *stream   = FALSE;
    
    while(argc)
    {
@@ -163,6 +194,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
       {
          switch(argv[0][1])
          {
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -3,11 +3,11 @@
 
    \file       pdbatomsel.c
    
-   \version    V1.7
-   \date       02.03.15
+   \version    V1.8
+   \date       15.10.26
    \brief      Select atoms from a PDB file. Acts as filter
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -55,6 +55,7 @@
 -  V1.5  07.11.14 Initialized a variable
 -  V1.6  12.02.15 Uses Whole PDB
 -  V1.7  02.03.15 Major rewrite to use blSelectAtomsPDBAsCopy()
+-  V1.8  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -71,6 +72,7 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -147,6 +149,9 @@ list.\n");
          selectedAtoms = ConvertAtomsToArray(atoms, &nSelected);
          FREELIST(atoms, ATOMTYPE);
 
+         if(IsPDBCache(in, "pdbatomsel"))
+            return(1);
+
          /* Read in the PDB file                                        */
          if((wpdb=blReadWholePDB(in))!=NULL)
          {
@@ -231,10 +236,11 @@ char **ConvertAtomsToArray(ATOMTYPE *atoms, int *nSelected)
 -  07.11.14 V1.5
 -  12.02.15 V1.6
 -  02.03.15 V1.7
+-  15.10.26 V1.8
 */
 void Usage(void)
 {            
-   fprintf(stderr,"\npdbatomsel V1.7 (c) 1994-2015, Andrew C.R. \
+   fprintf(stderr,"\npdbatomsel V1.8 (c) 1994-2026, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbatomsel [-atom] [-atom...] [<in.pdb> \
 [<out.pdb>]]\n\n");
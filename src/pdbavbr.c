@@ -3,11 +3,11 @@
 
    \file       pdbavbr.c
    
-   \version    V1.4
-   \date       25.06.15
+   \version    V1.5
+   \date       15.10.26
    \brief      Calc means and SDs of BValues by residue type
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -52,6 +52,7 @@
 -  V1.2  06.11.14 Renamed from avbr  By: ACRM
 -  V1.3  12.02.15 Some minor fixes and more usage info
 -  V1.4  25.06.15 Only prints bars for observed residues
+-  V1.5  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -66,6 +67,7 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/MathUtil.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -128,6 +130,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(InFile, OutFile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbavbr"))
+            return(1);
          if((pdb = blReadPDBAtoms(in, &natoms)) != NULL)
          {
             DoMeanSD(out, pdb);
@@ -169,10 +173,11 @@ int main(int argc, char **argv)
 -  06.11.14 V1.2 By: ACRM
 -  12.02.15 V1.3 By: ACRM
 -  25.06.15 V1.4 By: ACRM
+-  15.10.26 V1.5
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbavbr V1.4 (c) 1994-2015, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbavbr V1.5 (c) 1994-2026, Dr. Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbavbr [-n] [-m maxval] [-b nbin] [in.pdb \
 [output.txt]]\n");
@@ -3,11 +3,11 @@
 
    \file       pdbcalcrms.c
    
-   \version    V1.3
-   \date       06.11.14
+   \version    V1.4
+   \date       15.10.26
    \brief      Calculate RMS between 2 PDB files. Does no fitting.
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2014
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -52,6 +52,7 @@
 -  V1.2  19.08.14 Added AsCopy suffix to calls to blSelectAtomsPDB() and 
                   blStripHPDBAsCopy By: CTP
 -  V1.3  06.11.14 Renamed from rmspdb
+-  V1.4  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -63,6 +64,7 @@
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -124,6 +126,9 @@ int main(int argc, char **argv)
          return(1);
       }
       
+      if(IsPDBCache(fp1, "pdbcalcrms") || IsPDBCache(fp2, "pdbcalcrms"))
+         return(1);
+
       /* Read the two PDB files                                         */
       if((pdb1 = blReadPDB(fp1,&natoms))==NULL)
       {
@@ -344,10 +349,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *file1, char *file2,
 -  01.11.94 Original    By: ACRM
 -  22.07.14 V1.1 By: CTP
 -  06.11.14 V1.3 By: ACRM
+-  15.10.26 V1.4
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcalcrms V1.3 (c) 1994-2014, Andrew C.R. \
+   fprintf(stderr,"\npdbcalcrms V1.4 (c) 1994-2026, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbcalcrms [-h] [-c] [-b] [-m] <in1.pdb> \
 <in2.pdb>\n");
@@ -3,11 +3,11 @@
 
    \file       pdbcentralres.c
    
-   \version    V1.4
-   \date       12.03.15
+   \version    V1.5
+   \date       15.10.26
    \brief      Find the residue nearest the centroid of a protein
    
-   \copyright  (c) Dr. Andrew C. R. Martin 2012-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 2012-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -52,6 +52,7 @@
 -  V1.2  06.11.14 Renamed as pdbcentralres By: ACRM
 -  V1.3  07.11.14 Initialized a variable
 -  V1.4  12.03.15 Changed to allow multi-character chain names
+-  V1.5  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -61,6 +62,7 @@
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -103,6 +105,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbcentralres"))
+            return(1);
          if((pdb = blReadPDB(in,&natoms)) != NULL)
          {
             VEC3F cg;
@@ -210,10 +214,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 -  06.11.14 V1.2 By: ACRM
 -  07.11.14 V1.3 
 -  12.03.15 V1.4
+-  15.10.26 V1.5
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcentralres V1.4 (c) 2012-2015 UCL, \
+   fprintf(stderr,"\npdbcentralres V1.5 (c) 2012-2026 UCL, \
 Dr. Andrew C.R. Martin\n");
    fprintf(stderr,"\nUsage: pdbcentralres [in.pdb [out.pdb]]\n");
 
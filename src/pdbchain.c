@@ -3,11 +3,11 @@
 
    \file       pdbchain.c
    
-   \version    V2.1
-   \date       13.03.15
+   \version    V2.2
+   \date       15.10.26
    \brief      Insert chain labels into a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -69,6 +69,7 @@
                   L and H are now specified as L,H instead of LH
 -  V2.1  13.03.15 Now supports old chain specification method if
                   called as chainpdb
+-  V2.2  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -84,6 +85,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -138,6 +140,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbchain"))
+            return(1);
          if((wpdb=blReadWholePDB(in))==NULL)
          {
             fprintf(stderr,"No atoms read from input file\n");
@@ -284,10 +288,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  05.03.15 V1.10
 -  10.03.15 V2.0
 -  13.03.15 V2.1
+-  15.10.26 V2.2
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbchain V2.1 (c) 1994-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbchain V2.2 (c) 1994-2026 Dr. Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"\nUsage: pdbchain [-c chain[,chain[...]]] [in.pdb \
 [out.pdb]]\n");
@@ -3,11 +3,11 @@
 
    \file       pdbcheckforres.c
    
-   \version    V1.5
-   \date       10.03.15
+   \version    V1.6
+   \date       15.10.26
    \brief      Checks whether a specified residue exists in a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 2011-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 2011-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -56,6 +56,7 @@
 -  V1.4   06.11.14  Renamed from checkforres
 -  V1.5   10.03.15  Removed -l option as we no longer support upcasing
                     chain labels
+-  V1.6   15.10.26  Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -63,6 +64,7 @@
 #include <stdio.h>
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -115,6 +117,8 @@ int main(int argc, char **argv)
       {
          BOOL ParseResSpecResult;
 
+         if(IsPDBCache(in, "pdbcheckforres"))
+            return(1);
          if(readHet)
          {
             pdb=blReadPDB(in, &natom);
@@ -259,10 +263,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *resid,
 -  22.07.14 V1.3 By: CTP
 -  06.11.14 V1.4 By: ACRM
 -  10.03.15 V1.5
+-  15.10.26 V1.6
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcheckforres V1.5 (c) 2011-2015, UCL, Dr. \
+   fprintf(stderr,"\npdbcheckforres V1.6 (c) 2011-2026, UCL, Dr. \
 Andrew C.R. Martin\n");
    fprintf(stderr,"Usage: pdbcheckforres [-H] resspec [in.pdb \
 [out.txt]]\n");
@@ -3,7 +3,7 @@
 
    \file       pdbcount.c
    
-   \version    V1.5
+   \version    V1.7
    \date       12.03.15
    \brief      Count residues and atoms in a PDB file
    
@@ -53,6 +53,8 @@
                   Added doxygen annotation. By: CTP
 -  V1.4  06.11.14 Renamed from countpdb  By: ACRM
 -  V1.5  12.03.15 Changed to allow multi-character chain names
+-  V1.6  15.10.26 Reads the PDB file with ReadMappedPDB()
+-  V1.7  15.10.26 Added -l and -d to count a list of files
 
 *************************************************************************/
 /* Includes
@@ -66,6 +68,8 @@
 #include "bioplib/MathType.h"
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/mappdb.h"
+#include "common/batch.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -80,8 +84,10 @@
 /* Prototypes
 */
 int  main(int argc, char **argv);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  char *listfile, char *outdir);
 void Usage(void);
+BOOL CountFile(FILE *in, FILE *out, char *infile, void *data);
 void DoCount(PDB *pdb, int *nchain, int *nres, int *natom, int *nhyd,
              int *nhet);
 
@@ -95,29 +101,41 @@ void DoCount(PDB *pdb, int *nchain, int *nres, int *natom, int *nhyd,
 -  16.08.94 Original    By: ACRM
 -  24.08.94 Changed to call OpenStdFiles()
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  15.10.26 Uses ReadMappedPDB()   By: ACRM
+-  15.10.26 Added batch mode. Counting moved to CountFile()
 */
 int main(int argc, char **argv)
 {
    FILE *in  = stdin,
         *out = stdout;
    char infile[MAXBUFF],
-        outfile[MAXBUFF];
-   PDB  *pdb;
-   int  nchain, nres, natom, nhyd, nhet;
+        outfile[MAXBUFF],
+        listfile[MAXBUFF],
+        outdir[MAXBUFF];
+   int  nfail;
         
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   if(ParseCmdLine(argc, argv, infile, outfile, listfile, outdir))
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natom))==NULL)
+         if(listfile[0])
          {
-            fprintf(stderr,"No atoms read from input file\n");
+            if((nfail = RunBatch(listfile, outdir, out, CountFile, 
+                                 NULL)) < 0)
+            {
+               fprintf(stderr,"Unable to read list file, %s\n", 
+                       listfile);
+               return(1);
+            }
+            if(nfail)
+            {
+               fprintf(stderr,"%d files could not be counted\n", nfail);
+               return(1);
+            }
          }
          else
          {
-            DoCount(pdb, &nchain, &nres, &natom, &nhyd, &nhet);
-            fprintf(out,"Chains: %d Residues: %d Atoms: %d Het Atoms: %d \
-Total Hydrogens: %d\n", nchain, nres, natom, nhet, nhyd);
+            CountFile(in, out, infile, NULL);
          }
       }
       else
@@ -136,7 +154,43 @@ Total Hydrogens: %d\n", nchain, nres, natom, nhet, nhyd);
 }
 
 /************************************************************************/
-/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+/*>BOOL CountFile(FILE *in, FILE *out, char *infile, void *data)
+   -------------------------------------------------------------
+*//**
+
+   \param[in]      *in         Input PDB file
+   \param[in]      *out        Output file
+   \param[in]      *infile     Input filename
+   \param[in]      *data       Unused
+   \return                     Were any atoms read?
+
+   Reads a PDB file and prints the counts. Called directly or for each
+   file by RunBatch()
+
+-  15.10.26 Original (split from main())   By: ACRM
+*/
+BOOL CountFile(FILE *in, FILE *out, char *infile, void *data)
+{
+   MAPPEDPDB *mpdb;
+   int       nchain, nres, natom, nhyd, nhet;
+
+   if((mpdb=ReadMappedPDB(in))==NULL)
+   {
+      fprintf(stderr,"No atoms read from input file %s\n", infile);
+      return(FALSE);
+   }
+
+   DoCount(mpdb->pdb, &nchain, &nres, &natom, &nhyd, &nhet);
+   fprintf(out,"Chains: %d Residues: %d Atoms: %d Het Atoms: %d \
+Total Hydrogens: %d\n", nchain, nres, natom, nhet, nhyd);
+   FreeMappedPDB(mpdb);
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                     char *listfile, char *outdir)
    ----------------------------------------------------------------------
 *//**
 
@@ -144,18 +198,23 @@ Total Hydrogens: %d\n", nchain, nres, natom, nhet, nhyd);
    \param[in]      **argv      Argument array
    \param[out]     *infile     Input filename (or blank string)
    \param[out]     *outfile    Output filename (or blank string)
+   \param[out]     *listfile   File listing input files (or blank 
+                               string)
+   \param[out]     *outdir     Output directory (or blank string)
    \return                     Success
 
    Parse the command line
 
 -  16.08.94 Original    By: ACRM
+-  15.10.26 Added -l and -d. With -l, a filename is the output file
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  char *listfile, char *outdir)
 {
    argc--;
    argv++;
    
-   infile[0] = outfile[0] = '\0';
+   infile[0] = outfile[0] = listfile[0] = outdir[0] = '\0';
    
    while(argc)
    {
@@ -166,6 +225,20 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
          case 'h':
             return(FALSE);
             break;
+         case 'l':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(listfile, argv[0], MAXBUFF);
+            listfile[MAXBUFF-1] = '\0';
+            break;
+         case 'd':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(outdir, argv[0], MAXBUFF);
+            outdir[MAXBUFF-1] = '\0';
+            break;
          default:
             return(FALSE);
             break;
@@ -173,6 +246,15 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
       }
       else
       {
+         /* With a list of files, only the output file may be given     */
+         if(listfile[0])
+         {
+            if(argc > 1)
+               return(FALSE);
+            strcpy(outfile, argv[0]);
+            return(TRUE);
+         }
+
          /* Check that there are only 1 or 2 arguments left             */
          if(argc > 2)
             return(FALSE);
@@ -206,15 +288,28 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 -  22.07.14 V1.3 By: CTP
 -  06.11.14 V1.4 By: ACRM
 -  12.03.15 V1.5
+-  15.10.26 V1.6
+-  15.10.26 V1.7 Added -l and -d
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbcount V1.5 (c) 1994-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbcount V1.7 (c) 1994-2026 Dr. Andrew C.R. \
 Martin, UCL\n");
-   fprintf(stderr,"\nUsage: pdbcount [in.pdb [out.txt]]\n\n");
+   fprintf(stderr,"\nUsage: pdbcount [in.pdb [out.txt]]\n");
+   fprintf(stderr,"       pdbcount -l listfile [-d outdir] \
+[out.txt]\n");
+   fprintf(stderr,"       -l  Count each of the PDB files listed in \
+listfile ('-' for stdin)\n");
+   fprintf(stderr,"       -d  Write the counts for each file to a file \
+of the same name in\n");
+   fprintf(stderr,"           outdir rather than all to out.txt\n\n");
    fprintf(stderr,"If files are not specified, stdin and stdout are \
 used.\n");
-   fprintf(stderr,"Counts chains, residues & atoms in a PDB file.\n\n");
+   fprintf(stderr,"Counts chains, residues & atoms in a PDB file.\n");
+   fprintf(stderr,"\nWith -l, the output for each file is preceded by \
+a '%s<filename>' line\n", BATCH_BEGIN);
+   fprintf(stderr,"and followed by '%s<filename> OK' (or FAILED) unless \
+-d is used.\n\n", BATCH_END);
 }
 
 /************************************************************************/
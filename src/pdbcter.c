@@ -3,12 +3,12 @@
 
    \file       pdbcter.c
    
-   \version    V1.2
-   \date       25.02.15
+   \version    V1.3
+   \date       15.10.26
    \brief      Set naming for c-terminal oxygens and generate
                coordinates if required.
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -52,6 +52,7 @@
                   Added doxygen annotation. By: CTP
 -  V1.2  25.02.15 Modified for new blRenumAtomsPDB()
                   Supports whole PDB
+-  V1.3  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -65,6 +66,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -111,6 +113,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbcter"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb = wpdb->pdb;
@@ -211,10 +215,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  23.08.94 Original    By: ACRM
 -  22.07.14 V1.1 By: CTP
 -  24.02.15 V1.2 and improved help message By: ACRM
+-  15.10.26 V1.3
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nPDBCTer V1.2 (c) 1994-2015, Andrew C.R. Martin, \
+   fprintf(stderr,"\nPDBCTer V1.3 (c) 1994-2026, Andrew C.R. Martin, \
 UCL\n\n");
    fprintf(stderr,"Usage: pdbcter [-g] [-c] [in.pdb [out.pdb]]\n");
    fprintf(stderr,"               -g Gromos style C-terminii\n");
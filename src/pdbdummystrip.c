@@ -3,11 +3,11 @@
 
    \file       pdbdummystrip.c
    
-   \version    V1.3
-   \date       13.02.15
+   \version    V1.4
+   \date       15.10.26
    \brief      Strips atoms with NULL coordinates
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1996-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -52,6 +52,7 @@
 -  V1.2  06.11.14 Renamed from nullstrip. This replaces an older program
                   called pdbstrip.   By: ACRM
 -  V1.3  13.02.15 Added whole PDB support
+-  V1.4  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -65,6 +66,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -106,6 +108,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbdummystrip"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
@@ -242,10 +246,11 @@ PDB *StripNulls(PDB *pdb)
 -  22.07.14 V1.1 By: CTP
 -  06.11.14 V1.2 By: ACRM
 -  13.02.15 V1.3 By: ACRM
+-  15.10.26 V1.4
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbdummystrip V1.3 (c) 1996-2015, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbdummystrip V1.4 (c) 1996-2026, Dr. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbdummystrip [in.pdb [out.pdb]]\n");
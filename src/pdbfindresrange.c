@@ -3,12 +3,12 @@
 
    \file       pdbfindresrange.c
    
-   \version    V1.5
-   \date       12.03.15
+   \version    V1.6
+   \date       15.10.26
    \brief      Find a residue range given a key residue and a number
                of residues on either side
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2010-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2010-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -54,6 +54,7 @@
 -  V1.3   06.11.14  Renamed from findresrange
 -  V1.4   07.11.14  Removed an unused variable
 -  V1.5   12.03.15 Changed to allow multi-character chain names
+-  V1.6   15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -63,6 +64,7 @@
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -108,6 +110,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbfindresrange"))
+            return(1);
          if((pdb = blReadPDB(in, &natoms)) == NULL)
          {
             fprintf(stderr, "Unable to read PDB file\n");
@@ -309,10 +313,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  06.11.14 V1.3 By: ACRM
 -  07.11.14 V1.4 By: ACRM
 -  12.03.15 V1.5
+-  15.10.26 V1.6
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbfindresrange V1.5 (c) 2010-2015 UCL, Andrew \
+   fprintf(stderr,"\npdbfindresrange V1.6 (c) 2010-2026 UCL, Andrew \
 C.R. Martin\n");
    fprintf(stderr,"\nUsage: pdbfindresrange resspec width [input.pdb \
 [output.txt]]\n");
@@ -3,11 +3,11 @@
 
    \file       pdbflip.c
    
-   \version    V1.5
-   \date       12.03.15
+   \version    V1.6
+   \date       15.10.26
    \brief      Standardise equivalent atom labelling
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1996-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -53,6 +53,7 @@
 -  V1.3   06.11.14 Renamed from flip
 -  V1.4   13.02.15 Added whole PDB support
 -  V1.5   12.03.15 Changed to allow multi-character chain names
+-  V1.6   15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -63,6 +64,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/angle.h"
+#include "common/pdbcache.h"
 
 
 /************************************************************************/
@@ -124,6 +126,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbflip"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb = wpdb->pdb;
@@ -225,10 +229,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  22.07.14 V1.1 By: CTP
 -  06.11.14 V1.2 By: ACRM
 -  12.03.15 V1.5
+-  15.10.26 V1.6
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbflip V1.5 (c) 2014-2015 Dr. Andrew C.R. Martin, \
+   fprintf(stderr,"\npdbflip V1.6 (c) 2014-2026 Dr. Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"\nUsage: pdbflip [in.pdb [out.pdb]]\n");
 
@@ -3,11 +3,11 @@
 
    \file       pdbgetchain.c
    
-   \version    V2.1
-   \date       13.03.15
+   \version    V2.4
+   \date       15.10.26
    \brief      Extract chains from a PDB file
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -66,6 +66,11 @@
                   single character chain labels (not comma-separated) are
                   supported.
 -  V2.1  13.03.15 Modified to use bioplib routines for list parsing
+-  V2.2  15.10.26 Chain selection moved to common/chainsel.c so it can
+                  be shared with the bioptools pipeline
+-  V2.3  15.10.26 Reads the PDB file with ReadMappedWholePDB() so
+                  binary cache files may be used
+-  V2.4  15.10.26 -a reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -75,6 +80,9 @@
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
 #include "bioplib/array.h"
+#include "common/chainsel.h"
+#include "common/mappdb.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -101,9 +109,6 @@ int main(int argc, char **argv);
 void Usage(void);
 char **ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                     BOOL *numeric, BOOL *atomsOnly);
-PDB *FindEndOfChain(PDB *chain);
-void SelectPDBChains(WHOLEPDB *wpdb, char **chains, BOOL numeric);
-BOOL ValidChain(PDB *pdb, char **chains, BOOL numeric);
 
 
 
@@ -121,6 +126,7 @@ BOOL ValidChain(PDB *pdb, char **chains, BOOL numeric);
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Now always keeps header  By: ACRM
 - Removed lowercase
+-  15.10.26 Uses ReadMappedWholePDB()  By: ACRM
 */
 int main(int argc, char **argv)
 {
@@ -141,11 +147,13 @@ int main(int argc, char **argv)
          /* 29.06.09 Added atomsOnly option                             */
          if(atomsOnly)
          {
+            if(IsPDBCache(in, "pdbgetchain"))
+               return(1);
             wpdb=blReadWholePDBAtoms(in);
          }
          else
          {
-            wpdb=blReadWholePDB(in);
+            wpdb=ReadMappedWholePDB(in);
          }
          
          if((wpdb == NULL)||
@@ -169,85 +177,6 @@ int main(int argc, char **argv)
    return(0);
 }
 
-/************************************************************************/
-void SelectPDBChains(WHOLEPDB *wpdb, char **chains, BOOL numeric)
-{
-   PDB  *chainStart    = NULL,
-        *endOfChain    = NULL,
-        *nextChain     = NULL,
-        *keptChainsEnd = NULL;
-   
-   for(chainStart=wpdb->pdb; chainStart!=NULL; chainStart=nextChain)
-   {
-      endOfChain       = FindEndOfChain(chainStart);
-      nextChain        = endOfChain->next;
-      endOfChain->next = NULL;
-
-      if(ValidChain(chainStart, chains, numeric))
-      {
-         if(keptChainsEnd!=NULL)
-            keptChainsEnd->next = chainStart;
-         keptChainsEnd = endOfChain;
-      }
-      else
-      {
-         if(chainStart == wpdb->pdb)
-            wpdb->pdb = nextChain;
-
-         FREELIST(chainStart, PDB);
-      }
-   }
-}
-
-/************************************************************************/
-BOOL ValidChain(PDB *pdb, char **chains, BOOL numeric)
-{
-   int i;
-   static int sChainCount = 0;
-
-   if(numeric)
-   {
-      sChainCount++;
-      for(i=0; ((chains[i] != NULL) && (chains[i][0] != '\0')); i++)
-      {
-         int numericChain;
-         
-         if(sscanf(chains[i], "%d", &numericChain))
-         {
-            if(sChainCount == numericChain)
-               return(TRUE);
-         }
-      }
-   }
-   else
-   {
-      for(i=0; ((chains[i] != NULL) && (chains[i][0] != '\0')); i++)
-      {
-         if(CHAINMATCH(pdb->chain, chains[i]))
-            return(TRUE);
-      }
-   }
-   
-   return(FALSE);
-}
-
-/************************************************************************/
-PDB *FindEndOfChain(PDB *chain)
-{
-   PDB *p;
-   if(chain==NULL)
-      return(NULL);
-   
-   for(p=chain; 
-       ((p->next !=NULL) && CHAINMATCH(p->chain, p->next->chain));
-       NEXT(p))
-   {
-      continue;
-   }
-   return(p);
-}
-
-
 /************************************************************************/
 /*>void Usage(void)
    ----------------
@@ -266,10 +195,13 @@ PDB *FindEndOfChain(PDB *chain)
 -  13.02.15 V1.8
 -  04.03.15 V2.0
 -  13.03.15 V2.1
+-  15.10.26 V2.2
+-  15.10.26 V2.3
+-  15.10.26 V2.4
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbgetchain V2.1 (c) 1997-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbgetchain V2.4 (c) 1997-2026 Dr. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbgetchain [-n] [-a] \
@@ -3,11 +3,11 @@
 
    \file       pdbgetresidues.c
    
-   \version    V1.4
-   \date       12.03.15
+   \version    V1.5
+   \date       15.10.26
    \brief      Extract a set of residues from a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 2010-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 2010-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -52,6 +52,7 @@
 -  V1.2  06.11.14 Renamed from getresidues  By: ACRM
 -  V1.3  25.11.14 Initialized a variable
 -  V1.4  12.03.15 Changed to allow multi-character chain names
+-  V1.5  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -61,6 +62,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -123,6 +125,8 @@ int main(int argc, char **argv)
       {
          if(blOpenStdFiles(InFile, OutFile, &in, &out))
          {
+            if(IsPDBCache(in, "pdbgetresidues"))
+               return(1);
             if((pdb=blReadPDB(in, &natom))==NULL)
             {
                fprintf(stderr,"Error: pdbgetresidues - No atoms read from \
@@ -306,10 +310,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *resfile,
 -  06.11.14 V1.2 By: ACRM
 -  25.11.14 V1.3 By: ACRM
 -  12.03.15 V1.4
+-  15.10.26 V1.5
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbgetresidues V1.4 (c) 2010-2015, UCL, Dr. Andrew \
+   fprintf(stderr,"\npdbgetresidues V1.5 (c) 2010-2026, UCL, Dr. Andrew \
 C.R. Martin\n");
    fprintf(stderr,"\nUsage: pdbgetresidues resfile [in.pdb [out.pdb]]\n");
 
@@ -3,11 +3,11 @@
 
    \file       pdbgetzone.c
    
-   \version    V1.9
-   \date       07.10.15
+   \version    V1.10
+   \date       15.10.26
    \brief      Extract a numbered zone from a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1996-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -65,6 +65,7 @@
                     it to make sense
 -  V1.8   02.10.15  Added -x (extend) and -f (force) parameters
 -  V1.9   07.10.15  Added -v (invert) parameter
+-  V1.10  15.10.26  Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -72,6 +73,7 @@
 #include <stdio.h>
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -139,6 +141,8 @@ int main(int argc, char **argv)
       {
          BOOL ParseResSpec1Result, ParseResSpec2Result;
 
+         if(IsPDBCache(in, "pdbgetzone"))
+            return(1);
          if(((wpdb=blReadWholePDB(in))==NULL) || (wpdb->pdb == NULL))
          {
             fprintf(stderr,"pdbgetzone: No atoms read from PDB file\n");
@@ -471,11 +475,12 @@ BOOL FindOffsetResidue(PDBSTRUCT *pdbs, int width,
 -  13.02.15 V1.7 By: ACRM
 -  03.10.15 V1.8
 -  07.10.15 V1.9
+-  15.10.26 V1.10
 */
 void Usage(void)
 {
    fprintf(stderr,"\n");
-   fprintf(stderr,"pdbgetzone V1.9 (c) 1996-2015, Dr. Andrew C.R. \
+   fprintf(stderr,"pdbgetzone V1.10 (c) 1996-2026, Dr. Andrew C.R. \
 Martin, UCL.\n");
    fprintf(stderr,"                    Modified by Tony Lewis, \
 UCL, 2005\n");
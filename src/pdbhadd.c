@@ -3,11 +3,11 @@
 
    \file       pdbhadd.c
    
-   \version    V1.7
-   \date       23.06.15
+   \version    V1.8
+   \date       15.10.26
    \brief      Add hydrogens to a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -56,6 +56,7 @@
 -  V1.5  23.02.15 Modified for new blRenumAtomsPDB()
 -  V1.6  20.03.15 Takes -v option and -n option
 -  V1.7  23.06.15 Fixed bug if unable to strip hydrogens
+-  V1.8  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -69,6 +70,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -128,6 +130,8 @@ int main(int argc, char **argv)
       {
          if(blOpenStdFiles(infile, outfile, &in, &out))
          {
+            if(IsPDBCache(in, "pdbhadd"))
+               return(1);
             if((wpdb = blReadWholePDB(in)) != NULL)
             {
                pdb = wpdb->pdb;
@@ -316,10 +320,11 @@ void FixNTerNames(PDB *pdb)
 -  23.02.15 V1.5
 -  20.03.15 V1.6
 -  23.06.15 V1.7
+-  15.10.26 V1.8
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nPDBHAdd V1.7 (c) 1994-2015, Andrew C.R. Martin, \
+   fprintf(stderr,"\nPDBHAdd V1.8 (c) 1994-2026, Andrew C.R. Martin, \
 UCL\n\n");
    fprintf(stderr,"Usage: pdbhadd [-p pgpfile] [-a] [-c] [-n] [-v] \
 [<in.pdb> [<out.pdb>]]\n");
@@ -1,17 +1,13 @@
-/*** TODO
-Finish commenting
-Handle PGP file in data directory
- ***/
 /************************************************************************/
 /**
 
    \file       pdbhbond.c
    
-   \version    V2.0
-   \date       20.07.15
+   \version    V2.9
+   \date       15.10.26
    \brief      List hydrogen bonds
    
-   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2015
+   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2026
    \author     Dr. Andrew C.R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -40,7 +36,23 @@ Handle PGP file in data directory
    Description:
    ============
    Displays a list of hydrogen bonds based on calculated distances and
-   angles according to the Baker and Hubbard criteria
+   angles according to the Baker and Hubbard criteria, followed by a
+   list of non-bonded contacts made by ligands and nucleotides.
+
+   Hydrogens are first added using the proton generation parameter
+   (PGP) file given with -p or, by default, the one in the BiopLib data
+   directory. Five searches are then run, in output order: protein-
+   protein HBonds, protein-ligand HBonds, protein-ligand pseudo-HBonds,
+   ligand-ligand HBonds and non-bonds.
+
+   Protein-protein HBonds are only tested between residues whose
+   bounding spheres are within HBonding distance, using a cell-list
+   grid of residue centres. Non-bonds use a cell-list grid of atoms and
+   a hash set of the HBonded atom pairs which they must skip. With -j,
+   the searches are split into blocks which are run in parallel
+   threads and the results are merged in the original order, so the
+   output does not depend on the number of threads. With -l, a list of
+   files is processed in one run (see common/batch.c).
 
 
    Rules for finding Hydrogen Bonds
@@ -119,6 +131,10 @@ Handle PGP file in data directory
 
    Usage:
    ======
+   pdbhbond [-n dist][-x dist][-b dist][-p pgpfile][-j nthreads]
+            [infile [outfile]]
+   pdbhbond [-n dist][-x dist][-b dist][-p pgpfile][-j nthreads]
+            -l listfile [-d outdir] [outfile]
 
 **************************************************************************
 
@@ -138,6 +154,27 @@ Handle PGP file in data directory
                    rather than based on XMAS. Now uses internal PDB 
                    CONECT information rather than keeping its own version
                    of the CONECT data
+-   V2.1  15.10.26 FindNonBonds() uses a cell-list grid rather than
+                   comparing each ligand/nucleotide atom with every
+                   atom in the structure
+-   V2.2  15.10.26 FindNonBonds() checks for existing HBonds with a
+                   hash set of atom pairs rather than walking the
+                   HBond list for every candidate pair
+-   V2.3  15.10.26 Peptide chains are flagged once in PDB.extras 
+                   rather than by counting the residues in the chain
+                   for every atom tested
+-   V2.4  15.10.26 FindProtProtHBonds() only tests residue pairs whose
+                   bounding spheres are within HBonding distance and
+                   no longer loses all but the first HBond found 
+                   between a pair of residues
+-   V2.5  15.10.26 Added -j to run the searches in parallel threads
+-   V2.6  15.10.26 Added -l and -d to process a list of files
+-   V2.7  15.10.26 Reads the PDB file with ReadMappedWholePDB() so
+                   binary cache files may be used
+-   V2.8  15.10.26 Cell-list grid and residue table moved to
+                   common/cellgrid.c
+-   V2.9  15.10.26 Searches fail with an error rather than giving incomplete
+                   lists if a thread runs out of memory
 
 *************************************************************************/
 /* Includes
@@ -146,14 +183,19 @@ Handle PGP file in data directory
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "bioplib/macros.h"
 #include "bioplib/SysDefs.h"
+#include "bioplib/MathType.h"
 #include "bioplib/pdb.h"
 #include "bioplib/hbond.h"
 #include "bioplib/hash.h"
 #include "bioplib/angle.h"
 #include "bioplib/general.h"
+#include "common/batch.h"
+#include "common/mappdb.h"
+#include "common/cellgrid.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -172,10 +214,22 @@ Handle PGP file in data directory
 #define MAX_CHAIN_STRING   8
 #define MAX_START_STRING   8
 #define MAX_PEPTIDE_LENGTH 30
+#define MAXTHREADS      1024  /* Max number of threads given with -j    */
+#define CHUNKSPERTHREAD    4  /* Each search is split into this many 
+                                 blocks per thread to share the work   */
+
+#define STAGE_PROTPROT     0  /* The searches, in output order          */
+#define STAGE_PROTLIG      1
+#define STAGE_PSEUDO       2
+#define STAGE_LIGLIG       3
+#define STAGE_NONBOND      4
+#define NSTAGES            5
 
 #define BOND_TOL             DEFCONECTTOL   /* Tolerance for a bond     */
 
 #define MAXHBONDDISTSQ       11.2225        /* 3.35A max HBond distance */
+#define MAXHADIST             2.5           /* Max H-A distance used by
+                                               BiopLib when H is known  */
 #define MAXBONDSQ             3.0           /* 1.732A max bond distance */
 #define MINNBDISTSQ           8.41          /* 2.9A min NB distance     */
 #define MAXNBDISTSQ          15.21          /* 3.9A max NB distance     */
@@ -193,13 +247,73 @@ typedef struct
 }  HBONDING;
 
 /* PDB.extras structure used for original atom numbers (before adding
-   hydrogens) and molecule IDs                                          */
+   hydrogens), molecule IDs and whether the atom is in a peptide       */
 typedef struct _pdbextras
 {
-   int origAtnum;
-   int molid;
+   int  origAtnum;
+   int  molid;
+   BOOL peptide;
 }  PDBEXTRAS;
 
+/* Open-addressed hash set of HBonded atom pairs. Slot i holds the pair
+   pairs[2*i], pairs[2*i+1] (NULL if empty) with the atoms stored in a
+   canonical order so that either orientation of a pair matches       */
+typedef struct
+{
+   PDB           **pairs;
+   unsigned long mask;  /* Number of slots - 1 (a power of 2 minus 1)   */
+}  HBONDSET;
+
+/* Data shared by the searches. This is set up before the searches are
+   run and is then only read                                            */
+typedef struct
+{
+   PDB      *pdb,           /* PDB linked list                          */
+            **pdbarray,     /* Atoms indexed by atom number             */
+            **atoms;        /* Atoms in linked list order               */
+   RESIDUE  *residues;      /* Residues in linked list order            */
+   CELLGRID *resGrid,       /* Grid of residue centres                  */
+            *atomGrid;      /* Grid of atoms                            */
+   HBONDSET *hbondSet;      /* Ligand HBonds to be skipped as non-bonds */
+   BOOL     *isHydrogen;    /* Flags hydrogens in atoms[]               */
+   REAL     minNBDistSq,
+            maxNBDistSq,
+            maxHBDistSq,
+            resHBDist;      /* Max residue gap for protein HBonds       */
+   int      natoms,
+            nres;
+}  HBSEARCH;
+
+/* A block of the outer loop of one search                              */
+typedef struct
+{
+   HBSEARCH *search;
+   HBLIST   *hblist;        /* HBonds or non-bonds found                */
+   int      stage,          /* Which search (STAGE_...)                 */
+            first,          /* Range of residues for STAGE_PROTPROT or  */
+            last;           /*   atoms otherwise                        */
+   BOOL     failed;         /* An allocation failed                     */
+}  HBJOB;
+
+/* Queue of jobs shared by the threads                                  */
+typedef struct
+{
+   HBJOB           *jobs;
+   int             njobs,
+                   next;
+   pthread_mutex_t lock;
+}  JOBQUEUE;
+
+/* Options and the open PGP file shared by all the files processed      */
+typedef struct
+{
+   FILE *pgp;
+   REAL minNBDistSq,
+        maxNBDistSq,
+        maxHBDistSq;
+   int  nthreads;
+}  HBPARAMS;
+
 
 
 /************************************************************************/
@@ -275,13 +389,25 @@ int main(int argc, char **argv);
 void Usage(void);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   char *pgpfile, REAL *minNBDistSq, REAL *maxNBDistSq, 
-                  REAL *maxHBDistSq);
-HBLIST *FindProtProtHBonds(PDB *pdb);
-HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray,
-                             BOOL pseudo, REAL maxHBDistSq);
-HBLIST *FindLigandLigandHBonds(PDB *pdb, 
-                               PDB **pdbarray, BOOL pseudo,
-                               REAL maxHBDistSq);
+                  REAL *maxHBDistSq, int *nthreads, char *listfile,
+                  char *outdir);
+BOOL FindFileHBonds(FILE *in, FILE *out, char *infile, void *data);
+BOOL FindInteractions(PDB *pdb, PDB **pdbarray, REAL minNBDistSq,
+                      REAL maxNBDistSq, REAL maxHBDistSq, int nthreads,
+                      HBLIST **hblists);
+int SplitSearch(HBSEARCH *search, int stage, int nchunks, HBJOB *jobs);
+BOOL IsOuterItem(HBSEARCH *search, int stage, int i);
+void RunJobQueue(HBJOB *jobs, int njobs, int nthreads);
+void *RunHBondJobs(void *arg);
+BOOL MergeJobLists(HBJOB *jobs, int njobs, HBLIST **hblists);
+BOOL JobsFailed(HBJOB *jobs, int njobs);
+BOOL RemoveDuplicateHBonds(HBLIST **hblist);
+HBLIST *FindProtProtHBonds(HBSEARCH *search, int first, int last,
+                           BOOL *failed);
+HBLIST *FindProtLigandHBonds(HBSEARCH *search, BOOL pseudo, 
+                             int first, int last);
+HBLIST *FindLigandLigandHBonds(HBSEARCH *search, BOOL pseudo, 
+                               int first, int last);
 void PrintHBList(FILE *out, HBLIST *hblist, char *type, BOOL relaxed);
 HBLIST *TestForHBond(PDB *pdb, PDB *p, PDB *q, PDB **pdbarray,
                      BOOL pseudo, REAL maxHBDistSq);
@@ -291,16 +417,23 @@ PDB *FindAntecedent(PDB *atom, PDB **pdbarray, int *count, int nth);
 PDB *FindBondedHydrogen(PDB *pdb, PDB *donor, PDB *acceptor);
 HBLIST *doTestForHBond(PDB *pdb, PDB *donor, PDB *acceptor, 
                        PDB **pdbarray, int donMax, REAL maxHBDistSq);
-HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray,
-                     HBLIST *hbonds, REAL minNBDistSq, REAL maxNBDistSq);
+HBLIST *FindNonBonds(HBSEARCH *search, int first, int last, 
+                     BOOL *failed);
 BOOL IsListedAsHBonded(PDB *p, PDB *q, HBLIST *hbonds);
-BOOL isAPeptide(PDB *pdb, PDB *atm);
+HBONDSET *CreateHBondSet(int npairs);
+BOOL AddToHBondSet(HBONDSET *set, PDB *p, PDB *q);
+void FreeHBondSet(HBONDSET *set);
+BOOL IsInHBondSet(HBONDSET *set, PDB *p, PDB *q);
+unsigned long HashAtomPair(PDB *p, PDB *q);
+BOOL SetPeptideFlags(PDB *pdb);
 void SetAtomNumExtras(PDB *pdb);
 BOOL UpdatePDBExtras(PDB *pdb);
 BOOL SetMolecules(PDB *pdb);
 void MarkLinkedResidues(PDB *chainStart, PDB *resStart, 
                         PDB *nextChain, int id);
 void DeleteMetalConects(PDB *pdb);
+int FindGridNeighbours(CELLGRID *grid, PDB **atoms, int i, 
+                       REAL minDistSq, REAL maxDistSq, int *neighbours);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -315,161 +448,206 @@ void DeleteMetalConects(PDB *pdb);
 -  16.06.99 Added min and max NB/HB distances as variables
 -  22.07.15 Modified to use PDB files and standard BiopLib structures
             and functions
+-  15.10.26 Added call to SetPeptideFlags()
+-  15.10.26 Passes maxHBDistSq to FindProtProtHBonds()
+-  15.10.26 Added -j. Searches are now run by FindInteractions() and
+            the results printed afterwards
+-  15.10.26 Added -l and -d. The work for each file is now done by
+            FindFileHBonds()
 */
 int main(int argc, char **argv)
 {
-   FILE       *in = stdin, 
-              *out = stdout,
-              *pgp;
-   PDB        *pdb,
-              **pdbarray;
-   int        nhyd,
-              indexSize;
-   char       infile[MAXBUFF],
-              outfile[MAXBUFF],
-              pgpfile[MAXBUFF];
-   HBLIST     *ppHBonds = NULL,
-              *plHBonds = NULL,
-              *llHBonds = NULL,
-              *pplHBonds = NULL,
-              *nbContacts = NULL,
-              *hb;
-   WHOLEPDB   *wpdb = NULL;
-   REAL       minNBDistSq = MINNBDISTSQ,
-              maxNBDistSq = MAXNBDISTSQ,
-              maxHBDistSq = MAXHBONDDISTSQ;
-   STRINGLIST *warnings = NULL;
+   FILE     *in = stdin, 
+            *out = stdout;
+   char     infile[MAXBUFF],
+            outfile[MAXBUFF],
+            pgpfile[MAXBUFF],
+            listfile[MAXBUFF],
+            outdir[MAXBUFF];
+   int      nfail;
+   HBPARAMS params;
+
+   params.minNBDistSq = MINNBDISTSQ;
+   params.maxNBDistSq = MAXNBDISTSQ;
+   params.maxHBDistSq = MAXHBONDDISTSQ;
+   params.nthreads    = 1;
    
-   if(ParseCmdLine(argc, argv, infile, outfile, pgpfile, &minNBDistSq, 
-                   &maxNBDistSq, &maxHBDistSq))
+   if(ParseCmdLine(argc, argv, infile, outfile, pgpfile, 
+                   &params.minNBDistSq, &params.maxNBDistSq, 
+                   &params.maxHBDistSq, &params.nthreads,
+                   listfile, outdir))
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
          /* Open the PGP file                                           */
-         if((pgp = blOpenPGPFile(pgpfile, FALSE))==NULL)
+         if((params.pgp = blOpenPGPFile(pgpfile, FALSE))==NULL)
          {
             fprintf(stderr,"pdbhbond: (error) Unable to open PGP file\n");
             return(1);
          }
-            
-         if((wpdb = blReadWholePDB(in))==NULL)
-         {
-            fprintf(stderr,"pdbhbond: (error) Unable to PDB file\n");
-            return(1);
-         }
+         blSetMaxProteinHBondDADistance((REAL)sqrt(params.maxHBDistSq));
 
-         if((pdb = wpdb->pdb)==NULL)
+         if(listfile[0])
          {
-            fprintf(stderr,"pdbhbond: (error) No atoms read from PDB \
-file\n");
-            return(1);
+            if((nfail = RunBatch(listfile, outdir, out, FindFileHBonds,
+                                 (void *)&params)) < 0)
+            {
+               fprintf(stderr,"pdbhbond: (error) Unable to read list \
+file, %s\n", listfile);
+               return(1);
+            }
+            if(nfail)
+            {
+               fprintf(stderr,"pdbhbond: (error) %d files could not be \
+processed\n", nfail);
+               return(1);
+            }
          }
-
-         /* Store the original atom numbers in the extras field         */
-         if(!UpdatePDBExtras(pdb))
+         else if(!FindFileHBonds(in, out, infile, (void *)&params))
          {
-            fprintf(stderr,"pdbhbond: (error) No memory for extra PDB \
-data\n");
             return(1);
          }
-         
-         SetAtomNumExtras(pdb);
+      }
+   }
+   else
+   {
+      Usage();
+   }
+   
+   
+   return(0);
+}
 
-         /* Add hydrogens to the protein                                */
-         if((nhyd = blHAddPDB(pgp, pdb))==0)
-         {
-            fprintf(stderr,"pdbhbond: (warning) No hydrogens added to \
-PDB file\n");
-         }
+/************************************************************************/
+/*>BOOL FindFileHBonds(FILE *in, FILE *out, char *infile, void *data)
+   ------------------------------------------------------------------
+*//**
+   \param[in]    *in          Input PDB file
+   \param[in]    *out         Output file
+   \param[in]    *infile      Input filename
+   \param[in]    *data        HBPARAMS options and PGP file
+   \return                    Success
+
+   Reads a PDB file, adds hydrogens and prints the HBonds and non-bonds.
+   Called directly or for each file by RunBatch(). The PGP file is
+   rewound so it can be used again for the next file.
+
+-  15.10.26 Original (split from main())   By: ACRM
+-  15.10.26 Uses ReadMappedWholePDB()
+-  15.10.26 Frees the structure on errors
+*/
+BOOL FindFileHBonds(FILE *in, FILE *out, char *infile, void *data)
+{
+   HBPARAMS   *params = (HBPARAMS *)data;
+   PDB        *pdb,
+              **pdbarray = NULL;
+   int        nhyd,
+              indexSize,
+              stage;
+   HBLIST     *hblists[NSTAGES];
+   WHOLEPDB   *wpdb = NULL;
+   STRINGLIST *warnings = NULL;
+   BOOL       ok        = FALSE;
 
-         /* Create extras fields for the extra hydrogen atoms           */
-         if(!UpdatePDBExtras(pdb))
-         {
-            fprintf(stderr,"pdbhbond: (error) No memory for extra PDB \
-data\n");
-            return(1);
-         }
+   if((wpdb = ReadMappedWholePDB(in))==NULL)
+   {
+      fprintf(stderr,"pdbhbond: (error) Unable to read PDB file %s\n", 
+              infile);
+      return(FALSE);
+   }
 
-         if((warnings = blSetPDBAtomTypes(pdb))!=NULL)
-         {
-            STRINGLIST *s;
-            for(s=warnings; s!=NULL; NEXT(s))
-            {
-               fprintf(stderr,"%s\n", s->string);
-            }
-         }
-         
-         SetMolecules(pdb);
+   if((pdb = wpdb->pdb)==NULL)
+   {
+      fprintf(stderr,"pdbhbond: (error) No atoms read from PDB \
+file %s\n", infile);
+      goto cleanup;
+   }
 
-         if((pdbarray=blIndexAtomNumbersPDB(pdb, &indexSize))==NULL)
-         {
-            fprintf(stderr,"pdbhbond: (error) Failed to index PDB \
+   /* Store the original atom numbers in the extras field               */
+   if(!UpdatePDBExtras(pdb))
+   {
+      fprintf(stderr,"pdbhbond: (error) No memory for extra PDB \
 data\n");
-            return(1);
-         }
+      goto cleanup;
+   }
+   
+   SetAtomNumExtras(pdb);
 
-         DeleteMetalConects(pdb);
-            
-         /* Find protein-protein HBonds                                 */
-         blSetMaxProteinHBondDADistance((REAL)sqrt(maxHBDistSq));
-         ppHBonds = FindProtProtHBonds(pdb);
-         PrintHBList(out, ppHBonds, "pphbonds", FALSE);
-         FREELIST(ppHBonds, HBLIST);
-
-         /* Find protein-ligand HBonds                                  */
-         plHBonds = FindProtLigandHBonds(pdb, pdbarray, FALSE,
-                                         maxHBDistSq);
-         PrintHBList(out, plHBonds, "plhbonds", TRUE);
-
-         /* Find protein-ligand pseudo-HBonds                           */
-         pplHBonds = FindProtLigandHBonds(pdb, pdbarray, TRUE,
-                                          maxHBDistSq);
-         PrintHBList(out, pplHBonds, "pseudohbonds", FALSE);
-
-         /* Join the pseudo-HBonds list onto the protein-ligand list    */
-         hb = plHBonds;
-         if(hb != NULL)
-         {
-            LAST(hb);
-            hb->next = pplHBonds;
-         }
-         else
-         {
-            plHBonds = hb = pplHBonds;
-         }
+   /* Add hydrogens to the protein                                      */
+   rewind(params->pgp);
+   if((nhyd = blHAddPDB(params->pgp, pdb))==0)
+   {
+      fprintf(stderr,"pdbhbond: (warning) No hydrogens added to \
+PDB file %s\n", infile);
+   }
 
-         /* Find ligand-ligand HBonds                                   */
-         llHBonds = FindLigandLigandHBonds(pdb, pdbarray, FALSE,
-                                           maxHBDistSq);
-         PrintHBList(out, llHBonds, "llhbonds", TRUE);
+   /* Create extras fields for the extra hydrogen atoms                 */
+   if(!UpdatePDBExtras(pdb))
+   {
+      fprintf(stderr,"pdbhbond: (error) No memory for extra PDB \
+data\n");
+      goto cleanup;
+   }
 
-         /* Join the ligand-ligand HBonds list onto the previous lists  */
-         if(hb!=NULL)
-         {
-            LAST(hb);
-            hb->next = llHBonds;
-         }
-         else
-         {
-            plHBonds = hb = llHBonds;
-         }
+   if((warnings = blSetPDBAtomTypes(pdb))!=NULL)
+   {
+      STRINGLIST *s;
+      for(s=warnings; s!=NULL; NEXT(s))
+      {
+         fprintf(stderr,"%s\n", s->string);
+      }
+      blFreeStringList(warnings);
+   }
+   
+   SetMolecules(pdb);
 
-         /* Find non-bonded contacts                                    */
-         nbContacts = FindNonBonds(pdb, pdbarray, plHBonds,
-                                   minNBDistSq, maxNBDistSq);
-         PrintHBList(out, nbContacts, "nonbonds", FALSE);
+   if(!SetPeptideFlags(pdb))
+   {
+      fprintf(stderr,"pdbhbond: (error) No memory for chain \
+list\n");
+      goto cleanup;
+   }
 
-         FREEPDBEXTRAS(pdb);
-         FREELIST(pdb, PDB);
-      }
+   if((pdbarray=blIndexAtomNumbersPDB(pdb, &indexSize))==NULL)
+   {
+      fprintf(stderr,"pdbhbond: (error) Failed to index PDB \
+data\n");
+      goto cleanup;
    }
-   else
+
+   DeleteMetalConects(pdb);
+      
+   /* Find protein-protein, protein-ligand, protein-ligand pseudo
+      and ligand-ligand HBonds and non-bonded contacts
+   */
+   if(!FindInteractions(pdb, pdbarray, params->minNBDistSq,
+                        params->maxNBDistSq, params->maxHBDistSq,
+                        params->nthreads, hblists))
    {
-      Usage();
+      fprintf(stderr,"pdbhbond: (error) No memory for HBond \
+searches\n");
+      goto cleanup;
    }
-   
-   
-   return(0);
+
+   PrintHBList(out, hblists[STAGE_PROTPROT], "pphbonds",     FALSE);
+   PrintHBList(out, hblists[STAGE_PROTLIG],  "plhbonds",     TRUE);
+   PrintHBList(out, hblists[STAGE_PSEUDO],   "pseudohbonds", FALSE);
+   PrintHBList(out, hblists[STAGE_LIGLIG],   "llhbonds",     TRUE);
+   PrintHBList(out, hblists[STAGE_NONBOND],  "nonbonds",     FALSE);
+
+   for(stage=0; stage<NSTAGES; stage++)
+   {
+      FREELIST(hblists[stage], HBLIST);
+   }
+
+   ok = TRUE;
+
+cleanup:
+   if(pdbarray != NULL) free(pdbarray);
+   FREEPDBEXTRAS(wpdb->pdb);
+   blFreeWholePDB(wpdb);
+
+   return(ok);
 }
 
 /************************************************************************/
@@ -482,14 +660,28 @@ data\n");
 -  09.06.99 Added -q
 -  16.06.99 Added -n, -x, -b
 -  22.07.15 V2.0. Added -p
+-  15.10.26 V2.1
+-  15.10.26 V2.2
+-  15.10.26 V2.3
+-  15.10.26 V2.4
+-  15.10.26 V2.5. Added -j
+-  15.10.26 V2.6. Added -l and -d
+-  15.10.26 V2.7
+-  15.10.26 V2.8
+-  15.10.26 V2.9
 
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbhbond V2.0 (c) 2015, Dr. Andrew C.R. Martin, \
+   fprintf(stderr,"\npdbhbond V2.9 (c) 2015-2026, Dr. Andrew C.R. Martin, \
 UCL\n");
    fprintf(stderr,"Usage: pdbhbond [-n dist][-x dist][-b dist]\
-[-p pgpfile] [infile [outfile]]\n");
+[-p pgpfile][-j nthreads]\n");
+   fprintf(stderr,"                [infile [outfile]]\n");
+   fprintf(stderr,"       pdbhbond [-n dist][-x dist][-b dist]\
+[-p pgpfile][-j nthreads]\n");
+   fprintf(stderr,"                -l listfile [-d outdir] \
+[outfile]\n");
    fprintf(stderr,"       -n  Minimum NBond distance (Default: %.2f)\n",
            sqrt(MINNBDISTSQ));
    fprintf(stderr,"       -x  Maximum NBond distance (Default: %.2f)\n",
@@ -498,17 +690,34 @@ UCL\n");
            sqrt(MAXHBONDDISTSQ));
    fprintf(stderr,"       -p  Specify PGP file containing data for \
 adding hydrogens\n");
+   fprintf(stderr,"       -j  Number of threads to use (Default: 1)\n");
+   fprintf(stderr,"       -l  Process each of the PDB files listed in \
+listfile ('-' for stdin)\n");
+   fprintf(stderr,"       -d  Write the results for each file to a file \
+of the same name in\n");
+   fprintf(stderr,"           outdir rather than all to outfile\n");
    fprintf(stderr,"\nIdentifies hydrogen bonds using simple Baker and \
 Hubbard rules for\n");
    fprintf(stderr,"the definition of a hydrogen bond.\n");
    fprintf(stderr,"I/O is to standard input/output if filenames are not \
-specified.\n\n");
+specified.\n");
+   fprintf(stderr,"\nWith -j, the searches are run at the same time and \
+each is split\n");
+   fprintf(stderr,"between the threads. The output is the same as with \
+one thread.\n");
+   fprintf(stderr,"\nWith -l, the PGP file is opened once for all the \
+files. Unless -d is\n");
+   fprintf(stderr,"used, the output for each file is preceded by a \
+'%s<filename>' line and\n", BATCH_BEGIN);
+   fprintf(stderr,"followed by '%s<filename> OK' (or FAILED).\n\n",
+           BATCH_END);
 }
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                      char *pgpfile, REAL *minNBDistSq, REAL *maxNBDistSq,
-                     REAL *maxHBDistSq)
+                     REAL *maxHBDistSq, int *nthreads, char *listfile,
+                     char *outdir)
    ---------------------------------------------------------------------
 *//**
    \param[in]    argc          Argument count
@@ -519,6 +728,9 @@ specified.\n\n");
    \param[out]   *minNBDistSq  Min non-bond distance
    \param[out]   *maxNBDistSq  Max non-bond distance
    \param[out]   *maxHBDistSq  Max HBond distance
+   \param[out]   *nthreads     Number of threads
+   \param[out]   *listfile     File listing input files (or blank string)
+   \param[out]   *outdir       Output directory (or blank string)
    \return                     Success
 
    Parse the command line
@@ -528,15 +740,18 @@ specified.\n\n");
 -  16.06.99 Added -n, -x, -b and associated parameters
 -  21.07.15 Removed -q
 -  22.07.15 Added -p and pgpfile
+-  15.10.26 Added -j and nthreads
+-  15.10.26 Added -l and -d. With -l, a filename is the output file
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                   char *pgpfile, REAL *minNBDistSq, REAL *maxNBDistSq,
-                  REAL *maxHBDistSq)
+                  REAL *maxHBDistSq, int *nthreads, char *listfile,
+                  char *outdir)
 {
    argc--;
    argv++;
    
-   infile[0] = outfile[0] = pgpfile[0] = '\0';
+   infile[0] = outfile[0] = pgpfile[0] = listfile[0] = outdir[0] = '\0';
    
    while(argc)
    {
@@ -578,6 +793,28 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
             strncpy(pgpfile, argv[0], MAXBUFF);
             pgpfile[MAXBUFF-1] = '\0';
             break;
+         case 'j':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            if(!sscanf(argv[0], "%d", nthreads) ||
+               (*nthreads < 1) || (*nthreads > MAXTHREADS))
+               return(FALSE);
+            break;
+         case 'l':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(listfile, argv[0], MAXBUFF);
+            listfile[MAXBUFF-1] = '\0';
+            break;
+         case 'd':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(outdir, argv[0], MAXBUFF);
+            outdir[MAXBUFF-1] = '\0';
+            break;
          default:
             return(FALSE);
             break;
@@ -585,6 +822,15 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
       }
       else
       {
+         /* With a list of files, only the output file may be given     */
+         if(listfile[0])
+         {
+            if(argc > 1)
+               return(FALSE);
+            strcpy(outfile, argv[0]);
+            return(TRUE);
+         }
+
          /* Check that there are 1-2 arguments left                     */
          if(argc > 2)
             return(FALSE);
@@ -603,71 +849,665 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          
          return(TRUE);
       }
-      argc--;
-      argv++;
+      argc--;
+      argv++;
+   }
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL FindInteractions(PDB *pdb, PDB **pdbarray, REAL minNBDistSq,
+                         REAL maxNBDistSq, REAL maxHBDistSq, int nthreads,
+                         HBLIST **hblists)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]    *pdb         PDB linked list
+   \param[in]    **pdbarray   Array of PDB pointers indexed by atom
+                              number
+   \param[in]    minNBDistSq  Minimum distance for non-bond contact
+   \param[in]    maxNBDistSq  Maximum distance for non-bond contact
+   \param[in]    maxHBDistSq  Max D-A HBond distance
+   \param[in]    nthreads     Number of threads to use
+   \param[out]   **hblists    Array of NSTAGES lists of HBonds/non-bonds
+                              indexed by STAGE_...
+   \return                    Success in allocations
+
+   Runs all the searches. The protein-protein, protein-ligand, pseudo
+   and ligand-ligand searches only read the structure, so they are run
+   together with the outer loop of each split into blocks that are 
+   shared between the threads. The non-bond search needs the ligand 
+   HBonds and is run (again split into blocks) once they are complete.
+   The blocks for each search are joined back together in order so the
+   results are the same whatever the number of threads. If any block
+   fails to allocate memory, the whole search fails rather than giving
+   incomplete lists.
+
+-  15.10.26 Original (searches split from main())
+-  15.10.26 Checks for jobs which failed
+*/
+BOOL FindInteractions(PDB *pdb, PDB **pdbarray, REAL minNBDistSq,
+                      REAL maxNBDistSq, REAL maxHBDistSq, int nthreads,
+                      HBLIST **hblists)
+{
+   HBSEARCH search;
+   HBJOB    *jobs    = NULL;
+   VEC3F    *coords  = NULL;
+   HBLIST   *h;
+   REAL     maxResRad = (REAL)0.0;
+   int      nchunks  = (nthreads > 1) ? nthreads * CHUNKSPERTHREAD : 1,
+            njobs,
+            npairs,
+            stage,
+            i;
+   BOOL     ok       = FALSE;
+
+   for(stage=0; stage<NSTAGES; stage++)
+      hblists[stage] = NULL;
+
+   search.pdb         = pdb;
+   search.pdbarray    = pdbarray;
+   search.atoms       = NULL;
+   search.residues    = NULL;
+   search.resGrid     = NULL;
+   search.atomGrid    = NULL;
+   search.hbondSet    = NULL;
+   search.isHydrogen  = NULL;
+   search.minNBDistSq = minNBDistSq;
+   search.maxNBDistSq = maxNBDistSq;
+   search.maxHBDistSq = maxHBDistSq;
+
+   /* With hydrogens present BiopLib tests the H-A distance rather than
+      the D-A distance, so allow for whichever is larger when pruning
+      residue pairs
+   */
+   search.resHBDist   = MAX((REAL)sqrt(maxHBDistSq), (REAL)MAXHADIST);
+
+   if(((search.atoms = blIndexPDB(pdb, &search.natoms))==NULL) ||
+      ((search.residues = BuildResidueTable(pdb, &search.nres))==NULL))
+      goto cleanup;
+
+   if(((coords = (VEC3F *)malloc(MAX(search.natoms, search.nres) *
+                                 sizeof(VEC3F)))==NULL) ||
+      ((search.isHydrogen = (BOOL *)malloc(search.natoms * 
+                                           sizeof(BOOL)))==NULL) ||
+      ((jobs = (HBJOB *)malloc(NSTAGES * nchunks * sizeof(HBJOB)))
+       ==NULL))
+      goto cleanup;
+
+   /* Grid of residue centres for protein-protein HBonds                */
+   for(i=0; i<search.nres; i++)
+   {
+      coords[i] = search.residues[i].centre;
+      maxResRad = MAX(maxResRad, search.residues[i].radius);
+   }
+   if((search.resGrid = BuildCellGrid(coords, search.nres, 
+                                      search.resHBDist + 
+                                      (REAL)2.0 * maxResRad))==NULL)
+      goto cleanup;
+
+   /* Grid of atoms for non-bonds                                       */
+   for(i=0; i<search.natoms; i++)
+   {
+      coords[i].x          = search.atoms[i]->x;
+      coords[i].y          = search.atoms[i]->y;
+      coords[i].z          = search.atoms[i]->z;
+      search.isHydrogen[i] = (BOOL)!strcmp(search.atoms[i]->element, "H");
+   }
+   if((search.atomGrid = BuildCellGrid(coords, search.natoms, 
+                                       (REAL)sqrt(maxNBDistSq)))==NULL)
+      goto cleanup;
+
+   /* Run the HBond searches                                            */
+   for(stage=STAGE_PROTPROT, njobs=0; stage<=STAGE_LIGLIG; stage++)
+      njobs += SplitSearch(&search, stage, nchunks, jobs+njobs);
+   RunJobQueue(jobs, njobs, nthreads);
+   if(JobsFailed(jobs, njobs) || !MergeJobLists(jobs, njobs, hblists))
+      goto cleanup;
+
+   /* Build the set of ligand HBonds which are not non-bonded contacts  */
+   for(stage=STAGE_PROTLIG, npairs=0; stage<=STAGE_LIGLIG; stage++)
+   {
+      for(h=hblists[stage]; h!=NULL; NEXT(h))
+         npairs++;
+   }
+   if((search.hbondSet = CreateHBondSet(npairs))==NULL)
+      goto cleanup;
+   for(stage=STAGE_PROTLIG; stage<=STAGE_LIGLIG; stage++)
+   {
+      for(h=hblists[stage]; h!=NULL; NEXT(h))
+         AddToHBondSet(search.hbondSet, h->donor, h->acceptor);
+   }
+
+   /* Run the non-bond search                                           */
+   njobs = SplitSearch(&search, STAGE_NONBOND, nchunks, jobs);
+   RunJobQueue(jobs, njobs, nthreads);
+   if(JobsFailed(jobs, njobs) || !MergeJobLists(jobs, njobs, hblists))
+      goto cleanup;
+
+   ok = TRUE;
+
+cleanup:
+   if(!ok)
+   {
+      for(stage=0; stage<NSTAGES; stage++)
+      {
+         FREELIST(hblists[stage], HBLIST);
+         hblists[stage] = NULL;
+      }
+   }
+   FreeHBondSet(search.hbondSet);
+   FreeCellGrid(search.atomGrid);
+   FreeCellGrid(search.resGrid);
+   if(search.isHydrogen != NULL) free(search.isHydrogen);
+   if(search.residues   != NULL) free(search.residues);
+   if(search.atoms      != NULL) free(search.atoms);
+   if(coords            != NULL) free(coords);
+   if(jobs              != NULL) free(jobs);
+
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>int SplitSearch(HBSEARCH *search, int stage, int nchunks, HBJOB *jobs)
+   ----------------------------------------------------------------------
+*//**
+   \param[in]    *search      Data shared by the searches
+   \param[in]    stage        The search (STAGE_...)
+   \param[in]    nchunks      Number of blocks required
+   \param[out]   *jobs        Jobs for the blocks
+   \return                    Number of jobs created
+
+   Splits the outer loop (over residues for STAGE_PROTPROT or atoms
+   for the others) into blocks with similar numbers of the residues or
+   atoms which are actually searched from, since ligands are usually
+   grouped at the end of the file. Fewer blocks are created if there
+   are not enough of these.
+
+-  15.10.26 Original
+*/
+int SplitSearch(HBSEARCH *search, int stage, int nchunks, HBJOB *jobs)
+{
+   int nitems = (stage==STAGE_PROTPROT) ? search->nres : search->natoms,
+       nouter = 0,
+       count  = 0,
+       target,
+       chunk,
+       i;
+
+   for(i=0; i<nitems; i++)
+   {
+      if(IsOuterItem(search, stage, i))
+         nouter++;
+   }
+   nchunks = MAX(MIN(nchunks, nouter), 1);
+
+   for(chunk=0, i=0; chunk<nchunks; chunk++)
+   {
+      jobs[chunk].search = search;
+      jobs[chunk].hblist = NULL;
+      jobs[chunk].failed = FALSE;
+      jobs[chunk].stage  = stage;
+      jobs[chunk].first  = i;
+
+      target = (int)(((double)nouter * (chunk+1)) / nchunks);
+      while((i < nitems) && (count < target))
+      {
+         if(IsOuterItem(search, stage, i))
+            count++;
+         i++;
+      }
+      if(chunk == nchunks-1)
+         i = nitems;
+
+      jobs[chunk].last = i;
+   }
+
+   return(nchunks);
+}
+
+
+/************************************************************************/
+/*>BOOL IsOuterItem(HBSEARCH *search, int stage, int i)
+   ----------------------------------------------------
+*//**
+   \param[in]    *search      Data shared by the searches
+   \param[in]    stage        The search (STAGE_...)
+   \param[in]    i            Residue index for STAGE_PROTPROT or atom
+                              index otherwise
+   \return                    Is this searched from in the outer loop?
+
+   Tests whether the outer loop of a search does any work for a residue
+   or atom. Used to balance the blocks in SplitSearch().
+
+-  15.10.26 Original
+*/
+BOOL IsOuterItem(HBSEARCH *search, int stage, int i)
+{
+   PDB  *p;
+   BOOL isLigand;
+   
+   if(stage == STAGE_PROTPROT)
+   {
+      p = search->residues[i].start;
+      return((BOOL)(!(p->atomtype & ATOMTYPE_NONRESIDUE) &&
+                    (p->atomtype != ATOMTYPE_UNDEF)));
+   }
+
+   p        = search->atoms[i];
+   isLigand = (BOOL)((p->atomtype & ATOMTYPE_NONRESIDUE) &&
+                     (p->atomtype != ATOMTYPE_WATER));
+   
+   switch(stage)
+   {
+   case STAGE_PSEUDO:
+   case STAGE_LIGLIG:
+      return(isLigand);
+   case STAGE_NONBOND:
+      if(search->isHydrogen[i])
+         return(FALSE);
+      /* Fall through                                                   */
+   case STAGE_PROTLIG:
+      return((BOOL)(isLigand ||
+                    (p->atomtype == ATOMTYPE_NUC)    ||
+                    (p->atomtype == ATOMTYPE_MODNUC) ||
+                    PDBEXTRASPTR(p, PDBEXTRAS)->peptide));
+   }
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>void RunJobQueue(HBJOB *jobs, int njobs, int nthreads)
+   ------------------------------------------------------
+*//**
+   \param[in,out]  *jobs      Array of jobs
+   \param[in]      njobs      Number of jobs
+   \param[in]      nthreads   Number of threads to use
+
+   Runs the jobs using up to nthreads threads (including the calling 
+   thread) which each take the next job from a shared queue until none
+   are left. If threads cannot be created, the calling thread does the
+   remaining work.
+
+-  15.10.26 Original
+*/
+void RunJobQueue(HBJOB *jobs, int njobs, int nthreads)
+{
+   JOBQUEUE  queue;
+   pthread_t *threads  = NULL;
+   int       nstarted = 0,
+             i;
+
+   queue.jobs  = jobs;
+   queue.njobs = njobs;
+   queue.next  = 0;
+   pthread_mutex_init(&(queue.lock), NULL);
+
+   nthreads = MIN(nthreads, njobs);
+   if(nthreads > 1)
+   {
+      if((threads = (pthread_t *)malloc((nthreads-1) * 
+                                        sizeof(pthread_t)))!=NULL)
+      {
+         for(i=0; i<nthreads-1; i++)
+         {
+            if(pthread_create(&(threads[nstarted]), NULL, RunHBondJobs,
+                              (void *)&queue))
+               break;
+            nstarted++;
+         }
+      }
+   }
+
+   RunHBondJobs((void *)&queue);
+
+   for(i=0; i<nstarted; i++)
+      pthread_join(threads[i], NULL);
+
+   if(threads != NULL) free(threads);
+   pthread_mutex_destroy(&(queue.lock));
+}
+
+
+/************************************************************************/
+/*>void *RunHBondJobs(void *arg)
+   -----------------------------
+*//**
+   \param[in,out]  *arg       JOBQUEUE of jobs
+   \return                    NULL
+
+   Thread function which runs jobs from the queue until it is empty
+
+-  15.10.26 Original
+*/
+void *RunHBondJobs(void *arg)
+{
+   JOBQUEUE *queue = (JOBQUEUE *)arg;
+   HBJOB    *job;
+
+   for(;;)
+   {
+      pthread_mutex_lock(&(queue->lock));
+      job = (queue->next < queue->njobs) ? 
+         queue->jobs + (queue->next)++ : NULL;
+      pthread_mutex_unlock(&(queue->lock));
+
+      if(job == NULL)
+         break;
+
+      switch(job->stage)
+      {
+      case STAGE_PROTPROT:
+         job->hblist = FindProtProtHBonds(job->search, 
+                                          job->first, job->last,
+                                          &(job->failed));
+         break;
+      case STAGE_PROTLIG:
+         job->hblist = FindProtLigandHBonds(job->search, FALSE,
+                                            job->first, job->last);
+         break;
+      case STAGE_PSEUDO:
+         job->hblist = FindProtLigandHBonds(job->search, TRUE,
+                                            job->first, job->last);
+         break;
+      case STAGE_LIGLIG:
+         job->hblist = FindLigandLigandHBonds(job->search, FALSE,
+                                              job->first, job->last);
+         break;
+      case STAGE_NONBOND:
+         job->hblist = FindNonBonds(job->search, job->first, job->last,
+                                    &(job->failed));
+         break;
+      }
+   }
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>BOOL MergeJobLists(HBJOB *jobs, int njobs, HBLIST **hblists)
+   ------------------------------------------------------------
+*//**
+   \param[in,out]  *jobs      Array of jobs (the lists are taken over)
+   \param[in]      njobs      Number of jobs
+   \param[in,out]  **hblists  Array of lists indexed by STAGE_...
+   \return                    Success in allocations
+
+   Joins the lists from the jobs for each search in order. The ligand
+   searches skip atom pairs already in their HBond list, so if the two
+   atoms were searched from in different blocks the pair may have been
+   found twice and the later copy is removed.
+
+-  15.10.26 Original
+*/
+BOOL MergeJobLists(HBJOB *jobs, int njobs, HBLIST **hblists)
+{
+   HBLIST *tail[NSTAGES];
+   BOOL   split[NSTAGES];
+   int    stage,
+          i;
+
+   for(stage=0; stage<NSTAGES; stage++)
+   {
+      tail[stage]  = hblists[stage];
+      split[stage] = FALSE;
+      if(tail[stage] != NULL)
+         LAST(tail[stage]);
+   }
+
+   for(i=0; i<njobs; i++)
+   {
+      stage = jobs[i].stage;
+      if(jobs[i].hblist == NULL)
+         continue;
+      
+      if(tail[stage] == NULL)
+      {
+         hblists[stage] = jobs[i].hblist;
+      }
+      else
+      {
+         tail[stage]->next = jobs[i].hblist;
+         split[stage]      = TRUE;
+      }
+      tail[stage] = jobs[i].hblist;
+      LAST(tail[stage]);
+      jobs[i].hblist = NULL;
+   }
+
+   for(stage=STAGE_PROTLIG; stage<=STAGE_LIGLIG; stage++)
+   {
+      if(split[stage] && !RemoveDuplicateHBonds(&(hblists[stage])))
+         return(FALSE);
+   }
+   
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>BOOL JobsFailed(HBJOB *jobs, int njobs)
+   ---------------------------------------
+*//**
+   \param[in,out]  *jobs      Array of jobs
+   \param[in]      njobs      Number of jobs
+   \return                    Did any job fail?
+
+   Checks whether any job failed to allocate memory. The lists from all
+   the jobs are freed if so.
+
+-  15.10.26 Original
+*/
+BOOL JobsFailed(HBJOB *jobs, int njobs)
+{
+   BOOL failed = FALSE;
+   int  i;
+
+   for(i=0; i<njobs; i++)
+   {
+      if(jobs[i].failed)
+         failed = TRUE;
+   }
+
+   if(failed)
+   {
+      for(i=0; i<njobs; i++)
+      {
+         FREELIST(jobs[i].hblist, HBLIST);
+         jobs[i].hblist = NULL;
+      }
+   }
+
+   return(failed);
+}
+
+
+/************************************************************************/
+/*>BOOL RemoveDuplicateHBonds(HBLIST **hblist)
+   -------------------------------------------
+*//**
+   \param[in,out]  **hblist   List of HBonds
+   \return                    Success in allocations
+
+   Removes any HBond between the same pair of atoms (in either 
+   orientation) as an earlier HBond in the list
+
+-  15.10.26 Original
+*/
+BOOL RemoveDuplicateHBonds(HBLIST **hblist)
+{
+   HBONDSET *set;
+   HBLIST   *h,
+            *prev = NULL,
+            *next;
+   int      npairs = 0;
+
+   for(h=*hblist; h!=NULL; NEXT(h))
+      npairs++;
+   if((set = CreateHBondSet(npairs))==NULL)
+      return(FALSE);
+
+   for(h=*hblist; h!=NULL; h=next)
+   {
+      next = h->next;
+      if(AddToHBondSet(set, h->donor, h->acceptor))
+      {
+         prev = h;
+      }
+      else
+      {
+         if(prev == NULL)
+            *hblist = next;
+         else
+            prev->next = next;
+         free(h);
+      }
    }
-   
+
+   FreeHBondSet(set);
    return(TRUE);
 }
 
 
 /************************************************************************/
-/*>HBLIST *FindProtProtHBonds(PDB *pdb)
-   ------------------------------------
+/*>HBLIST *FindProtProtHBonds(HBSEARCH *search, int first, int last,
+                              BOOL *failed)
+   -----------------------------------------------------------------
 *//**
-   \param[in]   *pdb    PDB linked list
-   \return              Linked list of protein-protein HBonds
+   \param[in]   *search      Data shared by the searches
+   \param[in]   first        First residue to search from
+   \param[in]   last         Residue after the last to search from
+   \param[out]  *failed      Set to TRUE if memory allocation fails
+   \return                   Linked list of protein-protein HBonds
 
-   Create a list of HBonds within the protein
+   Create a list of HBonds within the protein between residues
+   first...last-1 and all following residues
+
+   Residue centres are placed on a cell-list grid and blListAllHBonds()
+   is only called for pairs of residues whose bounding spheres are 
+   within HBonding distance (search->resHBDist). Pairs are still tested
+   in linked list order, so the HBonds are listed in the same order as
+   testing every pair.
 
 -  07.06.99 Original   By: ACRM
 -  22.07.15 Modified to use PDB files and standard BiopLib structures
             and functions
+-  15.10.26 Added maxHBDistSq parameter and residue grid. No longer
+            uses a static list. Moves to the end of the list after
+            adding HBonds so that all HBonds for a residue pair are
+            kept rather than just the first
+-  15.10.26 Now takes the residue table and grid in search and works
+            on a range of residues
+-  15.10.26 Added failed parameter
 */
-HBLIST *FindProtProtHBonds(PDB *pdb)
+HBLIST *FindProtProtHBonds(HBSEARCH *search, int first, int last,
+                           BOOL *failed)
 {
-   PDB           *p, *q;
-   static HBLIST *hblist = NULL,
-                 *hbl,
-                 *hb;
-   
+   RESIDUE  *residues   = search->residues;
+   CELLGRID *grid       = search->resGrid;
+   HBLIST   *hblist     = NULL,
+            *hbl        = NULL,
+            *hb;
+   int      *neighbours,
+            nneighbours,
+            i, j, k,
+            cx, cy, cz,
+            ix, iy, iz,
+            cell;
    
+   if((neighbours = (int *)malloc(search->nres * sizeof(int)))==NULL)
+   {
+      fprintf(stderr,"pdbhbond: (error) No memory for residue \
+neighbours\n");
+      *failed = TRUE;
+      return(NULL);
+   }
+
    /* Loop through each residue                                         */
-   for(p=pdb; p!=NULL; p=blFindNextResidue(p))
+   for(i=first; i<last; i++)
    {
-      /* If it's a protein/nucleotide                                   */
-      if(!(p->atomtype & ATOMTYPE_NONRESIDUE) &&
-         (p->atomtype != ATOMTYPE_UNDEF))
+      PDB *p = residues[i].start;
+      
+      /* Skip unless it's a protein/nucleotide                          */
+      if((p->atomtype & ATOMTYPE_NONRESIDUE) ||
+         (p->atomtype == ATOMTYPE_UNDEF))
+         continue;
+
+      /* Find the following protein/nucleotide residues close enough to
+         HBond
+      */
+      nneighbours = 0;
+      cell = grid->itemCell[i];
+      cx   = cell % grid->nx;
+      cy   = (cell / grid->nx) % grid->ny;
+      cz   = cell / (grid->nx * grid->ny);
+
+      for(iz=MAX(cz-1, 0); iz<=MIN(cz+1, grid->nz-1); iz++)
       {
-         
-         /* Loop through each following residue                         */
-         for(q=blFindNextResidue(p); q!=NULL; q=blFindNextResidue(q))
+         for(iy=MAX(cy-1, 0); iy<=MIN(cy+1, grid->ny-1); iy++)
          {
-            if(p==q)
-               continue;
-            
-            /* If it's a protein/nucleotide                             */
-            if(!(q->atomtype & ATOMTYPE_NONRESIDUE) &&
-               (q->atomtype != ATOMTYPE_UNDEF))
+            for(ix=MAX(cx-1, 0); ix<=MIN(cx+1, grid->nx-1); ix++)
             {
-               /* If there is an HBond, add it to the list              */
-               if((hb=blListAllHBonds(p, q))!=NULL)
+               cell = ix + grid->nx * (iy + grid->ny * iz);
+               for(j=grid->cellStart[cell]; j<grid->cellStart[cell+1]; j++)
                {
-                  if(hblist==NULL)
-                  {
-                     hblist = hbl = hb;
-                  }
-                  else
-                  {
-                     hbl->next = hb;
-                     hbl       = hb;
-                  }
+                  PDB  *q;
+                  REAL maxDist;
+                  
+                  k = grid->cellItems[j];
+                  if(k <= i)
+                     continue;
+
+                  q = residues[k].start;
+                  if((q->atomtype & ATOMTYPE_NONRESIDUE) ||
+                     (q->atomtype == ATOMTYPE_UNDEF))
+                     continue;
+
+                  /* Skip if the bounding spheres are too far apart     */
+                  maxDist = residues[i].radius + residues[k].radius +
+                            search->resHBDist;
+                  if(DISTSQ(&(residues[i].centre), &(residues[k].centre))
+                     > maxDist * maxDist)
+                     continue;
+
+                  neighbours[nneighbours++] = k;
                }
             }
          }
       }
+
+      /* Insertion sort back into linked list order                     */
+      for(j=1; j<nneighbours; j++)
+      {
+         int key = neighbours[j];
+         for(k=j-1; k>=0 && neighbours[k] > key; k--)
+            neighbours[k+1] = neighbours[k];
+         neighbours[k+1] = key;
+      }
+      
+      for(j=0; j<nneighbours; j++)
+      {
+         /* If there is an HBond, add it to the list                    */
+         if((hb=blListAllHBonds(p, residues[neighbours[j]].start))!=NULL)
+         {
+            if(hblist==NULL)
+            {
+               hblist = hbl = hb;
+            }
+            else
+            {
+               hbl->next = hb;
+            }
+            LAST(hbl);
+         }
+      }
    }
 
+   free(neighbours);
    return(hblist);
 }
 
@@ -1294,26 +2134,30 @@ HBLIST *doTestForHBond(PDB *pdb, PDB *donor, PDB *acceptor,
 
 
 /************************************************************************/
-/*>HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, HBLIST *hbonds,
-                        REAL minNBDistSq, REAL maxNBDistSq)
-   --------------------------------------------------------------
+/*>HBLIST *FindNonBonds(HBSEARCH *search, int first, int last,
+                        BOOL *failed)
+   -----------------------------------------------------------
 *//**
-   \param[in]    *pdb         The PDB linked list
-   \param[in]    **pdbarray   Array of PDB structure indexed by atom
-                              number
-   \param[in]    *hbonds      Linked list of HBonds
-   \param[in]    minNBDistSq  Minimum distance for non-bond contact
-   \param[in]    maxNBDistSq  Maximum distance for non-bond contact
+   \param[in]    *search      Data shared by the searches
+   \param[in]    first        First atom to search from
+   \param[in]    last         Atom after the last to search from
+   \param[out]   *failed      Set to TRUE if memory allocation fails
    \return                    Linked list of non-bonds
 
    Finds non-bonded contacts between ligand and protein/nucleotide or
-   between nucleotide and protein.
+   between nucleotide and protein, searching from atoms first...last-1
+   (in linked list order).
 
 -  1. For atom pairs within a distance cutoff: 2.7 - 3.35A (centre-centre)
 -  2. a) Not covalently bonded
       b) Not H-bonded
       c) Not in the same residue
 
+   Candidate partners are taken from a cell-list grid with cells of
+   edge maxNBDistSq (as a distance) and are visited in linked list
+   order, so the output order is the same as comparing against every
+   atom. HBonded pairs are looked up in search->hbondSet.
+
 -  07.06.99 Original   By: ACRM
 -  16.06.99 Does NBond interactions for peptides
             Initialise nb to NULL
@@ -1322,35 +2166,86 @@ HBLIST *doTestForHBond(PDB *pdb, PDB *donor, PDB *acceptor,
             min and max distances now variables (and parameters)
 -  21.07.15 Modified to use PDB files and standard BiopLib structures
             and functions - added pdb parameter. 
+-  15.10.26 Uses a cell-list grid to find atoms within maxNBDistSq.
+            Hydrogens are flagged once rather than with strcmp() for
+            every pair
+-  15.10.26 Checks the HBond list via a hash set of atom pairs
+-  15.10.26 Uses the peptide flag from PDB.extras
+-  15.10.26 Now takes the grid, hydrogen flags and HBond set in search
+            and works on a range of atoms
+-  15.10.26 Added failed parameter
 */
-HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, HBLIST *hbonds, 
-                     REAL minNBDistSq, REAL maxNBDistSq)
+HBLIST *FindNonBonds(HBSEARCH *search, int first, int last, 
+                     BOOL *failed)
 {
-   PDB    *p, 
-          *q;
-   REAL   distSq;
-   HBLIST *nblist = NULL,
-          *nb     = NULL;
-   BOOL   isPeptide;
-   
+   PDB      *p, 
+            *q,
+            **atoms      = search->atoms;
+   HBLIST   *nblist      = NULL,
+            *nb          = NULL;
+   BOOL     isPeptide,
+            isNucleotide,
+            *isHydrogen  = search->isHydrogen;
+   int      *neighbours,
+            nneighbours,
+            i, j;
+
+   if((neighbours = (int *)malloc(search->natoms * sizeof(int)))==NULL)
+   {
+      fprintf(stderr,"pdbhbond: (error) No memory for non-bond \
+neighbours\n");
+      *failed = TRUE;
+      return(NULL);
+   }
 
-   for(p=pdb; p!=NULL; NEXT(p))
+   for(i=first; i<last; i++)
    {
+      p = atoms[i];
+      
       /* Skip hydrogens                                                 */
-      if(!strcmp(p->element, "H"))
+      if(isHydrogen[i])
          continue;
       
-      isPeptide = isAPeptide(pdb, p);
+      isPeptide = PDBEXTRASPTR(p, PDBEXTRAS)->peptide;
       
-      /* If it's a HET/METAL/BOUNDHET or a peptide                      */
+      /* If it's a HET/METAL/BOUNDHET or a peptide we look for
+         interactions with protein/nucleotide. If it's a nucleotide
+         we look for interactions with protein
+      */
       if(((p->atomtype & ATOMTYPE_NONRESIDUE) && 
           (p->atomtype != ATOMTYPE_WATER)) ||
          isPeptide)
       {
-         for(q=pdb; q!=NULL; NEXT(q))
+         isNucleotide = FALSE;
+      }
+      else if((p->atomtype == ATOMTYPE_NUC) || 
+              (p->atomtype == ATOMTYPE_MODNUC))
+      {
+         isNucleotide = TRUE;
+      }
+      else
+      {
+         continue;
+      }
+
+      nneighbours = FindGridNeighbours(search->atomGrid, atoms, i, 
+                                       search->minNBDistSq,
+                                       search->maxNBDistSq, neighbours);
+      for(j=0; j<nneighbours; j++)
+      {
+         q = atoms[neighbours[j]];
+
+         if(isNucleotide)
+         {
+            if((q->atomtype != ATOMTYPE_ATOM)    &&
+               (q->atomtype != ATOMTYPE_MODPROT) &&
+               (q->atomtype != ATOMTYPE_NONSTDAA))
+               continue;
+         }
+         else
          {
             /* Skip hydrogens                                           */
-            if(!strcmp(q->element, "H"))
+            if(isHydrogen[neighbours[j]])
                continue;
 
             /* If our first molecule is a peptide, then skip if this is
@@ -1361,90 +2256,114 @@ HBLIST *FindNonBonds(PDB *pdb, PDB **pdbarray, HBLIST *hbonds,
                 PDBEXTRASPTR(q, PDBEXTRAS)->molid))
                continue;
 
-            if(p==q)
+            /* Skip unless it's a protein/nucleotide                    */
+            if((q->atomtype & ATOMTYPE_NONRESIDUE) ||
+               (q->atomtype == ATOMTYPE_UNDEF))
                continue;
-
-            /* If it's a protein/nucleotide                             */
-            if(!(q->atomtype & ATOMTYPE_NONRESIDUE) &&
-                (q->atomtype != ATOMTYPE_UNDEF))
+         }
+         
+         if(!RESIDMATCH(p, q)  &&
+            !blIsConected(p, q) &&
+            !IsInHBondSet(search->hbondSet, p, q))
+         {
+            if(nblist==NULL)
             {
-               distSq = DISTSQ(p,q);
-               if(distSq >= minNBDistSq && distSq <= maxNBDistSq)
-               {
-                  if(!RESIDMATCH(p, q)  &&
-                     !blIsConected(p, q) &&
-                     !IsListedAsHBonded(p, q, hbonds))
-                  {
-                     if(nblist==NULL)
-                     {
-                        INIT(nblist, HBLIST);
-                        nb = nblist;
-                     }
-                     else
-                     {
-                        ALLOCNEXT(nb, HBLIST);
-                     }
-                     if(nb==NULL)
-                     {
-                        FREELIST(nblist, HBLIST);
-                        fprintf(stderr,"pdbhbond: (error) No memory for \
+               INIT(nblist, HBLIST);
+               nb = nblist;
+            }
+            else
+            {
+               ALLOCNEXT(nb, HBLIST);
+            }
+            if(nb==NULL)
+            {
+               FREELIST(nblist, HBLIST);
+               fprintf(stderr,"pdbhbond: (error) No memory for \
 Non-bond list\n");
-                        return(NULL);
-                     }
-                     nb->donor    = p;
-                     nb->acceptor = q;
-                  }
-               }
+               free(neighbours);
+               *failed = TRUE;
+               return(NULL);
             }
+            nb->donor    = p;
+            nb->acceptor = q;
          }
       }
-      else if((p->atomtype == ATOMTYPE_NUC) || 
-              (p->atomtype == ATOMTYPE_MODNUC))
+   }
+
+   free(neighbours);
+   return(nblist);
+}
+
+
+/************************************************************************/
+/*>int FindGridNeighbours(CELLGRID *grid, PDB **atoms, int i, 
+                          REAL minDistSq, REAL maxDistSq, int *neighbours)
+   -----------------------------------------------------------------------
+*//**
+   \param[in]      *grid        Cell-list grid of the atoms
+   \param[in]      **atoms      Atoms in linked list order
+   \param[in]      i            Index of the central atom
+   \param[in]      minDistSq    Minimum squared distance
+   \param[in]      maxDistSq    Maximum squared distance (must not 
+                                exceed the square of the cell size)
+   \param[out]     *neighbours  Indexes of atoms within the distance
+                                range in ascending (linked list) order
+   \return                      Number of neighbours
+
+   Finds the atoms between minDistSq and maxDistSq of atom i (which is
+   itself excluded) by searching this and the 26 adjacent grid cells
+
+-  15.10.26 Original
+*/
+int FindGridNeighbours(CELLGRID *grid, PDB **atoms, int i, 
+                       REAL minDistSq, REAL maxDistSq, int *neighbours)
+{
+   PDB  *p = atoms[i];
+   REAL distSq;
+   int  j, k, n = 0,
+        cx, cy, cz,
+        ix, iy, iz,
+        cell;
+
+   cell = grid->itemCell[i];
+   cx   = cell % grid->nx;
+   cy   = (cell / grid->nx) % grid->ny;
+   cz   = cell / (grid->nx * grid->ny);
+
+   /* Step through this cell and the 26 cells around it                 */
+   for(iz=MAX(cz-1, 0); iz<=MIN(cz+1, grid->nz-1); iz++)
+   {
+      for(iy=MAX(cy-1, 0); iy<=MIN(cy+1, grid->ny-1); iy++)
       {
-         /* If it's a nucleotide
-            Look for interactions with protein
-         */
-         for(q=pdb; q!=NULL; NEXT(q))
+         for(ix=MAX(cx-1, 0); ix<=MIN(cx+1, grid->nx-1); ix++)
          {
-            if(p==q)
-               continue;
-
-            if((q->atomtype == ATOMTYPE_ATOM) ||
-               (q->atomtype == ATOMTYPE_MODPROT) ||
-               (q->atomtype == ATOMTYPE_NONSTDAA))
+            cell = ix + grid->nx * (iy + grid->ny * iz);
+            for(j=grid->cellStart[cell]; j<grid->cellStart[cell+1]; j++)
             {
-               distSq = DISTSQ(p,q);
-               if(distSq >= minNBDistSq && distSq <= maxNBDistSq)
-               {
-                  if(!RESIDMATCH(p, q) &&
-                     !blIsConected(p, q) &&
-                     !IsListedAsHBonded(p, q, hbonds))
-                  {
-                     if(nblist==NULL)
-                     {
-                        INIT(nblist, HBLIST);
-                        nb = nblist;
-                     }
-                     else
-                     {
-                        ALLOCNEXT(nb, HBLIST);
-                     }
-                     if(nb==NULL)
-                     {
-                        FREELIST(nblist, HBLIST);
-                        fprintf(stderr,"pdbhbond: (error) No memory for \
-Non-bond list\n");
-                        return(NULL);
-                     }
-                     nb->donor    = p;
-                     nb->acceptor = q;
-                  }
-               }
+               k = grid->cellItems[j];
+               if(k == i)
+                  continue;
+
+               distSq = DISTSQ(p, atoms[k]);
+               if(distSq >= minDistSq && distSq <= maxDistSq)
+                  neighbours[n++] = k;
             }
          }
       }
    }
-   return(nblist);
+
+   /* Insertion sort back into linked list order - there are only ever
+      a handful of neighbours
+   */
+   for(j=1; j<n; j++)
+   {
+      int key = neighbours[j];
+      for(k=j-1; k>=0 && neighbours[k] > key; k--)
+         neighbours[k+1] = neighbours[k];
+      neighbours[k+1] = key;
+   }
+
+   return(n);
 }
 
 
@@ -1482,18 +2401,176 @@ BOOL IsListedAsHBonded(PDB *p, PDB *q, HBLIST *hbonds)
 
 
 /************************************************************************/
-/*>HBLIST *FindLigandLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
-                                  REAL maxHBDistSq)
-   ---------------------------------------------------------------------
+/*>HBONDSET *CreateHBondSet(int npairs)
+   -------------------------------------
+*//**
+   \param[in]     npairs  Maximum number of atom pairs to be stored
+   \return                Malloc'd empty hash set of HBonded atom pairs
+                          (NULL if no memory)
+
+   Creates a hash set of atom pairs so that IsInHBondSet() can replace
+   IsListedAsHBonded() when a list of HBonds is long and is checked 
+   many times
+
+-  15.10.26 Original
+*/
+HBONDSET *CreateHBondSet(int npairs)
+{
+   HBONDSET      *set;
+   unsigned long nslots = 16;
+
+   /* Keep the table at most half full                                  */
+   while(nslots < 2*(unsigned long)npairs)
+      nslots *= 2;
+
+   if((set = (HBONDSET *)malloc(sizeof(HBONDSET)))==NULL)
+      return(NULL);
+   if((set->pairs = (PDB **)calloc(2*nslots, sizeof(PDB *)))==NULL)
+   {
+      free(set);
+      return(NULL);
+   }
+   set->mask = nslots - 1;
+   
+   return(set);
+}
+
+
+/************************************************************************/
+/*>BOOL AddToHBondSet(HBONDSET *set, PDB *p, PDB *q)
+   -------------------------------------------------
+*//**
+   \param[in,out] *set    Hash set of HBonded atom pairs
+   \param[in]     *p      PDB pointer
+   \param[in]     *q      PDB pointer
+   \return                TRUE if added, FALSE if the pair (in either
+                          orientation) was already in the set
+
+   Adds a pair of atoms to a set created by CreateHBondSet(). No more
+   than the number of pairs given to CreateHBondSet() may be added.
+
+-  15.10.26 Original (split from BuildHBondSet())
+*/
+BOOL AddToHBondSet(HBONDSET *set, PDB *p, PDB *q)
+{
+   unsigned long slot;
+
+   if((unsigned long)p > (unsigned long)q)
+   {
+      PDB *tmp = p;
+      p = q;
+      q = tmp;
+   }
+
+   /* Linear probing                                                    */
+   for(slot=HashAtomPair(p, q) & set->mask;
+       set->pairs[2*slot] != NULL;
+       slot=(slot+1) & set->mask)
+   {
+      if((set->pairs[2*slot] == p) && (set->pairs[2*slot+1] == q))
+         return(FALSE);
+   }
+   set->pairs[2*slot]   = p;
+   set->pairs[2*slot+1] = q;
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeHBondSet(HBONDSET *set)
+   --------------------------------
+*//**
+   \param[in]     *set    Hash set of HBonded atom pairs
+
+   Frees a set created by CreateHBondSet()
+
+-  15.10.26 Original
+*/
+void FreeHBondSet(HBONDSET *set)
+{
+   if(set != NULL)
+   {
+      if(set->pairs != NULL) free(set->pairs);
+      free(set);
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL IsInHBondSet(HBONDSET *set, PDB *p, PDB *q)
+   ------------------------------------------------
+*//**
+   \param[in]     *set    Hash set of HBonded atom pairs
+   \param[in]     *p      PDB pointer
+   \param[in]     *q      PDB pointer
+   \return                Listed?
+
+   Tests whether the two specified atoms are in the set of hydrogen
+   bonded pairs (in either orientation)
+
+-  15.10.26 Original
+*/
+BOOL IsInHBondSet(HBONDSET *set, PDB *p, PDB *q)
+{
+   unsigned long slot;
+
+   if((unsigned long)p > (unsigned long)q)
+   {
+      PDB *tmp = p;
+      p = q;
+      q = tmp;
+   }
+
+   for(slot=HashAtomPair(p, q) & set->mask;
+       set->pairs[2*slot] != NULL;
+       slot=(slot+1) & set->mask)
+   {
+      if((set->pairs[2*slot] == p) && (set->pairs[2*slot+1] == q))
+         return(TRUE);
+   }
+
+   return(FALSE);
+}
+
+
+/************************************************************************/
+/*>unsigned long HashAtomPair(PDB *p, PDB *q)
+   ------------------------------------------
+*//**
+   \param[in]     *p      PDB pointer
+   \param[in]     *q      PDB pointer
+   \return                Hash value
+
+   Hashes an ordered pair of atom pointers. The low bits of a pointer
+   are always zero for malloc'd structures, so they are shifted out
+   before mixing
+
+-  15.10.26 Original
+*/
+unsigned long HashAtomPair(PDB *p, PDB *q)
+{
+   unsigned long h;
+
+   h  = ((unsigned long)p >> 4) * 2654435761UL;
+   h ^= ((unsigned long)q >> 4) + 0x9e3779b9UL + (h << 6) + (h >> 2);
+   return(h ^ (h >> 16));
+}
+
+
+/************************************************************************/
+/*>HBLIST *FindLigandLigandHBonds(HBSEARCH *search, BOOL pseudo,
+                                  int first, int last)
+   -------------------------------------------------------------
 *//**
-   \param[in]      *pdb        PDB linked list
-   \param[in]      **pdbarray  Array of PDB pointers indexed by atom
-                               number
+   \param[in]      *search     Data shared by the searches
    \param[in]      pseudo      Pseudo hbonds? (or true HBonds)
-   \param[in]      maxHBDistSq Max D-A Hbond distance
+   \param[in]      first       First atom to search from
+   \param[in]      last        Atom after the last to search from
    \return                     Linked list of hbonds
 
-   Finds HBonds between ligands. If pseudo is true then it finds 
+   Finds HBonds between ligands, searching from atoms first...last-1
+   (in linked list order). If pseudo is true then it finds 
    pseudo-HBonds rather than real ones. Basically a copy of the first
    part of FindProtLigandHBonds()
 
@@ -1501,27 +2578,25 @@ BOOL IsListedAsHBonded(PDB *p, PDB *q, HBLIST *hbonds)
 -  16.06.99 Added maxHBDistSq parameter
 -  21.07.15 Modified to use PDB files and standard BiopLib structures
             and functions - added pdb parameter. 
+-  15.10.26 Now takes the structure in search and works on a range of
+            atoms. No longer uses a static list
 */
-HBLIST *FindLigandLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
-                               REAL maxHBDistSq)
+HBLIST *FindLigandLigandHBonds(HBSEARCH *search, BOOL pseudo, 
+                               int first, int last)
 {
-   PDB           *p, *q;
-   static HBLIST *hblist = NULL,
-                 *hbl,
-                 *hb;
-   static int    prevPseudo = (-5);
-
-   
-   if(pseudo != prevPseudo)
-   {
-      prevPseudo = pseudo;
-      hblist = NULL;
-      hbl    = NULL;
-      hb     = NULL;
-   }
-   
-   for(p=pdb; p!=NULL; NEXT(p))
+   PDB    *pdb        = search->pdb,
+          **pdbarray  = search->pdbarray,
+          *p, *q;
+   HBLIST *hblist     = NULL,
+          *hbl        = NULL,
+          *hb;
+   REAL   maxHBDistSq = search->maxHBDistSq;
+   int    i;
+
+   for(i=first; i<last; i++)
    {
+      p = search->atoms[i];
+
       /* If it's a HET/METAL/BOUNDHET                                   */
       if((p->atomtype & ATOMTYPE_NONRESIDUE) &&
          (p->atomtype != ATOMTYPE_WATER))
@@ -1569,18 +2644,18 @@ HBLIST *FindLigandLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
 
 
 /************************************************************************/
-/*>HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
-                                REAL maxHBDistSq)
-   -------------------------------------------------------------------
+/*>HBLIST *FindProtLigandHBonds(HBSEARCH *search, BOOL pseudo,
+                                int first, int last)
+   -----------------------------------------------------------
 *//**
-   \param[in]     *pdb        PDB linked list
-   \param[in]     **pdbarray  Array of PDB pointers indexed by atom
-                              number
+   \param[in]     *search     Data shared by the searches
    \param[in]     pseudo      Pseudo hbonds? (or true HBonds)
-   \param[in]     maxHBDistSq Max D-A HBond distance
+   \param[in]     first       First atom to search from
+   \param[in]     last        Atom after the last to search from
    \return                    Linked list of hbonds
 
-   Finds HBonds between protein and ligand. If pseudo is true then it
+   Finds HBonds between protein and ligand, searching from atoms 
+   first...last-1 (in linked list order). If pseudo is true then it
    finds pseudo-HBonds rather than real ones.
 
 -  07.06.99 Original   By: ACRM
@@ -1593,27 +2668,26 @@ HBLIST *FindLigandLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
             molecules!
 -  21.07.15 Modified to use PDB files and standard BiopLib structures
             and functions - added pdb parameter. 
+-  15.10.26 Uses the peptide flag from PDB.extras
+-  15.10.26 Now takes the structure in search and works on a range of
+            atoms. No longer uses a static list
 */
-HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
-                             REAL maxHBDistSq)
+HBLIST *FindProtLigandHBonds(HBSEARCH *search, BOOL pseudo, 
+                             int first, int last)
 {
-   PDB           *p, *q;
-   static HBLIST *hblist = NULL,
-                 *hbl,
-                 *hb;
-   static int    prevPseudo = (-5);
-
-   
-   if(pseudo != prevPseudo)
-   {
-      prevPseudo = pseudo;
-      hblist = NULL;
-      hbl    = NULL;
-      hb     = NULL;
-   }
-   
-   for(p=pdb; p!=NULL; NEXT(p))
+   PDB    *pdb        = search->pdb,
+          **pdbarray  = search->pdbarray,
+          *p, *q;
+   HBLIST *hblist     = NULL,
+          *hbl        = NULL,
+          *hb;
+   REAL   maxHBDistSq = search->maxHBDistSq;
+   int    i;
+
+   for(i=first; i<last; i++)
    {
+      p = search->atoms[i];
+
       /* If it's a HET/METAL/BOUNDHET                                   */
       if((p->atomtype & ATOMTYPE_NONRESIDUE) && 
          (p->atomtype != ATOMTYPE_WATER))
@@ -1663,7 +2737,7 @@ HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
          /* If it's a nucleotide or a peptide                           */
          if((p->atomtype == ATOMTYPE_NUC) || 
             (p->atomtype == ATOMTYPE_MODNUC) ||
-            isAPeptide(pdb, p))
+            PDBEXTRASPTR(p, PDBEXTRAS)->peptide)
          {
             /* Look for interactions with protein                       */
             for(q=pdb; q!=NULL; NEXT(q))
@@ -1714,42 +2788,73 @@ HBLIST *FindProtLigandHBonds(PDB *pdb, PDB **pdbarray, BOOL pseudo,
 
 
 /************************************************************************/
-/*>BOOL isAPeptide(PDB *pdb, PDB *atm)
-   -----------------------------------
+/*>BOOL SetPeptideFlags(PDB *pdb)
+   ------------------------------
 *//**
-   \param[in]    pdb    Start of PDB linked list
-   \param[in]    atm    An atom in the PDB linked list
-   \return              Is it a peptide
-
-   Tests whether the molecule containing the given atom is a peptide
-   (i.e. less than MAX_PEPTIDE_LENGTH residues long)
-
--  21.07.15  Original   By: ACRM
+   \param[in,out]  *pdb   Start of PDB linked list
+   \return                Success in allocations
+
+   Sets the PDB.extras.peptide flag for every atom in a chain of no 
+   more than MAX_PEPTIDE_LENGTH residues. As in the original 
+   per-atom test, a chain label that appears in more than one run 
+   in the file (e.g. HETATMs listed after the other chains) takes its
+   length from the first run with that label.
+
+-  21.07.15  Original as isAPeptide()   By: ACRM
+-  15.10.26  Rewritten to flag all atoms in one pass rather than 
+             testing a single atom
 */
-BOOL isAPeptide(PDB *pdb, PDB *atm)
+BOOL SetPeptideFlags(PDB *pdb)
 {
-   PDB *start, *stop, *res;
-   int nRes;
-   
+   PDB  *start, 
+        *stop, 
+        *res,
+        *p,
+        **chains;
+   BOOL peptide;
+   int  nChains = 0,
+        nRes,
+        i, j;
    
-   /* Find the start of this chain                                      */
-   for(start=pdb; start!=atm; NEXT(start))
-   {
-      if(PDBCHAINMATCH(start, atm))
-         break;
-   }
-   /* Find the next chain                                               */
-   stop = blFindNextChain(start);
+   /* Find the start of each run of atoms with the same chain label     */
+   for(start=pdb; start!=NULL; start=blFindNextChain(start))
+      nChains++;
+   if((chains = (PDB **)malloc(MAX(nChains, 1) * sizeof(PDB *)))==NULL)
+      return(FALSE);
+   for(start=pdb, i=0; start!=NULL; start=blFindNextChain(start))
+      chains[i++] = start;
    
-   /* Count the residues in the chain                                   */
-   for(res=start, nRes=0; res!=stop; res=blFindNextResidue(res))
+   for(i=0; i<nChains; i++)
    {
-      nRes++;
+      start = chains[i];
+      stop  = (i < nChains-1) ? chains[i+1] : NULL;
+
+      /* See if we have already seen this chain label                   */
+      for(j=0; j<i; j++)
+      {
+         if(PDBCHAINMATCH(chains[j], start))
+            break;
+      }
+
+      if(j < i)
+      {
+         peptide = PDBEXTRASPTR(chains[j], PDBEXTRAS)->peptide;
+      }
+      else
+      {
+         /* Count the residues in the chain                             */
+         for(res=start, nRes=0; res!=stop; res=blFindNextResidue(res))
+         {
+            nRes++;
+         }
+         peptide = (BOOL)(nRes <= MAX_PEPTIDE_LENGTH);
+      }
+
+      for(p=start; p!=stop; NEXT(p))
+         PDBEXTRASPTR(p, PDBEXTRAS)->peptide = peptide;
    }
 
-   if(nRes > MAX_PEPTIDE_LENGTH)
-      return(FALSE);
-   
+   free(chains);
    return(TRUE);
 }
 
@@ -1783,10 +2888,11 @@ void SetAtomNumExtras(PDB *pdb)
 
    Walks the PDB linked list creating an 'extra' structure for each
    PDB entry that doesn't already have one. 
-   It initializes the PDB.extras.origAtnum to -1
-   and the PDB.extras.molid to 0
+   It initializes the PDB.extras.origAtnum to -1,
+   the PDB.extras.molid to 0 and PDB.extras.peptide to FALSE
 
 -  21.07.15  Original   By: ACRM
+-  15.10.26  Initializes peptide
 */
 BOOL UpdatePDBExtras(PDB *pdb)
 {
@@ -1800,6 +2906,7 @@ BOOL UpdatePDBExtras(PDB *pdb)
             return(FALSE);
          PDBEXTRASPTR(p, PDBEXTRAS)->origAtnum = (-1);
          PDBEXTRASPTR(p, PDBEXTRAS)->molid     = 0;
+         PDBEXTRASPTR(p, PDBEXTRAS)->peptide   = FALSE;
       }
    }
 
@@ -2055,3 +3162,4 @@ void DeleteMetalConects(PDB *pdb)
    }
 }
 
+
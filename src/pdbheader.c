@@ -3,11 +3,11 @@
 
    \file       pdbheader.c
    
-   \version    V1.3
-   \date       22.06.15
+   \version    V1.4
+   \date       15.10.26
    \brief      Get header info from a PDB file
    
-   \copyright  (c) UCL / Dr. Andrew C.R. Martin, 2015
+   \copyright  (c) UCL / Dr. Andrew C.R. Martin, 2015-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -52,6 +52,7 @@
 -  V1.1  29.04.15 Added -p and fixed bug in -m
 -  V1.2  04.06.15 Fixed bug in -c
 -  V1.3  22.06.15 Added resolution info to header. With -r gives only this
+-  V1.4  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -60,6 +61,7 @@
 #include <string.h>
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -131,6 +133,8 @@ file.\n");
       return(1);
    }
    
+   if(IsPDBCache(in, "pdbheader"))
+      return(1);
    if((wpdb = blReadWholePDB(in))!=NULL)
    {
       if(doAll)
@@ -469,10 +473,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 
 -   28.04.15 Original   By: ACRM
 -   29.04.15 Added -p
+-   15.10.26 V1.4
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbheader V1.3 (c) 2015 UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbheader V1.4 (c) 2015-2026 UCL, Dr. Andrew C.R. \
 Martin\n");
    fprintf(stderr,"Usage: pdbheader [-s][-m][-p][-c chain][-n][-r] \
 [in.pdb [out.pdb]]\n");
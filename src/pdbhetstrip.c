@@ -3,11 +3,11 @@
 
    \file       pdbhetstrip.c
    
-   \version    V1.3
-   \date       13.02.15
+   \version    V1.6
+   \date       15.10.26
    \brief      Strip het atoms from a PDB file. Acts as filter
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1995-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1995-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -51,6 +51,10 @@
                   Added doxygen annotation. By: CTP
 -  V1.2  06.11.14 Renamed from hetstrip By: ACRM
 -  V1.3  13.02.15 Added whole PDB support
+-  V1.4  15.10.26 Added -s to filter the file as a stream
+-  V1.5  15.10.26 HETATMs are removed by StripHetAtoms() which is
+                  shared with the bioptools pipeline
+-  V1.6  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -64,6 +68,9 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbfilter.h"
+#include "common/hetstrip.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -79,7 +86,9 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream);
+BOOL KeepNonHet(char *record, void *data);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -92,6 +101,8 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile);
 -  15.07.94 Now writes TER cards and returns 0 correctly
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Added whole PDB support  By: ACRM
+-  15.10.26 Added -s
+-  15.10.26 Uses StripHetAtoms()
 */
 int main(int argc, char **argv)
 {
@@ -100,13 +111,22 @@ int main(int argc, char **argv)
              *out = stdout;
    char      infile[MAXBUFF],
              outfile[MAXBUFF];
+   BOOL      stream = FALSE;
 
-   if(ParseCmdLine(argc, argv, infile, outfile))
+   if(ParseCmdLine(argc, argv, infile, outfile, &stream))
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDBAtoms(in))!=NULL)
+         if(IsPDBCache(in, "pdbhetstrip"))
+            return(1);
+         if(stream)
          {
+            if(!StreamFilterPDB(in, out, KeepNonHet, NULL, 0))
+               return(1);
+         }
+         else if((wpdb=blReadWholePDB(in))!=NULL)
+         {
+            StripHetAtoms(wpdb);
             blWriteWholePDB(out,wpdb);
          }
       }
@@ -129,18 +149,22 @@ int main(int argc, char **argv)
    \param[in]      **argv      Argument array
    \param[out]     *infile     Input filename (or blank string)
    \param[out]     *outfile    Output filename (or blank string)
+   \param[out]     *stream     Filter as a stream?
    \return                     Success
 
    Parse the command line
 
 -  16.08.94 Original    By: ACRM
+-  15.10.26 Added -s
 */
-BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
+BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
+                  BOOL *stream)
 {
    argc--;
    argv++;
    
    infile[0] = outfile[0] = '\0';
+   *stream   = FALSE;
    
    while(argc)
    {
@@ -151,6 +175,9 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
          case 'h':
             return(FALSE);
             break;
+         case 's':
+            *stream = TRUE;
+            break;
          default:
             return(FALSE);
             break;
@@ -191,13 +218,39 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 -  22.07.14 V1.1 By: CTP
 -  06.11.14 V1.2 By: ACRM
 -  13.02.15 V1.3 By: ACRM
+-  15.10.26 V1.4
+-  15.10.26 V1.5
+-  15.10.26 V1.6
 */
 void Usage(void)
 {            
-   fprintf(stderr,"\npdbhetstrip V1.3 (c) 1994-2015, Andrew C.R. \
+   fprintf(stderr,"\npdbhetstrip V1.6 (c) 1994-2026, Andrew C.R. \
 Martin, UCL\n");
-   fprintf(stderr,"Usage: pdbhetstrip [<in.pdb> [<out.pdb>]]\n\n");
+   fprintf(stderr,"Usage: pdbhetstrip [-s] [<in.pdb> [<out.pdb>]]\n");
+   fprintf(stderr,"       -s  Filter the file as a stream using \
+constant memory. Records are\n");
+   fprintf(stderr,"           copied unchanged and all models are \
+kept. Not available for\n");
+   fprintf(stderr,"           PDBML.\n\n");
    fprintf(stderr,"Removes het atoms from a PDB file. I/O is through \
 stdin/stdout if files\n");
    fprintf(stderr,"are not specified.\n\n");
 }
+
+/************************************************************************/
+/*>BOOL KeepNonHet(char *record, void *data)
+   -----------------------------------------
+*//**
+
+   \param[in]      *record     ATOM or HETATM record
+   \param[in]      *data       Unused
+   \return                     Keep the record?
+
+   Atom filter for StreamFilterPDB() which drops HETATM records
+
+-  15.10.26 Original    By: ACRM
+*/
+BOOL KeepNonHet(char *record, void *data)
+{
+   return((BOOL)(strncmp(record, "HETATM", 6) != 0));
+}
@@ -3,11 +3,11 @@
 
    \file       pdbhstrip.c
    
-   \version    V1.4
-   \date       13.02.15
+   \version    V1.7
+   \date       15.10.26
    \brief      Strip hydrogens from a PDB file. Acts as filter
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -53,6 +53,10 @@
 -  V1.3  06.11.14 Renamed from hstrip  By: ACRM
 -  V1.4  13.02.15 Added whole PDB support and re-written to use
                   blStripHPDBAsCopy()
+-  V1.5  15.10.26 Reads the PDB file with ReadMappedWholePDB() so
+                  binary cache files may be used
+-  V1.6  15.10.26 Added -s to filter the file as a stream
+-  V1.7  15.10.26 -s reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -60,11 +64,15 @@
 #include <stdio.h>
 #include <math.h>
 #include <string.h>
+#include <ctype.h>
 
 #include "bioplib/MathType.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/mappdb.h"
+#include "common/pdbfilter.h"
+#include "common/pdbcache.h"
 
 
 /************************************************************************/
@@ -80,6 +88,7 @@
 */
 int main(int argc, char **argv);
 void Usage(void);
+BOOL KeepNonHydrogen(char *record, void *data);
 
 /************************************************************************/
 /*>int main(int argc, char **argv)
@@ -93,12 +102,15 @@ void Usage(void);
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  13.02.15 Added whole PDB support and re-written to use
             blStripHPDBAsCopy()  By: ACRM
+-  15.10.26 Uses ReadMappedWholePDB()
+-  15.10.26 Added -s
 */
 int main(int argc, char **argv)
 {
    WHOLEPDB *wpdb;
    FILE     *in  = stdin, 
             *out = stdout;
+   BOOL     stream = FALSE;
 
    argc--;
    argv++;
@@ -113,6 +125,9 @@ int main(int argc, char **argv)
             Usage();
             return(0);
             break;
+         case 's':
+            stream = TRUE;
+            break;
          default:
             Usage();
             return(1);
@@ -156,7 +171,13 @@ int main(int argc, char **argv)
       return(1);
    }
 
-   if((wpdb=blReadWholePDB(in))!=NULL)
+   if(stream)
+   {
+      if(IsPDBCache(in, "pdbhstrip") ||
+         !StreamFilterPDB(in, out, KeepNonHydrogen, NULL, 0))
+         return(1);
+   }
+   else if((wpdb=ReadMappedWholePDB(in))!=NULL)
    {
       PDB *pdbin  = NULL,
           *pdbout = NULL;
@@ -183,13 +204,62 @@ int main(int argc, char **argv)
 -  22.07.14 V1.2 By: CTP
 -  06.11.14 V1.3 By: ACRM
 -  13.02.15 V1.4
+-  15.10.26 V1.5
+-  15.10.26 V1.6
+-  15.10.26 V1.7
 */
 void Usage(void)
 {            
-   fprintf(stderr,"\npdbhstrip V1.4 (c) 1994-2015, Andrew C.R. Martin, \
+   fprintf(stderr,"\npdbhstrip V1.7 (c) 1994-2026, Andrew C.R. Martin, \
 UCL\n");
-   fprintf(stderr,"Usage: pdbhstrip [in.pdb [out.pdb]]\n\n");
+   fprintf(stderr,"Usage: pdbhstrip [-s] [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"       -s  Filter the file as a stream using \
+constant memory. Records are\n");
+   fprintf(stderr,"           copied unchanged and all models are \
+kept. Not available for\n");
+   fprintf(stderr,"           PDBML.\n\n");
    fprintf(stderr,"Removes hydrogens from a PDB file. I/O is through \
 stdin/stdout if files\n");
    fprintf(stderr,"are not specified.\n\n");
 }
+
+/************************************************************************/
+/*>BOOL KeepNonHydrogen(char *record, void *data)
+   ----------------------------------------------
+*//**
+
+   \param[in]      *record     ATOM or HETATM record
+   \param[in]      *data       Unused
+   \return                     Keep the record?
+
+   Atom filter for StreamFilterPDB() which drops hydrogens (and
+   deuteriums). The element in columns 77-78 is used if present.
+   Otherwise, the element is taken from the atom name: column 14 if
+   column 13 is blank or a digit, or column 13 for a 4-character ATOM
+   name such as HG11.
+
+-  15.10.26 Original    By: ACRM
+*/
+BOOL KeepNonHydrogen(char *record, void *data)
+{
+   char element[3],
+        *chp;
+   int  len = strcspn(record, "\r\n");
+
+   if(len >= 78)
+   {
+      strncpy(element, record+76, 2);
+      element[2] = '\0';
+      for(chp=element; *chp==' '; chp++);
+      if(*chp)
+         return((BOOL)(strcmp(chp, "H ") && strcmp(chp, "H") &&
+                       strcmp(chp, "D ") && strcmp(chp, "D")));
+   }
+
+   if(len < 14)
+      return(TRUE);
+   if((record[12] == ' ') || isdigit((int)record[12]))
+      return((BOOL)((record[13] != 'H') && (record[13] != 'D')));
+   return((BOOL)(strncmp(record, "ATOM  ", 6) ||
+                 ((record[12] != 'H') && (record[12] != 'D'))));
+}
@@ -3,11 +3,11 @@
 
    \file       pdblistss.c
    
-   \version    V1.0
-   \date       20.07.15
+   \version    V1.1
+   \date       15.10.26
    \brief      List disulphide bonds
    
-   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2015
+   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2026
    \author     Dr. Andrew C.R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -48,6 +48,7 @@
    Revision History:
    =================
 -   V1.0   20.07.15 Original   By: ACRM
+-   V1.1   15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -61,6 +62,7 @@
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/access.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -112,6 +114,8 @@ file\n");
       return(1);
    }
 
+   if(IsPDBCache(in, "pdblistss"))
+      return(1);
    if((pdb = blReadPDBAtoms(in, &natoms))==NULL)
    {
       fprintf(stderr, "Error (pdblistss): No atoms read from PDB \
@@ -241,10 +245,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
    Prints a usage message
 
 -  20.07.15 Original   By: ACRM
+-  15.10.26 V1.1
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdblistss V1.0 (c) 2015 UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdblistss V1.1 (c) 2015-2026 UCL, Dr. Andrew C.R. \
 Martin\n");
 
    fprintf(stderr,"\nUsage: pdblistss [in.pdb [out.txt]]\n");
@@ -3,11 +3,11 @@
 
    \file       pdbmakepatch.c
    
-   \version    V1.11
-   \date       12.03.15
+   \version    V1.16
+   \date       15.10.26
    \brief      Build patches around a surface atom
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2009-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 2009-2026
    \author     Dr. Andrew C. R. Martin, Anja Baresic
    \par
                Biomolecular Structure & Modelling Unit,
@@ -51,6 +51,11 @@
    contacting that central atom and in turn contacting atoms already in
    the patch.
 
+   With -a, a patch is made around the specified atom of every residue
+   where that atom is on the surface. With -l, a patch is made around
+   each residue listed in a file. In both cases, only the summary for
+   each patch is written.
+
 
 **************************************************************************
 
@@ -80,16 +85,34 @@
                    By: CTP
 -  V1.10 06.11.14  Renamed from makepatch
 -  V1.11 12.03.15 Changed to allow multi-character chain names
+-  V1.12 15.10.26 Patches are grown as a flood fill from the central atom
+                  using a cell-list grid of atoms rather than repeatedly
+                  sweeping all pairs of atoms. The C-alpha for each atom
+                  is looked up in an index rather than searching the
+                  C-alpha list
+-  V1.13 15.10.26 Added -a and -l to make patches around all surface
+                  residues or a list of residues in one run. Solvent 
+                  vector mass centres are calculated once for all 
+                  C-alphas
+-  V1.14 15.10.26 The closest C-alphas for each solvent vector are found
+                  with a grid search rather than sorting all C-alphas.
+                  No longer overwrites the occupancy of the C-alphas
+-  V1.15 15.10.26 Cell-list grid moved to common/cellgrid.c
+-  V1.16 15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
 #include <math.h>
 
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/cellgrid.h"
+#include "common/pdbcache.h"
 
 
 /************************************************************************/
@@ -104,6 +127,33 @@
                                    include when claculating centre of 
                                    mass in CalcMassCentre()
                                 */
+#define CACELLSIZE         6.0  /* Grid cell size for finding the closest
+                                   C-alpha atoms                        */
+
+/************************************************************************/
+/* Type definitions
+*/
+/* Index of the atoms used to grow patches. Atoms are numbered in linked
+   list order                                                           */
+typedef struct
+{
+   PDB      **atoms,    /* Atoms in linked list order                   */
+            **atomCA;   /* C-alpha of the residue of each atom (or NULL)*/
+   PDB      **CAs;      /* C-alphas in list order                       */
+   VEC3F    *massCentre;/* Solvent vector mass centre for each C-alpha  */
+   CELLGRID *grid;      /* Grid of atoms with cells of the maximum 
+                           contact distance                             */
+   int      *queue,     /* Flood fill queue for MakePatches()           */
+            natoms,
+            nCA;
+}  PATCHINDEX;
+
+/* Sort key for looking up C-alphas by residue                          */
+typedef struct
+{
+   PDB *ca;
+   int order;           /* Position in the C-alpha list                 */
+}  CAKEY;
 
 /************************************************************************/
 /* Globals
@@ -113,9 +163,19 @@
 /* Prototypes
 */
 int  main(int argc, char **argv);
-void MakePatches(PDB *pdb, char *CentreRes, char *CentreAtom,
-                 REAL radius, REAL tolerance, PDB *CA, BOOL ringOnly,
-                 REAL minAccess);
+void MakePatches(PDB *pdb, PDB *catom, REAL radius, REAL tolerance, 
+                 PATCHINDEX *index, BOOL ringOnly, REAL minAccess);
+PDB *FindCentralAtom(PDB *pdb, char *CentreRes, char *CentreAtom);
+void MakeBatchPatches(FILE *out, FILE *list, PDB *pdb, PDB *CA, 
+                      char *CentreAtom, PATCHINDEX *index, REAL radius,
+                      REAL tolerance, BOOL ringOnly, REAL minAccess);
+void WritePatchSummary(FILE *out, PDB *pdb, char *Central, PDB *catom,
+                       PDB *centralCA, PATCHINDEX *index, REAL radius, 
+                       REAL tolerance, BOOL ringOnly, REAL minAccess);
+PATCHINDEX *BuildPatchIndex(PDB *pdb, PDB *CA, int nCatom, 
+                            REAL tolerance);
+void FreePatchIndex(PATCHINDEX *index);
+int  CompareCAKeys(const void *e1, const void *e2);
 BOOL FlagSet(PDB *p);
 void SetFlag(PDB *p);
 void ClearFlag(PDB *p);
@@ -124,13 +184,13 @@ void ClearFlags(PDB *pdb);
 BOOL ParseCmdLine(int argc, char **argv, char *CentreRes, 
                   char *CentreAtom, char *infile, char *outfile,
                   REAL *radius, REAL *tolerance, BOOL *summary,
-                  BOOL *ringOnly, REAL *minAccess);
+                  BOOL *ringOnly, REAL *minAccess, BOOL *allSurface,
+                  char *listfile);
 
-void FlagSolvVecAngles(PDB *CA, char *Central, int natom);
-void DistFromCentral(PDB *pdb, PDB *central);
-void MassCentre(PDB *pdb, PDB *central, int *natom, REAL *Masscen_x,
-                REAL *Masscen_y, REAL *Masscen_z);
-int  CompareFunc(const void* e1, const void* e2);
+BOOL CalcMassCentres(PATCHINDEX *index, PDB *CA, int nCatom);
+void FlagSolvVecAngles(PATCHINDEX *index, PDB *patchCentre);
+int  FindClosestCAs(PATCHINDEX *index, CELLGRID *grid, int central, 
+                    PDB **closest);
 void CalcMassCentre(PDB **tab, int natoms, 
                     REAL *cen_x, REAL *cen_y, REAL *cen_z);
 BOOL CheckVectAngle(PDB * cetral, REAL *Masscen_x, REAL *Masscen_y, 
@@ -138,7 +198,7 @@ BOOL CheckVectAngle(PDB * cetral, REAL *Masscen_x, REAL *Masscen_y,
                     REAL *Masscurr_y, REAL *Masscurr_z);
 
 void FlagWholeResidues(PDB *pdb);
-void PrintSummary(PDB *p, char *Central);
+void PrintSummary(FILE *out, PDB *pdb, char *Central);
 void CleanUpPDB(PDB *pdb);
 void Usage(void);
 
@@ -152,32 +212,49 @@ void Usage(void);
 -  02.06.09  Added -s command line option   By: Anja
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  19.08.14 Added AsCopy suffix to call to blSelectAtomsPDB() By: CTP
+-  15.10.26 Builds a PATCHINDEX for MakePatches(). Added -a and -l
 */
 int main(int argc, char **argv)
 {
    FILE *in  = stdin,
-        *out = stdout;
+        *out = stdout,
+        *list = NULL;
    
    char InFile[MAXBUFF],
         OutFile[MAXBUFF],
+        ListFile[MAXBUFF],
         CentreRes[MAXBUFF],
         CentreAtom[MAXBUFF]; 
    char *sel[2];
    PDB  *pdb, 
-        *Calphas;
+        *Calphas,
+        *patchCentre,
+        *catom;
+   PATCHINDEX *index;
    int  natom,
         nCatom;   
    REAL radius = DEF_RADIUS, 
         tolerance = DEF_TOLERANCE,
         minAccess = DEF_MINACCESS;
    BOOL summary,
-        ringOnly;
+        ringOnly,
+        allSurface;
 
    if(ParseCmdLine(argc, argv, CentreRes, CentreAtom, InFile, OutFile,
-                   &radius, &tolerance, &summary, &ringOnly, &minAccess))
+                   &radius, &tolerance, &summary, &ringOnly, &minAccess,
+                   &allSurface, ListFile))
    {
+      if(ListFile[0] && ((list = fopen(ListFile, "r"))==NULL))
+      {
+         fprintf(stderr,"pdbmakepatch: (Error) Unable to open list \
+file %s\n", ListFile);
+         return(1);
+      }
+      
       if(blOpenStdFiles(InFile, OutFile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbmakepatch"))
+            return(1);
          if((pdb=blReadPDB(in, &natom))==NULL)
          {
             fprintf(stderr,"pdbmakepatch: (Error) No atoms read from PDB \
@@ -194,26 +271,62 @@ file\n");
             <120 and to 0 if >=120 
 
             V1.4 Changed to use 'extras' for the flag
+            V1.13 The mass centres are calculated once when the index is
+            built
          */
          SELECT(sel[0],"CA  ");
          Calphas = blSelectAtomsPDBAsCopy(pdb, 1, sel, &nCatom);
-         FlagSolvVecAngles(Calphas, CentreRes, nCatom);
+
+         if((index = BuildPatchIndex(pdb, Calphas, nCatom, tolerance))
+            ==NULL)
+         {
+            fprintf(stderr,"pdbmakepatch: (Error) No memory for atom \
+index\n");
+            return(1);
+         }
  
          PADCHARMINTERM(CentreAtom, ' ', 4);
-         MakePatches(pdb, CentreRes, CentreAtom, radius, tolerance, 
-                     Calphas, ringOnly, minAccess);
 
-         FlagWholeResidues(pdb);
-         CleanUpPDB(pdb);
-         blWritePDB(out, pdb);
-         
-         /* V1.1 By: Anja
-            Print summary if required
-         */
-         if (summary)
+         if(allSurface || (list != NULL))
          {
-            PrintSummary(pdb, CentreRes);           
-         }         
+            MakeBatchPatches(out, list, pdb, Calphas, CentreAtom, index,
+                             radius, tolerance, ringOnly, minAccess);
+         }
+         else
+         {
+            if((patchCentre = blFindResidueSpec(Calphas, CentreRes))
+               ==NULL)
+            {
+               fprintf(stderr, "pdbmakepatch: (Error) Couldn't find \
+Residue %s\n", CentreRes);
+               return(1);
+            }
+            if((catom = FindCentralAtom(pdb, CentreRes, CentreAtom))
+               ==NULL)
+            {
+               fprintf(stderr, "pdbmakepatch: (Error) Couldn't find \
+Residue %s Atom %s\n", CentreRes, CentreAtom);
+               return(1);
+            }
+            
+            FlagSolvVecAngles(index, patchCentre);
+            MakePatches(pdb, catom, radius, tolerance, index, ringOnly,
+                        minAccess);
+
+            FlagWholeResidues(pdb);
+            CleanUpPDB(pdb);
+            blWritePDB(out, pdb);
+         
+            /* V1.1 By: Anja
+               Print summary if required
+            */
+            if (summary)
+            {
+               PrintSummary(stdout, pdb, CentreRes);           
+            }         
+         }
+         
+         FreePatchIndex(index);
       }
    }
    else
@@ -239,16 +352,24 @@ file\n");
 -  22.07.14  V1.8 By: CTP
 -  06.11.14  V1.10 By: ACRM
 -  12.03.15  V1.11
+-  15.10.26  V1.12
+-  15.10.26  V1.13
+-  15.10.26  V1.15
+-  15.10.26 V1.16
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbmakepatch V1.11 Andrew C.R. Martin, Anja \
-Baresic, UCL 2009-2015\n");
+   fprintf(stderr,"\npdbmakepatch V1.16 Andrew C.R. Martin, Anja \
+Baresic, UCL 2009-2026\n");
 
    fprintf(stderr,"\nUsage: pdbmakepatch [-r radius] [-t tolerance] [-c] \
 [-m minaccess]\n");
    fprintf(stderr,"                    resspec atomname [in.pdb \
 [out.pdb]]\n");
+   fprintf(stderr,"       pdbmakepatch [-r radius] [-t tolerance] [-c] \
+[-m minaccess]\n");
+   fprintf(stderr,"                    {-a | -l listfile} atomname \
+[in.pdb [out.pdb]]\n");
    fprintf(stderr,"       -r  Specify radius for considering atoms \
 [%.2f]\n", (REAL)DEF_RADIUS);
    fprintf(stderr,"       -t  Specify tolerance on atom radii to \
@@ -261,6 +382,13 @@ patch\n");
 around the central one only\n");
    fprintf(stderr,"       -m  Specify minimum accessibility to consider \
 a residue to be on the surface\n");
+   fprintf(stderr,"       -a  Make a patch around every residue where \
+the specified atom is\n");
+   fprintf(stderr,"           on the surface\n");
+   fprintf(stderr,"       -l  Make a patch around each residue listed \
+(one per line) in a file\n");
+   fprintf(stderr,"           With -a or -l, only the summary for each \
+patch is written\n");
 
    fprintf(stderr,"\npdbmakepatch takes a PDB file where the B-values \
 have been replaced by\n");
@@ -282,15 +410,15 @@ atoms already in\n");
 }
 
 /************************************************************************/
-/*>void MakePatches(PDB *pdb, char *CentreRes, char *CentreAtom,
-                    REAL radius, REAL tolerance, PDB *CA, BOOL ringOnly)
+/*>void MakePatches(PDB *pdb, PDB *catom, REAL radius, REAL tolerance, 
+                    PATCHINDEX *index, BOOL ringOnly, REAL minAccess)
    ---------------------------------------------------------------------
 *//**
 
-   Identifies the central atom, clears flags for all atoms then sets
-   the central atom flag. Iterates over the PDB file, flagging atoms
-   within the required radius of the central atom and within touching
-   distance of that atom or other flagged atoms.
+   Clears flags for all atoms then sets the central atom flag. Grows 
+   the patch outwards from the central atom, flagging atoms within the 
+   required radius of the central atom and within touching distance of 
+   other flagged atoms.
 
 -  01.06.09  Original   By: ACRM
 -  02.06.09  Added check on solvent vector < 120degrees   By: Anja
@@ -298,135 +426,477 @@ atoms already in\n");
 -  02.10.13  Added minAccess - rather than just using zero
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  12.03.15 Changed to allow multi-character chain names  By: ACRM
+-  15.10.26 Now a flood fill using the grid in the PATCHINDEX rather 
+            than iterating over all pairs of atoms until nothing changes.
+            Takes the index rather than the C-alpha list
+-  15.10.26 Takes the central atom found by FindCentralAtom()
 */
-void MakePatches(PDB *pdb, char *CentreRes, char *CentreAtom,
-                 REAL radius, REAL tolerance, PDB *CA, BOOL ringOnly,
-                 REAL minAccess)
+void MakePatches(PDB *pdb, PDB *catom, REAL radius, REAL tolerance, 
+                 PATCHINDEX *index, BOOL ringOnly, REAL minAccess)
 {
-   PDB *catom, *p;
-   BOOL Found = FALSE;
-   BOOL Changed, FoundInCA;
-   REAL RadSq = radius * radius;
-   
-   /* Find the central residue and atom                                */
-   catom = blFindResidueSpec(pdb, CentreRes);
-   for(p=catom; p!=NULL && (p->insert[0] == catom->insert[0]) &&
-      (p->resnum == catom->resnum); NEXT(p))
-   {
-      if(!strncmp(p->atnam, CentreAtom, 4))
-      {
-         Found = TRUE;
-         break;
-      }
-   }
-   if(!Found)
-   {
-      fprintf(stderr, "pdbmakepatch: (Error) Couldn't find Residue %s \
-Atom %s\n",
-              CentreRes, CentreAtom);
-      exit(1);
-   }
-   catom = p;
+   CELLGRID *grid = index->grid;
+   PDB  *p, *q;
+   REAL RadSq = radius * radius,
+        contact;
+   int  ip, iq, i, j,
+        cx, cy, cz,
+        ix, iy, iz,
+        cell,
+        nqueue;
    
    /* Clear flags and set the flag for the central patch atom           */
    ClearFlags(pdb);
    SetFlag(catom);
 
-   /* Iterate over the PDB file while we make a change                  */
-   do
+   /* Start the queue with the central atom                             */
+   for(i=0; i<index->natoms; i++)
    {
-      PDB *p, *q, *r;
-      
-      Changed = FALSE;
-      for(p=pdb; p!=NULL; NEXT(p))
+      if(index->atoms[i] == catom)
+         break;
+   }
+   index->queue[0] = i;
+   nqueue          = 1;
+
+   /* Take each flagged atom from the queue and look for neighbouring
+      atoms in this and adjacent grid cells. Each newly flagged atom is
+      added to the queue
+   */
+   for(i=0; i<nqueue; i++)
+   {
+      ip   = index->queue[i];
+      p    = index->atoms[ip];
+      cell = grid->itemCell[ip];
+      cx   = cell % grid->nx;
+      cy   = (cell / grid->nx) % grid->ny;
+      cz   = cell / (grid->nx * grid->ny);
+
+      for(iz=MAX(cz-1, 0); iz<=MIN(cz+1, grid->nz-1); iz++)
       {
-         /* If this is a flagged atom then look for neighbouring atoms  */
-         if(FlagSet(p))
+         for(iy=MAX(cy-1, 0); iy<=MIN(cy+1, grid->ny-1); iy++)
          {
-            for(q=pdb; q!=NULL; NEXT(q))
+            for(ix=MAX(cx-1, 0); ix<=MIN(cx+1, grid->nx-1); ix++)
             {
-               if(p!=q)
+               cell = ix + grid->nx * (iy + grid->ny * iz);
+               for(j=grid->cellStart[cell]; j<grid->cellStart[cell+1]; j++)
                {
-                  /* If this atom not yet flagged                       */
-                  if(!FlagSet(q))
+                  iq = grid->cellItems[j];
+                  q  = index->atoms[iq];
+
+                  /* Skip this atom and atoms already flagged           */
+                  if((iq == ip) || FlagSet(q))
+                     continue;
+
+                  /* See if it is on the surface and within the 
+                     specified radius
+                  */
+                  if((q->bval <= minAccess) || 
+                     (DISTSQ(q,catom) >= RadSq))
+                     continue;
+
+                  /* If it's in contact distance of the flagged atom    */
+                  contact = p->occ + q->occ + tolerance;
+                  if(DISTSQ(p,q) >= (contact * contact))
+                     continue;
+                  
+                  /* If we are doing a single ring of residues around   */
+                  if(ringOnly)
+                  {
+                     /* Test we are in same residue                     */
+                     if(!(((p->resnum == q->resnum) &&   
+                           (p->insert[0] == q->insert[0]) &&
+                           CHAINMATCH(p->chain, q->chain)) ||
+                          /* or other residue is the central one        */
+                          ((p->resnum == catom->resnum) && 
+                           (p->insert[0] == catom->insert[0]) &&
+                           CHAINMATCH(p->chain, catom->chain))))
+                     {
+                        continue;
+                     }
+                  }
+
+                  /* V1.1+  By: Anja
+                     Check solvvec vector angle is <120 degrees  
+                  */
+                  if(index->atomCA[iq] != NULL)
                   {
-                     /* See if it is on the surface and within the 
-                        specified radius
-                     */
-                     if((q->bval > minAccess) && 
-                        (DISTSQ(q,catom) < RadSq))
+                     if(FlagSet(index->atomCA[iq]))
                      {
-                        /* If it's in contact distance of the flagged 
-                           atom
+                        /* Set the flag for this atom and add it to the
+                           queue
                         */
-                        if(DISTSQ(p,q) < ((p->occ + q->occ + tolerance) *
-                                          (p->occ + q->occ + tolerance)))
-                        {
-                           /* If we are doing a single ring of residues 
-                              around
-                           */
-                           if(ringOnly)
-                           {
-                              /* Test we are in same residue            */
-                              if(!(((p->resnum == q->resnum) &&   
-                                    (p->insert[0] == q->insert[0]) &&
-                                    CHAINMATCH(p->chain, q->chain)) ||
-                                   /* or other residue is the central 
-                                      one 
-                                   */
-                                   ((p->resnum == catom->resnum) && 
-                                    (p->insert[0] == catom->insert[0]) &&
-                                    CHAINMATCH(p->chain, catom->chain))))
-                              {
-                                 continue;
-                              }
-                           }
-
-                           /* V1.1+  By: Anja
-                              Check solvvec vector angle is <120 degrees  
-                           */
-                           FoundInCA = FALSE;
-                           
-                           for (r=CA; r!=NULL && (!FoundInCA); NEXT(r))
-                           {
-                              if ( (r->resnum == q->resnum) &&
-                                   (!strcmp(r->chain, q->chain)) && 
-                                   (!strcmp(r->insert, q->insert)) )
-                              {
-                                 FoundInCA = TRUE;
-                                 
-                                 if(FlagSet(r))
-                                 {
-                                    
-                                    /* Set the flag for this atom and 
-                                       update the iteration flag to say 
-                                       we've done something            
-                                    */
-                                    SetFlag(q);
-                                    Changed = TRUE;
-                                 }
+                        SetFlag(q);
+                        index->queue[nqueue++] = iq;
+                     }
 #ifdef DEBUG
-                                 else
-                                 {
-                                    fprintf(stderr, "pdbmakepatch: \
-(Debug) Residue %s.%d%s failed on angle test\n", 
-                                            q->chain, q->resnum, 
-                                            q->insert);
-                                 }
-#endif
-                              }
-                           }                        
-                           /* V1.1-END                                  */
-                        }
+                     else
+                     {
+                        fprintf(stderr, "pdbmakepatch: (Debug) Residue \
+%s.%d%s failed on angle test\n", 
+                                q->chain, q->resnum, q->insert);
                      }
+#endif
                   }
+                  /* V1.1-END                                           */
                }
             }
          }
       }
-   } while(Changed);
+   }
+}
+
+
+/************************************************************************/
+/*>PDB *FindCentralAtom(PDB *pdb, char *CentreRes, char *CentreAtom)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *pdb         PDB linked list
+   \param[in]      *CentreRes   Central residue spec
+   \param[in]      *CentreAtom  Central atom name (padded to 4 chars)
+   \return                      The central atom (NULL if not found)
+
+   Finds the central atom of a patch
+
+-  15.10.26  Original (split from MakePatches())   By: ACRM
+*/
+PDB *FindCentralAtom(PDB *pdb, char *CentreRes, char *CentreAtom)
+{
+   PDB *catom, 
+       *p;
+   
+   catom = blFindResidueSpec(pdb, CentreRes);
+   for(p=catom; p!=NULL && (p->insert[0] == catom->insert[0]) &&
+      (p->resnum == catom->resnum); NEXT(p))
+   {
+      if(!strncmp(p->atnam, CentreAtom, 4))
+         return(p);
+   }
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>void MakeBatchPatches(FILE *out, FILE *list, PDB *pdb, PDB *CA, 
+                         char *CentreAtom, PATCHINDEX *index, 
+                         REAL radius, REAL tolerance, BOOL ringOnly, 
+                         REAL minAccess)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]      *out         Output file
+   \param[in]      *list        File of residue specs (or NULL)
+   \param[in]      *pdb         PDB linked list
+   \param[in]      *CA          C-alphas-only linked list
+   \param[in]      *CentreAtom  Central atom name (padded to 4 chars)
+   \param[in]      *index       Index of the PDB linked list
+   \param[in]      radius       Radius to include atoms
+   \param[in]      tolerance    Tolerance on contact distance for atoms
+   \param[in]      ringOnly     Only do residues in contact with central
+   \param[in]      minAccess    Minimum accessibility to be on the surface
+
+   Makes a patch around each residue listed in the list file or, if
+   there is no list, around every residue where the central atom is on 
+   the surface. The summary for each patch is written to the output
+   file.
+
+-  15.10.26  Original   By: ACRM
+*/
+void MakeBatchPatches(FILE *out, FILE *list, PDB *pdb, PDB *CA, 
+                      char *CentreAtom, PATCHINDEX *index, REAL radius,
+                      REAL tolerance, BOOL ringOnly, REAL minAccess)
+{
+   char buffer[MAXBUFF],
+        CentreRes[MAXBUFF];
+   PDB  *res,
+        *nextRes,
+        *p,
+        *catom,
+        *patchCentre;
+   int  i;
+   
+   if(list != NULL)
+   {
+      while(fgets(buffer, MAXBUFF, list))
+      {
+         if(sscanf(buffer, "%s", CentreRes) != 1)
+            continue;
+         
+         if(((patchCentre = blFindResidueSpec(CA, CentreRes))==NULL) ||
+            ((catom = FindCentralAtom(pdb, CentreRes, CentreAtom))
+             ==NULL))
+         {
+            fprintf(stderr, "pdbmakepatch: (Warning) Couldn't find \
+Residue %s Atom %s\n", CentreRes, CentreAtom);
+            continue;
+         }
+         
+         WritePatchSummary(out, pdb, CentreRes, catom, patchCentre, 
+                           index, radius, tolerance, ringOnly, 
+                           minAccess);
+      }
+   }
+   else
+   {
+      for(res=pdb, i=0; res!=NULL; res=nextRes)
+      {
+         nextRes = blFindNextResidue(res);
+
+         /* Find the central atom and check it is on the surface        */
+         catom       = NULL;
+         patchCentre = NULL;
+         for(p=res; p!=nextRes; NEXT(p), i++)
+         {
+            if((catom == NULL) && !strncmp(p->atnam, CentreAtom, 4))
+            {
+               catom       = p;
+               patchCentre = index->atomCA[i];
+            }
+         }
+         if((catom == NULL) || (patchCentre == NULL) || 
+            (catom->bval <= minAccess))
+            continue;
+
+         if((strlen(res->chain) > 1) || isdigit(res->chain[0]))
+            sprintf(CentreRes, "%s.%d", res->chain, res->resnum);
+         else
+            sprintf(CentreRes, "%s%d", res->chain, res->resnum);
+         if(res->insert[0] != ' ')
+            sprintf(CentreRes+strlen(CentreRes), "%c", res->insert[0]);
+
+         WritePatchSummary(out, pdb, CentreRes, catom, patchCentre, 
+                           index, radius, tolerance, ringOnly, 
+                           minAccess);
+      }
+   }
 }
 
+
+/************************************************************************/
+/*>void WritePatchSummary(FILE *out, PDB *pdb, char *Central, 
+                          PDB *catom, PDB *centralCA, PATCHINDEX *index,
+                          REAL radius, REAL tolerance, BOOL ringOnly, 
+                          REAL minAccess)
+   ----------------------------------------------------------------------
+*//**
+
+   \param[in]      *out         Output file
+   \param[in]      *pdb         PDB linked list
+   \param[in]      *Central     Central residue spec
+   \param[in]      *catom       Central atom
+   \param[in]      *centralCA   C-alpha of the central residue
+   \param[in]      *index       Index of the PDB linked list
+   \param[in]      radius       Radius to include atoms
+   \param[in]      tolerance    Tolerance on contact distance for atoms
+   \param[in]      ringOnly     Only do residues in contact with central
+   \param[in]      minAccess    Minimum accessibility to be on the surface
+
+   Makes a patch around a central atom and writes the summary. The PDB 
+   linked list is not modified except for the flags.
+
+-  15.10.26  Original   By: ACRM
+*/
+void WritePatchSummary(FILE *out, PDB *pdb, char *Central, PDB *catom,
+                       PDB *centralCA, PATCHINDEX *index, REAL radius, 
+                       REAL tolerance, BOOL ringOnly, REAL minAccess)
+{
+   FlagSolvVecAngles(index, centralCA);
+   MakePatches(pdb, catom, radius, tolerance, index, ringOnly, 
+               minAccess);
+   FlagWholeResidues(pdb);
+   PrintSummary(out, pdb, Central);
+}
+
+
+/************************************************************************/
+/*>PATCHINDEX *BuildPatchIndex(PDB *pdb, PDB *CA, int nCatom, 
+                               REAL tolerance)
+   -----------------------------------------------------------
+*//**
+
+   \param[in]      *pdb         PDB linked list
+   \param[in]      *CA          C-alphas-only linked list
+   \param[in]      nCatom       Number of C-alphas
+   \param[in]      tolerance    Tolerance on contact distance for atoms
+   \return                      Malloc'd index (NULL if no memory)
+
+   Indexes the atoms for MakePatches(). Finds the C-alpha for each atom's
+   residue (the first matching one in the C-alpha list), calculates the
+   solvent vector mass centres and places the atoms on a grid with cells
+   no smaller than the largest possible contact distance.
+
+-  15.10.26  Original   By: ACRM
+*/
+PATCHINDEX *BuildPatchIndex(PDB *pdb, PDB *CA, int nCatom, 
+                            REAL tolerance)
+{
+   PATCHINDEX *index;
+   CAKEY      *keys = NULL,
+              key;
+   VEC3F      *coords;
+   PDB        *start,
+              *stop,
+              *p,
+              *ca;
+   REAL       minOcc, 
+              maxOcc,
+              cellSize;
+   int        i, 
+              lo, hi, mid;
+
+   if((index = (PATCHINDEX *)malloc(sizeof(PATCHINDEX)))==NULL)
+      return(NULL);
+   index->atomCA     = NULL;
+   index->CAs        = NULL;
+   index->massCentre = NULL;
+   index->grid       = NULL;
+   index->queue      = NULL;
+
+   if((index->atoms = blIndexPDB(pdb, &(index->natoms)))==NULL)
+   {
+      free(index);
+      return(NULL);
+   }
+
+   if(((index->atomCA = (PDB **)malloc(index->natoms * sizeof(PDB *)))
+       ==NULL) ||
+      ((index->queue  = (int *)malloc(index->natoms * sizeof(int)))
+       ==NULL) ||
+      ((keys = (CAKEY *)malloc(MAX(nCatom, 1) * sizeof(CAKEY)))==NULL) ||
+      ((coords = (VEC3F *)malloc(index->natoms * sizeof(VEC3F)))==NULL))
+   {
+      if(keys != NULL) free(keys);
+      FreePatchIndex(index);
+      return(NULL);
+   }
+
+   /* Sort the C-alphas by residue, keeping the list order for 
+      duplicates
+   */
+   for(ca=CA, i=0; ca!=NULL && i<nCatom; NEXT(ca), i++)
+   {
+      keys[i].ca    = ca;
+      keys[i].order = i;
+   }
+   nCatom = i;
+
+   /* Calculate the solvent vector mass centre for each C-alpha         */
+   if(!CalcMassCentres(index, CA, nCatom))
+   {
+      free(keys);
+      free(coords);
+      FreePatchIndex(index);
+      return(NULL);
+   }
+   
+   qsort(keys, nCatom, sizeof(CAKEY), CompareCAKeys);
+
+   /* Find the first matching C-alpha for each residue                  */
+   for(start=pdb, i=0; start!=NULL; start=stop)
+   {
+      stop      = blFindNextResidue(start);
+      key.ca    = start;
+      key.order = -1;
+      for(lo=0, hi=nCatom; lo<hi; )
+      {
+         mid = (lo + hi) / 2;
+         if(CompareCAKeys(&(keys[mid]), &key) < 0)
+            lo = mid + 1;
+         else
+            hi = mid;
+      }
+      ca = NULL;
+      if(lo < nCatom)
+      {
+         key.order = keys[lo].order;
+         if(!CompareCAKeys(&(keys[lo]), &key))
+            ca = keys[lo].ca;
+      }
+      for(p=start; p!=stop; NEXT(p))
+         index->atomCA[i++] = ca;
+   }
+   free(keys);
+
+   /* The largest contact distance sets the grid cell size              */
+   minOcc = maxOcc = index->atoms[0]->occ;
+   for(i=0; i<index->natoms; i++)
+   {
+      minOcc = MIN(minOcc, index->atoms[i]->occ);
+      maxOcc = MAX(maxOcc, index->atoms[i]->occ);
+      coords[i].x = index->atoms[i]->x;
+      coords[i].y = index->atoms[i]->y;
+      coords[i].z = index->atoms[i]->z;
+   }
+   cellSize = MAX(ABS(2 * maxOcc + tolerance), 
+                  ABS(2 * minOcc + tolerance));
+
+   index->grid = BuildCellGrid(coords, index->natoms, cellSize);
+   free(coords);
+   if(index->grid == NULL)
+   {
+      FreePatchIndex(index);
+      return(NULL);
+   }
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>void FreePatchIndex(PATCHINDEX *index)
+   --------------------------------------
+*//**
+
+   \param[in]      *index       Index created by BuildPatchIndex()
+
+   Frees an index created by BuildPatchIndex()
+
+-  15.10.26  Original   By: ACRM
+*/
+void FreePatchIndex(PATCHINDEX *index)
+{
+   if(index != NULL)
+   {
+      FreeCellGrid(index->grid);
+      if(index->atoms  != NULL) free(index->atoms);
+      if(index->atomCA != NULL) free(index->atomCA);
+      if(index->CAs    != NULL) free(index->CAs);
+      if(index->massCentre != NULL) free(index->massCentre);
+      if(index->queue  != NULL) free(index->queue);
+      free(index);
+   }
+}
+
+
+/************************************************************************/
+/*>int CompareCAKeys(const void *e1, const void *e2)
+   -------------------------------------------------
+*//**
+
+   \param[in]      *e1          CAKEY to compare
+   \param[in]      *e2          CAKEY to compare
+   \return                      <0, 0, >0 for qsort()
+
+   Sorts C-alphas by chain, residue number and insert code and then by
+   their position in the C-alpha list
+
+-  15.10.26  Original   By: ACRM
+*/
+int CompareCAKeys(const void *e1, const void *e2)
+{
+   const CAKEY *k1 = (const CAKEY *)e1;
+   const CAKEY *k2 = (const CAKEY *)e2;
+   int         cmp;
+
+   if((cmp = strcmp(k1->ca->chain, k2->ca->chain)) != 0)
+      return(cmp);
+   if(k1->ca->resnum != k2->ca->resnum)
+      return((k1->ca->resnum < k2->ca->resnum) ? -1 : 1);
+   if((cmp = strcmp(k1->ca->insert, k2->ca->insert)) != 0)
+      return(cmp);
+   return(k1->order - k2->order);
+}
+
+
 /************************************************************************/
 /*>void CleanUpPDB(PDB *pdb)
    -------------------------
@@ -435,6 +905,7 @@ Atom %s\n",
    Restores the occupancy and bvalue columns to something sensible
 
 -  01.06.09  Original   By: ACRM
+-  15.10.26  No longer clears the flags
 */
 void CleanUpPDB(PDB *pdb)
 {
@@ -448,7 +919,6 @@ void CleanUpPDB(PDB *pdb)
       else
          p->bval = 0.0;
    }
-   ClearFlags(pdb);
 }
 
 
@@ -512,35 +982,37 @@ BOOL FlagSet(PDB *p)
 
 
 /************************************************************************/
-/*>void PrintSummary(PDB *p, char *Central)
-   ----------------------------------------
+/*>void PrintSummary(FILE *out, PDB *pdb, char *Central)
+   -----------------------------------------------------
 *//**
 
    Prints the summary of which residues are in the patch
 
 -  02.06.09  Original   By: Anja
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  15.10.26 Takes the output file and uses the flags rather than bval
+            By: ACRM
 */
-void PrintSummary(PDB *pdb, char *Central)
+void PrintSummary(FILE *out, PDB *pdb, char *Central)
 {
    PDB *res, 
        *NextRes;   
    
    /* printing patch identifier                                         */
-   fprintf (stdout, "<patch %s> ", Central);
+   fprintf (out, "<patch %s> ", Central);
 
    /* printing all residues in that patch (central will be on the list) */
    for (res=pdb; res!=NULL; res=NextRes)
    {
       NextRes = blFindNextResidue(res);
 
-      if (res->bval == 1)
+      if (FlagSet(res))
       {
-         fprintf(stdout, "%s:%d%s ",
+         fprintf(out, "%s:%d%s ",
               res->chain, res->resnum, res->insert);
       }      
    }
-   fprintf (stdout, "\n");
+   fprintf (out, "\n");
 }
 
 
@@ -597,7 +1069,8 @@ void ClearFlags(PDB *pdb)
 /*>BOOL ParseCmdLine(int argc, char **argv, char *CentreRes, 
                      char *CentreAtom, char *infile, char *outfile,
                      REAL *radius, REAL *tolerance, BOOL *summary,
-                     BOOL *ringOnly, REAL *minAcess)
+                     BOOL *ringOnly, REAL *minAcess, 
+                     BOOL *allSurface, char *listfile)
    ----------------------------------------------------------------
 *//**
 
@@ -613,6 +1086,8 @@ void ClearFlags(PDB *pdb)
                                 (default: FALSE)
    \param[out]     *ringOnly    Only do residues in contact with central
    \param[out]     *minAccess   minimum accessibility to be on the surface
+   \param[out]     *allSurface  Make patches around all surface residues
+   \param[out]     *listfile    File of central residues (or blank string)
    \return                      Success?
 
    Parse the command line
@@ -621,23 +1096,26 @@ void ClearFlags(PDB *pdb)
 -  02.06.09  Added -s command line option  By: Anja
 -  09.05.13  Added -c command line option  By: ACRM
 -  02.10.13  Added -m command line option
+-  15.10.26  Added -a and -l command line options
 */
 BOOL ParseCmdLine(int argc, char **argv, char *CentreRes, 
                   char *CentreAtom, char *infile, char *outfile,
                   REAL *radius, REAL *tolerance, BOOL *summary,
-                  BOOL *ringOnly, REAL *minAccess)
+                  BOOL *ringOnly, REAL *minAccess, BOOL *allSurface,
+                  char *listfile)
 {
    BOOL UserTol = FALSE;
    
    argc--;
    argv++;
 
-   infile[0] = outfile[0] = '\0';
+   infile[0] = outfile[0] = listfile[0] = CentreRes[0] = '\0';
    *radius = DEF_RADIUS;
    *tolerance = DEF_TOLERANCE;
    *summary = FALSE;
    *ringOnly = FALSE;
    *minAccess = DEF_MINACCESS;
+   *allSurface = FALSE;
    
    
    if(!argc)
@@ -685,6 +1163,16 @@ BOOL ParseCmdLine(int argc, char **argv, char *CentreRes,
             case 'c':
                *ringOnly = TRUE;
                break;
+            case 'a':
+               *allSurface = TRUE;
+               break;
+            case 'l':
+               argv++;
+               argc--;
+               if(!argc)
+                  return(FALSE);
+               strcpy(listfile, argv[0]);
+               break;
             default:
                return(FALSE);
                break;
@@ -701,14 +1189,26 @@ BOOL ParseCmdLine(int argc, char **argv, char *CentreRes,
             *tolerance = DEF_RING_TOLERANCE;
          }
 
-         /* Check that there are 2, 3 or 4 arguments left               */
-         if(argc < 2 || argc > 4)
-            return(FALSE);
+         /* With -a or -l there is no residue spec                      */
+         if(*allSurface || listfile[0])
+         {
+            /* Check that there are 1, 2 or 3 arguments left            */
+            if(argc < 1 || argc > 3)
+               return(FALSE);
+         }
+         else
+         {
+            /* Check that there are 2, 3 or 4 arguments left            */
+            if(argc < 2 || argc > 4)
+               return(FALSE);
          
-         /* Copy the first to CentreRes and second one to CentreAtom    */
-         strcpy(CentreRes, argv[0]);
-         argc--;
-         argv++;
+            /* Copy the first to CentreRes                              */
+            strcpy(CentreRes, argv[0]);
+            argc--;
+            argv++;
+         }
+         
+         /* Copy the next one to CentreAtom                             */
          strcpy(CentreAtom, argv[0]);
          argc--;
          argv++;
@@ -740,59 +1240,126 @@ BOOL ParseCmdLine(int argc, char **argv, char *CentreRes,
 
 
 /************************************************************************/
-/*>void FlagSolvVecAngles(PDB *CA, char *Central, int natom)
-   ---------------------------------------------------------
+/*>BOOL CalcMassCentres(PATCHINDEX *index, PDB *CA, int nCatom)
+   ------------------------------------------------------------
 *//**
- 
+
+   \param[in,out]  *index       Index of the PDB linked list
    \param[in]      *CA          C-alphas-only in linked list
-   \param[in]      *Central     Centre of the patch in [c]resnum[i]
-   \param[in]      natom        Number of atoms read in *pdb   
+   \param[in]      nCatom       Number of C-alphas
+   \return                      Success? (FALSE if no memory)
+
+   Calculates the mass centre of the closest C-alphas (the end of the 
+   solvent vector) for every C-alpha. These do not depend on the 
+   central residue so are only calculated once.
+
+-  15.10.26  Original (split from FlagSolvVecAngles())   By: ACRM
+-  15.10.26  Uses a grid of C-alphas and FindClosestCAs() rather than
+             DistFromCentral() and MassCentre()
+*/
+BOOL CalcMassCentres(PATCHINDEX *index, PDB *CA, int nCatom)
+{
+   PDB      *current,
+            *closest[NCLOSE];
+   VEC3F    *coords;
+   CELLGRID *grid;
+   int      i,
+            nclose;
+   
+   index->nCA = nCatom;
+   if(((index->CAs = (PDB **)malloc(MAX(nCatom, 1) * sizeof(PDB *)))
+       ==NULL) ||
+      ((index->massCentre = (VEC3F *)malloc(MAX(nCatom, 1) * 
+                                            sizeof(VEC3F)))==NULL))
+      return(FALSE);
+   
+   if(nCatom == 0)
+      return(TRUE);
 
-   Calculates mass centre vector for central residue. Then calculates 
+   /* Build a grid of the C-alphas                                      */
+   if((coords = (VEC3F *)malloc(nCatom * sizeof(VEC3F)))==NULL)
+      return(FALSE);
+   for(current=CA, i=0; i<nCatom; NEXT(current), i++)
+   {
+      index->CAs[i] = current;
+      coords[i].x   = current->x;
+      coords[i].y   = current->y;
+      coords[i].z   = current->z;
+   }
+   grid = BuildCellGrid(coords, nCatom, (REAL)CACELLSIZE);
+   free(coords);
+   if(grid == NULL)
+      return(FALSE);
+   
+   for(i=0; i<nCatom; i++)
+   {
+      nclose = FindClosestCAs(index, grid, i, closest);
+      CalcMassCentre(closest, nclose, &(index->massCentre[i].x), 
+                     &(index->massCentre[i].y), 
+                     &(index->massCentre[i].z));
+#ifdef DEBUG
+      /* prints out coordinates of the C-alpha (solvent vector begin) 
+         and coordinates of solvent vector end.
+      */
+      fprintf(stdout,"(%.4f,%.4f,%.4f):(%.4f,%.4f,%.4f)\n", 
+              index->CAs[i]->x, index->CAs[i]->y, index->CAs[i]->z, 
+              index->massCentre[i].x, index->massCentre[i].y, 
+              index->massCentre[i].z);
+#endif
+   }
+
+   FreeCellGrid(grid);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FlagSolvVecAngles(PATCHINDEX *index, PDB *patchCentre)
+   ------------------------------------------------------------
+*//**
+ 
+   \param[in,out]  *index       Index of the PDB linked list
+   \param[in]      *patchCentre C-alpha of the central residue
+
+   Takes the mass centre vector for central residue. Then takes the
    mass centre vector for every residue in Calphas, checks its angle 
-   with mass centre vector of central and flags CA->bval with 1 if angle 
-   is <120 degrees, else CA->bval=0.
+   with mass centre vector of central and sets the flag if angle 
+   is <120 degrees, else clears it.
 
 -  02.06.09  Original   By: Anja   
 -  26.10.11  Changed double to REAL  By: ACRM
 -  02.10.13  Changed to use 'extras' for the flag rather than bval
 -  04.11.13  Added check that Central residue is found
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
+-  15.10.26 Uses the mass centres from CalcMassCentres(). Takes the 
+            central C-alpha rather than the residue spec
 */
-void FlagSolvVecAngles(PDB *CA, char *Central, int natom)
+void FlagSolvVecAngles(PATCHINDEX *index, PDB *patchCentre)
 {
-   PDB  *current,
-        *patchCentre;   
+   PDB  *current;   
    BOOL AngleOK;
-   REAL Masscen_x = 0.0, 
-        Masscen_y = 0.0, 
-        Masscen_z = 0.0;
-   REAL Masscurr_x = 0.0, 
-        Masscurr_y = 0.0, 
-        Masscurr_z = 0.0;
+   int  i,
+        central;
 
    /* for Central                                                       */
-   if((patchCentre = blFindResidueSpec(CA, Central))==NULL)
+   for(central=0; central<index->nCA; central++)
    {
-      fprintf(stderr, "pdbmakepatch: (Error) Couldn't find Residue %s\n", 
-              Central);
-      exit(1);
+      if(index->CAs[central] == patchCentre)
+         break;
    }
 
-   DistFromCentral(CA, patchCentre);
-   MassCentre(CA, patchCentre, &natom, 
-              &Masscen_x, &Masscen_y, &Masscen_z);
-
    /* flagging for angles in CA                                         */
-   for (current=CA; current!=NULL; NEXT(current))
+   for(i=0; i<index->nCA; i++)
    {
-      DistFromCentral(CA, current);
-      MassCentre(CA, current, &natom, 
-                 &Masscurr_x, &Masscurr_y, &Masscurr_z);
-
-      AngleOK = CheckVectAngle(patchCentre, &Masscen_x, &Masscen_y,
-                               &Masscen_z, current, &Masscurr_x, 
-                               &Masscurr_y, &Masscurr_z);          
+      current = index->CAs[i];
+      AngleOK = CheckVectAngle(patchCentre, 
+                               &(index->massCentre[central].x), 
+                               &(index->massCentre[central].y),
+                               &(index->massCentre[central].z), 
+                               current, 
+                               &(index->massCentre[i].x), 
+                               &(index->massCentre[i].y), 
+                               &(index->massCentre[i].z));
       
       if (AngleOK)
       {
@@ -813,116 +1380,131 @@ solvvec FlagSolvVecAngles\n",
          
 
 /************************************************************************/
-/*>void DistFromCentral(PDB *pdb, PDB *central)
-   --------------------------------------------
+/*>int FindClosestCAs(PATCHINDEX *index, CELLGRID *grid, int central, 
+                      PDB **closest)
+   ------------------------------------------------------------------
 *//**
 
-   \param[in]      *pdb     
-   \param[in]      *central    Pointer to the central residue
+   \param[in]      *index       Index of the PDB linked list
+   \param[in]      *grid        Grid of the C-alphas in the index
+   \param[in]      central      Number of the central C-alpha
+   \param[out]     **closest    The closest C-alphas (NCLOSE elements)
+   \return                      Number of C-alphas found
 
-   Adds distance from the central residue to the occ parameter 
-   of residues in the same chain as central, all other residues 
-   get occ set to 999.99.
+   Finds the NCLOSE C-alphas closest to the central one in the same 
+   chain, ignoring any within 0.01A (including the central one). If
+   there are not enough in the same chain, C-alphas from other chains
+   are added in list order. Equal distances are ordered by position in
+   the list.
 
--  08.12.08  Original  By: Anja         
--  26.10.11  Changed double to REAL  By: ACRM
--  12.03.15 Changed to allow multi-character chain names
+   The grid is searched in rings of cells around the central C-alpha 
+   until no unsearched C-alpha can be closer than those found.
+
+-  15.10.26  Original (replaces DistFromCentral() and MassCentre())
+             By: ACRM
 */
-void DistFromCentral(PDB *pdb, PDB *central)
+int FindClosestCAs(PATCHINDEX *index, CELLGRID *grid, int central, 
+                   PDB **closest)
 {
-   PDB *current;
-   REAL dist_sq;    
-  
-   for (current=pdb; current!=NULL; NEXT(current))
+   PDB  *ca = index->CAs[central],
+        *p;
+   REAL distSq[NCLOSE],
+        dSq,
+        bound;
+   int  order[NCLOSE],
+        nclose = 0,
+        ring, maxRing,
+        cx, cy, cz,
+        ix, iy, iz,
+        i, j, k,
+        cell;
+
+   cell    = grid->itemCell[central];
+   cx      = cell % grid->nx;
+   cy      = (cell / grid->nx) % grid->ny;
+   cz      = cell / (grid->nx * grid->ny);
+   maxRing = MAX(MAX(grid->nx, grid->ny), grid->nz);
+
+   for(ring=0; ring<maxRing; ring++)
    {
-      /* centre of mass is based on atoms within the same 
-         chain as central
-      */
-      if (CHAINMATCH(current->chain, central->chain))
+      /* Any C-alpha not yet searched is at least this far away         */
+      bound = (ring - 1) * grid->cellSize;
+      if((nclose == NCLOSE) && (ring > 1) && 
+         (distSq[NCLOSE-1] < bound * bound))
+         break;
+
+      /* Step through the cells in this ring                            */
+      for(iz=MAX(cz-ring, 0); iz<=MIN(cz+ring, grid->nz-1); iz++)
       {
-         dist_sq = DISTSQ(central, current);
-         current->occ = sqrt(dist_sq);
+         for(iy=MAX(cy-ring, 0); iy<=MIN(cy+ring, grid->ny-1); iy++)
+         {
+            for(ix=MAX(cx-ring, 0); ix<=MIN(cx+ring, grid->nx-1); ix++)
+            {
+               if((ABS(ix-cx) != ring) && (ABS(iy-cy) != ring) && 
+                  (ABS(iz-cz) != ring))
+                  continue;
+               
+               cell = ix + grid->nx * (iy + grid->ny * iz);
+               for(j=grid->cellStart[cell]; j<grid->cellStart[cell+1]; j++)
+               {
+                  k = grid->cellItems[j];
+                  p = index->CAs[k];
+                  
+                  if(!CHAINMATCH(p->chain, ca->chain))
+                     continue;
+
+                  /* Skip the central atom and anything on top of it    */
+                  dSq = DISTSQ(p, ca);
+                  if(sqrt(dSq) < 0.01)
+                     continue;
+
+                  /* Skip if further than the NCLOSE'th found so far    */
+                  if((nclose == NCLOSE) &&
+                     ((dSq > distSq[NCLOSE-1]) ||
+                      ((dSq == distSq[NCLOSE-1]) && 
+                       (k > order[NCLOSE-1]))))
+                     continue;
+
+                  /* Insert into the sorted list of closest atoms       */
+                  i = (nclose < NCLOSE) ? nclose++ : NCLOSE-1;
+                  for(; i>0; i--)
+                  {
+                     if((distSq[i-1] < dSq) || 
+                        ((distSq[i-1] == dSq) && (order[i-1] < k)))
+                        break;
+                     distSq[i] = distSq[i-1];
+                     order[i]  = order[i-1];
+                  }
+                  distSq[i] = dSq;
+                  order[i]  = k;
+               }
+            }
+         }
       }
-      else
-      {
-         current->occ = 999.99;	
-      }			
    }
-} 
-
-
-/**********************************************************************/
-/*>void MassCentre(PDB *pdb, PDB *central, int *natom, 
-                   REAL *Masscen_x,REAL *Masscen_y, 
-                   REAL *Masscen_z)
-   ----------------------------------------------------
-*//**
-
-   \param[in]      *pdb     
-   \param[in]      *central       Pointer to the central residue
-   \param[in]      *natom         Number of atoms read from PDB file
-   \param[in]      *MassCenCoo    Coordinates of centre of mass
 
-   Outputs the coordinates of the beginning and end point of the solvent 
-   vector for the central residue. i.e. the centre of mass of the nearest
-   NCLOSE atoms
+   for(i=0; i<nclose; i++)
+      closest[i] = index->CAs[order[i]];
 
--  08.12.08  Original  By: Anja
--  03.06.09  Returns coordinates rather than printing them
--  26.10.11  Changed double to REAL  By: ACRM
--  05.11.13  CalcMassCentre() now takes the number of atoms
-*/
-void MassCentre(PDB *pdb, PDB *central, int *natom, REAL *Masscen_x,
-                REAL *Masscen_y, REAL *Masscen_z)
-{   
-   PDB  **tab,  
-        *it;
-   int  i;
-   REAL cen_x = 0, 
-        cen_y = 0, 
-        cen_z = 0;
-
-   tab = malloc(*natom * sizeof (PDB*));
-   
-   /* Creates an array of pointers to the nodes in pdb                  */
-   for(it = pdb, i=0; i<*natom; i++, it = it->next)
-   {             
-      tab[i] = it;
+   /* Make up the numbers from other chains                             */
+   for(k=0; (k<index->nCA) && (nclose<NCLOSE); k++)
+   {
+      if(!CHAINMATCH(index->CAs[k]->chain, ca->chain))
+         closest[nclose++] = index->CAs[k];
    }
 
-   /* sorts these in ascending order of value stored in occ             */
-   qsort(tab, *natom, sizeof(PDB*), CompareFunc); 
-
-   /* takes closest 10 residues, returns (x,y,z) for centre of mass     */
-   CalcMassCentre(tab, *natom, &cen_x, &cen_y, &cen_z);
-
-   free(tab);
-
-#ifdef DEBUG
-   /* prints out coordinates of the central residue C-alpha (solvent
-      vector begin) and coordinates of solvent vector end.
-      This is the mass vector not the solvent vector, angle is the same 
-   */
-   fprintf(stdout,"(%.4f,%.4f,%.4f):(%.4f,%.4f,%.4f)\n", 
-           central->x, central->y, central->z, cen_x, cen_y, cen_z);
-#endif
-
-   /* returning centre of mass coordinates                              */
-   *Masscen_x = cen_x;
-   *Masscen_y = cen_y;
-   *Masscen_z = cen_z;
-
-} 
+   return(nclose);
+}
 
 
 /************************************************************************/
-/*>int CalcMassCentre(PDB **tab, int natoms, 
-                      REAL *cen_x, REAL *cen_y, REAL *cen_z)
+/*>void CalcMassCentre(PDB **tab, int natoms, 
+                       REAL *cen_x, REAL *cen_y, REAL *cen_z)
    -----------------------------------------------------------
 *//**
 
-   \param[in]      **tab    
-           int    natoms    Number of atoms in tab[]
+   \param[in]      **tab    The closest C-alpha atoms
+   \param[in]      natoms   Number of atoms in tab[]
    \param[out]     *cen_x
    \param[out]     coordinates of centre of mass
    \param[out]     Calculates centre of mass for NCLOSE (10) closest 
@@ -932,28 +1514,22 @@ void MassCentre(PDB *pdb, PDB *central, int *natom, REAL *Masscen_x,
 -  26.10.11  Changed double to REAL  
              Uses NCLOSE instead of hard-coded 10   By: ACRM
 -  05.11.13  Added natoms parameter and check on this
+-  15.10.26  tab[] now just contains the closest atoms so the central 
+             atom is no longer skipped by checking occ
 */
 void CalcMassCentre(PDB **tab, int natoms, 
                     REAL *cen_x,REAL *cen_y, REAL *cen_z)
 {
-   int  added_count = 0,
-        array_count = 0;
+   int  count;
    REAL x_sum = 0, 
         y_sum = 0, 
         z_sum = 0;
  
-   while ((added_count < NCLOSE) && (array_count < natoms))
+   for(count=0; (count < NCLOSE) && (count < natoms); count++)
    {
-      /* if distance from central != 0 -> excluding coo. of central     */
-      if (! ( ((tab[array_count]->occ) > -0.01) && 
-              ((tab[array_count]->occ) < 0.01) ) )
-      {      
-         x_sum += tab[array_count] -> x;
-         y_sum += tab[array_count] -> y;
-         z_sum += tab[array_count] -> z;
-         added_count++;   
-      }      
-      array_count++;      
+      x_sum += tab[count] -> x;
+      y_sum += tab[count] -> y;
+      z_sum += tab[count] -> z;
    }
    
    /* coordinates of the centre of mass                                 */
@@ -963,40 +1539,6 @@ void CalcMassCentre(PDB **tab, int natoms,
 }
 
 
-/**********************************************************************/
-/*>int CompareFunc(const void* e1, const void* e2)
-   -----------------------------------------------
-*//**
-
-   \param[in]      elements to compare
-   \param[out]     0 or 1, depending whether the left element1 goes 
-                   before, is equal, or goes after element2, respectively
-
-   Defines comparison metric for qsort. Obtained from
-   http://www.codeguru.com/forum/archive/index.php/t-315091.html
-
--  08.12.08    By: Anja
-*/
-int CompareFunc(const void* e1, const void* e2) 
-{
-   const PDB* elem1 = *(PDB**)e1;
-   const PDB* elem2 = *(PDB**)e2;
-
-   if ( (elem1->occ) < (elem2->occ) )
-   {
-      return (-1);
-   }
-   else if ( (elem1->occ) == (elem2->occ) )
-   {
-      return (0);
-   }
-   else
-   {
-      return (1);           
-   }
-}
-
-
 /**********************************************************************/
 /*>BOOL CheckVectAngle(PDB *central, REAL *Masscen_x, REAL *Masscen_y, 
                     REAL *Masscen_z, PDB *current, REAL *Masscurr_x,
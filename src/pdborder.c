@@ -3,11 +3,11 @@
 
    \file       pdborder.c
    
-   \version    V1.7
-   \date       12.03.15
+   \version    V1.8
+   \date       15.10.26
    \brief      Correct the atom order in a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin, UCL 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin, UCL 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -55,6 +55,7 @@
 -  V1.5  13.02.15 Added whole PDB support and fixed some core dumps
 -  V1.6  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
 -  V1.7  12.03.15 Changed to allow multi-character chain names
+-  V1.8  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -68,6 +69,7 @@
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
 #include "bioplib/array.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -129,6 +131,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdborder"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb = wpdb->pdb;
@@ -264,10 +268,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  13.02.15 V1.5 
 -  05.03.15 V1.6
 -  12.03.15 V1.7
+-  15.10.26 V1.8
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdborder V1.7 (c) 1994-2015, Andrew C.R. Martin, \
+   fprintf(stderr,"\npdborder V1.8 (c) 1994-2026, Andrew C.R. Martin, \
 UCL\n\n");
    fprintf(stderr,"Usage: pdborder [-c] [-i] [-g] [in.pdb \
 [out.pdb]]\n");
@@ -3,11 +3,11 @@
 
    \file       pdborigin.c
    
-   \version    V1.2
-   \date       13.02.15
+   \version    V1.3
+   \date       15.10.26
    \brief      Add hydrogens to a PDB file
    
-   \copyright  (c) UCL, Dr. Andrew C. R. Martin 1999-2015
+   \copyright  (c) UCL, Dr. Andrew C. R. Martin 1999-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -50,6 +50,7 @@
 -  V1.1  22.07.14 Renamed deprecated functions with bl prefix.
                   Added doxygen annotation. By: CTP
 -  V1.2  13.02.15 Added whole PDB support  By: ACRM
+-  V1.3  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -63,6 +64,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -104,6 +106,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdborigin"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
@@ -192,10 +196,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile)
 -  28.01.99 Original    By: ACRM
 -  22.07.14 V1.1 By: CTP
 -  13.02.15 V1.2 By: ACRM
+-  15.10.26 V1.3
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdborigin V1.2 (c) 1999-2015, UCL, Andrew C.R. \
+   fprintf(stderr,"\npdborigin V1.3 (c) 1999-2026, UCL, Andrew C.R. \
 Martin\n\n");
    fprintf(stderr,"Usage: pdborigin [in.pdb [out.pdb]]\n");
    fprintf(stderr,"\nMoves a set of PDB coordinates such that the \
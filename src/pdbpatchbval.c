@@ -3,12 +3,12 @@
 
    \file       pdbpatchbval.c
    
-   \version    V1.7
-   \date       12.03.15
+   \version    V1.8
+   \date       15.10.26
    \brief      Patch the b-value (or occupancy) column using values from 
                a file
    
-   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1996-2015
+   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -57,6 +57,7 @@
 -  V1.5  25.11.14 Initialized a variable 
 -  V1.6  13.02.15 Added whole PDB support
 -  V1.7  12.03.15 Changed to allow multi-character chain names
+-  V1.8  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -68,6 +69,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -191,6 +193,8 @@ BOOL ApplyPatches(FILE *in, FILE *out, PATCH *patch, BOOL occup,
    PATCH    *pa;
    
    
+   if(IsPDBCache(in, "pdbpatchbval"))
+      return(FALSE);
    if((wpdb = blReadWholePDB(in))==NULL)
    {
       fprintf(stderr,"Unable to read PDB file\n");
@@ -417,10 +421,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *datafile, char *infile,
 -  25.11.14 V1.5
 -  13.02.15 V1.6
 -  13.03.15 V1.7
+-  15.10.26 V1.8
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbpatchbval V1.7 (c) 1996-2015, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbpatchbval V1.8 (c) 1996-2026, Dr. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbpatchbval [-o] [-v] patchfile [in.pdb \
@@ -3,12 +3,12 @@
 
    \file       pdbpatchnumbering.c
    
-   \version    V1.8
-   \date       12.03.15
+   \version    V1.9
+   \date       15.10.26
    \brief      Patch the numbering of a PDB file from a file of numbers
                and sequence (as created by KabatSeq, etc)
    
-   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1995-2015
+   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1995-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -60,6 +60,7 @@
 -  V1.7  13.02.15 Added whole PDB support
 -  V1.8  12.03.15 Changed to allow multi-character chain names and
                   three-letter code in patch file
+-  V1.9  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -73,6 +74,7 @@
 #include "bioplib/seq.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 
 /************************************************************************/
@@ -144,6 +146,8 @@ file\n");
             return(1);
          }
 
+         if(IsPDBCache(in, "pdbpatchnumbering"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
@@ -352,10 +356,11 @@ PATCH *ReadPatchFile(FILE *fp)
 -  07.11.14 V1.6 By: ACRM
 -  13.02.15 V1.7 By: ACRM
 -  12.03.15 V1.8
+-  15.10.26 V1.9
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbpatchnumbering V1.8 (c) 1995-2015, Dr. Andrew \
+   fprintf(stderr,"\npdbpatchnumbering V1.9 (c) 1995-2026, Dr. Andrew \
 C.R. Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbpatchnumbering patchfile [in.pdb \
@@ -3,11 +3,11 @@
 
    \file       pdbrenum.c
    
-   \version    V2.0
-   \date       10.03.15
+   \version    V2.1
+   \date       15.10.26
    \brief      Renumber a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -64,6 +64,8 @@
                   Uses blRenumberAtomsPDB() to do the atoms
 -  V1.13 02.03.15 Deals better with header and trailer
 -  V2.0  10.03.15 Chains specified with -c are now comma separated
+-  V2.1  15.10.26 Reads the PDB file with ReadMappedWholePDB() so
+                  binary cache files may be used
 
 *************************************************************************/
 /* Includes
@@ -77,6 +79,7 @@
 #include "bioplib/MathType.h"
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
+#include "common/mappdb.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -120,6 +123,7 @@ void DoRenumber(PDB *pdb, BOOL DoSequential, BOOL KeepChain,
             renumbered and always does blWriteWholePDBTrailer() since
             this now deals properly with renumbered atoms.
 -  10.03.15 Chains now an array of strings
+-  15.10.26 Uses ReadMappedWholePDB()
 */
 int main(int argc, char **argv)
 {
@@ -142,7 +146,7 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((wpdb=blReadWholePDB(in))==NULL)
+         if((wpdb=ReadMappedWholePDB(in))==NULL)
          {
             fprintf(stderr,"pdbrenum: Unable to read input PDB file\n");
          }
@@ -398,10 +402,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  23.02.15 V1.12
 -  02.03.15 V1.13
 -  10.03.15 V2.0
+-  15.10.26 V2.1
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbrenum V2.0 (c) 1994-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbrenum V2.1 (c) 1994-2026 Dr. Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbrenum [-s][-k][-c chain[,chain[...]]]\
 [-n][-d]\n");
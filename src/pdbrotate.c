@@ -3,11 +3,11 @@
 
    \file       pdbrotate.c
    
-   \version    V1.5
-   \date       13.02.15
+   \version    V1.6
+   \date       15.10.26
    \brief      Program to rotate PDB files
    
-   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin / UCL 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -53,6 +53,7 @@
                   Added doxygen annotation. By: CTP
 -  V1.4  06.11.14 Renamed from rotate  By: ACRM
 -  V1.5  13.02.15 Added whole PDB support
+-  V1.6  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -67,6 +68,7 @@
 #include "bioplib/matrix.h"
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -228,6 +230,9 @@ with -m\n");
       argv++;
    }
    
+   if(IsPDBCache(in, "pdbrotate"))
+      return(1);
+
    /* Read in the PDB file                                              */
    if((wpdb = blReadWholePDB(in))==NULL)
    {
@@ -334,10 +339,11 @@ BOOL BuildRotInstruct(ROTLIST **pRotList, char direction, char *amount)
 -  22.07.14 V1.3 By: CTP
 -  06.11.14 V1.4 By: ACRM
 -  13.02.15 V1.5 
+-  15.10.26 V1.6
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbrotate V1.5 (c) 1994-2015 Andrew C.R. \
+   fprintf(stderr,"\npdbrotate V1.6 (c) 1994-2026 Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Freely distributable if no profit is made\n\n");
    fprintf(stderr,"Usage: pdbrotate [-m 11 12 13 21 22 23 31 32 33] \
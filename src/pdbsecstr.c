@@ -3,11 +3,11 @@
 
    \File       pdbsecstr.c
    
-   \version    V1.1
-   \date       11.08.16
+   \version    V1.3
+   \date       15.10.26
    \brief      Secondary structure calculation program
    
-   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 1999-2016
+   \copyright  (c) Dr. Andrew C. R. Martin, UCL, 1999-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -49,6 +49,8 @@
    V1.0   19.05.99 Original, written while at Inpharmatica   By: ACRM
    V1.1   11.08.16 Rewritten to use PDB files rather than XMAS files
                    and to use blCalcSecStrucPDB() in Bioplib
+   V1.2   15.10.26 Added -l and -D to process a list of files
+   V1.3   15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -61,6 +63,9 @@
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
 #include "bioplib/secstr.h"
+#include "common/pdbcache.h"
+
+#include "common/batch.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -77,8 +82,9 @@ BOOL sNewChain = FALSE;
 */
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
-                  BOOL *debug);
+                  char *listfile, char *outdir, BOOL *debug);
 void Usage(void);
+BOOL SecStrFile(FILE *in, FILE *out, char *infile, void *data);
 void WriteResults(FILE *out, PDB *pdbStart, PDB *pdbStop);
 
 
@@ -93,19 +99,23 @@ void WriteResults(FILE *out, PDB *pdbStart, PDB *pdbStop);
 -  19.05.99 Original   By: ACRM
 -  27.05.99 Added error return if blCalcSS out of memory
 -  11.08.16 Updated for using Bioplib
+-  15.10.26 Added batch mode. Processing moved to SecStrFile()
+            By: ACRM
 */
 int main(int argc, char **argv)
 {
    char infile[MAXBUFF],
-        outfile[MAXBUFF];
+        outfile[MAXBUFF],
+        listfile[MAXBUFF],
+        outdir[MAXBUFF];
    FILE *in = stdin,
         *out = stdout;
-   PDB  *pdb;
-   int  natoms;
+   int  nfail;
    BOOL debug = FALSE;
    
    
-   if(!ParseCmdLine(argc, argv, infile, outfile, &debug))
+   if(!ParseCmdLine(argc, argv, infile, outfile, listfile, outdir, 
+                    &debug))
    {
       Usage();
       return(0);
@@ -114,27 +124,29 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
-         if((pdb = blReadPDBAtoms(in, &natoms))!=NULL)
+         if(listfile[0])
          {
-            PDB *start, *stop;
-            
-            for(start=pdb; start!=NULL; start=stop)
+            if((nfail = RunBatch(listfile, outdir, out, SecStrFile,
+                                 &debug)) < 0)
             {
-               stop=blFindNextChain(start);
-
-               if(blCalcSecStrucPDB(start, stop, debug) != 0)
-               {
-                  return(1);
-               }
-            
-               WriteResults(out, start, stop);
+               fprintf(stderr,"Unable to read list file, %s\n", 
+                       listfile);
+               return(1);
             }
-            
-            FREELIST(pdb, PDB);
-
-            if(in  != stdin)  fclose(in);
-            if(out != stdout) fclose(out);
+            if(nfail)
+            {
+               fprintf(stderr,"%d files could not be processed\n", 
+                       nfail);
+               return(1);
+            }
+         }
+         else if(!SecStrFile(in, out, infile, &debug))
+         {
+            return(1);
          }
+
+         if(in  != stdin)  fclose(in);
+         if(out != stdout) fclose(out);
       }
       else
       {
@@ -146,15 +158,68 @@ int main(int argc, char **argv)
 }
 
 
+/************************************************************************/
+/*>BOOL SecStrFile(FILE *in, FILE *out, char *infile, void *data)
+   --------------------------------------------------------------
+*//**
+   \param[in]   *in         Input PDB file
+   \param[in]   *out        Output file
+   \param[in]   *infile     Input filename (or blank string)
+   \param[in]   *data       Pointer to the debug flag (BOOL)
+   \return                  Success
+
+   Reads a PDB file, calculates the secondary structure of each chain
+   and writes the summary. Called directly or for each file by 
+   RunBatch()
+
+-  15.10.26 Original (split from main())   By: ACRM
+*/
+BOOL SecStrFile(FILE *in, FILE *out, char *infile, void *data)
+{
+   BOOL debug = *(BOOL *)data;
+   PDB  *pdb, 
+        *start, 
+        *stop;
+   int  natoms;
+   
+   if(IsPDBCache(in, "pdbsecstr"))
+      return(FALSE);
+   if((pdb = blReadPDBAtoms(in, &natoms))==NULL)
+   {
+      fprintf(stderr,"No atoms read from input file %s\n", infile);
+      return(FALSE);
+   }
+   
+   for(start=pdb; start!=NULL; start=stop)
+   {
+      stop=blFindNextChain(start);
+
+      if(blCalcSecStrucPDB(start, stop, debug) != 0)
+      {
+         FREELIST(pdb, PDB);
+         return(FALSE);
+      }
+            
+      WriteResults(out, start, stop);
+   }
+            
+   FREELIST(pdb, PDB);
+   return(TRUE);
+}
+
+
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
-                     BOOL *debug)
+                     char *listfile, char *outdir, BOOL *debug)
    ---------------------------------------------------------------------
 *//**
    \param[in]   argc              Argument count
    \param[in]   **argv            Argument array
    \param[out]  *infile           Input filename (or blank string)
    \param[out]  *outfile          Output filename (or blank string)
+   \param[out]  *listfile         File listing input files (or blank
+                                  string)
+   \param[out]  *outdir           Output directory (or blank string)
    \param[out]  *debug            Debug?
    \return                        Success
 
@@ -162,14 +227,15 @@ int main(int argc, char **argv)
 
 -   19.05.99 Original    By: ACRM
 -   11.08.16 Updated for PDB version
+-   15.10.26 Added -l and -D. With -l, a filename is the output file
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
-                  BOOL *debug)
+                  char *listfile, char *outdir, BOOL *debug)
 {
    argc--;
    argv++;
    
-   infile[0] = outfile[0] = '\0';
+   infile[0] = outfile[0] = listfile[0] = outdir[0] = '\0';
    *debug    = FALSE;
    
    while(argc)
@@ -181,6 +247,20 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          case 'd':
             *debug = TRUE;
             break;
+         case 'l':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(listfile, argv[0], MAXBUFF);
+            listfile[MAXBUFF-1] = '\0';
+            break;
+         case 'D':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(outdir, argv[0], MAXBUFF);
+            outdir[MAXBUFF-1] = '\0';
+            break;
          default:
             return(FALSE);
             break;
@@ -188,6 +268,15 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
       }
       else
       {
+         /* With a list of files, only the output file may be given     */
+         if(listfile[0])
+         {
+            if(argc > 1)
+               return(FALSE);
+            strcpy(outfile, argv[0]);
+            return(TRUE);
+         }
+
          /* Check that there are only 1 or 2 arguments left             */
          if(argc > 2)
             return(FALSE);
@@ -223,15 +312,24 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  19.05.99 Original   By: ACRM
 -  21.05.99 Added flags
 -  11.08.16 Updated for non-xmas version
+-  15.10.26 V1.2 Added -l and -D   By: ACRM
+-  15.10.26 V1.3
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbsecstr V1.1 (c) 1999-2015, UCL, \
+   fprintf(stderr,"\npdbsecstr V1.3 (c) 1999-2026, UCL, \
 Dr. Andrew C.R. Martin\n");
 
    fprintf(stderr,"\nUsage: pdbsecstr [-d] [in.xmas [out.xmas]]\n");
+   fprintf(stderr,"       pdbsecstr [-d] -l listfile [-D outdir] \
+[out.txt]\n");
    fprintf(stderr,"          -d Debug mode - reports information on\
 dropped 3rd Hbonds, etc.\n");
+   fprintf(stderr,"          -l Process each of the PDB files listed \
+in listfile ('-' for stdin)\n");
+   fprintf(stderr,"          -D Write the results for each file to a \
+file of the same name in\n");
+   fprintf(stderr,"             outdir rather than all to out.txt\n");
 
    fprintf(stderr,"\nCalculates secondary structure assignments \
 according to the method of\n");
@@ -239,7 +337,11 @@ according to the method of\n");
 a simple summary text\n");
    fprintf(stderr,"file.\n");
    fprintf(stderr,"\nInput/output is to standard input/output if \
-files are not specified.\n\n");
+files are not specified.\n");
+   fprintf(stderr,"With -l, the output for each file is preceded by \
+a '%s<filename>' line\n", BATCH_BEGIN);
+   fprintf(stderr,"and followed by '%s<filename> OK' (or FAILED) \
+unless -D is used.\n\n", BATCH_END);
 }
 
 
@@ -3,11 +3,11 @@
 
    \file       pdbsolv.c
    
-   \version    V1.5
-   \date       08.03.16
+   \version    V1.8
+   \date       15.10.26
    \brief      Solvent accessibility using bioplib
    
-   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2016
+   \copyright  (c) UCL, Dr. Andrew C.R. Martin, 2014-2026
    \author     Dr. Andrew C.R. Martin
    \par
                Institute of Structural & Molecular Biology,
@@ -54,6 +54,11 @@
                     accessibility
 -   V1.5   08.03.16 Corrected insert code printing so it is left-justified
                     and now touches the residue number
+-   V1.6   15.10.26 Added -l and -d to process a list of files
+-   V1.7   15.10.26 Reads the PDB file with ReadMappedWholePDB() so
+                    binary cache files may be used
+-   V1.8   15.10.26 The calculation is moved to common/solvcalc.c so
+                    it is shared with the bioptools pipeline
 
 *************************************************************************/
 /* Includes
@@ -66,14 +71,27 @@
 #include "bioplib/SysDefs.h"
 #include "bioplib/pdb.h"
 #include "bioplib/access.h"
+#include "common/batch.h"
+#include "common/mappdb.h"
+#include "common/solvcalc.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 160
-#define DEF_PROBERADIUS 1.4
-#define DEF_RADFILE "radii.dat"
-#define DATA_ENV "DATADIR"
+
+/* Options and open files shared by all the files processed            */
+typedef struct
+{
+   FILE *fpRad,
+        *resout;
+   REAL integrationAccuracy,
+        probeRadius;
+   BOOL doAccessibility,
+        noAtoms,
+        doResaccess,
+        batch;
+}  SOLVPARAMS;
 
 /************************************************************************/
 /* Globals
@@ -85,9 +103,10 @@
 int  main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
                   REAL *integrationAccuracy, REAL *rad, char *radfile,
-                  BOOL *doAccessibility, char *resfile, BOOL *noAtoms);
+                  BOOL *doAccessibility, char *resfile, BOOL *noAtoms,
+                  char *listfile, char *outdir);
 void Usage(void);
-void PopulateBValWithAccess(PDB *pdb);
+BOOL SolvFile(FILE *in, FILE *out, char *infile, void *data);
 void PrintResidueAccessibility(FILE *out, PDB *pdb, RESRAD *resrad);
 
 
@@ -101,41 +120,42 @@ void PrintResidueAccessibility(FILE *out, PDB *pdb, RESRAD *resrad);
 -  19.08.14 Fixed call to renamed function: blStripWatersPDBAsCopy()
                   By: CTP
 -  13.02.15 Modified to use whole PDB   By: ACRM
+-  15.10.26 Added -l and -d. The work for each file is now done by
+            SolvFile()
+-  15.10.26 Uses OpenRadiusFile()
 
 */
 int main(int argc, char **argv)
 {
-   RESRAD   *resrad;
-   FILE     *in     = stdin,
-            *out    = stdout,
-            *resout = stdout,
-            *fpRad  = NULL;
-   int      natoms;
-   WHOLEPDB *wpdb;
-   PDB      *pdb;
-   BOOL     doAccessibility = FALSE,
-            noenv           = FALSE,
-            noAtoms         = FALSE,
-            doResaccess     = FALSE;
-   REAL     integrationAccuracy,
-            probeRadius;
-   char     infile[MAXBUFF],
-            outfile[MAXBUFF],
-            radfile[MAXBUFF],
-            resfile[MAXBUFF];
+   FILE       *in     = stdin,
+              *out    = stdout;
+   BOOL       ok      = TRUE;
+   int        nfail;
+   char       infile[MAXBUFF],
+              outfile[MAXBUFF],
+              radfile[MAXBUFF],
+              resfile[MAXBUFF],
+              listfile[MAXBUFF],
+              outdir[MAXBUFF];
+   SOLVPARAMS params;
    
    if(!ParseCmdLine(argc, argv, infile, outfile, 
-                    &integrationAccuracy, &probeRadius, 
-                    radfile, &doAccessibility, resfile, &noAtoms))
+                    &params.integrationAccuracy, &params.probeRadius, 
+                    radfile, &params.doAccessibility, resfile, 
+                    &params.noAtoms, listfile, outdir))
    {
       Usage();
       return(0);
    }
 
+   params.resout      = stdout;
+   params.doResaccess = FALSE;
+   params.batch       = (BOOL)(listfile[0] != '\0');
+
    if(resfile[0] != '\0')
    {
-      doResaccess = TRUE;
-      if((resout = blOpenOrPipe(resfile))==NULL)
+      params.doResaccess = TRUE;
+      if((params.resout = blOpenOrPipe(resfile))==NULL)
       {
          fprintf(stderr, "Error (pdbsolv): Unable to open file or pipe \
 for residue accessibility data (%s)\n", resfile);
@@ -150,80 +170,116 @@ file\n");
       return(1);
    }
 
-   if((wpdb = blReadWholePDB(in))==NULL)
-   {
-      fprintf(stderr, "Error (pdbsolv): No atoms read from PDB \
-file, %s\n", infile);
+   /* Open the radius file                                              */
+   if((params.fpRad=OpenRadiusFile(radfile))==NULL)
       return(1);
-   }
 
-   /* Strip waters                                                      */
-   if((pdb = blStripWatersPDBAsCopy(wpdb->pdb, &natoms))==NULL)
+   if(params.batch)
    {
-      fprintf(stderr, "Error (pdbsolv): No memory to strip waters from \
-PDB file, %s\n",
-              infile);
-      return(1);
+      if((nfail = RunBatch(listfile, outdir, out, SolvFile, 
+                           (void *)&params)) < 0)
+      {
+         fprintf(stderr, "Error (pdbsolv): Unable to read list file, \
+%s\n", listfile);
+         return(1);
+      }
+      if(nfail)
+      {
+         fprintf(stderr, "Error (pdbsolv): %d files could not be \
+processed\n", nfail);
+         ok = FALSE;
+      }
+   }
+   else
+   {
+      ok = SolvFile(in, out, infile, (void *)&params);
    }
 
-   /* Free the original linked list of atoms and patch in the new one   */
-   FREELIST(wpdb->pdb, PDB);
-   wpdb->pdb = pdb;
+   if(params.doResaccess)
+      blCloseOrPipe(params.resout);
 
-   /* Open the radius file                                              */
-   if((fpRad=blOpenFile(radfile, DATA_ENV, "r", &noenv))==NULL)
+   return(ok ? 0 : 1);
+}
+
+
+/************************************************************************/
+/*>BOOL SolvFile(FILE *in, FILE *out, char *infile, void *data)
+   ------------------------------------------------------------
+*//**
+   \param[in]   FILE   *in       Input PDB file
+   \param[in]   FILE   *out      Output PDB file
+   \param[in]   char   *infile   Input filename
+   \param[in]   void   *data     SOLVPARAMS options and open files
+   \return      BOOL             Success
+
+   Does the accessibility calculations for one PDB file. Called directly
+   or for each file by RunBatch(). In batch mode, the residue 
+   accessibility data for each file are framed in the same way as the
+   main output.
+
+-  15.10.26 Original (split from main())   By: ACRM
+-  15.10.26 Uses ReadMappedWholePDB()
+-  15.10.26 Uses CalcWholePDBAccess()
+*/
+BOOL SolvFile(FILE *in, FILE *out, char *infile, void *data)
+{
+   SOLVPARAMS *params = (SOLVPARAMS *)data;
+   RESRAD     *resrad;
+   WHOLEPDB   *wpdb;
+   PDB        *pdb;
+
+   if((wpdb = ReadMappedWholePDB(in))==NULL)
    {
-      fprintf(stderr, "Error (pdbsolv): Unable to open radius file, \
-%s\n", radfile);
-      if(noenv)
-      {
-         fprintf(stderr, "              Environment variable %s \
-not set\n", DATA_ENV);
-      }
-      return(1);
+      fprintf(stderr, "Error (pdbsolv): No atoms read from PDB \
+file, %s\n", infile);
+      return(FALSE);
    }
 
-   /* Set the atom radii in the linked list                             */
-   resrad = blSetAtomRadii(pdb, fpRad);
-
-   /* Do the actual accessibility calculations                          */
-   if(!blCalcAccess(pdb, natoms, 
-                    integrationAccuracy, probeRadius,
-                    doAccessibility))
+   /* Strip waters, set the radii and do the calculations               */
+   if(!CalcWholePDBAccess(wpdb, params->fpRad, 
+                          params->integrationAccuracy, 
+                          params->probeRadius, params->doAccessibility,
+                          &resrad))
    {
-      fprintf(stderr,"Error: (pdbsolv) No memory for accessibility \
-arrays\n");
-      return(1);
+      fprintf(stderr, "Error (pdbsolv): Unable to process PDB file, \
+%s\n", infile);
+      blFreeWholePDB(wpdb);
+      return(FALSE);
    }
+   pdb = wpdb->pdb;
 
    /* And populate the B-values with the accessibility and write the
       new PDB file
    */
-   if(!noAtoms)
+   if(!params->noAtoms)
    {
       PopulateBValWithAccess(pdb);
       blWriteWholePDB(out, wpdb);
    }
 
-   if(doResaccess)
+   if(params->doResaccess)
    {
-      PrintResidueAccessibility(resout, pdb, resrad);
-      blCloseOrPipe(resout);
+      if(params->batch)
+         fprintf(params->resout, "%s%s\n", BATCH_BEGIN, infile);
+      PrintResidueAccessibility(params->resout, pdb, resrad);
+      if(params->batch)
+         fprintf(params->resout, "%s%s OK\n", BATCH_END, infile);
    }
 
-   /* Free up the memory for the PDB linked list                        */
-   FREELIST(pdb, PDB);
+   /* Free up the memory for the PDB data                               */
+   blFreeWholePDB(wpdb);
    /* Free up the memory from the residue radii                         */
    FREELIST(resrad, RESRAD);
 
-   return(0);
+   return(TRUE);
 }
 
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
                      REAL *p, REAL *rad, char *radfile,
-                     BOOL *doAccessibility, char *resfile, BOOL *noAtoms)
+                     BOOL *doAccessibility, char *resfile, BOOL *noAtoms,
+                     char *listfile, char *outdir)
    ----------------------------------------------------------------------
 *//**
    \param[in]   int    argc              Argument count
@@ -238,15 +294,21 @@ arrays\n");
    \param[out]  char   *resfile          File for storing residue 
                                          accessibilities
    \param[out]  BOOL   *noAtoms          Do not write atom accessibilities
+   \param[out]  char   *listfile         File listing input files (or 
+                                         blank string)
+   \param[out]  char   *outdir           Output directory (or blank 
+                                         string)
    \return      BOOL                     Success
 
    Parse the command line
 
    17.07.14 Original    By: ACRM
+   15.10.26 Added -l and -d. With -l, a filename is the output file
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
                   REAL *integrationAccuracy, REAL *rad, char *radfile,
-                  BOOL *doAccessibility, char *resfile, BOOL *noAtoms)
+                  BOOL *doAccessibility, char *resfile, BOOL *noAtoms,
+                  char *listfile, char *outdir)
 {
    argc--;
    argv++;
@@ -257,6 +319,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    *noAtoms             = FALSE;
 
    infile[0] = outfile[0] = radfile[0] = resfile[0] = '\0';
+   listfile[0] = outdir[0] = '\0';
    strcpy(radfile, DEF_RADFILE);
    
    while(argc)
@@ -284,6 +347,16 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
                return(FALSE);
             strncpy(resfile,(++argv)[0],MAXBUFF);
             break;
+         case 'l':
+            if(!(--argc))
+               return(FALSE);
+            strncpy(listfile,(++argv)[0],MAXBUFF);
+            break;
+         case 'd':
+            if(!(--argc))
+               return(FALSE);
+            strncpy(outdir,(++argv)[0],MAXBUFF);
+            break;
          case 'n':
             *noAtoms = TRUE;
             break;
@@ -297,6 +370,15 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
       }
       else
       {
+         /* With a list of files, only the output file may be given     */
+         if(listfile[0])
+         {
+            if(argc > 1)
+               return(FALSE);
+            strcpy(outfile, argv[0]);
+            return(TRUE);
+         }
+
          /* Check that there are only 1 or 2 arguments left             */
          if(argc > 2)
             return(FALSE);
@@ -332,14 +414,20 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -   13.02.15 V1.3
 -   17.06.15 V1.4
 -   08.03.16 V1.5
+-   15.10.26 V1.6 Added -l and -d
+-   15.10.26 V1.7
+-   15.10.26 V1.8
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbsolv V1.5 (c) 2014-2016 UCL, Dr. Andrew C.R. \
+   fprintf(stderr,"\npdbsolv V1.8 (c) 2014-2026 UCL, Dr. Andrew C.R. \
 Martin\n");
 
    fprintf(stderr,"\nUsage: pdbsolv [-i val] [-p val] [-f radfile] \
 [-r resfile] [-n] [-c] [in.pdb [out.pdb]]\n");
+   fprintf(stderr,"       pdbsolv [-i val] [-p val] [-f radfile] \
+[-r resfile] [-n] [-c] -l listfile\n");
+   fprintf(stderr,"               [-d outdir] [out.pdb]\n");
    fprintf(stderr,"            -i val      Specify integration accuracy \
 (Default: %.2f)\n",ACCESS_DEF_INTACC);
    fprintf(stderr,"            -p val      Specify probe radius \
@@ -361,33 +449,28 @@ program.\n");
 accessibility. Used with -r\n");
    fprintf(stderr,"            -c          Do contact area instead of \
 accessibility\n");
+   fprintf(stderr,"            -l listfile Process each of the PDB files \
+listed in listfile\n");
+   fprintf(stderr,"                        ('-' for stdin)\n");
+   fprintf(stderr,"            -d outdir   Write the output for each \
+file to a file of the same\n");
+   fprintf(stderr,"                        name in outdir rather than \
+all to out.pdb\n");
 
    fprintf(stderr,"\nPerforms solvent accessibility calculations \
 according to the method of\n");
    fprintf(stderr,"Lee and Richards. Reads and writes PDB format files. \
 Input/output is\n");
    fprintf(stderr,"to standard input/output if files are not \
-specified.\n\n");
-}
-
-
-/************************************************************************/
-/*>void PopulateBValWithAccess(PDB *pdb)
-   -------------------------------------
-*//**
-   \param   PDB  *pdb    PDB linked list
-
-   Copies the accessibility inforation into the B-Value column for output
-
--  17.07.14  Original   By: ACRM   
-*/
-void PopulateBValWithAccess(PDB *pdb)
-{
-   PDB *p;
-   for(p=pdb; p!=NULL; NEXT(p))
-   {
-      p->bval = p->access;
-   }
+specified.\n");
+   fprintf(stderr,"\nWith -l, the radius file is read for each file \
+without being reopened.\n");
+   fprintf(stderr,"Unless -d is used, the output for each file is \
+preceded by a\n");
+   fprintf(stderr,"'%s<filename>' line and followed by '%s<filename> \
+OK' (or FAILED).\n", BATCH_BEGIN, BATCH_END);
+   fprintf(stderr,"Residue accessibility data are framed in the same \
+way.\n\n");
 }
 
 
@@ -3,12 +3,12 @@
 
    \file       pdbsphere.c
    
-   \version    V1.10
-   \date       12.03.15
+   \version    V1.13
+   \date       15.10.26
    \brief      Output all aminoacids within range from central aminoacid 
                in a PDB file
    
-   \copyright  (c) UCL/Anja Baresic/Dr. Andrew C.R. Martin-2015
+   \copyright  (c) UCL/Anja Baresic/Dr. Andrew C.R. Martin-2015-2026
    \author     Anja Baresic/Dr. Andrew C.R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -70,21 +70,48 @@
 -  V1.9  22.07.14  Renamed deprecated functions with bl prefix.
                    Added doxygen annotation. By: CTP
 -  V1.10 12.03.15  Changed to allow multi-character chain names
+-  V1.11 15.10.26  Uses a cell-list grid to find residues in range 
+                   rather than comparing with every atom. -a no longer
+                   rescans and clears the whole structure for each
+                   residue
+-  V1.12 15.10.26  Cell-list grid moved to common/cellgrid.c. Reports an
+                   error if the central residue is not in the index
+-  V1.13 15.10.26 Reports an error for a binary cache file
 
 **************************************************************************/
 /* Includes
 */
 #include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
 #include "bioplib/pdb.h"
 #include "bioplib/SysDefs.h"
 #include "bioplib/MathType.h"
 #include "bioplib/macros.h"
+#include "common/cellgrid.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
 */
 #define MAXBUFF 160
 
+/* Index of the atoms and residues used to find residues in range. 
+   Atoms and residues are numbered in linked list order                 */
+typedef struct
+{
+   PDB      **atoms;    /* Atoms in linked list order                   */
+   CELLGRID *grid;      /* Grid of atoms                                */
+   int      *atomRes,   /* Residue number of each atom                  */
+            *resFirst,  /* First atom of each residue (plus natoms)     */
+            *found,     /* Stamp for residues found in the current 
+                           search                                       */
+            *inRange,   /* Residues found by FindResiduesInRange()      */
+            natoms,
+            nres,
+            search;     /* Number of the current search                 */
+}  SPHEREINDEX;
+
 /************************************************************************/
 /* Globals
 */
@@ -93,9 +120,15 @@
 /* Prototypes
 */
 int main(int argc, char **argv);
-void FlagResiduesInRange(PDB *pdb, PDB *central, REAL radiusSq);
+BOOL FlagResiduesInRange(SPHEREINDEX *index, PDB *central, 
+                         REAL radiusSq);
+int FindResiduesInRange(SPHEREINDEX *index, int central, REAL radiusSq);
+int CompareInts(const void *a, const void *b);
+SPHEREINDEX *BuildSphereIndex(PDB *pdb, REAL radius);
+void FreeSphereIndex(SPHEREINDEX *index);
 void WriteAtoms(PDB *pdb, FILE *out);
 void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact);
+void WriteResidueID(FILE *out, PDB *p, BOOL colons, BOOL compact);
 BOOL ParseCmdLine(int argc, char **argv,char *resspec, char *InFile, 
                   char *OutFile, BOOL *summary, REAL *radiusSq,
                   BOOL *colons, BOOL *isHet, BOOL *doAuto);
@@ -112,14 +145,21 @@ void Usage(void);
    a specified radius (default 8A, override with -r). Summary output
    (just the residue list) can be generated with -s and -c provides an
    alternative output format.
+
+-  15.10.26 Builds a SPHEREINDEX once. -a finds the residues in range 
+            of each residue from the index and writes them directly
+-  15.10.26 Checks the return from FlagResiduesInRange()
 */
 int main(int argc, char **argv)
 {
-   FILE   *in  = stdin,
-          *out = stdout;
-   PDB    *pdb,
-          *central;         
-   int    natom;
+   FILE        *in  = stdin,
+               *out = stdout;
+   PDB         *pdb,
+               *central;         
+   SPHEREINDEX *index;
+   int         natom,
+               nInRange,
+               i, j;
    REAL   radiusSq;
    char   resspec[MAXBUFF],
           InFile[MAXBUFF],
@@ -134,6 +174,8 @@ int main(int argc, char **argv)
    {
       if (blOpenStdFiles(InFile, OutFile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbsphere"))
+            return(1);
          if((pdb=blReadPDB(in, &natom))==NULL)
          {
             fprintf(stderr,"Error: (pdbsphere) No atoms read from PDB \
@@ -145,17 +187,31 @@ file\n");
             /* Clear the ->extras field                                 */
             ClearExtras(pdb);
 
+            if((index = BuildSphereIndex(pdb, (REAL)sqrt(radiusSq)))
+               ==NULL)
+            {
+               fprintf(stderr,"Error: (pdbsphere) No memory for atom \
+index\n");
+               return(1);
+            }
+
             if(doAuto)
             {
-               for(central=pdb; central!=NULL; central=blFindNextResidue(central))
+               for(i=0; i<index->nres; i++)
                {
-                  FlagResiduesInRange(pdb, central, radiusSq);
+                  central  = index->atoms[index->resFirst[i]];
+                  nInRange = FindResiduesInRange(index, i, radiusSq);
                   fprintf(out, "%s %s%d%s:",central->resnam, 
                           central->chain,
                           central->resnum,
                           central->insert);
-                  WriteResidues(pdb, out, colons, TRUE);
-                  ClearExtras(pdb);
+                  for(j=0; j<nInRange; j++)
+                  {
+                     WriteResidueID(out, 
+                        index->atoms[index->resFirst[index->inRange[j]]],
+                        colons, TRUE);
+                  }
+                  fprintf(out,"\n");
                }
             }
             else
@@ -177,7 +233,12 @@ found in %s\n", resspec, InFile);
                }
                else                  
                {
-                  FlagResiduesInRange(pdb, central, radiusSq);
+                  if(!FlagResiduesInRange(index, central, radiusSq))
+                  {
+                     fprintf(stderr,"Error: (pdbsphere) Residue %s not \
+found in atom index\n", resspec);
+                     return(1);
+                  }
                
                   if (summary)
                   {
@@ -189,6 +250,8 @@ found in %s\n", resspec, InFile);
                   }      
                }
             }
+
+            FreeSphereIndex(index);
          }
       }      
    }
@@ -200,60 +263,262 @@ found in %s\n", resspec, InFile);
 }
 
 /**********************************************************************/
-/*>void FlagResiduesInRange(PDB *pdb, PDB *central, REAL *radiusSq)
-   ----------------------------------------------------------------
+/*>BOOL FlagResiduesInRange(SPHEREINDEX *index, PDB *central, 
+                            REAL radiusSq)
+   -------------------------------------------------------------
 *//**
 
-   \param[in]      *pdb     
+   \param[in]      *index      Index of the PDB linked list
    \param[in]      *central    Pointer to the first atom of a central 
-   \param[in]      Input:   REAL   radiusSq    To be flagged, atom has to be within that 
-   \param[in]      (radius is squared for speed)
+                               residue
+   \param[in]      radiusSq    To be flagged, atom has to be within 
+                               that (radius is squared for speed)
+   \return                     Was the central atom in the index?
 
    If any atom in a residue is within range from *central, marks all 
    atoms in that residue (sets extras field to 1) 
 
 -  17.05.11 Changed double to REAL and use extras field rather than occ
             By: ACRM
+-  15.10.26 Now takes a SPHEREINDEX and uses FindResiduesInRange()
 */
-void FlagResiduesInRange(PDB *pdb, PDB *central, REAL radiusSq)
+BOOL FlagResiduesInRange(SPHEREINDEX *index, PDB *central, 
+                         REAL radiusSq)
 {
-   PDB  *p,
-        *q,
-        *current,
-        *nextPRes,
-        *nextCurrentRes;
-   BOOL aaInRange;
-      
-
-   nextPRes=blFindNextResidue(central);
-  
-   for (current=pdb; current!=NULL; current=nextCurrentRes)
+   int i, 
+       res,
+       nInRange;
+
+   /* Find the residue containing the central atom                      */
+   for(i=0; i<index->natoms; i++)
    {
-      aaInRange=FALSE;
-      nextCurrentRes=blFindNextResidue(current);
-      
-      for (q=current; q!=nextCurrentRes; NEXT(q))
-      {            
-         for (p=central; p!=nextPRes; NEXT(p))
+      if(index->atoms[i] == central)
+         break;
+   }
+   if(i == index->natoms)
+      return(FALSE);
+   res = index->atomRes[i];
+
+   nInRange = FindResiduesInRange(index, res, radiusSq);
+   for(res=0; res<nInRange; res++)
+   {
+      for(i=index->resFirst[index->inRange[res]]; 
+          i<index->resFirst[index->inRange[res]+1]; 
+          i++)
+      {
+         index->atoms[i]->extras=(APTR)1;
+      }
+   }
+
+   return(TRUE);
+} 
+
+
+/************************************************************************/
+/*>int FindResiduesInRange(SPHEREINDEX *index, int central, 
+                           REAL radiusSq)
+   --------------------------------------------------------
+*//**
+
+   \param[in,out]  *index      Index of the PDB linked list
+   \param[in]      central     Number of the central residue
+   \param[in]      radiusSq    Squared distance cutoff
+   \return                     Number of residues in range
+
+   Finds the residues with any atom within range of an atom of the
+   central residue (including the central residue itself). The residue
+   numbers are placed in index->inRange[] in linked list order.
+
+   Only atoms in the grid cells around each central atom are tested,
+   and once a residue has been found its other atoms are skipped.
+
+-  15.10.26 Original   By: ACRM
+*/
+int FindResiduesInRange(SPHEREINDEX *index, int central, REAL radiusSq)
+{
+   CELLGRID *grid = index->grid;
+   PDB      *p;
+   int      nInRange = 0,
+            i, j, k, res,
+            cx, cy, cz,
+            ix, iy, iz,
+            cell;
+
+   index->search++;
+   
+   for(i=index->resFirst[central]; i<index->resFirst[central+1]; i++)
+   {
+      p    = index->atoms[i];
+      cell = grid->itemCell[i];
+      cx   = cell % grid->nx;
+      cy   = (cell / grid->nx) % grid->ny;
+      cz   = cell / (grid->nx * grid->ny);
+
+      /* Step through this cell and the 26 cells around it              */
+      for(iz=MAX(cz-1, 0); iz<=MIN(cz+1, grid->nz-1); iz++)
+      {
+         for(iy=MAX(cy-1, 0); iy<=MIN(cy+1, grid->ny-1); iy++)
          {
-            if (DISTSQ(p, q)<radiusSq)
+            for(ix=MAX(cx-1, 0); ix<=MIN(cx+1, grid->nx-1); ix++)
             {
-               aaInRange=TRUE;
-               /*q=nextCurrentRes;
-                 break;*/
+               cell = ix + grid->nx * (iy + grid->ny * iz);
+               for(j=grid->cellStart[cell]; j<grid->cellStart[cell+1]; j++)
+               {
+                  k   = grid->cellItems[j];
+                  res = index->atomRes[k];
+
+                  /* Skip if this residue has already been found        */
+                  if(index->found[res] == index->search)
+                     continue;
+                  
+                  if(DISTSQ(p, index->atoms[k]) < radiusSq)
+                  {
+                     index->found[res]           = index->search;
+                     index->inRange[nInRange++] = res;
+                  }
+               }
             }
          }
       }
-      
-      if (aaInRange)
-      {
-         for (q=current; q!=nextCurrentRes; NEXT(q))
-         {
-            q->extras=(APTR)1;
-         }    
-      }
    }
-} 
+
+   qsort(index->inRange, nInRange, sizeof(int), CompareInts);
+   
+   return(nInRange);
+}
+
+
+/************************************************************************/
+/*>int CompareInts(const void *a, const void *b)
+   ---------------------------------------------
+*//**
+
+   \param[in]      *a          Pointer to int
+   \param[in]      *b          Pointer to int
+   \return                     <0, 0, >0 for qsort()
+
+   Comparison function for sorting ints into ascending order
+
+-  15.10.26 Original   By: ACRM
+*/
+int CompareInts(const void *a, const void *b)
+{
+   return(*(const int *)a - *(const int *)b);
+}
+
+
+/************************************************************************/
+/*>SPHEREINDEX *BuildSphereIndex(PDB *pdb, REAL radius)
+   ----------------------------------------------------
+*//**
+
+   \param[in]      *pdb        PDB linked list
+   \param[in]      radius      Distance cutoff
+   \return                     Malloc'd index (NULL if no memory)
+
+   Indexes the atoms and residues in the PDB linked list and places the
+   atoms on a grid with cells of edge radius
+
+-  15.10.26 Original   By: ACRM
+*/
+SPHEREINDEX *BuildSphereIndex(PDB *pdb, REAL radius)
+{
+   SPHEREINDEX *index;
+   VEC3F       *coords;
+   PDB         *start,
+               *stop,
+               *p;
+   int         i, res;
+
+   if((index = (SPHEREINDEX *)malloc(sizeof(SPHEREINDEX)))==NULL)
+      return(NULL);
+   index->grid     = NULL;
+   index->atomRes  = NULL;
+   index->resFirst = NULL;
+   index->found    = NULL;
+   index->inRange  = NULL;
+   index->search   = 0;
+   index->nres     = 0;
+   for(start=pdb; start!=NULL; start=blFindNextResidue(start))
+      index->nres++;
+
+   if((index->atoms = blIndexPDB(pdb, &(index->natoms)))==NULL)
+   {
+      free(index);
+      return(NULL);
+   }
+
+   if(((index->atomRes  = (int *)malloc(index->natoms * sizeof(int)))
+       ==NULL) ||
+      ((index->resFirst = (int *)malloc((index->nres+1) * sizeof(int)))
+       ==NULL) ||
+      ((index->found    = (int *)calloc(index->nres, sizeof(int)))
+       ==NULL) ||
+      ((index->inRange  = (int *)malloc(index->nres * sizeof(int)))
+       ==NULL))
+   {
+      FreeSphereIndex(index);
+      return(NULL);
+   }
+
+   /* Number the residues                                               */
+   for(start=pdb, res=0, i=0; start!=NULL; start=stop, res++)
+   {
+      stop = blFindNextResidue(start);
+      index->resFirst[res] = i;
+      for(p=start; p!=stop; NEXT(p))
+         index->atomRes[i++] = res;
+   }
+   index->resFirst[index->nres] = index->natoms;
+
+   /* Build the grid of atoms                                           */
+   if((coords = (VEC3F *)malloc(index->natoms * sizeof(VEC3F)))==NULL)
+   {
+      FreeSphereIndex(index);
+      return(NULL);
+   }
+   for(i=0; i<index->natoms; i++)
+   {
+      coords[i].x = index->atoms[i]->x;
+      coords[i].y = index->atoms[i]->y;
+      coords[i].z = index->atoms[i]->z;
+   }
+   index->grid = BuildCellGrid(coords, index->natoms, radius);
+   free(coords);
+   if(index->grid == NULL)
+   {
+      FreeSphereIndex(index);
+      return(NULL);
+   }
+
+   return(index);
+}
+
+
+/************************************************************************/
+/*>void FreeSphereIndex(SPHEREINDEX *index)
+   ----------------------------------------
+*//**
+
+   \param[in]      *index      Index created by BuildSphereIndex()
+
+   Frees an index created by BuildSphereIndex()
+
+-  15.10.26 Original   By: ACRM
+*/
+void FreeSphereIndex(SPHEREINDEX *index)
+{
+   if(index != NULL)
+   {
+      FreeCellGrid(index->grid);
+      if(index->atoms    != NULL) free(index->atoms);
+      if(index->atomRes  != NULL) free(index->atomRes);
+      if(index->resFirst != NULL) free(index->resFirst);
+      if(index->found    != NULL) free(index->found);
+      if(index->inRange  != NULL) free(index->inRange);
+      free(index);
+   }
+}
 
 
 /************************************************************************/
@@ -299,6 +564,7 @@ void WriteAtoms(PDB *pdb, FILE *out)
             old format and uses extras rather than occ
 -  14.05.12 Added compact
 -  12.03.15 Changed to allow multi-character chain names
+-  15.10.26 Residue IDs are written by WriteResidueID()
 */
 void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact)
 {
@@ -309,39 +575,7 @@ void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact)
       if (p->extras)
       {
          p->extras=(APTR)0;
-         if(compact)
-         {
-            if(isdigit(p->chain[0]))
-            {
-               fprintf(out, " %s.%d%c", p->chain, p->resnum, 
-                       p->insert[0]);
-            }
-            else
-            {
-               fprintf(out, " %s%d%c", p->chain, p->resnum, 
-                       p->insert[0]);
-            }
-         }
-         else
-         {
-            if(colons)
-            {
-               fprintf(out, "%s:%d:%s\n", p->chain, p->resnum, p->insert);
-            }
-            else
-            {
-               if(isdigit(p->chain[0]))
-               {
-                  fprintf(out, "%s.%d%c\n", p->chain, p->resnum, 
-                          p->insert[0]);
-               }
-               else
-               {
-                  fprintf(out, "%s%d%c\n", p->chain, p->resnum, 
-                          p->insert[0]);
-               }
-            }
-         }
+         WriteResidueID(out, p, colons, compact);
       }
    }
 
@@ -353,6 +587,58 @@ void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact)
 }  
 
 
+/************************************************************************/
+/*>void WriteResidueID(FILE *out, PDB *p, BOOL colons, BOOL compact)
+   -----------------------------------------------------------------
+*//**
+
+   \param[in]      *out     output file
+   \param[in]      *p       first atom of the residue
+   \param[in]      colons   Include colons in output format
+   \param[in]      compact  Space separated on one line (for -a)
+
+   Writes a residue ID in the format for WriteResidues()
+
+-  15.10.26 Original (split from WriteResidues())   By: ACRM
+*/
+void WriteResidueID(FILE *out, PDB *p, BOOL colons, BOOL compact)
+{
+   if(compact)
+   {
+      if(isdigit(p->chain[0]))
+      {
+         fprintf(out, " %s.%d%c", p->chain, p->resnum, 
+                 p->insert[0]);
+      }
+      else
+      {
+         fprintf(out, " %s%d%c", p->chain, p->resnum, 
+                 p->insert[0]);
+      }
+   }
+   else
+   {
+      if(colons)
+      {
+         fprintf(out, "%s:%d:%s\n", p->chain, p->resnum, p->insert);
+      }
+      else
+      {
+         if(isdigit(p->chain[0]))
+         {
+            fprintf(out, "%s.%d%c\n", p->chain, p->resnum, 
+                    p->insert[0]);
+         }
+         else
+         {
+            fprintf(out, "%s%d%c\n", p->chain, p->resnum, 
+                    p->insert[0]);
+         }
+      }
+   }
+}
+
+
 /***********************************************************************/
 /*>void Usage(void)
    ----------------
@@ -366,11 +652,14 @@ void WriteResidues(PDB *pdb, FILE *out, BOOL colons, BOOL compact)
 -  27.07.12 V1.8 By: ACRM
 -  22.07.14 V1.9 By: CTP
 -  12.03.15 V1.10 By: ACRM
+-  15.10.26 V1.11
+-  15.10.26 V1.12
+-  15.10.26 V1.13
 */
 void Usage(void)
 {
    fprintf(stderr,"\n");
-   fprintf(stderr,"PDBsphere V1.10 (c) 2011-2015 UCL, Anja Baresic, \
+   fprintf(stderr,"PDBsphere V1.13 (c) 2011-2026 UCL, Anja Baresic, \
 Andrew Martin.\n");
    fprintf(stderr,"\nUsage: \
 pdbsphere [-s] [-c] [-r radius] [-h] [-H] resspec\n                 \
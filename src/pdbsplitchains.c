@@ -3,11 +3,11 @@
 
    \file       pdbsplitchains.c
    
-   \version    V2.0
-   \date       26.03.15
+   \version    V2.1
+   \date       15.10.26
    \brief      Split a PDB file into separate chains
    
-   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2015
+   \copyright  (c) UCL / Dr. Andrew C. R. Martin 1997-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -53,6 +53,7 @@
 -  V1.3    06.11.14  Renamed from splitchains By: ACRM
 -  V1.4    12.03.15  Checks blank chain as string
 -  V2.0    26.03.15  Major rewrite to handled whole PDB
+-  V2.1    15.10.26  Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -62,6 +63,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/general.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -110,6 +112,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(InFile, NULL, &in, NULL))
       {
+         if(IsPDBCache(in, "pdbsplitchains"))
+            return(1);
          if((wpdb=blReadWholePDB(in))==NULL)
          {
             if(!gQuiet)
@@ -209,10 +213,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, BOOL *current)
 -  22.07.14 V1.2 By: CTP
 -  12.03.15 V1.4
 -  26.03.15 V2.0
+-  15.10.26 V2.1
 */
 void Usage(void)
 {
-   fprintf(stderr,"pdbsplitchains V2.0 (c) 1997-2015 \
+   fprintf(stderr,"pdbsplitchains V2.1 (c) 1997-2026 \
 Dr. Andrew C.R. Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: pdbsplitchains [-c][-q] [in.pdb]\n");
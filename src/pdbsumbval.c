@@ -3,12 +3,12 @@
 
    \file       pdbsumbval.c
    
-   \version    V1.6
-   \date       05.03.15
+   \version    V1.7
+   \date       15.10.26
    \brief      Sum B-vals over each residue and replace with the
                summed or average value
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1994-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1994-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -55,6 +55,7 @@
 -  V1.4  06.11.14 Renamed from sumbval  By: ACRM
 -  V1.5  13.02.15 Added whole PDB support
 -  V1.6  05.03.15 Replaced blFindEndPDB() with blFindNextResidue()
+-  V1.7  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -68,6 +69,7 @@
 #include "bioplib/macros.h"
 #include "bioplib/MathUtil.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -116,6 +118,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbsumbval"))
+            return(1);
          if((wpdb = blReadWholePDB(in)) != NULL)
          {
             pdb=wpdb->pdb;
@@ -221,10 +225,11 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  06.11.14 V1.4 By: ACRM
 -  13.02.15 V1.5
 -  05.03.15 V1.6
+-  15.10.26 V1.7
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbsumbval V1.6 (c) 1994-2015, Andrew C.R. \
+   fprintf(stderr,"\npdbsumbval V1.7 (c) 1994-2026, Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"Usage: pdbsumbval [-a] [-s] [-q] [in.pdb \
 [[out.pdb]\n");
@@ -3,11 +3,11 @@
 
    \file       pdbtorsions.c
    
-   \version    V2.1
-   \date       04.03.15
+   \version    V2.3
+   \date       15.10.26
    \brief      Calculate torsion angles for a PDB file
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1996-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -66,12 +66,16 @@
                   residue. Still makes the old format available
 -  V2.1  04.03.15 Improved checking for old name
                   Now done by blCheckProgName()
+-  V2.2  15.10.26 Added -l and -d to process a list of files. Fixed
+                  the output file being ignored   By: ACRM
+-  V2.3  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include <ctype.h>
 
@@ -82,6 +86,9 @@
 #include "bioplib/seq.h"
 #include "bioplib/angle.h"
 #include "bioplib/macros.h"
+#include "common/pdbcache.h"
+
+#include "common/batch.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -105,6 +112,14 @@ do {                    \
    (c)[2] = NULL;       \
 }  while(0)
 
+typedef struct
+{
+   BOOL CATorsions,
+        terse,
+        Radians,
+        oldStyle;
+}  TOROPTS;
+
 /************************************************************************/
 /* Globals
 */
@@ -115,8 +130,8 @@ do {                    \
 int main(int argc, char **argv);
 void Usage(void);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  BOOL *CATorsions, BOOL *terse, BOOL *Radians, 
-                  BOOL *oldStyle);
+                  char *listfile, char *outdir, TOROPTS *opts);
+BOOL TorsionsFile(FILE *in, FILE *out, char *infile, void *data);
 BOOL CalculateAndDisplayTorsions(FILE *out, PDB *fullpdb, 
                                  BOOL CATorsions, BOOL terse, 
                                  BOOL Radians, BOOL oldStyle);
@@ -146,40 +161,51 @@ void BuildLabel(char *label, PDB *p, int width, BOOL LeftJustify);
 -  22.07.14 Renamed deprecated functions with bl prefix. By: CTP
 -  19.08.14 Added AsCopy suffix to call to blSelectAtomsPDB() By: CTP
 -  07.11.14 Initialized TorNum
+-  15.10.26 Added batch mode. Processing moved to TorsionsFile()
+            By: ACRM
 */
 int main(int argc, char **argv)
 {
    FILE    *in  = stdin,
            *out = stdout;
    char    inFile[MAXBUFF],
-           outFile[MAXBUFF];
-   int     natoms;
-   PDB     *pdb;
-   BOOL    CATorsions = FALSE;
-   BOOL    terse      = FALSE;
-   BOOL    Radians    = FALSE;
-   BOOL    oldStyle   = FALSE;
+           outFile[MAXBUFF],
+           listFile[MAXBUFF],
+           outDir[MAXBUFF];
+   int     nfail;
+   TOROPTS opts;
+
+   opts.CATorsions = FALSE;
+   opts.terse      = FALSE;
+   opts.Radians    = FALSE;
 
    /* Set the default output style based on whether the program is called
       pdbtorsions or torsions
    */
-   oldStyle = blCheckProgName(argv[0], "torsions");
+   opts.oldStyle = blCheckProgName(argv[0], "torsions");
 
-   if(ParseCmdLine(argc, argv, inFile, outFile, 
-                   &CATorsions, &terse, &Radians, &oldStyle))
+   if(ParseCmdLine(argc, argv, inFile, outFile, listFile, outDir, &opts))
    {
       if(blOpenStdFiles(inFile, outFile, &in, &out))
       {
-         if((pdb=blReadPDB(in, &natoms))!=NULL)
+         if(listFile[0])
          {
-            if(!CalculateAndDisplayTorsions(out, pdb, CATorsions, terse, 
-                                            Radians, oldStyle))
+            if((nfail = RunBatch(listFile, outDir, out, TorsionsFile, 
+                                 &opts)) < 0)
+            {
+               fprintf(stderr,"pdbtorsions: Error - unable to read list \
+file, %s\n", listFile);
                return(1);
+            }
+            if(nfail)
+            {
+               fprintf(stderr,"pdbtorsions: %d files could not be \
+processed\n", nfail);
+               return(1);
+            }
          }
-         else
+         else if(!TorsionsFile(in, out, inFile, &opts))
          {
-            fprintf(stderr,"pdbtorsions: Error - no atoms read from PDB \
-file\n");
             return(1);
          }
       }
@@ -200,6 +226,46 @@ output file\n");
 }
 
 
+/************************************************************************/
+/*>BOOL TorsionsFile(FILE *in, FILE *out, char *infile, void *data)
+   ----------------------------------------------------------------
+*//**
+
+   \param[in]    *in       Input PDB file
+   \param[in]    *out      Output file
+   \param[in]    *infile   Input filename (or blank string)
+   \param[in]    *data     Options (TOROPTS)
+   \return                 Success?
+
+   Reads a PDB file and displays its torsions. Called directly or for
+   each file by RunBatch()
+
+-  15.10.26 Original (split from main())   By: ACRM
+*/
+BOOL TorsionsFile(FILE *in, FILE *out, char *infile, void *data)
+{
+   TOROPTS *opts = (TOROPTS *)data;
+   PDB     *pdb;
+   int     natoms;
+   BOOL    ok;
+
+   if(IsPDBCache(in, "pdbtorsions"))
+      return(FALSE);
+   if((pdb=blReadPDB(in, &natoms))==NULL)
+   {
+      fprintf(stderr,"pdbtorsions: Error - no atoms read from PDB \
+file %s\n", infile);
+      return(FALSE);
+   }
+
+   ok = CalculateAndDisplayTorsions(out, pdb, opts->CATorsions, 
+                                    opts->terse, opts->Radians, 
+                                    opts->oldStyle);
+   FREELIST(pdb, PDB);
+   return(ok);
+}
+
+
 /************************************************************************/
 /*>BOOL CalculateAndDisplayTorsions(FILE *out, PDB *fullpdb, 
                                     BOOL CATorsions, BOOL terse, 
@@ -217,6 +283,7 @@ output file\n");
    Calculate and display the torsion angles as required
 
 - 27.11.14 Original   By: ACRM
+- 15.10.26 Frees the selected atoms
 */
 BOOL CalculateAndDisplayTorsions(FILE *out, PDB *fullpdb, BOOL CATorsions,
                                  BOOL terse, BOOL Radians, BOOL oldStyle)
@@ -250,6 +317,7 @@ atoms from PDB file (no memory?)\n");
       doFullTorsions(out, pdb, terse, Radians, oldStyle);
    }
 
+   FREELIST(pdb, PDB);
    return(TRUE);
 }
 
@@ -610,8 +678,7 @@ REAL CalcTorsion(PDB *p1, PDB *p2, PDB *p3, PDB *p4, BOOL Radians)
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                     BOOL *CATorsions, BOOL *terse, BOOL *Radians, 
-                     BOOL *oldStyle)
+                     char *listfile, char *outdir, TOROPTS *opts)
    ---------------------------------------------------------------------
 *//**
 
@@ -619,25 +686,26 @@ REAL CalcTorsion(PDB *p1, PDB *p2, PDB *p3, PDB *p4, BOOL Radians)
    \param[in]     **argv       Argument array
    \param[out]    *infile      Input file (or blank string)
    \param[out]    *outfile     Output file (or blank string)
-   \param[out]    *CATorsions  Do CA pseudo-torsions
-   \param[out]    *terse       Terse (1-letter AA code) output
-   \param[out]    *Radians     Output radians rather than degrees
-   \param[out]    *oldStyle    Old style output
+   \param[out]    *listfile    File listing input files (or blank string)
+   \param[out]    *outdir      Output directory (or blank string)
+   \param[in,out] *opts        Torsion and output options
    \return                     Success?
 
    Parse the command line
    
 -  05.02.96 Original    By: ACRM
 -  27.02.14 V2.0
+-  15.10.26 Added -l and -d. With -l, a filename is the output file.
+            The second filename is now copied to outfile
+            Options passed in a TOROPTS structure
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  BOOL *CATorsions, BOOL *terse, BOOL *Radians, 
-                  BOOL *oldStyle)
+                  char *listfile, char *outdir, TOROPTS *opts)
 {
    argc--;
    argv++;
 
-   infile[0] = outfile[0] = '\0';
+   infile[0] = outfile[0] = listfile[0] = outdir[0] = '\0';
    
    while(argc)
    {
@@ -646,19 +714,33 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          switch(argv[0][1])
          {
          case 'c':
-            *CATorsions = TRUE;
+            opts->CATorsions = TRUE;
             break;
          case 't':
-            *terse = TRUE;
+            opts->terse = TRUE;
             break;
          case 'r':
-            *Radians = TRUE;
+            opts->Radians = TRUE;
             break;
          case 'o':
-            *oldStyle = TRUE;
+            opts->oldStyle = TRUE;
             break;
          case 'n':
-            *oldStyle = FALSE;
+            opts->oldStyle = FALSE;
+            break;
+         case 'l':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(listfile, argv[0], MAXBUFF);
+            listfile[MAXBUFF-1] = '\0';
+            break;
+         case 'd':
+            if(!(--argc))
+               return(FALSE);
+            argv++;
+            strncpy(outdir, argv[0], MAXBUFF);
+            outdir[MAXBUFF-1] = '\0';
             break;
          default:
             return(FALSE);
@@ -667,6 +749,15 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
       }
       else
       {
+         /* With a list of files, only the output file may be given     */
+         if(listfile[0])
+         {
+            if(argc > 1)
+               return(FALSE);
+            strcpy(outfile, argv[0]);
+            return(TRUE);
+         }
+
          /* Check that there are <= 2 arguments left                    */
          if(argc > 2)
             return(FALSE);
@@ -676,12 +767,13 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          {
             strcpy(infile, argv[0]);
             argc--;
+            argv++;
          }
          
          /* Copy the second to outfile                                  */
          if(argc)
          {
-            strcpy(infile, argv[0]);
+            strcpy(outfile, argv[0]);
             argc--;
          }
          
@@ -710,23 +802,36 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 -  07.11.14 V1.6
 -  27.11.14 V2.0
 -  04.03.15 V2.1
+-  15.10.26 V2.2 Added -l and -d   By: ACRM
+-  15.10.26 V2.3
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbtorsions V2.1 (c) 1994-2015 Andrew Martin, \
+   fprintf(stderr,"\npdbtorsions V2.3 (c) 1994-2026 Andrew Martin, \
 UCL.\n");
    fprintf(stderr,"\nUsage: pdbtorsions [-h][-r][-c][-t][-o][-n] \
 [in.pdb [out.tor]]\n");
+   fprintf(stderr,"       pdbtorsions [-h][-r][-c][-t][-o][-n] \
+-l listfile [-d outdir] [out.tor]\n");
    fprintf(stderr,"       -h   This help message\n");
    fprintf(stderr,"       -r   Give results in radians\n");
    fprintf(stderr,"       -c   Generate CA-CA pseudo-torsions\n");
    fprintf(stderr,"       -t   Terse format - use 1-letter code\n");
    fprintf(stderr,"       -o   Old format (see below)\n");
    fprintf(stderr,"       -n   New format (see below)\n");
+   fprintf(stderr,"       -l   Process each of the PDB files listed \
+in listfile ('-' for stdin)\n");
+   fprintf(stderr,"       -d   Write the torsions for each file to a \
+file of the same name in\n");
+   fprintf(stderr,"            outdir rather than all to out.tor\n");
 
    fprintf(stderr,"\nGenerates a set of backbone torsions from a PDB \
 file.\n\n");
    fprintf(stderr,"I/O is through stdin/stdout if unspecified.\n");
+   fprintf(stderr,"With -l, the output for each file is preceded by \
+a '%s<filename>' line\n", BATCH_BEGIN);
+   fprintf(stderr,"and followed by '%s<filename> OK' (or FAILED) \
+unless -d is used.\n", BATCH_END);
 
    fprintf(stderr,"\nV1.x of this program associated the omega torsion angle with the residue\n");
    fprintf(stderr,"before the torsion instead of the standard way of associating it with\n");
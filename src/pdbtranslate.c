@@ -3,11 +3,11 @@
 
    \file       pdbtranslate.c
    
-   \version    V1.3
-   \date       12.02.15
+   \version    V1.4
+   \date       15.10.26
    \brief      Simple program to translate PDB files
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1995-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1995-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -51,6 +51,7 @@
                   Added doxygen annotation. By: CTP
 -  V1.2  06.11.14 Renamed from transpdb  By: ACRM
 -  V1.3  12.02.15 Uses whole PDB
+-  V1.4  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -65,6 +66,7 @@
 #include "bioplib/pdb.h"
 #include "bioplib/macros.h"
 #include "bioplib/general.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -111,6 +113,8 @@ int main(int argc, char **argv)
    {
       if(blOpenStdFiles(infile, outfile, &in, &out))
       {
+         if(IsPDBCache(in, "pdbtranslate"))
+            return(1);
          if((wpdb=blReadWholePDB(in))!=NULL)
          {
             pdb = wpdb->pdb;
@@ -142,10 +146,11 @@ int main(int argc, char **argv)
 -  22.07.14 V1.1 By: CTP
 -  06.11.14 V1.2 By: ACRM
 -  12.02.15 V1.3 By: ACRM
+-  15.10.26 V1.4
 */
 void Usage(void)
 {
-   fprintf(stderr,"\npdbtranslate V1.3  (c) 1995-2015 Andrew C.R. \
+   fprintf(stderr,"\npdbtranslate V1.4  (c) 1995-2026 Andrew C.R. \
 Martin\n");
    fprintf(stderr,"Freely distributable if no profit is made\n\n");
    fprintf(stderr,"Usage: pdbtranslate [-x x] [-y y] [-z z] [-h]\n");
@@ -3,13 +3,13 @@
    Program:    scorecons
    File:       scorecons.c
    
-   Version:    V1.5
-   Date:       24.08.15
+   Version:    V1.13
+   Date:       15.10.26
    Function:   Scores conservation from a PIR sequence alignment
                Not to be confused with the program of the same name
                by Will Valdar (this one predates his!)
    
-   Copyright:  (c) Dr. Andrew C. R. Martin 1996-2015
+   Copyright:  (c) Dr. Andrew C. R. Martin 1996-2026
    Author:     Dr. Andrew C. R. Martin
                Tom Northey (implemented Valdar01 scoring)
    Address:    Biomolecular Structure & Modelling Unit,
@@ -121,13 +121,37 @@
    V1.3  15.07.08 Added -x flag
    V1.4  11.08.15 Modified for new bioplib
    V1.5  24.08.15 Implemented the Valdar01 scoring By: TCN
+   V1.6  15.10.26 MDM score is calculated from counts of the residue 
+                  types in each column rather than over all pairs of
+                  sequences
+   V1.7  15.10.26 Valdar01 scoring uses an integer-encoded alignment and
+                  a table of matrix scores. Sequence weights are 
+                  calculated from one half of the distance matrix and 
+                  column scores from weighted residue type counts
+   V1.8  15.10.26 Valdar01 sequence distances are calculated in a single
+                  pass over padded rows of codes and may be split across
+                  threads. Added -j
+   V1.9  15.10.26 The alignment is stored as residue codes in a single
+                  column-major array which is used by all the methods.
+                  The sequences read are now freed and all are padded
+                  to the length of the longest
+   V1.10 15.10.26 Entropy scores are calculated from a single count of
+                  the residue types in each column
+   V1.11 15.10.26 Added -b to score the alignment in blocks of columns
+                  read from a temporary file of residue codes
+   V1.12 15.10.26 Columns are scored by -j threads. Removed the static
+                  valdar01 data
+   V1.13 15.10.26 MDM scores for each pair of residue codes are looked
+                  up once before the columns are scored
 
 *************************************************************************/
 /* Includes
 */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
+#include <pthread.h>
 
 #include "bioplib/SysDefs.h"
 #include "bioplib/MathType.h"
@@ -140,10 +164,23 @@
 /************************************************************************/
 /* Defines and macros
 */
+#define MAXRESTYPE 256      /* Number of possible residue characters    */
+#define MAXGROUPS  21       /* Max number of groups for entropy scores  */
+#define ROWPAD     16       /* Encoded rows are padded to a multiple of
+                               this length                              */
+#define STRIPSEQS  128      /* Sequences in each strip of the distance
+                               matrix calculated at once                */
+#define TILESEQS   32       /* Sequences in each tile of a strip given 
+                               to a thread                              */
+#define MAXTHREADS 1024     /* Max number of threads given with -j      */
+#define SEQALLOC   1024     /* Sequences allocated at once with -b      */
+#define COLCHUNK   16       /* Columns taken at once by a thread        */
+
 typedef struct _seqdata
 {
    struct _seqdata *next;
    char *seqs[8];
+   int  nchain;
 }  SEQDATA;
 
 typedef struct 
@@ -153,6 +190,104 @@ typedef struct
         group[2];
 }  AMINOACID;
 
+/* Alignment stored as residue codes, one column after another. Column
+   pos is codes[pos*nseq]...codes[pos*nseq + nseq-1]                    */
+typedef struct
+{
+   unsigned char *codes;    /* Residue codes                            */
+   int  nseq,               /* Number of sequences                      */
+        seqlen,             /* Length of the (padded) sequences         */
+        offset,             /* Position of the first column in the full
+                               alignment                                */
+        code[MAXRESTYPE],   /* Residue code for each character or -1    */
+        ncodes;             /* Number of residue codes (0 is '-')       */
+   char res[MAXRESTYPE];    /* Character for each residue code          */
+}  ALIGNMENT;
+
+/* Alignment read in blocks of columns from a temporary file of residue
+   codes in which the sequences are stored one after another            */
+typedef struct
+{
+   FILE          *fp;       /* Temporary file                           */
+   long          *start;    /* Offset of each sequence in the file      */
+   int           *len,      /* Length of each sequence                  */
+                 seqlen,    /* Length of the longest sequence           */
+                 blockLen,  /* Number of columns in each block          */
+                 nblocks;   /* Number of blocks                         */
+   unsigned char *rows;     /* Block as rows of blockLen codes          */
+   ALIGNMENT     aln;       /* Current block. The residue codes are 
+                               those for the whole alignment            */
+}  ALNSTREAM;
+
+typedef struct
+{
+   REAL *seqWeights,        /* Weight for each sequence                 */
+        **score,            /* valdarMatrixScore() for each pair of 
+                               residue codes                            */
+        lambda;             /* Scale factor for the weighted sum        */
+   int  ncodes;             /* Number of residue codes                  */
+}  VALDARDATA;
+
+/* Everything needed to calculate the score for a column                */
+typedef struct
+{
+   VALDARDATA *valdar;                  /* valdar01 data (or NULL)      */
+   AMINOACID  *AA21Lookup[MAXRESTYPE],  /* Groups for each residue for  */
+              *AA9Lookup[MAXRESTYPE];   /* the entropy methods          */
+   LONG       **mdmScore;               /* blCalcMDMScore() for each 
+                                           pair of residue codes for 
+                                           the MDM method (or NULL)     */
+   int        MaxInMatrix,
+              Method,
+              ncodes;                   /* Size of mdmScore             */
+}  SCORING;
+
+/* Encoded alignment used to calculate the distances between sequences.
+   Each sequence is a row of stride codes padded with gaps              */
+typedef struct
+{
+   unsigned char *codes,    /* Residue codes                            */
+                 *nonGap;   /* 1 where the code is not a gap, else 0    */
+   int           *pairScore,/* Whole part of the score for each pair of
+                               codes (ncodes x ncodes)                  */
+                 stride,
+                 ncodes;
+}  DISTDATA;
+
+/* Tile of the distance matrix calculated by one job. The sums for 
+   rows firstRow...lastRow-1 are added to scoreSum and nonGapCount, 
+   which have a row of numSeqs for each                                 */
+typedef struct
+{
+   DISTDATA *dist;
+   int      *scoreSum,
+            *nonGapCount,
+            numSeqs,
+            firstRow,
+            lastRow,
+            firstCol,
+            lastCol;
+}  DISTJOB;
+
+/* Queue of jobs shared by the threads                                  */
+typedef struct
+{
+   DISTJOB         *jobs;
+   int             njobs,
+                   next;
+   pthread_mutex_t lock;
+}  JOBQUEUE;
+
+/* Queue of columns to be scored by the threads                         */
+typedef struct
+{
+   ALIGNMENT       *aln;
+   SCORING         *scoring;
+   REAL            *scores;
+   int             next;
+   pthread_mutex_t lock;
+}  COLQUEUE;
+
 #define DATADIR "DATADIR"
 #define MUTMAT  "pet91.mat"
 #define MAXBUFF 160
@@ -163,47 +298,60 @@ typedef struct
 #define METH_ENTROPY8  3
 #define METH_VALDAR    4
 
-#define LAMBDA_UNITIALIZED 0
-#define SEQWEIGHTS_UNITIALIZED NULL
-
-/************************************************************************/
-/* Globals
-*/
-
-static REAL sLambda = LAMBDA_UNITIALIZED;
-static REAL *sSeqWeights=NULL;
 
 /************************************************************************/
 /* Prototypes
 */
 int main(int argc, char **argv);
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  char *matrix, int *Method, BOOL *extended);
+                  char *matrix, int *Method, BOOL *extended, 
+                  int *nthreads, int *blockLen);
 void Usage(void);
 BOOL ReadAndScoreSeqs(FILE *fp, FILE *out, int MaxInMatrix, int Method,
-                      BOOL Extended);
+                      BOOL Extended, int nthreads);
+BOOL StreamAndScoreSeqs(FILE *fp, FILE *out, int MaxInMatrix, 
+                        int Method, BOOL Extended, int nthreads, 
+                        int blockLen);
 SEQDATA *ReadAllSeqs(FILE *fp);
-char **ListToTable(SEQDATA *SeqList, int *nseq, int *seqlen);
-void PadSeqs(char **SeqTable, int nseq, int seqlen);
-void DisplayScores(FILE *fp, char **SeqTable, int nseq, int seqlen, 
-                   int MaxInMatrix, int Method, BOOL Extended);
-REAL CalcScore(char **SeqTable, int nseq, int seqlen, int pos, int MaxInMatrix,
-               int Method);
-REAL MDMBasedScore(char **SeqTable, int nseq, int pos, int MaxInMatrix);
-REAL EntropyScore(char **SeqTable, int nseq, int pos, 
-                  AMINOACID *aminoacids, int NGroups);
-
-REAL valdarScore (char **SeqTable, int pos, int numSeqs, int seqlen, 
-                  int MaxInMatrix);
-void initLambda(int numSeqs);
-BOOL initSequenceWeights(char **SeqTable, int numSeqs, int seqlen, 
-                         int MaxInMatrix);
-REAL **getSeqDistTable(char **SeqTable, int numSeqs, int seqlen, 
-                       int MaxInMatrix);
-REAL getInterSeqDistance(char **SeqTable, int seqAindex, int seqBindex, 
-                         int seqlen, int MaxInMatrix);
-int getNonGapPosCount(char **SeqTable, int seqAindex, int seqBindex, 
-                      int seqlen);
+void FreeSeqList(SEQDATA *SeqList);
+void InitResidueCodes(ALIGNMENT *aln);
+unsigned char ResidueCode(ALIGNMENT *aln, char res);
+ALIGNMENT *ListToAlignment(SEQDATA *SeqList);
+void FreeAlignment(ALIGNMENT *aln);
+ALNSTREAM *ReadSeqStream(FILE *fp, int blockLen);
+void FreeSeqStream(ALNSTREAM *stream);
+BOOL ReadBlockRows(ALNSTREAM *stream, int block, unsigned char *rows,
+                   int stride);
+BOOL ReadBlock(ALNSTREAM *stream, int block);
+void InitScoring(SCORING *scoring, int MaxInMatrix, int Method);
+BOOL InitMDMScores(SCORING *scoring, ALIGNMENT *aln);
+void FreeMDMScores(SCORING *scoring);
+BOOL DisplayScores(FILE *fp, ALIGNMENT *aln, SCORING *scoring, 
+                   BOOL Extended, int nthreads);
+void ScoreColumns(ALIGNMENT *aln, SCORING *scoring, REAL *scores, 
+                  int nthreads);
+void *RunColumnJobs(void *arg);
+REAL CalcScore(ALIGNMENT *aln, int pos, SCORING *scoring);
+void CountResidues(ALIGNMENT *aln, int pos, int *count);
+REAL MDMBasedScore(ALIGNMENT *aln, int pos, SCORING *scoring);
+void BuildGroupLookup(AMINOACID *aminoacids, AMINOACID **lookup);
+REAL EntropyScore(ALIGNMENT *aln, int *count, AMINOACID **lookup, 
+                  int NGroups);
+
+REAL valdarScore(ALIGNMENT *aln, int pos, VALDARDATA *valdar);
+VALDARDATA *initValdar(ALIGNMENT *aln, ALNSTREAM *stream, 
+                       int MaxInMatrix, int nthreads);
+void freeValdar(VALDARDATA *valdar);
+void initLambda(VALDARDATA *valdar, int numSeqs);
+BOOL initSequenceWeights(VALDARDATA *valdar, ALIGNMENT *aln, 
+                         ALNSTREAM *stream, int nthreads);
+BOOL loadDistBlock(DISTDATA *dist, ALIGNMENT *aln, ALNSTREAM *stream,
+                   int block);
+void sumInterSeqScores(DISTDATA *dist, int seqA, int seqB, 
+                       int *scoreSum, int *nonGapCount);
+void RunThreads(void *(*worker)(void *), void *queue, int nthreads);
+void RunJobQueue(DISTJOB *jobs, int njobs, int nthreads);
+void *RunDistJobs(void *arg);
 REAL valdarMatrixScore(char res1, char res2, int MaxInMatrix);
 
 /************************************************************************/
@@ -216,6 +364,8 @@ REAL valdarMatrixScore(char res1, char res2, int MaxInMatrix);
    17.09.96 Rewritten. Zeros the MDM
    18.09.96 Added check on environment variable if ReadMDM() failed.
    15.07.08 Added -x/Extended handling
+   15.10.26 Added -j/nthreads
+   15.10.26 Added -b/blockLen
 */
 int main(int argc, char **argv)
 {
@@ -225,11 +375,13 @@ int main(int argc, char **argv)
         OutFile[MAXBUFF],
         matrix[MAXBUFF];
    int  MaxInMatrix,
-        Method = METH_MDM;
+        Method = METH_MDM,
+        nthreads = 1,
+        blockLen = 0;
    BOOL Extended = FALSE;
    
    if(ParseCmdLine(argc, argv, InFile, OutFile, matrix, &Method,
-                   &Extended))
+                   &Extended, &nthreads, &blockLen))
    {
       if(blOpenStdFiles(InFile, OutFile, &in, &out))
       {
@@ -244,8 +396,13 @@ int main(int argc, char **argv)
             return(1);
          }
          MaxInMatrix = blZeroMDM();
+         if(blockLen)
+         {
+            return(StreamAndScoreSeqs(in, out, MaxInMatrix, Method,
+                                      Extended, nthreads, blockLen)?0:1);
+         }
          return(ReadAndScoreSeqs(in, out, MaxInMatrix, Method,
-                                 Extended)?0:1);
+                                 Extended, nthreads)?0:1);
       }
       else
       {
@@ -262,7 +419,8 @@ int main(int argc, char **argv)
 
 /************************************************************************/
 /*>BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                     char *matrix, int *Method, BOOL *Extended)
+                     char *matrix, int *Method, BOOL *Extended,
+                     int *nthreads, int *blockLen)
    ---------------------------------------------------------------------
    Input:   int    argc         Argument count
             char   **argv       Argument array
@@ -271,6 +429,9 @@ int main(int argc, char **argv)
             char   *matrix      Mutation matrix name
             int    *Method      Scoring method
             BOOL   *Extended    Extended precision printing
+            int    *nthreads    Number of threads
+            int    *blockLen    Columns in each block (0 to read the
+                                whole alignment)
    Returns: BOOL                Success?
 
    Parse the command line
@@ -278,9 +439,12 @@ int main(int argc, char **argv)
    17.09.96 Original    By: ACRM
    15.07.08 Added -x
    24.08.15 Added -d    By: TCN
+   15.10.26 Added -j    By: ACRM
+   15.10.26 Added -b
 */
 BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile, 
-                  char *matrix, int *Method, BOOL *Extended)
+                  char *matrix, int *Method, BOOL *Extended, 
+                  int *nthreads, int *blockLen)
 {
    argc--;
    argv++;
@@ -316,6 +480,21 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
          case 'x':
             *Extended = TRUE;
             break;
+         case 'j':
+            if(--argc <= 0)
+               return(FALSE);
+            argv++;
+            if(!sscanf(argv[0], "%d", nthreads) ||
+               (*nthreads < 1) || (*nthreads > MAXTHREADS))
+               return(FALSE);
+            break;
+         case 'b':
+            if(--argc <= 0)
+               return(FALSE);
+            argv++;
+            if(!sscanf(argv[0], "%d", blockLen) || (*blockLen < 1))
+               return(FALSE);
+            break;
          default:
             return(FALSE);
             break;
@@ -348,7 +527,7 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
 
 /************************************************************************/
 /*>BOOL ReadAndScoreSeqs(FILE *fp, FILE *out, int MaxInMatrix, int Method,
-                         BOOL Extended)
+                         BOOL Extended, int nthreads)
    -----------------------------------------------------------------------
    Routine which reads in files, calculates and displays the variability
    scores.
@@ -356,36 +535,123 @@ BOOL ParseCmdLine(int argc, char **argv, char *infile, char *outfile,
    11.09.96 Original   By: ACRM
    17.09.96 Added out parameter and MaxInMatrix
    15.07.08 Added Extended parameter
+   15.10.26 Added nthreads. Initializes the valdar01 data
+   15.10.26 Uses an ALIGNMENT rather than a table of strings
+   15.10.26 Uses a SCORING rather than static valdar01 data
+   15.10.26 Creates the MDM score table
 */
 BOOL ReadAndScoreSeqs(FILE *fp, FILE *out, int MaxInMatrix, int Method,
-                      BOOL Extended)
+                      BOOL Extended, int nthreads)
 {
-   SEQDATA *SeqList;
-   char    **SeqTable;
-   int     seqlen, nseq;
+   SEQDATA   *SeqList;
+   ALIGNMENT *aln;
+   SCORING   scoring;
+   BOOL      ok;
    
    /* Read sequences into a linked list                                 */
    if((SeqList=ReadAllSeqs(fp))==NULL)
       return(FALSE);
 
-   /* Reorganise into a 2D table                                        */
-   if((SeqTable = ListToTable(SeqList, &nseq, &seqlen))==NULL)
+   /* Encode as an alignment                                            */
+   if((aln = ListToAlignment(SeqList))==NULL)
    {
-      FREELIST(SeqList, SEQDATA);
+      FreeSeqList(SeqList);
       return(FALSE);
    }
 
    /* Free up linked list                                               */
-   FREELIST(SeqList, SEQDATA);
+   FreeSeqList(SeqList);
+
+   /* Calculate the sequence weights for the valdar01 method or the 
+      matrix scores for the MDM method
+   */
+   InitScoring(&scoring, MaxInMatrix, Method);
+   if(Method == METH_VALDAR)
+      scoring.valdar = initValdar(aln, NULL, MaxInMatrix, nthreads);
+   if((Method == METH_MDM) && !InitMDMScores(&scoring, aln))
+   {
+      fprintf(stderr,"No memory for matrix scores\n");
+      FreeAlignment(aln);
+      return(FALSE);
+   }
 
    /* Calculate and print scores                                        */
-   DisplayScores(out, SeqTable, nseq, seqlen, MaxInMatrix, Method,
-                 Extended);
+   ok = DisplayScores(out, aln, &scoring, Extended, nthreads);
 
-   /* Free memory from sequence table                                   */
-   blFreeArray2D((char **)SeqTable, nseq, seqlen);
+   /* Free memory from the alignment                                    */
+   FreeAlignment(aln);
+   freeValdar(scoring.valdar);
+   FreeMDMScores(&scoring);
 
-   return(TRUE);
+   return(ok);
+}
+
+
+/************************************************************************/
+/*>BOOL StreamAndScoreSeqs(FILE *fp, FILE *out, int MaxInMatrix, 
+                           int Method, BOOL Extended, int nthreads, 
+                           int blockLen)
+   ---------------------------------------------------------------------
+   As ReadAndScoreSeqs(), but the sequences are stored as residue codes
+   in a temporary file and scored in blocks of blockLen columns. Only 
+   one block is held in memory, so memory use does not depend on the
+   length of the alignment.
+
+   15.10.26 Original   By: ACRM
+   15.10.26 Uses a SCORING rather than static valdar01 data
+   15.10.26 Creates the MDM score table
+*/
+BOOL StreamAndScoreSeqs(FILE *fp, FILE *out, int MaxInMatrix, 
+                        int Method, BOOL Extended, int nthreads, 
+                        int blockLen)
+{
+   ALNSTREAM *stream;
+   SCORING   scoring;
+   int       block;
+   BOOL      ok = TRUE;
+
+   /* Read sequences into the temporary file                            */
+   if((stream = ReadSeqStream(fp, blockLen))==NULL)
+      return(FALSE);
+
+   /* Calculate the sequence weights for the valdar01 method or the 
+      matrix scores for the MDM method
+   */
+   InitScoring(&scoring, MaxInMatrix, Method);
+   if(Method == METH_VALDAR)
+   {
+      scoring.valdar = initValdar(&(stream->aln), stream, MaxInMatrix,
+                                  nthreads);
+   }
+   if((Method == METH_MDM) && !InitMDMScores(&scoring, &(stream->aln)))
+   {
+      fprintf(stderr,"No memory for matrix scores\n");
+      FreeSeqStream(stream);
+      return(FALSE);
+   }
+
+   /* Read each block of columns, calculate and print scores            */
+   for(block=0; block<stream->nblocks; block++)
+   {
+      if(!ReadBlock(stream, block))
+      {
+         fprintf(stderr,"Error reading temporary file\n");
+         ok = FALSE;
+         break;
+      }
+      if(!DisplayScores(out, &(stream->aln), &scoring, Extended, 
+                        nthreads))
+      {
+         ok = FALSE;
+         break;
+      }
+   }
+
+   FreeSeqStream(stream);
+   freeValdar(scoring.valdar);
+   FreeMDMScores(&scoring);
+
+   return(ok);
 }
 
 
@@ -396,6 +662,7 @@ BOOL ReadAndScoreSeqs(FILE *fp, FILE *out, int MaxInMatrix, int Method,
    sequences.
 
    11.09.96 Original   By: ACRM
+   15.10.26 Records the number of chains read so they can all be freed
 */
 SEQDATA *ReadAllSeqs(FILE *fp)
 {
@@ -410,11 +677,13 @@ SEQDATA *ReadAllSeqs(FILE *fp)
    if((p=start)==NULL)
       return(NULL);
    
-   while(blReadPIR(fp, TRUE, p->seqs, 2, &seqinfo, &punct, &error))
+   while((p->nchain = blReadPIR(fp, TRUE, p->seqs, 2, &seqinfo, &punct,
+                                &error))!=0)
    {
       if(error)
       {
-         FREELIST(start, SEQDATA);
+         p->nchain = 0;
+         FreeSeqList(start);
          return(NULL);
       }
       
@@ -422,7 +691,7 @@ SEQDATA *ReadAllSeqs(FILE *fp)
       ALLOCNEXT(p,SEQDATA);
       if(p==NULL)
       {
-         FREELIST(start, SEQDATA);
+         FreeSeqList(start);
          return(NULL);
       }
    }
@@ -436,126 +705,380 @@ SEQDATA *ReadAllSeqs(FILE *fp)
 
    
 /************************************************************************/
-/*>char **ListToTable(SEQDATA *SeqList, int *nseq, int *seqlen)
-   ------------------------------------------------------------
-   Converts the linked list of sequences to a 2D table
+/*>void FreeSeqList(SEQDATA *SeqList)
+   -----------------------------------
+   Frees the linked list of sequences and the sequences themselves
 
-   11.09.96 Original   By: ACRM
+   15.10.26 Original   By: ACRM
+   15.10.26 Frees all the chains rather than just the first
 */
-char **ListToTable(SEQDATA *SeqList, int *nseq, int *seqlen)
+void FreeSeqList(SEQDATA *SeqList)
 {
    SEQDATA *p;
-   char **table;
-   int  i, j, len;
+   int     i;
+
+   for(p=SeqList; p!=NULL; NEXT(p))
+   {
+      for(i=0; i<p->nchain; i++)
+      {
+         if(p->seqs[i] != NULL)
+            free(p->seqs[i]);
+      }
+   }
+   FREELIST(SeqList, SEQDATA);
+}
+
+
+/************************************************************************/
+/*>void InitResidueCodes(ALIGNMENT *aln)
+   -------------------------------------
+   Clears the residue codes of an alignment. '-' is always code 0.
+
+   15.10.26 Original   By: ACRM
+*/
+void InitResidueCodes(ALIGNMENT *aln)
+{
+   int i;
 
-   *seqlen=strlen(SeqList->seqs[0]);
+   for(i=0; i<MAXRESTYPE; i++)
+      aln->code[i] = (-1);
+   aln->code[(unsigned char)'-'] = 0;
+   aln->res[0]                   = '-';
+   aln->ncodes                   = 1;
+}
+
+
+/************************************************************************/
+/*>unsigned char ResidueCode(ALIGNMENT *aln, char res)
+   ---------------------------------------------------
+   Returns the code for a residue character, giving it the next code if
+   it has not been seen before.
+
+   15.10.26 Original   By: ACRM
+*/
+unsigned char ResidueCode(ALIGNMENT *aln, char res)
+{
+   if(aln->code[(unsigned char)res] < 0)
+   {
+      aln->res[aln->ncodes]          = res;
+      aln->code[(unsigned char)res] = aln->ncodes++;
+   }
+   return((unsigned char)aln->code[(unsigned char)res]);
+}
+
+
+/************************************************************************/
+/*>ALIGNMENT *ListToAlignment(SEQDATA *SeqList)
+   --------------------------------------------
+   Encodes the linked list of sequences as an alignment. Each residue 
+   character is given a code in the order they are found (see 
+   ResidueCode()). Sequences are padded with '-' to the length of the 
+   longest.
+
+   Returns NULL if out of memory
+
+   15.10.26 Original   By: ACRM (replaces ListToTable() and PadSeqs())
+*/
+ALIGNMENT *ListToAlignment(SEQDATA *SeqList)
+{
+   SEQDATA   *p;
+   ALIGNMENT *aln;
+   int       i, pos, len;
+
+   if((aln = (ALIGNMENT *)malloc(sizeof(ALIGNMENT)))==NULL)
+      return(NULL);
 
    /* First count the number of sequences and find the longest seq      */
-   for(p=SeqList, *nseq=0; p!=NULL; NEXT(p))
+   aln->nseq   = 0;
+   aln->seqlen = 0;
+   aln->offset = 0;
+   for(p=SeqList; p!=NULL; NEXT(p))
    {
-      (*nseq)++;
-      if(strlen(p->seqs[0]) > *seqlen)
-         *seqlen = strlen(SeqList->seqs[0]);
+      aln->nseq++;
+      len = strlen(p->seqs[0]);
+      if(len > aln->seqlen)
+         aln->seqlen = len;
    }
 
-   /* Allocate memory                                                   */
-   if((table = (char **)blArray2D(sizeof(char), *nseq, (*seqlen + 1)))
+   InitResidueCodes(aln);
+
+   /* Allocate memory. This is zeroed so the padding is already '-'     */
+   if((aln->codes = (unsigned char *)calloc((size_t)aln->nseq * 
+                                            (size_t)aln->seqlen,
+                                            sizeof(unsigned char)))
       ==NULL)
+   {
+      free(aln);
       return(NULL);
-   
+   }
+
    for(p=SeqList, i=0; p!=NULL; NEXT(p), i++)
    {
-      len = strlen(p->seqs[0]);
-      for(j=0; j<len; j++)
-         table[i][j] = p->seqs[0][j];
-      table[i][j] = '\0';
+      for(pos=0; p->seqs[0][pos]; pos++)
+      {
+         aln->codes[(size_t)pos * aln->nseq + i] = 
+            ResidueCode(aln, p->seqs[0][pos]);
+      }
+   }
+   
+   return(aln);
+}
+
+
+/************************************************************************/
+/*>void FreeAlignment(ALIGNMENT *aln)
+   ----------------------------------
+   Frees an alignment created by ListToAlignment()
+
+   15.10.26 Original   By: ACRM
+*/
+void FreeAlignment(ALIGNMENT *aln)
+{
+   if(aln != NULL)
+   {
+      if(aln->codes != NULL)
+         free(aln->codes);
+      free(aln);
    }
+}
+
+
+/************************************************************************/
+/*>ALNSTREAM *ReadSeqStream(FILE *fp, int blockLen)
+   ------------------------------------------------
+   Reads the sequences in a PIR file one at a time and writes them as
+   residue codes to a temporary file. The alignment may then be read in
+   blocks of blockLen columns with ReadBlock().
+
+   Returns NULL if out of memory or the temporary file could not be
+   written
 
-   PadSeqs(table, *nseq, *seqlen);
+   15.10.26 Original   By: ACRM
+   15.10.26 Frees the chains after the first in multi-chain entries
+*/
+ALNSTREAM *ReadSeqStream(FILE *fp, int blockLen)
+{
+   ALNSTREAM     *stream;
+   unsigned char *codes  = NULL;
+   char          *seqs[8];
+   SEQINFO       seqinfo;
+   BOOL          punct,
+                 error;
+   void          *ptr;
+   long          offset  = 0L;
+   int           nalloc  = 0,
+                 maxlen  = 0,
+                 nchain,
+                 len, pos, i;
+
+   if((stream = (ALNSTREAM *)malloc(sizeof(ALNSTREAM)))==NULL)
+      return(NULL);
+   stream->start       = NULL;
+   stream->len         = NULL;
+   stream->rows        = NULL;
+   stream->seqlen      = 0;
+   stream->aln.codes   = NULL;
+   stream->aln.nseq    = 0;
+   stream->aln.seqlen  = 0;
+   stream->aln.offset  = 0;
+   InitResidueCodes(&(stream->aln));
+
+   if((stream->fp = tmpfile())==NULL)
+   {
+      fprintf(stderr,"Unable to create temporary file\n");
+      FreeSeqStream(stream);
+      return(NULL);
+   }
    
-   return(table);
+   while((nchain = blReadPIR(fp, TRUE, seqs, 2, &seqinfo, &punct,
+                             &error))!=0)
+   {
+      if(error)
+         break;
+
+      /* Only the first chain is scored                                 */
+      for(i=1; i<nchain; i++)
+         free(seqs[i]);
+
+      /* Make space for the start and length of more sequences          */
+      if(stream->aln.nseq == nalloc)
+      {
+         nalloc += SEQALLOC;
+         if((ptr = realloc(stream->start, nalloc * sizeof(long)))==NULL)
+         {
+            free(seqs[0]);
+            error = TRUE;
+            break;
+         }
+         stream->start = (long *)ptr;
+         if((ptr = realloc(stream->len, nalloc * sizeof(int)))==NULL)
+         {
+            free(seqs[0]);
+            error = TRUE;
+            break;
+         }
+         stream->len = (int *)ptr;
+      }
+
+      /* Encode the sequence                                            */
+      len = strlen(seqs[0]);
+      if(len > maxlen)
+      {
+         if((ptr = realloc(codes, len * sizeof(unsigned char)))==NULL)
+         {
+            free(seqs[0]);
+            error = TRUE;
+            break;
+         }
+         codes  = (unsigned char *)ptr;
+         maxlen = len;
+      }
+      for(pos=0; pos<len; pos++)
+         codes[pos] = ResidueCode(&(stream->aln), seqs[0][pos]);
+      free(seqs[0]);
+
+      if(fwrite(codes, sizeof(unsigned char), len, stream->fp) != len)
+      {
+         fprintf(stderr,"Error writing temporary file\n");
+         error = TRUE;
+         break;
+      }
+
+      stream->start[stream->aln.nseq] = offset;
+      stream->len[stream->aln.nseq]   = len;
+      stream->aln.nseq++;
+      offset += len;
+      if(len > stream->seqlen)
+         stream->seqlen = len;
+   }
+
+   if(codes != NULL)
+      free(codes);
+
+   if(error || (stream->seqlen == 0))
+   {
+      FreeSeqStream(stream);
+      return(NULL);
+   }
+
+   /* Allocate memory for a block                                       */
+   stream->blockLen = MIN(blockLen, stream->seqlen);
+   stream->nblocks  = (stream->seqlen + stream->blockLen - 1) / 
+                      stream->blockLen;
+   if(((stream->rows = (unsigned char *)
+        malloc((size_t)stream->aln.nseq * stream->blockLen *
+               sizeof(unsigned char)))==NULL) ||
+      ((stream->aln.codes = (unsigned char *)
+        malloc((size_t)stream->aln.nseq * stream->blockLen *
+               sizeof(unsigned char)))==NULL))
+   {
+      FreeSeqStream(stream);
+      return(NULL);
+   }
+
+   return(stream);
 }
 
 
 /************************************************************************/
-/*>void PadSeqs(char **SeqTable, int nseq, int seqlen)
-   ---------------------------------------------------
-   Pads all sequences in a table to the same length
+/*>void FreeSeqStream(ALNSTREAM *stream)
+   -------------------------------------
+   Frees an ALNSTREAM created by ReadSeqStream() and closes (and so
+   deletes) the temporary file
 
-   11.09.96 Original   By: ACRM
+   15.10.26 Original   By: ACRM
 */
-void PadSeqs(char **SeqTable, int nseq, int seqlen)
+void FreeSeqStream(ALNSTREAM *stream)
 {
-   int i;
-   for(i=0; i<nseq; i++)
+   if(stream != NULL)
    {
-      if(strlen(SeqTable[i]) < seqlen)
-         blPadchar(SeqTable[i], seqlen, '-');
+      if(stream->fp        != NULL) fclose(stream->fp);
+      if(stream->start     != NULL) free(stream->start);
+      if(stream->len       != NULL) free(stream->len);
+      if(stream->rows      != NULL) free(stream->rows);
+      if(stream->aln.codes != NULL) free(stream->aln.codes);
+      free(stream);
    }
 }
 
 
 /************************************************************************/
-/*>void DisplayScores(FILE *fp, char **SeqTable, int nseq, int seqlen,
-                      int MaxInMatrix, int Method, BOOL Extended)
-   -------------------------------------------------------------------
-   Display the variability scores for each position in the alignment
+/*>BOOL ReadBlockRows(ALNSTREAM *stream, int block, unsigned char *rows,
+                      int stride)
+   ---------------------------------------------------------------------
+   Reads a block of columns from the temporary file as a row of stride
+   codes for each sequence. Rows are padded with gaps (code 0).
 
-   11.09.96 Original   By: ACRM
-   17.09.96 Added MaxInMatrix and prints amino acid list
-   15.07.08 Added Extended parameter and printing
+   15.10.26 Original   By: ACRM
 */
-void DisplayScores(FILE *fp, char **SeqTable, int nseq, int seqlen, 
-                   int MaxInMatrix, int Method, BOOL Extended)
+BOOL ReadBlockRows(ALNSTREAM *stream, int block, unsigned char *rows,
+                   int stride)
 {
-   int i, j;
+   unsigned char *row;
+   int           i, n,
+                 first = block * stream->blockLen;
 
-   for(i=0; i<seqlen; i++)
+   for(i=0; i<stream->aln.nseq; i++)
    {
-      if(Extended)
+      row = rows + (size_t)i * stride;
+      n   = MIN(stream->len[i] - first, stream->blockLen);
+      if(n > 0)
       {
-         fprintf(fp,"%4d %9.6f ",
-                 i+1,
-                 CalcScore(SeqTable, nseq, seqlen, i, 
-                           MaxInMatrix, Method));
+         if(fseek(stream->fp, stream->start[i] + first, SEEK_SET) ||
+            (fread(row, sizeof(unsigned char), n, stream->fp) != n))
+            return(FALSE);
       }
       else
       {
-         fprintf(fp,"%4d %6.3f ",
-                 i+1,
-                 CalcScore(SeqTable, nseq, seqlen, i, 
-                           MaxInMatrix, Method));
+         n = 0;
       }
-      
-      for(j=0; j<nseq; j++)
-      {
-         fprintf(fp,"%c",SeqTable[j][i]);
-      }
-      fprintf(fp,"\n");
+      memset(row + n, 0, stride - n);
    }
+
+   return(TRUE);
 }
 
 
 /************************************************************************/
-/*>REAL CalcScore(char **SeqTable, int nseq, int seql, int pos, 
-                  int MaxInMatrix, int Method)
-   ------------------------------------------------------------
-   Calculate the score for a given position in the alignment
+/*>BOOL ReadBlock(ALNSTREAM *stream, int block)
+   --------------------------------------------
+   Reads a block of columns from the temporary file into stream->aln
 
-   11.09.96 Original   By: ACRM
-   17.09.96 Changed score to LONG rather than ULONG since return value
-            from CalcMDMScore() can be -ve!
-            Added MaxInMatrix
-   18.09.96 Changed calculation of combined score
-   11.08.15 Initialize e
-   24.08.15 Add seql parameter and valdar01 method.  By: TCN
+   15.10.26 Original   By: ACRM
 */
-REAL CalcScore(char **SeqTable, int nseq, int seql, int pos, 
-               int MaxInMatrix, int Method)
+BOOL ReadBlock(ALNSTREAM *stream, int block)
 {
-   REAL e = 0.0,
-        e9, e21;
+   ALIGNMENT     *aln = &(stream->aln);
+   unsigned char *column;
+   int           i, pos;
+
+   if(!ReadBlockRows(stream, block, stream->rows, stream->blockLen))
+      return(FALSE);
    
+   aln->offset = block * stream->blockLen;
+   aln->seqlen = MIN(stream->blockLen, stream->seqlen - aln->offset);
+
+   for(pos=0; pos<aln->seqlen; pos++)
+   {
+      column = aln->codes + (size_t)pos * aln->nseq;
+      for(i=0; i<aln->nseq; i++)
+         column[i] = stream->rows[(size_t)i * stream->blockLen + pos];
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void InitScoring(SCORING *scoring, int MaxInMatrix, int Method)
+   ---------------------------------------------------------------
+   Initializes a SCORING for the method. The valdar01 data or MDM
+   scores must be set by the caller.
+
+   15.10.26 Original   By: ACRM (group tables from CalcScore())
+*/
+void InitScoring(SCORING *scoring, int MaxInMatrix, int Method)
+{
    /* Defines group membership for the amino acid types                 */
    static AMINOACID AA21Groups[] =
    {  { 'A', 1, { 0,  0}},
@@ -613,16 +1136,223 @@ REAL CalcScore(char **SeqTable, int nseq, int seql, int pos,
       { ' ', 0, { 0,  0}}
    };
 
-   switch(Method)
+   scoring->valdar      = NULL;
+   scoring->mdmScore    = NULL;
+   scoring->ncodes      = 0;
+   scoring->MaxInMatrix = MaxInMatrix;
+   scoring->Method      = Method;
+   BuildGroupLookup(AA21Groups, scoring->AA21Lookup);
+   BuildGroupLookup(AA9Groups,  scoring->AA9Lookup);
+}
+
+
+/************************************************************************/
+/*>BOOL InitMDMScores(SCORING *scoring, ALIGNMENT *aln)
+   ----------------------------------------------------
+   Creates the table of blCalcMDMScore() values for each pair of residue
+   codes in the alignment for the MDM method. ' ' is treated as '-'.
+   All the matrix lookups are done here before the columns are scored
+   so that the threads in ScoreColumns() only read this table and do not
+   call into BiopLib.
+
+   Returns FALSE if out of memory
+
+   15.10.26 Original   By: ACRM
+*/
+BOOL InitMDMScores(SCORING *scoring, ALIGNMENT *aln)
+{
+   char resI, resJ;
+   int  i, j;
+
+   scoring->ncodes = aln->ncodes;
+   if((scoring->mdmScore = (LONG **)blArray2D(sizeof(LONG), 
+                                              scoring->ncodes,
+                                              scoring->ncodes))==NULL)
+      return(FALSE);
+
+   for(i=0; i<scoring->ncodes; i++)
+   {
+      resI = (aln->res[i] == ' ') ? '-' : aln->res[i];
+      for(j=0; j<scoring->ncodes; j++)
+      {
+         resJ = (aln->res[j] == ' ') ? '-' : aln->res[j];
+         scoring->mdmScore[i][j] = (LONG)blCalcMDMScore(resI, resJ);
+      }
+   }
+
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void FreeMDMScores(SCORING *scoring)
+   ------------------------------------
+   Frees the table created by InitMDMScores()
+
+   15.10.26 Original   By: ACRM
+*/
+void FreeMDMScores(SCORING *scoring)
+{
+   if(scoring->mdmScore != NULL)
+   {
+      blFreeArray2D((char **)scoring->mdmScore, scoring->ncodes, 
+                    scoring->ncodes);
+      scoring->mdmScore = NULL;
+   }
+}
+
+
+/************************************************************************/
+/*>BOOL DisplayScores(FILE *fp, ALIGNMENT *aln, SCORING *scoring, 
+                      BOOL Extended, int nthreads)
+   ----------------------------------------------------------------
+   Display the variability scores for each position in the alignment.
+   The scores are calculated first using nthreads threads.
+
+   Returns FALSE if out of memory
+
+   11.09.96 Original   By: ACRM
+   17.09.96 Added MaxInMatrix and prints amino acid list
+   15.07.08 Added Extended parameter and printing
+   15.10.26 Takes an ALIGNMENT
+   15.10.26 Numbers positions from the alignment offset
+   15.10.26 Takes a SCORING and nthreads. Calculates all the scores 
+            before printing
+*/
+BOOL DisplayScores(FILE *fp, ALIGNMENT *aln, SCORING *scoring, 
+                   BOOL Extended, int nthreads)
+{
+   unsigned char *column;
+   REAL          *scores;
+   int           i, j;
+
+   if((scores = (REAL *)malloc(aln->seqlen * sizeof(REAL)))==NULL)
+   {
+      fprintf(stderr,"No memory for scores\n");
+      return(FALSE);
+   }
+   ScoreColumns(aln, scoring, scores, nthreads);
+
+   for(i=0; i<aln->seqlen; i++)
+   {
+      if(Extended)
+      {
+         fprintf(fp,"%4d %9.6f ", aln->offset+i+1, scores[i]);
+      }
+      else
+      {
+         fprintf(fp,"%4d %6.3f ", aln->offset+i+1, scores[i]);
+      }
+      
+      column = aln->codes + (size_t)i * aln->nseq;
+      for(j=0; j<aln->nseq; j++)
+      {
+         fputc(aln->res[column[j]], fp);
+      }
+      fprintf(fp,"\n");
+   }
+
+   free(scores);
+   return(TRUE);
+}
+
+
+/************************************************************************/
+/*>void ScoreColumns(ALIGNMENT *aln, SCORING *scoring, REAL *scores, 
+                     int nthreads)
+   -----------------------------------------------------------------
+   Calculates the score for each column of the alignment into scores.
+   Up to nthreads threads (including the calling thread) each take 
+   COLCHUNK columns at a time.
+
+   15.10.26 Original   By: ACRM
+*/
+void ScoreColumns(ALIGNMENT *aln, SCORING *scoring, REAL *scores, 
+                  int nthreads)
+{
+   COLQUEUE queue;
+
+   queue.aln     = aln;
+   queue.scoring = scoring;
+   queue.scores  = scores;
+   queue.next    = 0;
+   pthread_mutex_init(&(queue.lock), NULL);
+
+   nthreads = MIN(nthreads, (aln->seqlen + COLCHUNK - 1) / COLCHUNK);
+   RunThreads(RunColumnJobs, (void *)&queue, nthreads);
+
+   pthread_mutex_destroy(&(queue.lock));
+}
+
+
+/************************************************************************/
+/*>void *RunColumnJobs(void *arg)
+   ------------------------------
+   Thread function which scores columns from the queue until there are
+   none left
+
+   15.10.26 Original   By: ACRM
+*/
+void *RunColumnJobs(void *arg)
+{
+   COLQUEUE *queue = (COLQUEUE *)arg;
+   int      first, last, pos;
+
+   for(;;)
+   {
+      pthread_mutex_lock(&(queue->lock));
+      first        = queue->next;
+      queue->next += COLCHUNK;
+      pthread_mutex_unlock(&(queue->lock));
+
+      if(first >= queue->aln->seqlen)
+         break;
+
+      last = MIN(first + COLCHUNK, queue->aln->seqlen);
+      for(pos=first; pos<last; pos++)
+         queue->scores[pos] = CalcScore(queue->aln, pos, queue->scoring);
+   }
+
+   return(NULL);
+}
+
+
+/************************************************************************/
+/*>REAL CalcScore(ALIGNMENT *aln, int pos, SCORING *scoring)
+   ----------------------------------------------------------
+   Calculate the score for a given position in the alignment
+
+   11.09.96 Original   By: ACRM
+   17.09.96 Changed score to LONG rather than ULONG since return value
+            from CalcMDMScore() can be -ve!
+            Added MaxInMatrix
+   18.09.96 Changed calculation of combined score
+   11.08.15 Initialize e
+   24.08.15 Add seql parameter and valdar01 method.  By: TCN
+   15.10.26 Takes an ALIGNMENT   By: ACRM
+   15.10.26 Counts the residues once for the entropy methods and looks
+            up the groups for each residue
+   15.10.26 Takes a SCORING. The group tables moved to InitScoring()
+   15.10.26 Passes the SCORING to MDMBasedScore()
+*/
+REAL CalcScore(ALIGNMENT *aln, int pos, SCORING *scoring)
+{
+   REAL e = 0.0,
+        e9, e21;
+   int  count[MAXRESTYPE];
+   
+   switch(scoring->Method)
    {
    case METH_MDM:
-      return(MDMBasedScore(SeqTable, nseq, pos, MaxInMatrix));
+      return(MDMBasedScore(aln, pos, scoring));
    case METH_ENTROPY20:
+      CountResidues(aln, pos, count);
       return((REAL)1.0 -
-             EntropyScore(SeqTable, nseq, pos, AA21Groups, 21));
+             EntropyScore(aln, count, scoring->AA21Lookup, 21));
    case METH_ENTROPY8:
+      CountResidues(aln, pos, count);
       return((REAL)1.0 -
-             EntropyScore(SeqTable, nseq, pos, AA9Groups, 9)); 
+             EntropyScore(aln, count, scoring->AA9Lookup, 9)); 
    case METH_ENTROPY:
 /*
       e21 = (REAL)1.0 - EntropyScore(SeqTable, nseq, pos, AA21Groups, 21);
@@ -632,13 +1362,14 @@ REAL CalcScore(char **SeqTable, int nseq, int seql, int pos,
                                 ((REAL)20.0/(REAL)8.0)));
       return(e);
 */
-      e21 = EntropyScore(SeqTable, nseq, pos, AA21Groups, 21);
-      e9  = EntropyScore(SeqTable, nseq, pos, AA9Groups,  9);
+      CountResidues(aln, pos, count);
+      e21 = EntropyScore(aln, count, scoring->AA21Lookup, 21);
+      e9  = EntropyScore(aln, count, scoring->AA9Lookup,  9);
       e   = e21 * ((1.0 - (8.0/20.0))*e9 + (8.0/20.0));
       e   = 1.0 - e;
       return((REAL)e);
    case METH_VALDAR:
-      return(valdarScore(SeqTable, pos, nseq, seql, MaxInMatrix));
+      return(valdarScore(aln, pos, scoring->valdar));
    default:
       return((REAL)0.0);
    }
@@ -648,49 +1379,126 @@ REAL CalcScore(char **SeqTable, int nseq, int seql, int pos,
 
 
 /************************************************************************/
-/*>REAL MDMBasedScore(char **SeqTable, int nseq, int pos, int MaxInMatrix)
-   -----------------------------------------------------------------------
+/*>void CountResidues(ALIGNMENT *aln, int pos, int *count)
+   -------------------------------------------------------
+   Input:   ALIGNMENT *aln      The alignment
+            int       pos       Position in the alignment
+   Output:  int       *count    Number of each residue code in the 
+                                column (aln->ncodes values)
+
+   Counts the residue codes in a column of the alignment
+
+   15.10.26 Original   By: ACRM
+*/
+void CountResidues(ALIGNMENT *aln, int pos, int *count)
+{
+   unsigned char *column = aln->codes + (size_t)pos * aln->nseq;
+   int           i;
+   
+   for(i=0; i<aln->ncodes; i++)
+      count[i] = 0;
+   for(i=0; i<aln->nseq; i++)
+      count[column[i]]++;
+}
+
+
+/************************************************************************/
+/*>REAL MDMBasedScore(ALIGNMENT *aln, int pos, SCORING *scoring)
+   --------------------------------------------------------------
    Calculate the score for a given position in the alignment using the
    MDM Method
 
+   The residue types in the column are counted first. The sum over all
+   pairs of sequences is then the sum over pairs of residue types of
+   the product of their counts and the matrix score. This assumes that
+   the mutation matrix is symmetric. The matrix scores are taken from
+   the table made by InitMDMScores().
+
    11.09.96 Original   By: ACRM
    17.09.96 Changed score to LONG rather than ULONG since return value
             from CalcMDMScore() can be -ve!
             Added MaxInMatrix
+   15.10.26 Calculated from counts of each residue type
+   15.10.26 Takes an ALIGNMENT
+   15.10.26 Takes a SCORING and uses its table of matrix scores rather
+            than calling blCalcMDMScore()
 */
-REAL MDMBasedScore(char **SeqTable, int nseq, int pos, int MaxInMatrix)
+REAL MDMBasedScore(ALIGNMENT *aln, int pos, SCORING *scoring)
 {
-   int   i, j,
-         count;
-   LONG  score;
-   char  res1,
-         res2;
+   LONG **mdmScore = scoring->mdmScore;
+   int  i, j,
+        nseq   = aln->nseq,
+        ntypes = 0,
+        count[MAXRESTYPE],
+        code[MAXRESTYPE];
+   LONG score  = 0L,
+        npairs;
    
-   count = 0;
-   score = 0L;
-   for(i=0; i<nseq-1; i++)
+   /* Count the residue codes in this column                            */
+   CountResidues(aln, pos, count);
+
+   /* Find the residue types present                                    */
+   for(i=0; i<aln->ncodes; i++)
+   {
+      if(count[i])
+      {
+         code[ntypes]    = i;
+         count[ntypes++] = count[i];
+      }
+   }
+
+   /* Sum the scores over pairs of residue types                        */
+   for(i=0; i<ntypes; i++)
    {
-      res1 = SeqTable[i][pos];
-      if(res1 == ' ')
-         res1 = '-';
+      LONG ni = count[i];
       
-      for(j=i+1; j<nseq; j++)
+      /* Pairs of sequences with the same residue type                  */
+      score += ((ni * (ni-1)) / 2) * mdmScore[code[i]][code[i]];
+
+      /* Pairs with different types                                     */
+      for(j=i+1; j<ntypes; j++)
       {
-         res2 = SeqTable[j][pos];
-         if(res2 == ' ')
-            res2 = '-';
-         count++;
-         score += blCalcMDMScore(res1, res2);
+         score += ni * (LONG)count[j] * mdmScore[code[i]][code[j]];
       }
    }
 
-   return(((REAL)score/(REAL)count)/(REAL)MaxInMatrix);
+   npairs = ((LONG)nseq * (LONG)(nseq-1)) / 2;
+
+   return(((REAL)score/(REAL)npairs)/(REAL)scoring->MaxInMatrix);
 }
 
 /************************************************************************/
-/*>REAL EntropyScore(char **SeqTable, int nseq, int pos, 
-                     AMINOACID *aminoacids, int NGroups)
-   -----------------------------------------------------
+/*>void BuildGroupLookup(AMINOACID *aminoacids, AMINOACID **lookup)
+   -----------------------------------------------------------------
+   Input:   AMINOACID *aminoacids   Table of groups for the amino acids
+                                    ending with an entry with NGroup==0
+   Output:  AMINOACID **lookup      Entry in the table for each residue
+                                    character (MAXRESTYPE values). NULL
+                                    if the residue is not in a group
+
+   Builds a lookup table of the groups for each residue character.
+
+   15.10.26 Original   By: ACRM
+*/
+void BuildGroupLookup(AMINOACID *aminoacids, AMINOACID **lookup)
+{
+   int i, type;
+
+   for(i=0; i<MAXRESTYPE; i++)
+      lookup[i] = NULL;
+   
+   for(type=0; aminoacids[type].NGroup != 0; type++)
+   {
+      if(lookup[(unsigned char)aminoacids[type].res] == NULL)
+         lookup[(unsigned char)aminoacids[type].res] = aminoacids + type;
+   }
+}
+
+
+/************************************************************************/
+/*>REAL EntropyScore(ALIGNMENT *aln, int *count, AMINOACID **lookup, 
+                     int NGroups)
+   -----------------------------------------------------------------
    Calculates an entropy score based on the equation:
    S = - \sum_i p_i \log p_i
    where p_i is n_i/N
@@ -698,65 +1506,61 @@ REAL MDMBasedScore(char **SeqTable, int nseq, int pos, int MaxInMatrix)
    A table of classifications for the amino acids is supplied to the 
    routine such that the amino acid types may be grouped. This table
    also allows residues to belong to 2 groups to account for B (ASX)
-   and Z (GLX).
+   and Z (GLX). The table is looked up from the residue character (see
+   BuildGroupLookup()) and count is the number of each residue code in
+   the column (see CountResidues()).
 
    The result is scaled such that the entropy runs from 0 (all conserved)
    to 1.0 (maximum variability)
 
    17.09.96 Original   By: ACRM
+   15.10.26 Takes an ALIGNMENT
+   15.10.26 Uses the residue counts and a lookup of the groups rather 
+            than scanning the column for each amino acid type. No 
+            longer allocates the group counts
 */
-REAL EntropyScore(char **SeqTable, int nseq, int pos, 
-                  AMINOACID *aminoacids, int NGroups)
+REAL EntropyScore(ALIGNMENT *aln, int *count, AMINOACID **lookup, 
+                  int NGroups)
 {
-   REAL entropy = (REAL)0.0,
-        *count;
-   int  type, i, j;
+   AMINOACID *aa;
+   REAL      entropy = (REAL)0.0,
+             groupCount[MAXGROUPS];
+   int       i, j,
+             nseq    = aln->nseq;
 
-   /* Allocate memory to store the counts and zero them                 */
-   if((count = (REAL *)malloc(NGroups * sizeof(REAL)))==NULL)
+   if(NGroups > MAXGROUPS)
       return((REAL)9999.0);
    for(i=0; i<NGroups; i++)
-      count[i] = (REAL)0.0;
+      groupCount[i] = (REAL)0.0;
    
-   /* For each recognised amino acid type                               */
-   for(type=0; aminoacids[type].NGroup != 0; type++)
+   /* For each residue type in the column which is in a group           */
+   for(i=0; i<aln->ncodes; i++)
    {
-      /* Count through the sequences to see how many amino acids are of 
-         this type
-      */
-      for(i=0; i<nseq; i++)
+      if(count[i] && 
+         ((aa = lookup[(unsigned char)aln->res[i]]) != NULL))
       {
-         /* We've got an amino acid of this type                        */
-         if(SeqTable[i][pos] == aminoacids[type].res)
-         {
-            /* We allow amino acids to belong to more than one group to
-               handle B (ASX) and Z (GLX).
-
-               For each group to which this residue belongs             
-            */
-            for(j=0; j<aminoacids[type].NGroup; j++)
-            {
-               /* Increment the count by 1 over the number of groups to
-                  which this residue belongs
-               */
-               count[aminoacids[type].group[j]] += 
-                  (REAL)1.0/(REAL)aminoacids[type].NGroup;
-            }
-         }
+         /* We allow amino acids to belong to more than one group to
+            handle B (ASX) and Z (GLX).
+
+            For each group to which this residue belongs add the count
+            over the number of groups to which this residue belongs
+         */
+         for(j=0; j<aa->NGroup; j++)
+            groupCount[aa->group[j]] += (REAL)count[i]/(REAL)aa->NGroup;
       }
    }
 
    /* Now run through all the counts and convert them to fractions      */
    for(i=0; i<NGroups; i++)
-      count[i] /= nseq;
+      groupCount[i] /= nseq;
 
    /* Add up the entropy score                                          */
    for(i=0; i<NGroups; i++)
    {
-      if(count[i] > (REAL)0.0)
+      if(groupCount[i] > (REAL)0.0)
       {
-         entropy -= count[i] * 
-            (REAL)log((double)count[i]);
+         entropy -= groupCount[i] * 
+            (REAL)log((double)groupCount[i]);
       }
    }
 
@@ -770,60 +1574,157 @@ REAL EntropyScore(char **SeqTable, int nseq, int pos,
 }
 
 /************************************************************************/
-/*>REAL valdarScore(char **SeqTable, int pos, int numSeqs, int seqlen,
-                    int MaxInMatrix)
-   -----------------------------------------------------------------------
+/*>REAL valdarScore(ALIGNMENT *aln, int pos, VALDARDATA *valdar)
+   -------------------------------------------------------------
    Calculate the conservation score of an alignment position, using the
    valdar01 method.
+
+   The weights of the sequences with each residue type are summed. The
+   weighted sum over pairs of sequences is then the sum over pairs of
+   residue types of the products of their summed weights and the matrix
+   score, less the products of each sequence with itself.
    
    Returns 9999.0 on error
 
    20.08.15 Original   By: TCN
+   15.10.26 Uses VALDARDATA and sums weights for each residue type
+            By: ACRM
+   15.10.26 The VALDARDATA is created before scoring
+   15.10.26 Takes an ALIGNMENT
+   15.10.26 Takes the VALDARDATA rather than using a static
 */
-REAL valdarScore(char **SeqTable, int pos, int numSeqs, int seqlen,
-                 int MaxInMatrix) 
+REAL valdarScore(ALIGNMENT *aln, int pos, VALDARDATA *valdar)
 {
-   int  i, j;
-   REAL matrixScore;
-   REAL weightedSum = 0;
+   unsigned char *column = aln->codes + (size_t)pos * aln->nseq;
+   int  i, j, 
+        code;
+   REAL weight,
+        weightedSum = 0,
+        typeWeight[MAXRESTYPE],
+        typeWeightSq[MAXRESTYPE];
+
+   if(valdar == NULL)
+      return((REAL)9999.0);
 
-   if(sSeqWeights == SEQWEIGHTS_UNITIALIZED)
+   /* Sum the weights and squared weights for each residue type         */
+   for(i=0; i<valdar->ncodes; i++)
+      typeWeight[i] = typeWeightSq[i] = (REAL)0.0;
+   
+   for(i=0; i<aln->nseq; i++)
+   {
+      code                = column[i];
+      weight              = valdar->seqWeights[i];
+      typeWeight[code]   += weight;
+      typeWeightSq[code] += weight * weight;
+   }
+   
+   /* Sum over pairs of residue types. Gaps (code 0 and ' ') score zero */
+   for(i=1; i<valdar->ncodes; i++)
    {
-      if(initSequenceWeights(SeqTable, numSeqs, seqlen, 
-                             MaxInMatrix)==FALSE)
+      if(typeWeight[i] == (REAL)0.0)
+         continue;
+      
+      weightedSum += (REAL)0.5 * 
+                     (typeWeight[i] * typeWeight[i] - typeWeightSq[i]) *
+                     valdar->score[i][i];
+      for(j=i+1; j<valdar->ncodes; j++)
       {
-         return((REAL)9999.0);
+         weightedSum += typeWeight[i] * typeWeight[j] * 
+                        valdar->score[i][j];
       }
    }
-   
-   if(sLambda == LAMBDA_UNITIALIZED)
+
+   return(valdar->lambda * weightedSum);
+}
+
+/************************************************************************/
+/*>VALDARDATA *initValdar(ALIGNMENT *aln, ALNSTREAM *stream, 
+                          int MaxInMatrix, int nthreads)
+   --------------------------------------------------------------
+   Creates the data needed for the valdar01 method: the table of matrix 
+   scores for each pair of residue codes, the sequence weights and 
+   lambda. If stream is not NULL, the sequences are read from it and
+   aln just gives the residue codes and the number of sequences.
+
+   Returns NULL if out of memory
+
+   15.10.26 Original   By: ACRM
+   15.10.26 Takes an ALIGNMENT rather than encoding the sequences
+   15.10.26 Added stream
+*/
+VALDARDATA *initValdar(ALIGNMENT *aln, ALNSTREAM *stream, 
+                       int MaxInMatrix, int nthreads)
+{
+   VALDARDATA *valdar;
+   char       resI, resJ;
+   int        i, j;
+
+   if((valdar = (VALDARDATA *)malloc(sizeof(VALDARDATA)))==NULL)
+      return(NULL);
+   valdar->seqWeights = NULL;
+   valdar->ncodes     = aln->ncodes;
+
+   /* Table of scores for each pair of residue codes. ' ' is treated as
+      a gap
+   */
+   if((valdar->score = (REAL **)blArray2D(sizeof(REAL), valdar->ncodes,
+                                          valdar->ncodes))==NULL)
    {
-      initLambda(numSeqs);
+      freeValdar(valdar);
+      return(NULL);
    }
-   
-   for(i=0; i<numSeqs; i++)
+   for(i=0; i<valdar->ncodes; i++)
    {
-      for(j=i+1; j<numSeqs; j++)
+      resI = (aln->res[i] == ' ') ? '-' : aln->res[i];
+      for(j=0; j<valdar->ncodes; j++)
       {
-         matrixScore = valdarMatrixScore(SeqTable[i][pos], 
-                                         SeqTable[j][pos], 
-                                         MaxInMatrix);
-         weightedSum += sSeqWeights[i] * sSeqWeights[j] * matrixScore;
+         resJ = (aln->res[j] == ' ') ? '-' : aln->res[j];
+         valdar->score[i][j] = valdarMatrixScore(resI, resJ, 
+                                                 MaxInMatrix);
       }
    }
 
-   return(sLambda * weightedSum);
+   if(!initSequenceWeights(valdar, aln, stream, nthreads))
+   {
+      freeValdar(valdar);
+      return(NULL);
+   }
+   
+   initLambda(valdar, aln->nseq);
+   
+   return(valdar);
 }
 
 /************************************************************************/
-/*>void initLambda(int numSeqs)
-   ----------------------------
-   Initializes the global static REAL lambda, a scalar used for
-   calculating conscores using the valdar01 method.
+/*>void freeValdar(VALDARDATA *valdar)
+   -----------------------------------
+   Frees the data created by initValdar()
+
+   15.10.26 Original   By: ACRM
+*/
+void freeValdar(VALDARDATA *valdar)
+{
+   if(valdar != NULL)
+   {
+      if(valdar->seqWeights != NULL)
+         free(valdar->seqWeights);
+      if(valdar->score != NULL)
+         blFreeArray2D((char **)valdar->score, valdar->ncodes, 
+                       valdar->ncodes);
+      free(valdar);
+   }
+}
+
+/************************************************************************/
+/*>void initLambda(VALDARDATA *valdar, int numSeqs)
+   ------------------------------------------------
+   Initializes lambda, a scalar used for calculating conscores using the
+   valdar01 method.
    
    20.08.2015 Original   By: TCN
+   15.10.26   Stores lambda in the VALDARDATA   By: ACRM
 */
-void initLambda(int numSeqs) 
+void initLambda(VALDARDATA *valdar, int numSeqs) 
 {
    REAL weightSum = 0;
    int  i, j;
@@ -832,163 +1733,346 @@ void initLambda(int numSeqs)
    {
       for(j=i+1; j<numSeqs; j++)
       {
-         weightSum += sSeqWeights[i] * sSeqWeights[j];
+         weightSum += valdar->seqWeights[i] * valdar->seqWeights[j];
       }
    }
 
-   sLambda =  ((REAL)1 / weightSum); 
+   valdar->lambda =  ((REAL)1 / weightSum); 
 }
 
 /************************************************************************/
-/*>REAL initSequenceWeights(char **SeqTable, int numSeqs, int seqlen,
-                            int MaxInMatrix)
-   -----------------------------------------------------------------------
-   Initializes the global static array sSeqWeights, used for the
-   valdar01 method. Each sequence is given a weight according to its
-   evolutionary distance from the other in the alignment.
+/*>BOOL initSequenceWeights(VALDARDATA *valdar, ALIGNMENT *aln, 
+                            ALNSTREAM *stream, int nthreads)
+   ---------------------------------------------------------------
+   Initializes the sequence weights used for the valdar01 method. Each 
+   sequence is given a weight according to its evolutionary distance 
+   from the other in the alignment.
+
+   The distances are calculated for a strip of STRIPSEQS sequences at a
+   time, split into tiles which are shared between the threads. Each 
+   distance is then added to the sums for both sequences. Since this is
+   done in order of the first sequence, each sum is still accumulated in
+   order of the other sequence so the weights do not depend on the 
+   number of threads.
+
+   If stream is not NULL, the matrix scores and non-gap positions for 
+   the strip are summed over each block of columns in turn, so the 
+   blocks are read once for each strip.
    
    20.08.15 Original   By: TCN
+   15.10.26 Takes the encoded alignment. Only calculates each distance
+            once and no longer stores the distance matrix   By: ACRM
+   15.10.26 Calculates the distances in strips using threads
+   15.10.26 Copies the sequences from the ALIGNMENT to padded rows
+   15.10.26 Added stream
 */
-BOOL initSequenceWeights(char **SeqTable, int numSeqs, int seqlen,
-                         int MaxInMatrix) 
+BOOL initSequenceWeights(VALDARDATA *valdar, ALIGNMENT *aln, 
+                         ALNSTREAM *stream, int nthreads) 
 {
-   int  i, j;
-   REAL seqDistSum;
-   REAL **seqDistTable = NULL;
-   
-   if((seqDistTable = getSeqDistTable(SeqTable, numSeqs, seqlen, 
-                                      MaxInMatrix))==NULL)
+   DISTDATA dist;
+   DISTJOB  *jobs        = NULL;
+   REAL     d;
+   int      *scoreSum    = NULL,
+            *nonGapCount = NULL,
+            i, j, k,
+            block,
+            firstRow,
+            lastRow,
+            njobs,
+            numSeqs      = aln->nseq,
+            nblocks      = (stream == NULL) ? 1 : stream->nblocks,
+            blockLen     = (stream == NULL) ? aln->seqlen : 
+                                              stream->blockLen;
+   size_t   ncodes,
+            stripSize    = (size_t)STRIPSEQS * numSeqs;
+   BOOL     ok           = FALSE;
+
+   if((valdar->seqWeights = (REAL *)malloc(sizeof(REAL) * numSeqs))
+      ==NULL)
       return(FALSE);
+
+   dist.stride    = ((blockLen + ROWPAD - 1) / ROWPAD) * ROWPAD;
+   dist.ncodes    = valdar->ncodes;
+   dist.codes     = NULL;
+   dist.nonGap    = NULL;
+   dist.pairScore = NULL;
+   ncodes         = (size_t)valdar->ncodes;
    
-   if((sSeqWeights = malloc(sizeof(REAL) * numSeqs))==NULL)
-      return(FALSE);
+   if(((dist.codes = (unsigned char *)calloc((size_t)numSeqs * 
+                                             dist.stride,
+                                             sizeof(unsigned char)))
+       ==NULL) ||
+      ((dist.nonGap = (unsigned char *)malloc((size_t)numSeqs * 
+                                              dist.stride *
+                                              sizeof(unsigned char)))
+       ==NULL) ||
+      ((dist.pairScore = (int *)malloc(ncodes * ncodes * sizeof(int)))
+       ==NULL) ||
+      ((scoreSum = (int *)malloc(stripSize * sizeof(int)))==NULL) ||
+      ((nonGapCount = (int *)malloc(stripSize * sizeof(int)))==NULL) ||
+      ((jobs = (DISTJOB *)malloc((numSeqs/TILESEQS + 1) * 
+                                 sizeof(DISTJOB)))==NULL))
+      goto cleanup;
+
+   /* The distance sums the matrix scores as an int so only the whole
+      part of each score counts (scores are >= 0 after blZeroMDM())
+   */
+   for(i=0; i<valdar->ncodes; i++)
+   {
+      for(j=0; j<valdar->ncodes; j++)
+         dist.pairScore[i*ncodes + j] = (int)valdar->score[i][j];
+   }
    
    for(i=0; i<numSeqs; i++)
+      valdar->seqWeights[i] = (REAL)0.0;
+
+   for(firstRow=0; firstRow<numSeqs; firstRow=lastRow)
    {
-      seqDistSum = (REAL)0.0;
-      for(j=0; j<numSeqs; j++)
+      lastRow = MIN(firstRow + STRIPSEQS, numSeqs);
+
+      for(k=0; k<stripSize; k++)
+         scoreSum[k] = nonGapCount[k] = 0;
+
+      /* Split the strip into tiles of columns                          */
+      for(njobs=0, j=firstRow+1; j<numSeqs; j+=TILESEQS, njobs++)
       {
-         if(i == j)
-            continue;
-            seqDistSum += seqDistTable[i][j];
+         jobs[njobs].dist        = &dist;
+         jobs[njobs].scoreSum    = scoreSum;
+         jobs[njobs].nonGapCount = nonGapCount;
+         jobs[njobs].numSeqs     = numSeqs;
+         jobs[njobs].firstRow    = firstRow;
+         jobs[njobs].lastRow     = lastRow;
+         jobs[njobs].firstCol    = j;
+         jobs[njobs].lastCol     = MIN(j + TILESEQS, numSeqs);
+      }
+
+      /* Sum over each block of the alignment. If it is all in one block
+         it only needs to be loaded for the first strip
+      */
+      for(block=0; block<nblocks; block++)
+      {
+         if((nblocks > 1) || (firstRow == 0))
+         {
+            if(!loadDistBlock(&dist, aln, stream, block))
+               goto cleanup;
+         }
+         RunJobQueue(jobs, njobs, nthreads);
+      }
+
+      /* Add the distances to the sums                                  */
+      for(i=firstRow; i<lastRow; i++)
+      {
+         for(j=i+1; j<numSeqs; j++)
+         {
+            k = (i-firstRow) * numSeqs + j;
+            d = (REAL)1.0 - ((REAL)scoreSum[k] / (REAL)nonGapCount[k]);
+            valdar->seqWeights[i] += d;
+            valdar->seqWeights[j] += d;
+         }
       }
-      sSeqWeights[i] = seqDistSum / ((REAL)numSeqs - (REAL)1.0);
    }
+
+   for(i=0; i<numSeqs; i++)
+      valdar->seqWeights[i] /= ((REAL)numSeqs - (REAL)1.0);
+
+   ok = TRUE;
    
-   return(TRUE);
+cleanup:
+   if(dist.codes     != NULL) free(dist.codes);
+   if(dist.nonGap    != NULL) free(dist.nonGap);
+   if(dist.pairScore != NULL) free(dist.pairScore);
+   if(scoreSum       != NULL) free(scoreSum);
+   if(nonGapCount    != NULL) free(nonGapCount);
+   if(jobs           != NULL) free(jobs);
+   
+   return(ok);
 }
 
 /************************************************************************/
-/*>REAL **getSeqDistTable(char **SeqTable, int numSeqs, int seqlen, 
-                          int MaxInMatrix)
-   ----------------------------------------------------------------
-   Get 2d table of inter-sequence evolutionary distances.
-   
-   20.08.2015 Original   By: TCN
+/*>BOOL loadDistBlock(DISTDATA *dist, ALIGNMENT *aln, ALNSTREAM *stream,
+                      int block)
+   ---------------------------------------------------------------------
+   Loads a block of the alignment into the padded rows of dist and marks
+   the non-gap positions. If stream is NULL, the whole of aln is copied
+   and block is ignored.
+
+   15.10.26 Original   By: ACRM
 */
-REAL **getSeqDistTable(char **SeqTable, int numSeqs, int seqlen, 
-                       int MaxInMatrix)
+BOOL loadDistBlock(DISTDATA *dist, ALIGNMENT *aln, ALNSTREAM *stream,
+                   int block)
 {
-   int i, j;
-   REAL **seqDistTable;
-
-   if((seqDistTable = malloc(sizeof(REAL *) * numSeqs))==NULL)
+   unsigned char *column;
+   int           i, pos;
+   size_t        nCodes = (size_t)aln->nseq * dist->stride;
+   
+   if(stream != NULL)
    {
-      return (NULL); 
+      if(!ReadBlockRows(stream, block, dist->codes, dist->stride))
+         return(FALSE);
    }
-    
-   for(i=0; i<numSeqs; ++i)
+   else
    {
-      if((seqDistTable[i] = malloc(sizeof(REAL) * seqlen))==NULL)
-         return (NULL);
+      /* Copy the columns into rows already padded with gaps            */
+      for(pos=0; pos<aln->seqlen; pos++)
+      {
+         column = aln->codes + (size_t)pos * aln->nseq;
+         for(i=0; i<aln->nseq; i++)
+            dist->codes[(size_t)i * dist->stride + pos] = column[i];
+      }
    }
-    
-   for(i=0; i<numSeqs; ++i)
+   
+   for(i=0; i<nCodes; i++)
+   {
+      dist->nonGap[i] = 
+         (unsigned char)((dist->codes[i] != 0) && 
+                         (aln->res[dist->codes[i]] != ' '));
+   }
+
+   return(TRUE);
+}
+
+/************************************************************************/
+/*>void RunThreads(void *(*worker)(void *), void *queue, int nthreads)
+   ---------------------------------------------------------------------
+   Runs worker on queue in up to nthreads threads (including the calling 
+   thread) and waits for them to finish. If threads cannot be created, 
+   the calling thread does the remaining work.
+
+   15.10.26 Original   By: ACRM (split from RunJobQueue())
+*/
+void RunThreads(void *(*worker)(void *), void *queue, int nthreads)
+{
+   pthread_t *threads  = NULL;
+   int       nstarted = 0,
+             i;
+
+   if(nthreads > 1)
    {
-      for(j=0 ; j<numSeqs; ++j)
+      if((threads = (pthread_t *)malloc((nthreads-1) * 
+                                        sizeof(pthread_t)))!=NULL)
       {
-         if(i == j)
-            continue;
-         seqDistTable[i][j] = getInterSeqDistance(SeqTable, i, j, 
-                                                  seqlen, MaxInMatrix);  
+         for(i=0; i<nthreads-1; i++)
+         {
+            if(pthread_create(&(threads[nstarted]), NULL, worker, queue))
+               break;
+            nstarted++;
+         }
       }
    }
 
-   return seqDistTable;
+   worker(queue);
+
+   for(i=0; i<nstarted; i++)
+      pthread_join(threads[i], NULL);
+
+   if(threads != NULL) free(threads);
 }
 
+/************************************************************************/
+/*>void RunJobQueue(DISTJOB *jobs, int njobs, int nthreads)
+   --------------------------------------------------------
+   Runs the jobs using up to nthreads threads which each take the next 
+   job from a shared queue until none are left.
+
+   15.10.26 Original   By: ACRM
+   15.10.26 Uses RunThreads()
+*/
+void RunJobQueue(DISTJOB *jobs, int njobs, int nthreads)
+{
+   JOBQUEUE queue;
+
+   queue.jobs  = jobs;
+   queue.njobs = njobs;
+   queue.next  = 0;
+   pthread_mutex_init(&(queue.lock), NULL);
+
+   RunThreads(RunDistJobs, (void *)&queue, MIN(nthreads, njobs));
+
+   pthread_mutex_destroy(&(queue.lock));
+}
 
 /************************************************************************/
-/*>REAL getInterSeqDistance(char **SeqTable, int seqAindex, int seqBindex,
-                            int seqlen, int MaxInMatrix)
-   -----------------------------------------------------------------------
-   Calculates the evolutionary distance between two sequences.
-   
-   20.08.2015 Original   By: TCN
+/*>void *RunDistJobs(void *arg)
+   ----------------------------
+   Thread function which adds the sums for the distances in tiles from
+   the queue until it is empty
+
+   15.10.26 Original   By: ACRM
+   15.10.26 Adds to the sums rather than calculating the distances
 */
-REAL getInterSeqDistance(char **SeqTable, int seqAindex, int seqBindex,
-                         int seqlen, int MaxInMatrix)
+void *RunDistJobs(void *arg)
 {
-   int  nonGapPosCount,
-        matrixScoreSum = 0,
-        pos;
-   char res1, res2;
+   JOBQUEUE *queue = (JOBQUEUE *)arg;
+   DISTJOB  *job;
+   size_t   k;
+   int      i, j;
 
-   nonGapPosCount = getNonGapPosCount(SeqTable, seqAindex, 
-                                      seqBindex, seqlen);
-    
-   for(pos=0; pos<seqlen; pos++)
+   for(;;)
    {
-      res1 = SeqTable[seqAindex][pos];
-      res2 = SeqTable[seqBindex][pos];
-        
-      if (res1 == ' ')
-         res1 = '-';
-      if (res2 == ' ')
-         res2 = '-';
-       
-      if(! (res1 == '-' && res2 == '-'))
+      pthread_mutex_lock(&(queue->lock));
+      job = (queue->next < queue->njobs) ? 
+         queue->jobs + (queue->next)++ : NULL;
+      pthread_mutex_unlock(&(queue->lock));
+
+      if(job == NULL)
+         break;
+
+      for(i=job->firstRow; i<job->lastRow; i++)
       {
-         matrixScoreSum += valdarMatrixScore(res1, res2, MaxInMatrix);
+         for(j=MAX(job->firstCol, i+1); j<job->lastCol; j++)
+         {
+            k = (size_t)(i-job->firstRow) * job->numSeqs + j;
+            sumInterSeqScores(job->dist, i, j, job->scoreSum + k,
+                              job->nonGapCount + k);
+         }
       }
    }
 
-   return ((REAL)1.0 - ((REAL)matrixScoreSum / (REAL)nonGapPosCount));
+   return(NULL);
 }
 
 /************************************************************************/
-/*>int getNonGapPosCount(char **SeqTable, int seqAindex, int seqBindex, 
-                         int seqlen) 
-   --------------------------------------------------------------------
-   Given two sequences, counts the number of positions where at least 
-   one sequence is non-gap.
-   
+/*>void sumInterSeqScores(DISTDATA *dist, int seqA, int seqB, 
+                          int *scoreSum, int *nonGapCount)
+   ------------------------------------------------------------
+   Adds the matrix scores for two encoded sequences and the number of 
+   positions where at least one sequence is non-gap to the sums used for
+   the evolutionary distance between them:
+      1 - scoreSum/nonGapCount
+
+   Both are counted in a single pass. Gaps and padding score 0 so do not
+   need to be skipped. The pairScore[] lookup is a gather over the
+   residue codes, so while the compiler may use vector instructions for
+   the gap count and the sums, the lookups themselves are scalar loads.
+
    20.08.2015 Original   By: TCN
+   15.10.26   Takes encoded sequences and a score table   By: ACRM
+   15.10.26   Counts non-gap positions in the same pass using the gap
+              masks (replaces getNonGapPosCount())
+   15.10.26   Adds to the sums for the distance so it can be calculated
+              over blocks of the alignment (was getInterSeqDistance())
 */
-int getNonGapPosCount(char **SeqTable, int seqAindex, int seqBindex, 
-                      int seqlen)
+void sumInterSeqScores(DISTDATA *dist, int seqA, int seqB, 
+                       int *scoreSum, int *nonGapCount)
 {
-   int  pos,
-        nonGapPosCount = 0;
-   char res1, res2;
-    
-   for(pos=0; pos<seqlen; pos++)
+   const unsigned char *resA   = dist->codes  + (size_t)seqA*dist->stride,
+                       *resB   = dist->codes  + (size_t)seqB*dist->stride,
+                       *nonGapA = dist->nonGap + (size_t)seqA*dist->stride,
+                       *nonGapB = dist->nonGap + (size_t)seqB*dist->stride;
+   const int           *pairScore = dist->pairScore;
+   int                 ncodes     = dist->ncodes,
+                       nonGapPosCount = 0,
+                       matrixScoreSum = 0,
+                       pos;
+
+   for(pos=0; pos<dist->stride; pos++)
    {
-      res1 = SeqTable[seqAindex][pos];
-      res2 = SeqTable[seqBindex][pos];
-        
-      if (res1 == ' ')
-         res1 = '-';
-      if (res2 == ' ')
-         res2 = '-';
-       
-      if(! (res1 == '-' && res2 == '-'))
-      {
-         nonGapPosCount += 1;
-      }
+      nonGapPosCount += nonGapA[pos] | nonGapB[pos];
+      matrixScoreSum += pairScore[resA[pos] * ncodes + resB[pos]];
    }
 
-   return nonGapPosCount;
+   *scoreSum    += matrixScoreSum;
+   *nonGapCount += nonGapPosCount;
 }
 
 
@@ -1026,16 +2110,26 @@ REAL valdarMatrixScore(char res1, char res2, int MaxInMatrix)
    15.07.08 V1.3 - added -x
    11.08.15 V1.4
    24.08.15 V1.5 (added -d Valdar method)
+   15.10.26 V1.6
+   15.10.26 V1.7
+   15.10.26 V1.8 (added -j)
+   15.10.26 V1.9
+   15.10.26 V1.10
+   15.10.26 V1.11 (added -b)
+   15.10.26 V1.12
+   15.10.26 V1.13
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nScoreCons V1.5 (c) 1996-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\nScoreCons V1.13 (c) 1996-2026 Dr. Andrew C.R. \
 Martin, UCL\n");
    fprintf(stderr,"          valdar01 scoring implemented by Tom \
 Northey\n");
 
    fprintf(stderr,"\nUsage: scorecons [-m matrixfile] [-a|-g|-e|-d] \
-[-x] [alignment.pir [output.dat]]\n");
+[-x] [-j nthreads]\n");
+   fprintf(stderr,"                 [-b blocklen] [alignment.pir \
+[output.dat]]\n");
    fprintf(stderr,"       -m Specify the mutation matrix (Default: %s)\n",
            MUTMAT);
    fprintf(stderr,"       -a Score by entropy method per residue\n");
@@ -1044,6 +2138,12 @@ residues\n");
    fprintf(stderr,"       -e Score by combined entropy method\n");
    fprintf(stderr,"       -d Score by the valdar01 method\n");
    fprintf(stderr,"       -x Extended precision output\n");
+   fprintf(stderr,"       -j Number of threads used to calculate the \
+scores and the\n");
+   fprintf(stderr,"          valdar01 sequence weights [1]\n");
+   fprintf(stderr,"       -b Score the alignment in blocks of this many \
+columns. The\n");
+   fprintf(stderr,"          whole alignment is not held in memory\n");
 
    fprintf(stderr,"\nCalculates a conservation score between 0 and 1 \
 for a PIR format\n");
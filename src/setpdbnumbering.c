@@ -3,11 +3,11 @@
 
    \file       setpdbnumbering.c
    
-   \version    V1.5
-   \date       12.03.15
+   \version    V1.6
+   \date       15.10.26
    \brief      Apply standard numbering to a set of PDB files
    
-   \copyright  (c) Dr. Andrew C. R. Martin 1996-2015
+   \copyright  (c) Dr. Andrew C. R. Martin 1996-2026
    \author     Dr. Andrew C. R. Martin
    \par
                Biomolecular Structure & Modelling Unit,
@@ -61,6 +61,7 @@
 -  V1.4  05.03.15 Now calls pdbpatchnumbering rather than assuming the
                   link to patchpdbnum is available. Improved help message
 -  V1.5  12.03.15 Changed to allow multi-character chain names
+-  V1.6  15.10.26 Reports an error for a binary cache file
 
 *************************************************************************/
 /* Includes
@@ -78,6 +79,7 @@
 #include "bioplib/seq.h"
 #include "bioplib/macros.h"
 #include "bioplib/array.h"
+#include "common/pdbcache.h"
 
 /************************************************************************/
 /* Defines and macros
@@ -178,10 +180,11 @@ int main(int argc, char **argv)
 -  25.11.14 V1.3 By: ACRM
 -  05.03.15 V1.4
 -  12.03.15 V1.5
+-  15.10.26 V1.6
 */
 void Usage(void)
 {
-   fprintf(stderr,"\nsetpdbnumbering V1.5 (c) 1996-2015 Dr. Andrew C.R. \
+   fprintf(stderr,"\nsetpdbnumbering V1.6 (c) 1996-2026 Dr. Andrew C.R. \
 Martin, UCL\n");
 
    fprintf(stderr,"\nUsage: setpdbnumbering alnfile\n");
@@ -403,6 +406,12 @@ BOOL GetNumbering(NAMSEQ *namseq, char **numbering)
       return(FALSE);
    }
 
+   if(IsPDBCache(fp, "setpdbnumbering"))
+   {
+      fclose(fp);
+      return(FALSE);
+   }
+
    /* Read the PDB file                                                 */
    if((pdb=blReadPDB(fp, &natoms))!=NULL)
    {